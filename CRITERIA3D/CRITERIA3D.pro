@@ -21,6 +21,9 @@ INCLUDEPATH +=  ./shared ../PRAGA/shared  \
 
 CONFIG += debug_and_release
 
+# soilFluxes3D parallel solver
+*-g++*:QMAKE_LFLAGS += -fopenmp
+
 unix:{
     LIBS += -L../mapGraphics/release -lMapGraphics
 }
@@ -25,6 +25,8 @@
 */
 
 #include <math.h>
+#include <memory>
+#include <QFile>
 
 #include "commonConstants.h"
 #include "waterBalance3D.h"
@@ -175,11 +177,34 @@ bool setLayersDepth(Crit3DProject* myProject, double minThickness, double maxThi
 bool setCrit3DTopography(Crit3DProject* myProject)
 {
     double x, y;
-    double z, area, lateralArea, volume, slope;
+    double area, lateralArea, slope;
     long index, surfaceIndex, linkIndex;
     int myResult;
     QString myError;
 
+    long nrNodes = myProject->nrVoxels;
+    std::vector<float> nodeX(size_t(nrNodes)), nodeY(size_t(nrNodes)), nodeZ(size_t(nrNodes));
+    std::vector<float> nodeSlope(size_t(nrNodes), 0.f);
+    std::vector<double> volume_or_area(size_t(nrNodes));
+    std::vector<int> boundaryType(size_t(nrNodes), BOUNDARY_NONE);
+    std::unique_ptr<bool[]> isSurface(new bool[size_t(nrNodes)]());
+    std::unique_ptr<bool[]> isBoundary(new bool[size_t(nrNodes)]());
+
+    // links are collected in fixed slots (up, down, 8 lateral) and then compressed by node index
+    const size_t maxLinks = 10;
+    std::vector<int> nrLinks(size_t(nrNodes), 0);
+    std::vector<long> slotIndex(size_t(nrNodes) * maxLinks);
+    std::vector<short> slotDirection(size_t(nrNodes) * maxLinks);
+    std::vector<float> slotArea(size_t(nrNodes) * maxLinks);
+
+    auto addLinkSlot = [&](size_t node, long link, short direction, float interfaceArea)
+    {
+        size_t slot = node * maxLinks + size_t(nrLinks[node]++);
+        slotIndex[slot] = link;
+        slotDirection[slot] = direction;
+        slotArea[slot] = interfaceArea;
+    };
+
     for (int row = 0; row < myProject->indexMap.header->nrRows; row++)
         for (int col = 0; col < myProject->indexMap.header->nrCols; col++)
         {
@@ -189,82 +214,58 @@ bool setCrit3DTopography(Crit3DProject* myProject)
                 gis::getUtmXYFromRowCol(*(myProject->DTM.header), row, col, &x, &y);
                 area = myProject->DTM.header->cellSize * myProject->DTM.header->cellSize;
                 slope = myProject->radiationMaps->slopeMap->value[row][col] / 100.0;
+                bool isRunoff = (myProject->boundaryMap.value[row][col] == BOUNDARY_RUNOFF);
 
                 for (int layer = 0; layer < myProject->nrLayers; layer++)
                 {
                     index = layer * myProject->nrVoxelsPerLayer + surfaceIndex;
-                    z = myProject->DTM.value[row][col] - myProject->layerDepth[layer];
-                    volume = area * myProject->layerThickness[layer];
+                    size_t n = size_t(index);
+
+                    nodeX[n] = float(x);
+                    nodeY[n] = float(y);
+                    nodeZ[n] = float(myProject->DTM.value[row][col] - myProject->layerDepth[layer]);
 
                     //surface
                     if (layer == 0)
                     {
                         lateralArea = myProject->DTM.header->cellSize;
-                        if (myProject->boundaryMap.value[row][col] == BOUNDARY_RUNOFF)
+                        volume_or_area[n] = area;
+                        isSurface[n] = true;
+                        if (isRunoff)
                         {
-                            myResult = soilFluxes3D::setNode(index, float(x), float(y), float(z), area,
-                                             true, true, BOUNDARY_RUNOFF, float(slope));
-                        }
-                        else
-                        {
-                            myResult = soilFluxes3D::setNode(index, float(x), float(y), float(z), area,
-                                             true, false, BOUNDARY_NONE, 0.f);
+                            isBoundary[n] = true;
+                            boundaryType[n] = BOUNDARY_RUNOFF;
+                            nodeSlope[n] = float(slope);
                         }
                     }
                     //sub-surface
                     else
                     {
                         lateralArea = myProject->DTM.header->cellSize * myProject->layerThickness[layer];
+                        volume_or_area[n] = area * myProject->layerThickness[layer];
                         //last layer
                         if (layer == (myProject->nrLayers - 1))
                         {
-                            myResult = soilFluxes3D::setNode(index, float(x), float(y), float(z), volume,
-                                             false, true, BOUNDARY_FREEDRAINAGE, 0.f);
+                            isBoundary[n] = true;
+                            boundaryType[n] = BOUNDARY_FREEDRAINAGE;
                         }
-                        else
+                        else if (isRunoff)
                         {
-                            if (myProject->boundaryMap.value[row][col] == BOUNDARY_RUNOFF)
-                            {
-                                myResult = soilFluxes3D::setNode(index, float(x), float(y), float(z), volume,
-                                                 false, true, BOUNDARY_FREELATERALDRAINAGE, float(slope));
-                            }
-                            else
-                            {
-                                myResult = soilFluxes3D::setNode(index, float(x), float(y), float(z), volume,
-                                             false, false, BOUNDARY_NONE, 0.f);
-                            }
+                            isBoundary[n] = true;
+                            boundaryType[n] = BOUNDARY_FREELATERALDRAINAGE;
+                            nodeSlope[n] = float(slope);
                         }
                     }
-                    //check error
-                    if (isCrit3dError(myResult, &myError))
-                    {
-                        myProject->errorString = "setCrit3DTopography:" + myError
-                                    + " in layer nr:" + QString::number(layer);
-                        return(false);
-                    }
+
                     //up link
                     if (layer > 0)
                     {
-                        linkIndex = index - myProject->nrVoxelsPerLayer;
-                        myResult = soilFluxes3D::setNodeLink(index, linkIndex, UP, float(area));
-                        if (isCrit3dError(myResult, &myError))
-                        {
-                            myProject->errorString = "setNodeLink:" + myError
-                                    + " in layer nr:" + QString::number(layer);
-                            return(false);
-                        }
+                        addLinkSlot(n, index - myProject->nrVoxelsPerLayer, UP, float(area));
                     }
                     //down link
                     if (layer < (myProject->nrLayers - 1))
                     {
-                        linkIndex = index + myProject->nrVoxelsPerLayer;
-                        myResult = soilFluxes3D::setNodeLink(index, linkIndex, DOWN, float(area));
-                        if (isCrit3dError(myResult, &myError))
-                        {
-                            myProject->errorString = "setNodeLink:" + myError
-                                    + " in layer nr:" + QString::number(layer);
-                            return(false);
-                        }
+                        addLinkSlot(n, index + myProject->nrVoxelsPerLayer, DOWN, float(area));
                     }
                     //lateral links
                     for (int i=-1; i <= 1; i++)
@@ -279,13 +280,7 @@ bool setCrit3DTopography(Crit3DProject* myProject)
                                     if (linkIndex != myProject->indexMap.header->flag)
                                     {
                                         linkIndex += layer * myProject->nrVoxelsPerLayer;
-                                        myResult = soilFluxes3D::setNodeLink(index, linkIndex, LATERAL, float(lateralArea / 2.));
-                                        if (isCrit3dError(myResult, &myError))
-                                        {
-                                            myProject->errorString = "setNodeLink:" + myError
-                                                    + " in layer nr:" + QString::number(layer);
-                                            return(false);
-                                        }
+                                        addLinkSlot(n, linkIndex, LATERAL, float(lateralArea / 2.));
                                     }
                                 }
                             }
@@ -295,6 +290,42 @@ bool setCrit3DTopography(Crit3DProject* myProject)
             }
          }
 
+    myResult = soilFluxes3D::setNodes(0, nrNodes, nodeX.data(), nodeY.data(), nodeZ.data(),
+                                      volume_or_area.data(), isSurface.get(), isBoundary.get(),
+                                      boundaryType.data(), nodeSlope.data());
+    if (isCrit3dError(myResult, &myError))
+    {
+        myProject->errorString = "setCrit3DTopography:" + myError;
+        return(false);
+    }
+
+    std::vector<long> firstLink(size_t(nrNodes) + 1, 0);
+    for (size_t n = 0; n < size_t(nrNodes); n++)
+        firstLink[n+1] = firstLink[n] + nrLinks[n];
+
+    std::vector<long> linkIndexes(size_t(firstLink.back()));
+    std::vector<short> directions(size_t(firstLink.back()));
+    std::vector<float> interfaceAreas(size_t(firstLink.back()));
+    for (size_t n = 0; n < size_t(nrNodes); n++)
+    {
+        for (int k = 0; k < nrLinks[n]; k++)
+        {
+            size_t slot = n * maxLinks + size_t(k);
+            size_t l = size_t(firstLink[n] + k);
+            linkIndexes[l] = slotIndex[slot];
+            directions[l] = slotDirection[slot];
+            interfaceAreas[l] = slotArea[slot];
+        }
+    }
+
+    myResult = soilFluxes3D::setLinksCSR(0, nrNodes, firstLink.data(), linkIndexes.data(),
+                                         directions.data(), interfaceAreas.data());
+    if (isCrit3dError(myResult, &myError))
+    {
+        myProject->errorString = "setNodeLink:" + myError;
+        return(false);
+    }
+
    return (true);
 }
 
@@ -556,14 +587,11 @@ bool setWaterSinkSource(Crit3DProject* myProject, double* totalPrecipitation,
             }
         }
 
-    for (long i = 0; i < myProject->nrVoxels; i++)
+    myResult = soilFluxes3D::setWaterSinkSources(0, myProject->nrVoxels, waterSinkSource.data());
+    if (isCrit3dError(myResult, &myError))
     {
-        myResult = soilFluxes3D::setWaterSinkSource(i, waterSinkSource[i]);
-        if (isCrit3dError(myResult, &myError))
-        {
-            myProject->errorString = "initializeSoilMoisture:" + myError;
-            return(false);
-        }
+        myProject->errorString = "initializeSoilMoisture:" + myError;
+        return(false);
     }
 
     return(true);
@@ -896,8 +924,12 @@ std::string getPrefixFromVar(Crit3DDate myDate, criteria3DVariable myVar)
     return fileName;
 }
 
+// matric potential: binary snapshot of soilFluxes3D if available, otherwise ESRI maps (previous states)
 bool loadWaterBalanceState(Crit3DProject* myProject, Crit3DDate myDate, std::string statePath, criteria3DVariable myVar)
 {
+    if (myVar == waterMatricPotential && loadSoilFluxesState(myProject, myDate, statePath))
+        return true;
+
     std::string myErrorString;
     std::string myMapName;
 
@@ -922,6 +954,37 @@ bool loadWaterBalanceState(Crit3DProject* myProject, Crit3DDate myDate, std::str
 }
 
 
+// binary snapshot of the whole soilFluxes3D state (water, heat, balances, time step)
+bool saveSoilFluxesState(Crit3DProject* myProject, Crit3DDate myDate, std::string statePath)
+{
+    std::string fileName = statePath + myDate.toStdString() + "_soilFluxes3D.state";
+    int result = soilFluxes3D::saveState(fileName.c_str());
+    if (result != CRIT3D_OK)
+    {
+        myProject->logError("Error in saving soilFluxes3D state: " + QString::fromStdString(fileName)
+                            + " error: " + QString::number(result));
+        return false;
+    }
+    return true;
+}
+
+
+// fast restart: false if the snapshot is missing or does not match the current domain
+bool loadSoilFluxesState(Crit3DProject* myProject, Crit3DDate myDate, std::string statePath)
+{
+    std::string fileName = statePath + myDate.toStdString() + "_soilFluxes3D.state";
+    if (! QFile::exists(QString::fromStdString(fileName))) return false;
+
+    int result = soilFluxes3D::loadState(fileName.c_str());
+    if (result != CRIT3D_OK)
+    {
+        myProject->log("soilFluxes3D state not valid: " + fileName + " error: " + std::to_string(result));
+        return false;
+    }
+    return true;
+}
+
+
 //[m] upper depth of soil layer
 double getSoilLayerTop(Crit3DProject* myProject, int i)
 {
@@ -950,8 +1013,12 @@ int getSoilLayerIndex(Crit3DProject* myProject, double depth)
 }
 
 
+// matric potential: binary snapshot of soilFluxes3D, the other variables as ESRI maps
 bool saveWaterBalanceState(Crit3DProject* myProject, Crit3DDate myDate, std::string statePath, criteria3DVariable myVar)
 {
+    if (myVar == waterMatricPotential)
+        return saveSoilFluxesState(myProject, myDate, statePath);
+
     std::string myErrorString;
     gis::Crit3DRasterGrid* myMap;
     myMap = new gis::Crit3DRasterGrid();
@@ -25,6 +25,10 @@
 
     bool loadWaterBalanceState(Crit3DProject* myProject, Crit3DDate myDate, std::string myStatePath, criteria3DVariable myVar);
 
+    bool saveSoilFluxesState(Crit3DProject* myProject, Crit3DDate myDate, std::string myStatePath);
+
+    bool loadSoilFluxesState(Crit3DProject* myProject, Crit3DDate myDate, std::string myStatePath);
+
     bool getCriteria3DVarMap(Crit3DProject* myProject, criteria3DVariable myVar, int layerIndex,
                              gis::Crit3DRasterGrid* criteria3DMap);
 
@@ -727,10 +727,14 @@ bool runHeat1D(double myHourlyTemperature,  double myHourlyRelativeHumidity,
     {
         soilFluxes3D::setHeatBoundaryHeightWind(1, 2);
         soilFluxes3D::setHeatBoundaryHeightTemperature(1, 1.5);
-        soilFluxes3D::setHeatBoundaryTemperature(1, myHourlyTemperature);
-        soilFluxes3D::setHeatBoundaryRelativeHumidity(1, myHourlyRelativeHumidity);
-        soilFluxes3D::setHeatBoundaryWindSpeed(1, myHourlyWindSpeed);
-        soilFluxes3D::setHeatBoundaryNetIrradiance(1, myHourlyNetIrradiance);
+
+        long boundaryNode = 1;
+        TheatBoundaryForcing forcing;
+        forcing.temperature = &myHourlyTemperature;
+        forcing.relativeHumidity = &myHourlyRelativeHumidity;
+        forcing.windSpeed = &myHourlyWindSpeed;
+        forcing.netIrradiance = &myHourlyNetIrradiance;
+        soilFluxes3D::setHeatBoundaryForcing(1, &boundaryNode, &forcing);
 
         /*
         surfaceWaterHeight = soilFluxes3D::getWaterContent(0);
@@ -11,6 +11,9 @@ TEMPLATE = app
 
 CONFIG += debug_and_release
 
+# soilFluxes3D parallel solver
+*-g++*:QMAKE_LFLAGS += -fopenmp
+
 CONFIG(debug, debug|release) {
     LIBS += -L../soilFluxes3D/debug -lsoilFluxes3D
     LIBS += -L../mathFunctions/debug -lmathFunctions
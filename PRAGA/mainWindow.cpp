@@ -1228,7 +1228,8 @@ void MainWindow::on_actionSave_meteo_grid_triggered()
 {
     if (myProject.meteoGridDbHandler != nullptr)
     {
-        myProject.saveGrid(myProject.getCurrentVariable(), myProject.getFrequency(), myProject.getCurrentTime(), true);
+        if (! myProject.saveGrid(myProject.getCurrentVariable(), myProject.getFrequency(), myProject.getCurrentTime(), true))
+            myProject.logError();
     }
 }
 
@@ -1687,6 +1688,27 @@ void MainWindow::on_actionLoadTAD_triggered()
         myProject.logError();
 }
 
+void MainWindow::on_actionShowKrigingVariance_triggered()
+{
+    if (! myProject.krigingVarianceRaster.isLoaded)
+    {
+        myProject.logError("Kriging variance not available: interpolate on DEM with kriging and the kriging variance option");
+        return;
+    }
+
+    setCurrentRaster(&(myProject.krigingVarianceRaster));
+    ui->labelRasterScale->setText("Kriging variance");
+}
+
+void MainWindow::on_actionSaveKrigingVariance_triggered()
+{
+    QString fileName = QFileDialog::getSaveFileName(this, tr("Save kriging variance"), "", tr("ESRI grid files (*.flt)"));
+    if (fileName == "") return;
+
+    if (! myProject.saveKrigingVariance(fileName))
+        myProject.logError();
+}
+
 void MainWindow::on_meteoPoints_clicked()
 {
     redrawMeteoPoints(currentPointsVisualization, true);
@@ -79,6 +79,8 @@
         void on_actionParameters_triggered();
         void on_actionWriteTAD_triggered();
         void on_actionLoadTAD_triggered();
+        void on_actionShowKrigingVariance_triggered();
+        void on_actionSaveKrigingVariance_triggered();
         void on_actionClimate_fields_triggered();
 
         void on_actionShowPointsHide_triggered();
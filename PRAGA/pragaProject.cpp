@@ -5,6 +5,7 @@
 #include "download.h"
 #include "formInfo.h"
 
+#include <algorithm>
 #include <iostream> //debug
 
 bool PragaProject::getIsElabMeteoPointsValue() const
@@ -76,7 +77,11 @@ bool PragaProject::interpolationMeteoGrid(meteoVariable myVar, frequencyType myF
         {
             return false;
         }
-        meteoGridDbHandler->meteoGrid()->aggregateMeteoGrid(myVar, myFrequency, myTime.date, myTime.getHour(), myTime.getMinutes(), &DTM, dataRaster, interpolationSettings.getMeteoGridAggrMethod());
+        if (! meteoGridDbHandler->meteoGrid()->aggregateMeteoGrid(myVar, myFrequency, myTime.date, myTime.getHour(), myTime.getMinutes(), &DTM, &dataRaster, interpolationSettings.getMeteoGridAggrMethod()))
+        {
+            errorString = "No meteo grid cell aggregated: check the DEM and the grid coverage";
+            return false;
+        }
         meteoGridDbHandler->meteoGrid()->fillMeteoRaster();
     }
     else
@@ -89,71 +94,29 @@ bool PragaProject::interpolationMeteoGrid(meteoVariable myVar, frequencyType myF
 
 bool PragaProject::saveGrid(meteoVariable myVar, frequencyType myFrequency, const Crit3DTime& myTime, bool showInfo)
 {
-    std::string id;
     FormInfo myInfo;
-    int infoStep;
-
+    QDate myDate(myTime.date.year, myTime.date.month, myTime.date.day);
+    bool isOk = false;
 
     if (myFrequency == daily)
     {
         if (showInfo)
-        {
-            QString infoStr = "Save grid daily data";
-            infoStep = myInfo.start(infoStr, this->meteoGridDbHandler->gridStructure().header().nrRows);
-        }
+            myInfo.start("Save grid daily data", 0);
 
-        for (int row = 0; row < this->meteoGridDbHandler->gridStructure().header().nrRows; row++)
-        {
-            if (showInfo && (row % infoStep) == 0)
-                myInfo.setValue(row);
-            for (int col = 0; col < this->meteoGridDbHandler->gridStructure().header().nrCols; col++)
-            {
-                if (this->meteoGridDbHandler->meteoGrid()->getMeteoPointActiveId(row, col, &id))
-                {
-                    if (!this->meteoGridDbHandler->gridStructure().isFixedFields())
-                    {
-                        this->meteoGridDbHandler->saveCellCurrrentGridDaily(&errorString, QString::fromStdString(id), QDate(myTime.date.year, myTime.date.month, myTime.date.day), this->meteoGridDbHandler->getDailyVarCode(myVar), this->meteoGridDbHandler->meteoGrid()->meteoPoint(row,col).currentValue);
-                    }
-                    else
-                    {
-                        this->meteoGridDbHandler->saveCellCurrentGridDailyFF(&errorString, QString::fromStdString(id), QDate(myTime.date.year, myTime.date.month, myTime.date.day), QString::fromStdString(this->meteoGridDbHandler->getDailyPragaName(myVar)), this->meteoGridDbHandler->meteoGrid()->meteoPoint(row,col).currentValue);
-                    }
-                }
-            }
-        }
+        isOk = this->meteoGridDbHandler->saveGridCurrentDaily(&errorString, myDate, myVar);
     }
     else if (myFrequency == hourly)
     {
         if (showInfo)
-        {
-            QString infoStr = "Save grid hourly data";
-            infoStep = myInfo.start(infoStr, this->meteoGridDbHandler->gridStructure().header().nrRows);
-        }
+            myInfo.start("Save grid hourly data", 0);
 
-        for (int row = 0; row < this->meteoGridDbHandler->gridStructure().header().nrRows; row++)
-        {
-            if (showInfo && (row % infoStep) == 0)
-                myInfo.setValue(row);
-            for (int col = 0; col < this->meteoGridDbHandler->gridStructure().header().nrCols; col++)
-            {
-                if (this->meteoGridDbHandler->meteoGrid()->getMeteoPointActiveId(row, col, &id))
-                {
-                    if (!this->meteoGridDbHandler->gridStructure().isFixedFields())
-                    {
-                        this->meteoGridDbHandler->saveCellCurrentGridHourly(&errorString, QString::fromStdString(id), QDateTime(QDate(myTime.date.year, myTime.date.month, myTime.date.day), QTime(myTime.getHour(), myTime.getMinutes(), myTime.getSeconds())), this->meteoGridDbHandler->getHourlyVarCode(myVar), this->meteoGridDbHandler->meteoGrid()->meteoPoint(row,col).currentValue);
-                    }
-                    else
-                    {
-                        this->meteoGridDbHandler->saveCellCurrentGridHourlyFF(&errorString, QString::fromStdString(id), QDateTime(QDate(myTime.date.year, myTime.date.month, myTime.date.day), QTime(myTime.getHour(), myTime.getMinutes(), myTime.getSeconds())), QString::fromStdString(this->meteoGridDbHandler->getHourlyPragaName(myVar)), this->meteoGridDbHandler->meteoGrid()->meteoPoint(row,col).currentValue);
-                    }
-                }
-            }
-        }
+        QDateTime myDateTime(myDate, QTime(myTime.getHour(), myTime.getMinutes(), myTime.getSeconds()));
+        isOk = this->meteoGridDbHandler->saveGridCurrentHourly(&errorString, myDateTime, myVar);
     }
 
     if (showInfo) myInfo.close();
 
-    return true;
+    return isOk;
 }
 
 bool PragaProject::elaborationCheck(bool isMeteoGrid, bool isAnomaly)
@@ -530,7 +493,7 @@ bool PragaProject::elaborationPointsCycle(bool isAnomaly, bool showInfo)
 
             // meteoPointTemp should be init
             meteoPointTemp->nrObsDataDaysH = 0;
-            meteoPointTemp->nrObsDataDaysD = 0;
+            meteoPointTemp->cleanObsDataD();
 
             if (showInfo && (i % infoStep) == 0)
                         myInfo.setValue(i);
@@ -633,12 +596,34 @@ bool PragaProject::elaborationPointsCycleGrid(bool isAnomaly, bool showInfo)
 
      Crit3DMeteoPoint* meteoPointTemp = new Crit3DMeteoPoint;
 
-     for (int row = 0; row < meteoGridDbHandler->gridStructure().header().nrRows; row++)
+     // daily data are preloaded in parallel for blocks of rows (at most MAX_PRELOAD_VALUES cell-days):
+     // the elaboration of each cell reads them from memory
+     const long MAX_PRELOAD_VALUES = 1000000;
+     int nrRows = meteoGridDbHandler->gridStructure().header().nrRows;
+     int nrCols = meteoGridDbHandler->gridStructure().header().nrCols;
+     bool isPreload = getFrequency(climaUsed->variable()) == daily && ! (isAnomaly && climaUsed->getIsClimateAnomalyFromDb());
+     long nrPreloadDays = startDate.daysTo(endDate) + 1;
+     int blockRows = int(std::max(1L, MAX_PRELOAD_VALUES / (std::max(1L, nrPreloadDays) * std::max(1, nrCols))));
+
+     for (int row = 0; row < nrRows; row++)
      {
          if (showInfo && (row % infoStep) == 0)
              myInfo.setValue(row);
 
-         for (int col = 0; col < meteoGridDbHandler->gridStructure().header().nrCols; col++)
+         if (isPreload && (row % blockRows) == 0)
+         {
+             std::vector<std::string> idList;
+             for (int blockRow = row; blockRow < std::min(row + blockRows, nrRows); blockRow++)
+                 for (int col = 0; col < nrCols; col++)
+                     if (meteoGridDbHandler->meteoGrid()->getMeteoPointActiveId(blockRow, col, &id))
+                         idList.push_back(id);
+
+             // on error the cells are read from the db
+             QString preloadError;
+             meteoGridDbHandler->preloadGridDailyData(&preloadError, idList, startDate, endDate);
+         }
+
+         for (int col = 0; col < nrCols; col++)
          {
 
             if (meteoGridDbHandler->meteoGrid()->getMeteoPointActiveId(row, col, &id))
@@ -654,7 +639,7 @@ bool PragaProject::elaborationPointsCycleGrid(bool isAnomaly, bool showInfo)
 
                 // meteoPointTemp should be init
                 meteoPointTemp->nrObsDataDaysH = 0;
-                meteoPointTemp->nrObsDataDaysD = 0;
+                meteoPointTemp->cleanObsDataD();
 
                 if (isAnomaly && climaUsed->getIsClimateAnomalyFromDb())
                 {
@@ -681,6 +666,8 @@ bool PragaProject::elaborationPointsCycleGrid(bool isAnomaly, bool showInfo)
         }
     }
 
+    meteoGridDbHandler->clearPreloadedData();
+
     if (showInfo) myInfo.close();
 
     if (validCell == 0)
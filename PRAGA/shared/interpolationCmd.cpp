@@ -4,41 +4,37 @@
 #include "gis.h"
 
 bool interpolationRaster(std::vector <Crit3DInterpolationDataPoint> &myPoints, Crit3DInterpolationSettings* mySettings,
-                        gis::Crit3DRasterGrid* myGrid, const gis::Crit3DRasterGrid& myDTM, meteoVariable myVar, bool showInfo)
+                        gis::Crit3DRasterGrid* myGrid, const gis::Crit3DRasterGrid& myDTM, meteoVariable myVar,
+                        gis::Crit3DRasterGrid* varianceGrid, bool showInfo)
 {
     if (! myGrid->initializeGrid(myDTM))
         return false;
 
+    // kriging variance (NODATA where the method gives no estimate)
+    if (varianceGrid != nullptr && ! varianceGrid->initializeGrid(myDTM))
+        return false;
+
     FormInfo myInfo;
-    int infoStep;
     QString infoStr;
+    std::function<void(int)> progress;
 
     if (showInfo)
     {
         infoStr = "Interpolation on DEM...";
-        infoStep = myInfo.start(infoStr, myGrid->header->nrRows);
+        myInfo.start(infoStr, myGrid->header->nrRows);
+        progress = [&myInfo](int nrRows) { myInfo.setValue(nrRows); };
     }
 
-    float myX, myY;
-
-    for (long myRow = 0; myRow < myGrid->header->nrRows ; myRow++)
-    {
-        if (showInfo)
-            myInfo.setValue(myRow);
-
-        for (long myCol = 0; myCol < myGrid->header->nrCols; myCol++)
-        {
-            gis::getUtmXYFromRowColSinglePrecision(*myGrid, myRow, myCol, &myX, &myY);
-            float myZ = myDTM.value[myRow][myCol];
-            if (myZ != myGrid->header->flag)
-                myGrid->value[myRow][myCol] = interpolate(myPoints, mySettings, myVar, myX, myY, myZ, getProxyValuesXY(myX, myY, mySettings), true);
-        }
-    }
+    // row tiles on all the cores
+    bool isOk = interpolationRasterParallel(myPoints, mySettings, myVar, myDTM, myGrid, varianceGrid, 0, progress);
 
     if (showInfo) myInfo.close();
 
-    if (! gis::updateMinMaxRasterGrid(myGrid))
+    if (! isOk || ! gis::updateMinMaxRasterGrid(myGrid))
         return false;
 
+    if (varianceGrid != nullptr)
+        gis::updateMinMaxRasterGrid(varianceGrid);
+
     return true;
 }
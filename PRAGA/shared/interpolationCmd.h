@@ -16,6 +16,7 @@
 
 
 bool interpolationRaster(std::vector <Crit3DInterpolationDataPoint> &myPoints, Crit3DInterpolationSettings* mySettings,
-                        gis::Crit3DRasterGrid* myGrid, const gis::Crit3DRasterGrid& myDTM, meteoVariable myVar, bool showInfo);
+                        gis::Crit3DRasterGrid* myGrid, const gis::Crit3DRasterGrid& myDTM, meteoVariable myVar,
+                        gis::Crit3DRasterGrid* varianceGrid, bool showInfo);
 
 #endif // INTERPOLATIONCMD_H
@@ -85,6 +85,32 @@ InterpolationDialog::InterpolationDialog(Project *myProject)
     layoutAlgorithm->addWidget(&algorithmEdit);
     layoutMain->addLayout(layoutAlgorithm);
 
+    // kriging
+    QHBoxLayout *layoutKriging = new QHBoxLayout;
+    QLabel *labelKrigingType = new QLabel(tr("kriging type"));
+    layoutKriging->addWidget(labelKrigingType);
+
+    std::map<std::string, TkrigingType>::const_iterator itKriging;
+    for (itKriging = krigingTypeNames.begin(); itKriging != krigingTypeNames.end(); ++itKriging)
+    {
+        krigingTypeEdit.addItem(QString::fromStdString(itKriging->first), QString::fromStdString(itKriging->first));
+        if (itKriging->second == _interpolationSettings->getKrigingType())
+            krigingTypeEdit.setCurrentIndex(krigingTypeEdit.count() - 1);
+    }
+    layoutKriging->addWidget(&krigingTypeEdit);
+
+    QLabel *labelKrigingNeighbours = new QLabel(tr("neighbours (0 = all)"));
+    layoutKriging->addWidget(labelKrigingNeighbours);
+    krigingNeighboursEdit.setFixedWidth(50);
+    krigingNeighboursEdit.setValidator(new QIntValidator(0, 10000, this));
+    krigingNeighboursEdit.setText(QString::number(_interpolationSettings->getKrigingNrNeighbours()));
+    layoutKriging->addWidget(&krigingNeighboursEdit);
+
+    krigingVarianceEdit = new QCheckBox(tr("kriging variance"));
+    krigingVarianceEdit->setChecked(_interpolationSettings->getComputeKrigingVariance());
+    layoutKriging->addWidget(krigingVarianceEdit);
+    layoutMain->addLayout(layoutKriging);
+
     // proxies
     QHBoxLayout *layoutProxy = new QHBoxLayout;
     QLabel *labelProxy = new QLabel(tr("temperature detrending proxies"));
@@ -157,6 +183,9 @@ void InterpolationDialog::writeInterpolationSettings()
     _paramSettings->setValue("useDewPoint", useDewPointEdit->isChecked());
     _paramSettings->setValue("thermalInversion", thermalInversionEdit->isChecked());
     _paramSettings->setValue("minRegressionR2", minRegressionR2Edit.text());
+    _paramSettings->setValue("krigingType", krigingTypeEdit.itemData(krigingTypeEdit.currentIndex()).toString());
+    _paramSettings->setValue("krigingNeighbours", krigingNeighboursEdit.text().toInt());
+    _paramSettings->setValue("krigingVariance", krigingVarianceEdit->isChecked());
     _paramSettings->endGroup();
 
     Crit3DProxy* myProxy;
@@ -199,6 +228,11 @@ void InterpolationDialog::accept()
     _interpolationSettings->setUseDewPoint(useDewPointEdit->isChecked());
     _interpolationSettings->setMinRegressionR2(minRegressionR2Edit.text().toFloat());
 
+    QString krigingString = krigingTypeEdit.itemData(krigingTypeEdit.currentIndex()).toString();
+    _interpolationSettings->setKrigingType(krigingTypeNames.at(krigingString.toStdString()));
+    _interpolationSettings->setKrigingNrNeighbours(krigingNeighboursEdit.text().toInt());
+    _interpolationSettings->setComputeKrigingVariance(krigingVarianceEdit->isChecked());
+
     _qualityInterpolationSettings->setMinRegressionR2(minRegressionR2Edit.text().toFloat());
     _qualityInterpolationSettings->setUseLapseRateCode(lapseRateCodeEdit->isChecked());
     _qualityInterpolationSettings->setUseThermalInversion(thermalInversionEdit->isChecked());
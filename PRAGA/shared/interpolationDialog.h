@@ -19,6 +19,9 @@ class InterpolationDialog : public QDialog
         explicit InterpolationDialog(Project *myProject);
 
         QComboBox algorithmEdit;
+        QComboBox krigingTypeEdit;
+        QLineEdit krigingNeighboursEdit;
+        QCheckBox* krigingVarianceEdit;
         QLineEdit minRegressionR2Edit;
         QCheckBox* lapseRateCodeEdit;
         QCheckBox* thermalInversionEdit;
@@ -44,6 +44,7 @@ void Project::inizializeDBConnection()
     dbPort = NODATA;
     dbUsername = "";
     dbPassword = "";
+    isMeteoPointsCache = false;
 }
 
 bool Project::openDBConnection()
@@ -222,6 +223,13 @@ bool Project::loadParameters(QString parametersFileName)
             if (parameters->contains("topographicDistance"))
                 interpolationSettings.setUseTAD(parameters->value("topographicDistance").toBool());
 
+            // resolution factor of the topographic distance maps: default 1 (exact), > 1 faster but less accurate
+            if (parameters->contains("topographicDistanceFactor"))
+                topoDistanceCache.setResolutionFactor(parameters->value("topographicDistanceFactor").toInt());
+
+            if (parameters->contains("topographicDistanceMemoryMB"))
+                topoDistanceCache.setMaxMemoryMB(parameters->value("topographicDistanceMemoryMB").toInt());
+
             if (parameters->contains("lapseRateCode"))
             {
                 interpolationSettings.setUseLapseRateCode(parameters->value("lapseRateCode").toBool());
@@ -240,6 +248,24 @@ bool Project::loadParameters(QString parametersFileName)
             if (parameters->contains("useDewPoint"))
                 interpolationSettings.setUseDewPoint(parameters->value("useDewPoint").toBool());
 
+            if (parameters->contains("krigingType"))
+            {
+                std::string krigingType = parameters->value("krigingType").toString().toStdString();
+                if (krigingTypeNames.find(krigingType) == krigingTypeNames.end())
+                {
+                    errorString = "Unknown kriging type";
+                    return false;
+                }
+                else
+                    interpolationSettings.setKrigingType(krigingTypeNames.at(krigingType));
+            }
+
+            if (parameters->contains("krigingNeighbours"))
+                interpolationSettings.setKrigingNrNeighbours(parameters->value("krigingNeighbours").toInt());
+
+            if (parameters->contains("krigingVariance"))
+                interpolationSettings.setComputeKrigingVariance(parameters->value("krigingVariance").toBool());
+
             parameters->endGroup();
 
         }
@@ -346,6 +372,7 @@ bool Project::loadCommonSettings(QString settingsFileName)
         if (projectSettings->contains("dbname") && !projectSettings->value("dbname").toString().isEmpty()) dbName = projectSettings->value("dbname").toString();
         if (projectSettings->contains("username") && !projectSettings->value("username").toString().isEmpty()) dbUsername = projectSettings->value("username").toString();
         if (projectSettings->contains("password") && !projectSettings->value("password").toString().isEmpty()) dbPassword = projectSettings->value("password").toString();
+        isMeteoPointsCache = projectSettings->value("meteo_points_cache", false).toBool();
     projectSettings->endGroup();
 
     projectSettings->beginGroup("location");
@@ -525,12 +552,10 @@ bool Project::loadDEM(QString myFileName)
     }
     radiationMaps = new Crit3DRadiationMaps(DTM, gisSettings);
 
-    //reset aggregationPoints meteoGrid
+    //reset aggregationPoints meteoGrid (the aggregation matrix is computed again on the new DEM)
     if (meteoGridDbHandler != nullptr)
     {
         meteoGridDbHandler->meteoGrid()->setIsAggregationDefined(false);
-        // TODO
-        // ciclo sulle celle della meteo grid -> clean vettore aggregation points
     }
 
     setProxyDEM();
@@ -539,6 +564,14 @@ bool Project::loadDEM(QString myFileName)
     interpolationSettings.setCurrentDEM(&DTM);
     qualityInterpolationSettings.setCurrentDEM(&DTM);
 
+    //maps of topographic distance on the new DEM (DATA/GEO/TAD)
+    QString mapsFolder = this->path + "DATA/GEO/TAD/";
+    if (! QDir(mapsFolder).exists())
+        QDir().mkpath(mapsFolder);
+    topoDistanceCache.initialize(&DTM, mapsFolder.toStdString());
+    interpolationSettings.setTopoDistanceCache(&topoDistanceCache);
+    qualityInterpolationSettings.setTopoDistanceCache(&topoDistanceCache);
+
     //check points position with respect to DEM
     checkMeteoPointsDEM();
 
@@ -559,6 +592,7 @@ bool Project::loadMeteoPointsDB(QString dbName)
         closeMeteoPointsDB();
         return false;
     }
+    meteoPointsDbHandler->setCacheActive(isMeteoPointsCache);
 
     QList<Crit3DMeteoPoint> listMeteoPoints = meteoPointsDbHandler->getPropertiesFromDb(gisSettings, &errorString);
 
@@ -623,9 +657,7 @@ bool Project::loadMeteoPointsData(QDate firstDate, QDate lastDate, bool showInfo
     //check
     if (firstDate == QDate(1800,1,1) || lastDate == QDate(1800,1,1)) return false;
 
-    bool isData = false;
     FormInfo myInfo;
-    int step = 0;
 
     QString infoStr = "Load data: " + firstDate.toString();
 
@@ -633,25 +665,13 @@ bool Project::loadMeteoPointsData(QDate firstDate, QDate lastDate, bool showInfo
         infoStr += " - " + lastDate.toString();
 
     if (showInfo)
-        step = myInfo.start(infoStr, nrMeteoPoints);
-
-    for (int i=0; i < nrMeteoPoints; i++)
     {
-        if (showInfo)
-        {
-            if ((i % step) == 0) myInfo.setValue(i);
-        }
+        myInfo.start(infoStr, nrMeteoPoints);
+        QObject::connect(meteoPointsDbHandler, &Crit3DMeteoPointsDbHandler::loadingProgress, &myInfo, &FormInfo::setValue);
+    }
 
-        if (meteoPointsDbHandler->loadDailyData(getCrit3DDate(firstDate), getCrit3DDate(lastDate), &(meteoPoints[i])))
-        {
-            isData = true;
-        }
+    bool isData = meteoPointsDbHandler->loadAllData(getCrit3DDate(firstDate), getCrit3DDate(lastDate), meteoPoints, nrMeteoPoints);
 
-        if (meteoPointsDbHandler->loadHourlyData(getCrit3DDate(firstDate), getCrit3DDate(lastDate), &(meteoPoints[i])))
-        {
-            isData = true;
-        }
-    }
     if (showInfo) myInfo.close();
 
     return isData;
@@ -674,107 +694,44 @@ void Project::loadMeteoGridData(QDate firstDate, QDate lastDate, bool showInfo)
 
 bool Project::loadMeteoGridDailyData(QDate firstDate, QDate lastDate, bool showInfo)
 {
-    std::string id;
-    int count = 0;
-
     FormInfo myInfo;
-    int infoStep = 1;
 
     if (showInfo)
     {
         QString infoStr = "Load grid daily data: " + firstDate.toString();
         if (firstDate != lastDate) infoStr += " - " + lastDate.toString();
-        infoStep = myInfo.start(infoStr, this->meteoGridDbHandler->gridStructure().header().nrRows);
+        myInfo.start(infoStr, meteoGridDbHandler->meteoGrid()->getNrActiveMeteoPoints());
     }
 
-    for (int row = 0; row < this->meteoGridDbHandler->gridStructure().header().nrRows; row++)
-    {
-        if (showInfo && (row % infoStep) == 0)
-            myInfo.setValue(row);
+    std::function<void(int)> progress = nullptr;
+    if (showInfo) progress = [&](int nrCells) { myInfo.setValue(nrCells); };
 
-        for (int col = 0; col < this->meteoGridDbHandler->gridStructure().header().nrCols; col++)
-        {
-            if (this->meteoGridDbHandler->meteoGrid()->getMeteoPointActiveId(row, col, &id))
-            {
-                if (!this->meteoGridDbHandler->gridStructure().isFixedFields())
-                {
-                    if (this->meteoGridDbHandler->loadGridDailyData(&errorString, QString::fromStdString(id), firstDate, lastDate))
-                    {
-                        count = count + 1;
-                    }
-                }
-                else
-                {
-                    if (this->meteoGridDbHandler->loadGridDailyDataFixedFields(&errorString, QString::fromStdString(id), firstDate, lastDate))
-                    {
-                        count = count + 1;
-                    }
-                }
-            }
-        }
-    }
+    bool isData = this->meteoGridDbHandler->loadGridAllDailyData(&errorString, firstDate, lastDate, 0, progress);
 
     if (showInfo) myInfo.close();
 
-    if (count == 0)
-    {
-        errorString = "No Data Available";
-        return false;
-    }
-    else
-        return true;
+    return isData;
 }
 
 
 bool Project::loadMeteoGridHourlyData(QDateTime firstDate, QDateTime lastDate, bool showInfo)
 {
-    std::string id;
-    int count = 0;
     FormInfo myInfo;
-    int infoStep = 1;
 
     if (showInfo)
     {
         QString infoStr = "Load grid hourly data: " + firstDate.toString("yyyy-MM-dd:hh") + " - " + lastDate.toString("yyyy-MM-dd:hh");
-        infoStep = myInfo.start(infoStr, this->meteoGridDbHandler->gridStructure().header().nrRows);
+        myInfo.start(infoStr, meteoGridDbHandler->meteoGrid()->getNrActiveMeteoPoints());
     }
 
-    for (int row = 0; row < this->meteoGridDbHandler->gridStructure().header().nrRows; row++)
-    {
-        if (showInfo && (row % infoStep) == 0)
-            myInfo.setValue(row);
+    std::function<void(int)> progress = nullptr;
+    if (showInfo) progress = [&](int nrCells) { myInfo.setValue(nrCells); };
 
-        for (int col = 0; col < this->meteoGridDbHandler->gridStructure().header().nrCols; col++)
-        {
-            if (this->meteoGridDbHandler->meteoGrid()->getMeteoPointActiveId(row, col, &id))
-            {
-                if (!this->meteoGridDbHandler->gridStructure().isFixedFields())
-                {
-                    if (this->meteoGridDbHandler->loadGridHourlyData(&errorString, QString::fromStdString(id), firstDate, lastDate))
-                    {
-                        count = count + 1;
-                    }
-                }
-                else
-                {
-                    if (this->meteoGridDbHandler->loadGridHourlyDataFixedFields(&errorString, QString::fromStdString(id), firstDate, lastDate))
-                    {
-                        count = count + 1;
-                    }
-                }
-            }
-        }
-    }
+    bool isData = this->meteoGridDbHandler->loadGridAllHourlyData(&errorString, firstDate, lastDate, 0, progress);
 
     if (showInfo) myInfo.close();
 
-    if (count == 0)
-    {
-        errorString = "No Data Available";
-        return false;
-    }
-    else
-        return true;
+    return isData;
 }
 
 
@@ -907,7 +864,12 @@ bool Project::updateProxy()
     return true;
 }
 
-bool Project::writeTopographicDistanceMaps()
+/*!
+ * \brief computeTopographicDistanceMaps
+ * load (or compute on all the cores and write in DATA/GEO/TAD/) the maps of the active points:
+ * otherwise the interpolation loads them when they are required
+ */
+bool Project::computeTopographicDistanceMaps(const QString& infoStr)
 {
     if (nrMeteoPoints == 0)
     {
@@ -915,87 +877,43 @@ bool Project::writeTopographicDistanceMaps()
         return false;
     }
 
-    if (! DTM.isLoaded)
+    if (! DTM.isLoaded || ! topoDistanceCache.isActive(&DTM))
     {
         errorString = "Load a DEM before.";
         return false;
     }
 
-    QString mapsFolder = this->path + "DATA/GEO/TAD/";
-    if (! QDir(mapsFolder).exists())
-        QDir().mkdir(mapsFolder);
-
-    FormInfo myInfo;
-    int infoStep;
-    QString infoStr = "Computing topographic distance maps...";
-    infoStep = myInfo.start(infoStr, nrMeteoPoints);
-
-    std::string myError;
-    std::string fileName;
-    gis::Crit3DRasterGrid myMap;
+    std::vector <gis::Crit3DPoint> points;
     for (int i=0; i < nrMeteoPoints; i++)
-    {
-        myInfo.setValue(i);
-
         if (meteoPoints[i].active)
-        {
-            if (gis::topographicDistanceMap(meteoPoints[i].point, DTM, &myMap))
-            {
-                fileName = mapsFolder.toStdString() + "TAD_" + meteoPoints[i].id;
-                if (! gis::writeEsriGrid(fileName, &myMap, &myError))
-                {
-                    errorString = QString::fromStdString(myError);
-                    return false;
-                }
-            }
-        }
-    }
+            points.push_back(meteoPoints[i].point);
 
-    myInfo.close();
+    FormInfo myInfo;
+    myInfo.start(infoStr, int(points.size()));
 
-    return true;
-}
+    bool isOk = topoDistanceCache.computeMaps(points, 0, [&myInfo](int nrPoints) { myInfo.setValue(nrPoints); });
 
+    myInfo.close();
 
-bool Project::loadTopographicDistanceMaps()
-{
-    if (nrMeteoPoints == 0)
+    if (! isOk)
     {
-        errorString = "Open a meteo points DB before.";
+        errorString = "Error in computing the topographic distance maps.";
         return false;
     }
 
-    QString mapsFolder = this->path + "DATA/GEO/TAD/";
-    if (! QDir(mapsFolder).exists()) return false;
-
-    FormInfo myInfo;
-    int infoStep;
-    QString infoStr = "Loading topographic distance maps...";
-    infoStep = myInfo.start(infoStr, nrMeteoPoints);
-
-    std::string myError;
-    std::string fileName;
-
+    return true;
+}
 
-    for (int i=0; i < nrMeteoPoints; i++)
-    {
-        myInfo.setValue(i);
 
-        if (meteoPoints[i].active)
-        {
-            fileName = mapsFolder.toStdString() + "TAD_" + meteoPoints[i].id;
-            meteoPoints[i].topographicDistance = new gis::Crit3DRasterGrid();
-            if (! gis::readEsriGrid(fileName, meteoPoints[i].topographicDistance, &myError))
-            {
-                errorString = QString::fromStdString(myError);
-                return false;
-            }
-        }
-    }
+bool Project::writeTopographicDistanceMaps()
+{
+    return computeTopographicDistanceMaps("Computing topographic distance maps...");
+}
 
-    myInfo.close();
 
-    return true;
+bool Project::loadTopographicDistanceMaps()
+{
+    return computeTopographicDistanceMaps("Loading topographic distance maps...");
 }
 
 
@@ -1027,7 +945,14 @@ bool Project::interpolationDem(meteoVariable myVar, const Crit3DTime& myTime, gi
     }
 
     // Interpolate
-    if (! interpolationRaster(interpolationPoints, &interpolationSettings, myRaster, DTM, myVar, showInfo))
+    // kriging variance: second output raster, only if requested
+    gis::Crit3DRasterGrid* varianceRaster = nullptr;
+    if (interpolationSettings.getInterpolationMethod() == kriging && interpolationSettings.getComputeKrigingVariance())
+        varianceRaster = &krigingVarianceRaster;
+    else
+        krigingVarianceRaster.freeGrid();
+
+    if (! interpolationRaster(interpolationPoints, &interpolationSettings, myRaster, DTM, myVar, varianceRaster, showInfo))
     {
         errorString = "Interpolation: error in function interpolateGridDtm";
         return false;
@@ -1035,6 +960,39 @@ bool Project::interpolationDem(meteoVariable myVar, const Crit3DTime& myTime, gi
 
     Crit3DTime t = myTime;
     myRaster->timeString = t.toStdString();
+
+    if (varianceRaster != nullptr)
+    {
+        setColorScale(noMeteoTerrain, krigingVarianceRaster.colorScale);
+        krigingVarianceRaster.timeString = myRaster->timeString;
+    }
+
+    return true;
+}
+
+
+/*!
+ * \brief saveKrigingVariance
+ * write the kriging variance of the last interpolation on DEM as ESRI grid (.flt/.hdr)
+ */
+bool Project::saveKrigingVariance(QString myFileName)
+{
+    if (! krigingVarianceRaster.isLoaded)
+    {
+        errorString = "Kriging variance not available: interpolate on DEM with kriging and the kriging variance option";
+        return false;
+    }
+
+    if (myFileName.endsWith(".flt", Qt::CaseInsensitive))
+        myFileName.chop(4);
+
+    std::string myError;
+    if (! gis::writeEsriGrid(myFileName.toStdString(), &krigingVarianceRaster, &myError))
+    {
+        errorString = "Save kriging variance failed: " + QString::fromStdString(myError);
+        return false;
+    }
+
     return true;
 }
 
@@ -1067,7 +1025,7 @@ bool Project::interpolateDemRadiation(const Crit3DTime& myTime, gis::Crit3DRaste
 
     preInterpolation(interpolationPoints, &interpolationSettings, meteoPoints, nrMeteoPoints, atmTransmissivity, myTime);
 
-    if (! interpolationRaster(interpolationPoints, &interpolationSettings, this->radiationMaps->transmissivityMap, DTM, atmTransmissivity, showInfo))
+    if (! interpolationRaster(interpolationPoints, &interpolationSettings, this->radiationMaps->transmissivityMap, DTM, atmTransmissivity, nullptr, showInfo))
     {
         errorString = "Function interpolateRasterRadiation: error interpolating transmissivity.";
         return false;
@@ -1110,6 +1068,9 @@ bool Project::interpolationDemMain(meteoVariable myVar, const Crit3DTime& myTime
 
     myRaster->initializeGrid(this->DTM);
 
+    // the kriging variance refers only to the last interpolation on DEM
+    krigingVarianceRaster.freeGrid();
+
     if (myVar == globalIrradiance)
     {
         Crit3DTime measureTime = myTime.addSeconds(-1800);
@@ -35,6 +35,10 @@
     #include "solarRadiation.h"
 #endif
 
+#ifndef TOPODISTANCECACHE_H
+    #include "topoDistanceCache.h"
+#endif
+
     class Project {
     private:
 
@@ -50,6 +54,7 @@
         int dbPort;
         QString dbUsername;
         QString dbPassword;
+        bool isMeteoPointsCache;        // binary cache of the meteo points data
 
         frequencyType currentFrequency;
         meteoVariable currentVariable;
@@ -85,9 +90,11 @@
 
         gis::Crit3DRasterGrid DTM;
         gis::Crit3DRasterGrid dataRaster;
+        gis::Crit3DRasterGrid krigingVarianceRaster;
 
         Crit3DInterpolationSettings interpolationSettings;
         Crit3DInterpolationSettings qualityInterpolationSettings;
+        Crit3DTopoDistanceCache topoDistanceCache;
 
         #ifdef NETCDF
             NetCDFHandler netCDF;
@@ -142,10 +149,12 @@
         bool readProxyValues();
         bool updateProxy();
         void checkMeteoPointsDEM();
+        bool computeTopographicDistanceMaps(const QString& infoStr);
         bool writeTopographicDistanceMaps();
         bool loadTopographicDistanceMaps();
         bool interpolationDemMain(meteoVariable myVar, const Crit3DTime& myTime, gis::Crit3DRasterGrid *myRaster, bool showInfo);
         bool interpolationDem(meteoVariable myVar, const Crit3DTime& myTime, gis::Crit3DRasterGrid *myRaster, bool showInfo);
+        bool saveKrigingVariance(QString myFileName);
         bool interpolateDemRadiation(const Crit3DTime& myTime, gis::Crit3DRasterGrid *myRaster, bool showInfo);
     };
 
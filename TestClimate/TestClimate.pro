@@ -0,0 +1,57 @@
+#-------------------------------------------------------------------
+#
+#   TestClimate
+#   benchmark of the climate elaborations on a long daily series
+#   this project is part of CRITERIA3D distribution
+#
+#-------------------------------------------------------------------
+
+QT       += core sql xml
+QT       -= gui
+
+CONFIG += c++11
+
+CONFIG += console
+CONFIG -= app_bundle
+
+CONFIG += debug_and_release
+
+TEMPLATE = app
+
+unix:{
+    CONFIG(debug, debug|release) {
+        TARGET = debug/testClimate
+    } else {
+        TARGET = release/testClimate
+    }
+}
+win32:{
+    TARGET = testClimate
+}
+
+INCLUDEPATH += ../crit3dDate ../mathFunctions ../gis ../meteo ../utilities ../interpolation \
+               ../dbMeteoPoints ../dbMeteoGrid ../climate
+
+SOURCES += main.cpp
+
+CONFIG(debug, debug|release) {
+    LIBS += -L../climate/debug -lclimate
+    LIBS += -L../dbMeteoGrid/debug -ldbMeteoGrid
+    LIBS += -L../dbMeteoPoints/debug -ldbMeteoPoints
+    LIBS += -L../utilities/debug -lutilities
+    LIBS += -L../interpolation/debug -linterpolation
+    LIBS += -L../meteo/debug -lmeteo
+    LIBS += -L../gis/debug -lgis
+    LIBS += -L../crit3dDate/debug -lcrit3dDate
+    LIBS += -L../mathFunctions/debug -lmathFunctions
+} else {
+    LIBS += -L../climate/release -lclimate
+    LIBS += -L../dbMeteoGrid/release -ldbMeteoGrid
+    LIBS += -L../dbMeteoPoints/release -ldbMeteoPoints
+    LIBS += -L../utilities/release -lutilities
+    LIBS += -L../interpolation/release -linterpolation
+    LIBS += -L../meteo/release -lmeteo
+    LIBS += -L../gis/release -lgis
+    LIBS += -L../crit3dDate/release -lcrit3dDate
+    LIBS += -L../mathFunctions/release -lmathFunctions
+}
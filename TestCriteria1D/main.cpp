@@ -175,8 +175,8 @@ int main(int argc, char *argv[])
                                 // SHORT TERM FORECAST
                                 if(myProject.criteria.isShortTermForecast)
                                 {
-                                    indexOfForecast = myProject.criteria.meteoPoint.nrObsDataDaysD - myProject.criteria.daysOfForecast - 1;
-                                    dateOfForecast = myProject.criteria.meteoPoint.obsDataD[indexOfForecast].date;
+                                    indexOfForecast = myProject.criteria.meteoPoint.getNrObsDataDaysD() - myProject.criteria.daysOfForecast - 1;
+                                    dateOfForecast = myProject.criteria.meteoPoint.firstDateD.addDays(indexOfForecast);
                                     dateOfForecastStr = QString::fromStdString(dateOfForecast.toStdString());
                                     IrrPreviousDateStr = QString::fromStdString(dateOfForecast.addDays(-13).toStdString());
 
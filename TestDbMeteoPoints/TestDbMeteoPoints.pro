@@ -0,0 +1,50 @@
+#-------------------------------------------------------------------
+#
+#   TestDbMeteoPoints
+#   benchmark of the meteo points data loading on a synthetic db
+#   this project is part of CRITERIA3D distribution
+#
+#-------------------------------------------------------------------
+
+QT       += core sql
+QT       -= gui
+
+CONFIG += c++11
+
+CONFIG += console
+CONFIG -= app_bundle
+
+CONFIG += debug_and_release
+
+TEMPLATE = app
+
+unix:{
+    CONFIG(debug, debug|release) {
+        TARGET = debug/testDbMeteoPoints
+    } else {
+        TARGET = release/testDbMeteoPoints
+    }
+}
+win32:{
+    TARGET = testDbMeteoPoints
+}
+
+INCLUDEPATH += ../crit3dDate ../mathFunctions ../gis ../meteo ../interpolation ../dbMeteoPoints
+
+SOURCES += main.cpp
+
+CONFIG(debug, debug|release) {
+    LIBS += -L../dbMeteoPoints/debug -ldbMeteoPoints
+    LIBS += -L../interpolation/debug -linterpolation
+    LIBS += -L../meteo/debug -lmeteo
+    LIBS += -L../gis/debug -lgis
+    LIBS += -L../crit3dDate/debug -lcrit3dDate
+    LIBS += -L../mathFunctions/debug -lmathFunctions
+} else {
+    LIBS += -L../dbMeteoPoints/release -ldbMeteoPoints
+    LIBS += -L../interpolation/release -linterpolation
+    LIBS += -L../meteo/release -lmeteo
+    LIBS += -L../gis/release -lgis
+    LIBS += -L../crit3dDate/release -lcrit3dDate
+    LIBS += -L../mathFunctions/release -lmathFunctions
+}
@@ -0,0 +1,268 @@
+/*!
+   \name testDbMeteoPoints
+   \brief benchmark of the meteo points data loading on a synthetic db
+   (1000 stations, one year of daily and hourly data)
+   the station by station loading of the previous implementation (QDate parsing,
+   MapIdMeteoVar lookup and setMeteoPointValue for each row) is compared with
+   loadAllData, on one thread and on all the cores.
+   Then the date range of the db is read from point_dates (getLastDate)
+   and loadAllData is timed with the binary cache (first load writes it, second reads it)
+ */
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QDate>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QVariant>
+
+#include <math.h>
+#include <chrono>
+#include <thread>
+#include <iostream>
+
+#include "commonConstants.h"
+#include "meteo.h"
+#include "meteoPoint.h"
+#include "dbMeteoPoints.h"
+
+#define NR_STATIONS 1000
+#define FIRST_YEAR 2019
+
+
+QString getStationId(int i)
+{
+    return QString("st%1").arg(i, 4, 10, QChar('0'));
+}
+
+
+bool createSyntheticDb(const QString& dbName)
+{
+    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", "synthetic");
+    db.setDatabaseName(dbName);
+    if (! db.open())
+    {
+        std::cout << db.lastError().text().toStdString() << std::endl;
+        return false;
+    }
+
+    QDate firstDate(FIRST_YEAR, 1, 1);
+    int nrDays = firstDate.daysTo(QDate(FIRST_YEAR, 12, 31)) + 1;
+    QSqlQuery qry(db);
+
+    for (int i = 0; i < NR_STATIONS; i++)
+    {
+        QString id = getStationId(i);
+        db.transaction();
+
+        qry.exec(QString("CREATE TABLE `%1_D` (date_time TEXT, id_variable INTEGER, value REAL, PRIMARY KEY(date_time,id_variable))").arg(id));
+        qry.exec(QString("CREATE TABLE `%1_H` (date_time TEXT, id_variable INTEGER, value REAL, PRIMARY KEY(date_time,id_variable))").arg(id));
+
+        qry.prepare(QString("INSERT INTO `%1_D` VALUES (?, ?, ?)").arg(id));
+        for (int d = 0; d < nrDays; d++)
+        {
+            QString dateStr = firstDate.addDays(d).toString("yyyy-MM-dd");
+            float tAvg = float(12 + 10 * sin(2 * PI * d / 365.) + i * 0.001);
+            float values[4] = {tAvg - 5, tAvg + 5, tAvg, float((d * 7 + i) % 13)};
+            for (int v = 0; v < 4; v++)
+            {
+                qry.addBindValue(dateStr);
+                qry.addBindValue(151 + v);
+                qry.addBindValue(values[v]);
+                qry.exec();
+            }
+        }
+
+        qry.prepare(QString("INSERT INTO `%1_H` VALUES (?, ?, ?)").arg(id));
+        for (int d = 0; d < nrDays; d++)
+        {
+            QString dateStr = firstDate.addDays(d).toString("yyyy-MM-dd");
+            for (int h = 0; h < 24; h++)
+            {
+                qry.addBindValue(dateStr + QString(" %1:00:00").arg(h, 2, 10, QChar('0')));
+                qry.addBindValue(101);
+                qry.addBindValue(float(12 + 10 * sin(2 * PI * d / 365.) + 5 * sin(2 * PI * h / 24.)));
+                qry.exec();
+            }
+        }
+
+        db.commit();
+    }
+
+    qry.clear();
+    db.close();
+    return true;
+}
+
+
+/*! previous implementation of loadDailyData */
+void loadDailyDataByDate(QSqlDatabase& db, Crit3DDate dateStart, Crit3DDate dateEnd, Crit3DMeteoPoint *meteoPoint)
+{
+    meteoPoint->initializeObsDataD(difference(dateStart, dateEnd) + 1, dateStart);
+
+    QSqlQuery myQuery(db);
+    QString statement = QString( "SELECT * FROM `%1` WHERE date_time >= DATE('%2') AND date_time < DATE('%3', '+1 day')")
+                                .arg(QString::fromStdString(meteoPoint->id) + "_D")
+                                .arg(QString::fromStdString(dateStart.toStdString()))
+                                .arg(QString::fromStdString(dateEnd.toStdString()));
+    if (! myQuery.exec(statement)) return;
+
+    while (myQuery.next())
+    {
+        QDate d = QDate::fromString(myQuery.value(0).toString(), "yyyy-MM-dd");
+        meteoVariable variable = MapIdMeteoVar.at(myQuery.value(1).toInt());
+        meteoPoint->setMeteoPointValueD(Crit3DDate(d.day(), d.month(), d.year()), variable, myQuery.value(2).toFloat());
+    }
+}
+
+
+/*! previous implementation of loadHourlyData */
+void loadHourlyDataByDate(QSqlDatabase& db, Crit3DDate dateStart, Crit3DDate dateEnd, Crit3DMeteoPoint *meteoPoint)
+{
+    meteoPoint->initializeObsDataH(1, difference(dateStart, dateEnd) + 1, dateStart);
+
+    QSqlQuery qry(db);
+    QString statement = QString( "SELECT * FROM `%1` WHERE date_time >= DATE('%2') AND date_time < DATE('%3', '+1 day')")
+                                .arg(QString::fromStdString(meteoPoint->id) + "_H")
+                                .arg(QString::fromStdString(dateStart.toStdString()))
+                                .arg(QString::fromStdString(dateEnd.toStdString()));
+    if (! qry.exec(statement)) return;
+
+    while (qry.next())
+    {
+        QDateTime d = QDateTime::fromString(qry.value(0).toString(), "yyyy-MM-dd HH:mm:ss");
+        meteoVariable variable = MapIdMeteoVar.at(qry.value(1).toInt());
+        meteoPoint->setMeteoPointValueH(Crit3DDate(d.date().day(), d.date().month(), d.date().year()),
+                                        d.time().hour(), d.time().minute(), variable, qry.value(2).toFloat());
+    }
+}
+
+
+double checkSum(Crit3DMeteoPoint* meteoPoints, const Crit3DDate& firstDate, int nrDays)
+{
+    double sum = 0;
+    for (int i = 0; i < NR_STATIONS; i++)
+        for (int d = 0; d < nrDays; d++)
+        {
+            Crit3DDate myDate = firstDate.addDays(d);
+            sum += meteoPoints[i].getMeteoPointValueD(myDate, dailyAirTemperatureMax);
+            sum += meteoPoints[i].getMeteoPointValueD(myDate, dailyPrecipitation);
+            sum += meteoPoints[i].getMeteoPointValueH(myDate, 12, 0, airTemperature);
+        }
+    return sum;
+}
+
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication myApp(argc, argv);
+
+    QString dbName = QDir::temp().filePath("testDbMeteoPoints.db");
+    if (argc > 1) dbName = argv[1];
+
+    if (! QFile::exists(dbName))
+    {
+        std::cout << "creating synthetic db: " << dbName.toStdString() << std::endl;
+        if (! createSyntheticDb(dbName)) return -1;
+    }
+
+    Crit3DMeteoPointsDbHandler dbHandler(dbName);
+    if (! dbHandler.error.isEmpty())
+    {
+        std::cout << dbHandler.error.toStdString() << std::endl;
+        return -1;
+    }
+
+    Crit3DDate firstDate(1, 1, FIRST_YEAR);
+    Crit3DDate lastDate(31, 12, FIRST_YEAR);
+    int nrDays = firstDate.daysTo(lastDate) + 1;
+
+    Crit3DMeteoPoint* meteoPoints = new Crit3DMeteoPoint[NR_STATIONS];
+    for (int i = 0; i < NR_STATIONS; i++)
+        meteoPoints[i].id = getStationId(i).toStdString();
+
+    // previous implementation
+    QSqlDatabase db = dbHandler.getDb();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < NR_STATIONS; i++)
+    {
+        loadDailyDataByDate(db, firstDate, lastDate, &(meteoPoints[i]));
+        loadHourlyDataByDate(db, firstDate, lastDate, &(meteoPoints[i]));
+    }
+    double timeByDate = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double sumByDate = checkSum(meteoPoints, firstDate, nrDays);
+
+    // station by station
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < NR_STATIONS; i++)
+    {
+        dbHandler.loadDailyData(firstDate, lastDate, &(meteoPoints[i]));
+        dbHandler.loadHourlyData(firstDate, lastDate, &(meteoPoints[i]));
+    }
+    double timeByStation = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double sumByStation = checkSum(meteoPoints, firstDate, nrDays);
+
+    // bulk loading: one thread, all the cores
+    start = std::chrono::steady_clock::now();
+    dbHandler.loadAllData(firstDate, lastDate, meteoPoints, NR_STATIONS, 1);
+    double timeBulk1 = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double sumBulk1 = checkSum(meteoPoints, firstDate, nrDays);
+
+    start = std::chrono::steady_clock::now();
+    dbHandler.loadAllData(firstDate, lastDate, meteoPoints, NR_STATIONS);
+    double timeBulk = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double sumBulk = checkSum(meteoPoints, firstDate, nrDays);
+
+    std::cout << "stations: " << NR_STATIONS << "  days: " << nrDays << std::endl;
+    std::cout << "previous implementation [s]: " << timeByDate << std::endl;
+    std::cout << "loadDailyData + loadHourlyData [s]: " << timeByStation << std::endl;
+    std::cout << "loadAllData, 1 thread [s]: " << timeBulk1 << std::endl;
+    std::cout << "loadAllData, " << std::thread::hardware_concurrency() << " threads [s]: " << timeBulk << std::endl;
+
+    if (sumByStation != sumByDate || sumBulk1 != sumByDate || sumBulk != sumByDate)
+    {
+        std::cout << "MISMATCH in the loaded data" << std::endl;
+        return -1;
+    }
+
+    // date range of the db: read from point_dates (built on open, rebuilt here for the timing)
+    start = std::chrono::steady_clock::now();
+    dbHandler.createPointDates();
+    double timeRebuild = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    QDateTime lastDateD = dbHandler.getLastDate(daily);
+    QDateTime lastDateH = dbHandler.getLastDate(hourly);
+    double timeLastDate = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "point_dates rebuild [ms]: " << timeRebuild << std::endl;
+    std::cout << "getLastDate daily, hourly [ms]: " << timeLastDate << "  "
+              << lastDateD.toString("yyyy-MM-dd").toStdString() << "  "
+              << lastDateH.toString("yyyy-MM-dd").toStdString() << std::endl;
+
+    // binary cache: the first loading writes the files, the next ones read them
+    dbHandler.setCacheActive(true);
+    start = std::chrono::steady_clock::now();
+    dbHandler.loadAllData(firstDate, lastDate, meteoPoints, NR_STATIONS);
+    double timeCacheWrite = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double sumCacheWrite = checkSum(meteoPoints, firstDate, nrDays);
+
+    start = std::chrono::steady_clock::now();
+    dbHandler.loadAllData(firstDate, lastDate, meteoPoints, NR_STATIONS);
+    double timeCacheRead = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double sumCacheRead = checkSum(meteoPoints, firstDate, nrDays);
+
+    std::cout << "loadAllData, writing the cache [s]: " << timeCacheWrite << std::endl;
+    std::cout << "loadAllData, reading the cache [s]: " << timeCacheRead << std::endl;
+
+    delete [] meteoPoints;
+
+    if (sumCacheWrite != sumByDate || sumCacheRead != sumByDate)
+    {
+        std::cout << "MISMATCH in the cached data" << std::endl;
+        return -1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,648 @@
+/*!
+   \name testInterpolation
+   \brief benchmark of the raster interpolation on DATA/DEM/DEM_ER_450m
+   synthetic stations on the DEM (temperature with a lapse rate, elevation proxy):
+   the serial loop of the previous implementation is compared with
+   interpolationRasterParallel on one thread and on all the cores,
+   for idw and shepard (also with an elevation proxy not aligned with the DEM).
+   The maps have to be identical.
+   Then the shepard neighbourhood with the spatial index is compared with the linear scan
+   of all the points (same maps) and with the previous computeShepard (vector copies and
+   sortPointsByDistance), with more stations.
+   Last, kriging (ordinary and universal, global system and moving neighbourhood):
+   the batched raster with the kriging variance is compared with interpolate cell by cell.
+   Then shepard with TAD: topographic distance of each cell, maps of Crit3DTopoDistanceCache
+   (computed, read from the folder of the second argument, reduced resolution) and plain shepard.
+ */
+
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include <thread>
+#include <iostream>
+
+#include "commonConstants.h"
+#include "gis.h"
+#include "meteo.h"
+#include "interpolationSettings.h"
+#include "interpolationPoint.h"
+#include "interpolation.h"
+#include "topoDistanceCache.h"
+
+#define NR_STATIONS 250
+#define NR_STATIONS_SHEPARD 2000
+#define KRIGING_NEIGHBOURS 32
+#define TAD_KH 16
+#define TAD_KZ 4
+#define TAD_RESOLUTION_FACTOR 4
+#define TAD_TOLERANCE 0.01f
+#define TAD_MAX_DIFFERENT_FRACTION 0.001
+
+
+int sortPointsByDistance(int maxIndex, std::vector <Crit3DInterpolationDataPoint> &myPoints, std::vector <Crit3DInterpolationDataPoint> &myValidPoints);
+float retrend(meteoVariable myVar, const std::vector <float> &myProxyValues, Crit3DInterpolationSettings* mySettings);
+
+
+void createStations(const gis::Crit3DRasterGrid& myDTM, unsigned nrStations, std::vector <Crit3DInterpolationDataPoint> &myPoints)
+{
+    unsigned long seed = 12345;
+    int row, col;
+    float x, y;
+
+    myPoints.clear();
+    while (myPoints.size() < nrStations)
+    {
+        seed = (seed * 1103515245 + 12345) % 2147483648;
+        row = int(seed % unsigned(myDTM.header->nrRows));
+        seed = (seed * 1103515245 + 12345) % 2147483648;
+        col = int(seed % unsigned(myDTM.header->nrCols));
+
+        float z = myDTM.value[row][col];
+        if (z == myDTM.header->flag) continue;
+
+        gis::getUtmXYFromRowColSinglePrecision(myDTM, row, col, &x, &y);
+
+        Crit3DInterpolationDataPoint myPoint;
+        myPoint.index = int(myPoints.size());
+        myPoint.point->utm.x = x;
+        myPoint.point->utm.y = y;
+        myPoint.point->z = z;
+        myPoint.value = float(25 - 0.0065 * z + 2 * sin(x / 20000.) + 0.5 * cos(y / 7000.));
+        myPoint.proxyValues.push_back(z);
+        myPoint.isActive = true;
+        myPoints.push_back(myPoint);
+    }
+}
+
+
+/*! previous implementation of interpolationRaster */
+void interpolationRasterSerial(std::vector <Crit3DInterpolationDataPoint> &myPoints, Crit3DInterpolationSettings* mySettings,
+                               gis::Crit3DRasterGrid* myGrid, const gis::Crit3DRasterGrid& myDTM, meteoVariable myVar)
+{
+    float myX, myY;
+
+    for (long myRow = 0; myRow < myGrid->header->nrRows ; myRow++)
+        for (long myCol = 0; myCol < myGrid->header->nrCols; myCol++)
+        {
+            gis::getUtmXYFromRowColSinglePrecision(*myGrid, myRow, myCol, &myX, &myY);
+            float myZ = myDTM.value[myRow][myCol];
+            if (myZ != myGrid->header->flag)
+                myGrid->value[myRow][myCol] = interpolate(myPoints, mySettings, myVar, myX, myY, myZ, getProxyValuesXY(myX, myY, mySettings), true);
+        }
+}
+
+
+/*! previous implementation of computeShepard */
+float computeShepardPrevious(std::vector <Crit3DInterpolationDataPoint> myPoints, Crit3DInterpolationSettings* settings, float X, float Y)
+{
+    std::vector <Crit3DInterpolationDataPoint> validPoints;
+    std::vector <Crit3DInterpolationDataPoint> neighbourPoints;
+    unsigned int i;
+    float radius;
+
+    neighbourPoints.clear();
+
+    // define a first neighborhood inside initial radius
+    for (i=1; i < myPoints.size(); i++)
+        if (myPoints.at(i).distance <= settings->getShepardInitialRadius() && myPoints.at(i).distance > 0 && myPoints.at(i).index != settings->getIndexPointCV())
+            neighbourPoints.push_back(myPoints.at(i));
+
+    if (neighbourPoints.size() <= SHEPARD_MIN_NRPOINTS)
+    {
+        sortPointsByDistance(SHEPARD_MIN_NRPOINTS + 1, myPoints, validPoints);
+        if (validPoints.size() > SHEPARD_MIN_NRPOINTS)
+        {
+            radius = validPoints.at(SHEPARD_MIN_NRPOINTS).distance;
+            validPoints.pop_back();
+        }
+        else
+            radius = validPoints.at(validPoints.size()-1).distance + 1;
+    }
+    else if (neighbourPoints.size() > SHEPARD_MAX_NRPOINTS)
+    {
+        sortPointsByDistance(SHEPARD_MAX_NRPOINTS + 1, neighbourPoints, validPoints);
+        radius = validPoints.at(SHEPARD_MAX_NRPOINTS).distance;
+        validPoints.pop_back();
+    }
+    else
+    {
+        validPoints = neighbourPoints;
+        radius = settings->getShepardInitialRadius();
+    }
+
+    unsigned int j;
+    float weightSum, radius_27_4, radius_3, tmp, cosine, result;
+    std::vector <float> weight, t, S;
+
+    weight.resize(validPoints.size());
+    t.resize(validPoints.size());
+    S.resize(validPoints.size());
+
+    weightSum = 0;
+    radius_3 = radius / 3;
+    radius_27_4 = (27 / 4) / radius;
+    for (i=0; i < validPoints.size(); i++)
+        if (validPoints.at(i).distance > 0)
+        {
+            if (validPoints.at(i).distance <= radius_3)
+                S.at(i) = 1 / (validPoints.at(i).distance);
+            else if (validPoints.at(i).distance <= radius)
+            {
+                tmp = (validPoints.at(i).distance / radius) - 1;
+                S.at(i) = radius_27_4 * tmp * tmp;
+            }
+            else
+                S.at(i) = 0;
+
+            weightSum = weightSum + S.at(i);
+        }
+
+    if (weightSum == 0)
+        return NODATA;
+
+    // including direction
+    for (i=0; i<validPoints.size(); i++)
+    {
+        t.at(i) = 0;
+        for (j=0; j < validPoints.size(); j++)
+            if (i != j)
+            {
+                cosine = ((X - (float)validPoints.at(i).point->utm.x) * (X - (float)validPoints.at(j).point->utm.x) + (Y - (float)validPoints.at(i).point->utm.y) * (Y - (float)validPoints.at(j).point->utm.y)) / (validPoints.at(i).distance * validPoints.at(j).distance);
+                t.at(i) = t.at(i) + S.at(j) * (1 - cosine);
+            }
+
+        if (weightSum != 0)
+            t.at(i) /= weightSum;
+    }
+
+    // weights
+    weightSum = 0;
+    for (i=0; i<validPoints.size(); i++)
+    {
+       weight.at(i) = S.at(i) * S.at(i) * (1 + t.at(i));
+       weightSum += weight.at(i);
+    }
+    for (i=0; i<validPoints.size(); i++)
+        weight.at(i) /= weightSum;
+
+    result = 0;
+    for (i=0; i<validPoints.size(); i++)
+        result += weight.at(i) * validPoints.at(i).value;
+
+    return result;
+}
+
+
+/*! previous shepard map (the distances were computed by interpolate) */
+void shepardRasterPrevious(std::vector <Crit3DInterpolationDataPoint> &myPoints, Crit3DInterpolationSettings* mySettings,
+                           gis::Crit3DRasterGrid* myGrid, const gis::Crit3DRasterGrid& myDTM, meteoVariable myVar)
+{
+    float myX, myY;
+
+    for (long myRow = 0; myRow < myGrid->header->nrRows ; myRow++)
+        for (long myCol = 0; myCol < myGrid->header->nrCols; myCol++)
+        {
+            gis::getUtmXYFromRowColSinglePrecision(*myGrid, myRow, myCol, &myX, &myY);
+            float myZ = myDTM.value[myRow][myCol];
+            if (myZ != myGrid->header->flag)
+            {
+                for (unsigned i = 0; i < myPoints.size(); i++)
+                {
+                    myPoints[i].distance = gis::computeDistance(myX, myY, float(myPoints[i].point->utm.x), float(myPoints[i].point->utm.y));
+                    myPoints[i].deltaZ = float(fabs(myPoints[i].point->z - myZ));
+                }
+                float myValue = computeShepardPrevious(myPoints, mySettings, myX, myY);
+                if (myValue != NODATA)
+                    myValue += retrend(myVar, getProxyValuesXY(myX, myY, mySettings), mySettings);
+                myGrid->value[myRow][myCol] = myValue;
+            }
+        }
+}
+
+
+int countDifferentCells(const gis::Crit3DRasterGrid& grid1, const gis::Crit3DRasterGrid& grid2, float tolerance)
+{
+    int nrDifferent = 0;
+    for (int row = 0; row < grid1.header->nrRows; row++)
+        for (int col = 0; col < grid1.header->nrCols; col++)
+            if (fabs(grid1.value[row][col] - grid2.value[row][col]) > tolerance)
+                nrDifferent++;
+    return nrDifferent;
+}
+
+
+// mean and maximum absolute difference on the valid cells of both grids
+void getDifference(const gis::Crit3DRasterGrid& grid1, const gis::Crit3DRasterGrid& grid2, double* meanDifference, double* maxDifference)
+{
+    long nrCells = 0;
+    *meanDifference = 0;
+    *maxDifference = 0;
+    for (int row = 0; row < grid1.header->nrRows; row++)
+        for (int col = 0; col < grid1.header->nrCols; col++)
+        {
+            if (grid1.value[row][col] == grid1.header->flag || grid2.value[row][col] == grid2.header->flag)
+                continue;
+            double difference = fabs(double(grid1.value[row][col]) - double(grid2.value[row][col]));
+            *meanDifference += difference;
+            *maxDifference = std::max(*maxDifference, difference);
+            nrCells++;
+        }
+    if (nrCells > 0) *meanDifference /= nrCells;
+}
+
+
+bool isEqualGrid(const gis::Crit3DRasterGrid& grid1, const gis::Crit3DRasterGrid& grid2)
+{
+    for (int row = 0; row < grid1.header->nrRows; row++)
+        if (memcmp(grid1.value[row], grid2.value[row], size_t(grid1.header->nrCols) * sizeof(float)) != 0)
+            return false;
+    return true;
+}
+
+
+int main(int argc, char *argv[])
+{
+    std::string fileName = "../DATA/DEM/DEM_ER_450m";
+    if (argc > 1) fileName = argv[1];
+
+    // folder of the topographic distance maps (existing), empty: memory only
+    std::string tadFolder = "";
+    if (argc > 2) tadFolder = argv[2];
+
+    gis::Crit3DRasterGrid myDTM;
+    std::string myError;
+    if (! gis::readEsriGrid(fileName, &myDTM, &myError))
+    {
+        std::cout << "Error in reading: " << fileName << std::endl << myError << std::endl;
+        return -1;
+    }
+
+    long nrValidCells = 0;
+    for (int row = 0; row < myDTM.header->nrRows; row++)
+        for (int col = 0; col < myDTM.header->nrCols; col++)
+            if (myDTM.value[row][col] != myDTM.header->flag) nrValidCells++;
+
+    std::vector <Crit3DInterpolationDataPoint> myPoints;
+    createStations(myDTM, NR_STATIONS, myPoints);
+
+    Crit3DInterpolationSettings mySettings;
+    Crit3DProxy myProxy;
+    myProxy.setName("elevation");
+    myProxy.setGrid(&myDTM);
+    mySettings.addProxy(myProxy, true);
+    mySettings.setCurrentDEM(&myDTM);
+    mySettings.computeShepardInitialRadius(float(nrValidCells) * myDTM.header->cellSize * myDTM.header->cellSize, NR_STATIONS);
+
+    Crit3DTime myTime(Crit3DDate(1, 6, 2019), 12 * 3600);
+    if (! preInterpolation(myPoints, &mySettings, nullptr, 0, airTemperature, myTime))
+    {
+        std::cout << "Error in preInterpolation" << std::endl;
+        return -1;
+    }
+
+    std::cout << "DEM: " << fileName << "  " << myDTM.header->nrCols << " x " << myDTM.header->nrRows
+              << "  valid cells: " << nrValidCells << "  stations: " << NR_STATIONS << std::endl;
+
+    unsigned nrCores = std::thread::hardware_concurrency();
+    TInterpolationMethod methods[2] = {idw, shepard};
+    std::string methodNames[2] = {"idw", "shepard"};
+    bool isOk = true;
+
+    for (int m = 0; m < 2; m++)
+    {
+        mySettings.setInterpolationMethod(methods[m]);
+
+        gis::Crit3DRasterGrid serialGrid, grid1, gridN, grid4;
+        serialGrid.initializeGrid(myDTM);
+        grid1.initializeGrid(myDTM);
+        gridN.initializeGrid(myDTM);
+        grid4.initializeGrid(myDTM);
+
+        auto start = std::chrono::steady_clock::now();
+        interpolationRasterSerial(myPoints, &mySettings, &serialGrid, myDTM, airTemperature);
+        double timeSerial = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        interpolationRasterParallel(myPoints, &mySettings, airTemperature, myDTM, &grid1, nullptr, 1, nullptr);
+        double time1 = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        interpolationRasterParallel(myPoints, &mySettings, airTemperature, myDTM, &gridN, nullptr, 0, nullptr);
+        double timeN = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        // 4 workers (also on fewer cores): the progress is reported by the calling thread, it never decreases
+        int lastProgress = 0;
+        bool isProgressOk = true;
+        interpolationRasterParallel(myPoints, &mySettings, airTemperature, myDTM, &grid4, nullptr, 4,
+                                    [&](int nrRowsDone)
+                                    {
+                                        if (nrRowsDone < lastProgress) isProgressOk = false;
+                                        lastProgress = nrRowsDone;
+                                    });
+        if (! isProgressOk || lastProgress != myDTM.header->nrRows)
+        {
+            std::cout << "  WRONG progress: " << lastProgress << " rows" << std::endl;
+            isOk = false;
+        }
+
+        std::cout << methodNames[m] << std::endl;
+        std::cout << "  previous implementation [s]: " << timeSerial
+                  << "  (" << long(nrValidCells / timeSerial) << " cells/s)" << std::endl;
+        std::cout << "  parallel, 1 thread [s]: " << time1
+                  << "  (" << long(nrValidCells / time1) << " cells/s)" << std::endl;
+        std::cout << "  parallel, " << nrCores << " threads [s]: " << timeN
+                  << "  (" << long(nrValidCells / timeN) << " cells/s)" << std::endl;
+
+        if (! isEqualGrid(serialGrid, grid1) || ! isEqualGrid(serialGrid, gridN) || ! isEqualGrid(serialGrid, grid4))
+        {
+            std::cout << "  MISMATCH with the serial map" << std::endl;
+            isOk = false;
+        }
+    }
+
+    // elevation proxy not aligned with the DEM (shifted by half a cell, one more row and column):
+    // the retrend of the rows uses the remap of the proxy rows and columns
+    gis::Crit3DRasterGrid shiftedDTM;
+    shiftedDTM.header->nrRows = myDTM.header->nrRows + 1;
+    shiftedDTM.header->nrCols = myDTM.header->nrCols + 1;
+    shiftedDTM.header->cellSize = myDTM.header->cellSize;
+    shiftedDTM.header->flag = myDTM.header->flag;
+    shiftedDTM.header->llCorner->x = myDTM.header->llCorner->x - 0.5 * myDTM.header->cellSize;
+    shiftedDTM.header->llCorner->y = myDTM.header->llCorner->y - 0.5 * myDTM.header->cellSize;
+    shiftedDTM.initializeGrid(myDTM.header->flag);
+    for (int row = 0; row < shiftedDTM.header->nrRows; row++)
+        for (int col = 0; col < shiftedDTM.header->nrCols; col++)
+        {
+            double x, y;
+            gis::getUtmXYFromRowCol(shiftedDTM, row, col, &x, &y);
+            shiftedDTM.value[row][col] = myDTM.getFastValueXY(x, y);
+        }
+
+    mySettings.getProxy(0)->setGrid(&shiftedDTM);
+    mySettings.setInterpolationMethod(shepard);
+    preInterpolation(myPoints, &mySettings, nullptr, 0, airTemperature, myTime);
+
+    gis::Crit3DRasterGrid shiftedSerialGrid, shiftedGrid;
+    shiftedSerialGrid.initializeGrid(myDTM);
+    shiftedGrid.initializeGrid(myDTM);
+
+    auto start = std::chrono::steady_clock::now();
+    interpolationRasterSerial(myPoints, &mySettings, &shiftedSerialGrid, myDTM, airTemperature);
+    double timeShiftedSerial = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    interpolationRasterParallel(myPoints, &mySettings, airTemperature, myDTM, &shiftedGrid, nullptr, 1, nullptr);
+    double timeShifted = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "shepard, elevation proxy not aligned with the DEM" << std::endl;
+    std::cout << "  previous implementation [s]: " << timeShiftedSerial << std::endl;
+    std::cout << "  parallel, 1 thread [s]: " << timeShifted << std::endl;
+
+    if (! isEqualGrid(shiftedSerialGrid, shiftedGrid))
+    {
+        std::cout << "  MISMATCH with the serial map" << std::endl;
+        isOk = false;
+    }
+
+    mySettings.getProxy(0)->setGrid(&myDTM);
+
+    // shepard neighbourhood: spatial index, linear scan, previous implementation
+    createStations(myDTM, NR_STATIONS_SHEPARD, myPoints);
+    mySettings.computeShepardInitialRadius(float(nrValidCells) * myDTM.header->cellSize * myDTM.header->cellSize, NR_STATIONS_SHEPARD);
+    mySettings.setInterpolationMethod(shepard);
+    preInterpolation(myPoints, &mySettings, nullptr, 0, airTemperature, myTime);
+
+    gis::Crit3DRasterGrid indexGrid, scanGrid, previousGrid;
+    indexGrid.initializeGrid(myDTM);
+    scanGrid.initializeGrid(myDTM);
+    previousGrid.initializeGrid(myDTM);
+
+    start = std::chrono::steady_clock::now();
+    interpolationRasterParallel(myPoints, &mySettings, airTemperature, myDTM, &indexGrid, nullptr, 1, nullptr);
+    double timeIndex = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    mySettings.getPointsIndex()->clear();
+    start = std::chrono::steady_clock::now();
+    interpolationRasterParallel(myPoints, &mySettings, airTemperature, myDTM, &scanGrid, nullptr, 1, nullptr);
+    double timeScan = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    shepardRasterPrevious(myPoints, &mySettings, &previousGrid, myDTM, airTemperature);
+    double timePrevious = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "shepard, " << NR_STATIONS_SHEPARD << " stations, 1 thread" << std::endl;
+    std::cout << "  previous implementation [s]: " << timePrevious << std::endl;
+    std::cout << "  linear scan [s]: " << timeScan << std::endl;
+    std::cout << "  spatial index [s]: " << timeIndex << std::endl;
+    std::cout << "  cells different from the previous implementation (> 0.01): "
+              << countDifferentCells(previousGrid, indexGrid, 0.01f) << std::endl;
+
+    if (! isEqualGrid(indexGrid, scanGrid))
+    {
+        std::cout << "  MISMATCH between spatial index and linear scan" << std::endl;
+        isOk = false;
+    }
+
+    // kriging: global system (ordinary, universal) and moving neighbourhood,
+    // the batched raster has to match the cell by cell interpolate
+    TkrigingType krigingTypes[2] = {KRIGING_ORDINARY, KRIGING_UNIVERSAL};
+    std::string krigingNames[2] = {"ordinary", "universal"};
+    int nrStations[2] = {NR_STATIONS, NR_STATIONS_SHEPARD};
+    int nrNeighbours[2] = {0, KRIGING_NEIGHBOURS};
+
+    for (int k = 0; k < 4; k++)
+    {
+        int t = k % 2, n = k / 2;
+        createStations(myDTM, nrStations[n], myPoints);
+        mySettings.setInterpolationMethod(kriging);
+        mySettings.setKrigingType(krigingTypes[t]);
+        mySettings.setKrigingNrNeighbours(nrNeighbours[n]);
+
+        start = std::chrono::steady_clock::now();
+        preInterpolation(myPoints, &mySettings, nullptr, 0, airTemperature, myTime);
+        double timeModel = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        gis::Crit3DRasterGrid krigingGrid, estimateGrid, varianceGrid, cellGrid;
+        krigingGrid.initializeGrid(myDTM);
+        estimateGrid.initializeGrid(myDTM);
+        varianceGrid.initializeGrid(myDTM);
+        cellGrid.initializeGrid(myDTM);
+
+        // the variance is computed only if its raster is passed
+        start = std::chrono::steady_clock::now();
+        interpolationRasterParallel(myPoints, &mySettings, airTemperature, myDTM, &estimateGrid, nullptr, 1, nullptr);
+        double timeEstimate = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        interpolationRasterParallel(myPoints, &mySettings, airTemperature, myDTM, &krigingGrid, &varianceGrid, 1, nullptr);
+        double timeBatch = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        interpolationRasterSerial(myPoints, &mySettings, &cellGrid, myDTM, airTemperature);
+        double timeCell = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        float minVariance = NODATA, maxVariance = NODATA;
+        for (int row = 0; row < varianceGrid.header->nrRows; row++)
+            for (int col = 0; col < varianceGrid.header->nrCols; col++)
+            {
+                float v = varianceGrid.value[row][col];
+                if (v == varianceGrid.header->flag) continue;
+                if (minVariance == NODATA || v < minVariance) minVariance = v;
+                if (maxVariance == NODATA || v > maxVariance) maxVariance = v;
+            }
+
+        const Crit3DVariogram& variogram = mySettings.getKrigingModel()->getVariogram();
+        std::cout << "kriging " << krigingNames[t] << ", " << nrStations[n] << " stations, "
+                  << (nrNeighbours[n] == 0 ? std::string("global") : std::to_string(nrNeighbours[n]) + " neighbours")
+                  << ", 1 thread" << std::endl;
+        std::cout << "  variogram: model " << variogram.mode << "  nugget " << variogram.nugget
+                  << "  sill " << variogram.sill << "  range " << variogram.range << std::endl;
+        std::cout << "  model [s]: " << timeModel << "  raster [s]: " << timeEstimate
+                  << "  raster with variance [s]: " << timeBatch << std::endl;
+        std::cout << "  cell by cell, no variance [s]: " << timeCell << std::endl;
+        std::cout << "  variance min, max: " << minVariance << "  " << maxVariance << std::endl;
+
+        int nrDifferent = countDifferentCells(krigingGrid, cellGrid, 0.001f)
+                          + countDifferentCells(estimateGrid, cellGrid, 0.001f);
+        if (nrDifferent > 0 || minVariance == NODATA || minVariance < 0)
+        {
+            std::cout << "  MISMATCH: " << nrDifferent << " cells different from interpolate" << std::endl;
+            isOk = false;
+        }
+    }
+
+    // TAD (shepard): distances from the maps of the cache, compared with the topographic distance
+    // computed on each cell (previous implementation, all the points) and with plain shepard
+    createStations(myDTM, NR_STATIONS, myPoints);
+    mySettings.setInterpolationMethod(shepard);
+    mySettings.setUseTAD(false);
+    preInterpolation(myPoints, &mySettings, nullptr, 0, airTemperature, myTime);
+
+    gis::Crit3DRasterGrid plainGrid, marchGrid, cacheGrid, cacheScanGrid, diskGrid, coarseGrid;
+    plainGrid.initializeGrid(myDTM);
+    marchGrid.initializeGrid(myDTM);
+    cacheGrid.initializeGrid(myDTM);
+    cacheScanGrid.initializeGrid(myDTM);
+    diskGrid.initializeGrid(myDTM);
+    coarseGrid.initializeGrid(myDTM);
+
+    start = std::chrono::steady_clock::now();
+    interpolationRasterParallel(myPoints, &mySettings, airTemperature, myDTM, &plainGrid, nullptr, 1, nullptr);
+    double timePlain = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    mySettings.setUseTAD(true);
+    mySettings.setTopoDist_Kh(TAD_KH);
+    mySettings.setTopoDist_Kz(TAD_KZ);
+
+    mySettings.getPointsIndex()->clear();
+    start = std::chrono::steady_clock::now();
+    interpolationRasterParallel(myPoints, &mySettings, airTemperature, myDTM, &marchGrid, nullptr, 1, nullptr);
+    double timeMarch = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    Crit3DTopoDistanceCache topoDistanceCache;
+    topoDistanceCache.initialize(&myDTM, tadFolder);
+    mySettings.setTopoDistanceCache(&topoDistanceCache);
+
+    start = std::chrono::steady_clock::now();
+    topoDistanceCache.setPointsMaps(myPoints, 1);
+    double timeMaps = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    mySettings.getPointsIndex()->initialize(myPoints);
+    start = std::chrono::steady_clock::now();
+    interpolationRasterParallel(myPoints, &mySettings, airTemperature, myDTM, &cacheGrid, nullptr, 1, nullptr);
+    double timeCache = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    mySettings.getPointsIndex()->clear();
+    interpolationRasterParallel(myPoints, &mySettings, airTemperature, myDTM, &cacheScanGrid, nullptr, 1, nullptr);
+    mySettings.getPointsIndex()->initialize(myPoints);
+
+    std::cout << "shepard TAD, " << NR_STATIONS << " stations, kh " << TAD_KH << "  kz " << TAD_KZ << ", 1 thread" << std::endl;
+    std::cout << "  plain shepard [s]: " << timePlain << std::endl;
+    std::cout << "  previous implementation (topographic distance of each cell) [s]: " << timeMarch << std::endl;
+    std::cout << "  computing the maps [s]: " << timeMaps << "  ("
+              << topoDistanceCache.getMemorySize() / 1048576. << " MB)" << std::endl;
+    std::cout << "  cached maps [s]: " << timeCache << std::endl;
+
+    // full resolution maps (default): quantization only, they have to match the previous implementation
+    double meanDifference, maxDifference;
+    int nrDifferent = countDifferentCells(marchGrid, cacheGrid, TAD_TOLERANCE);
+    getDifference(marchGrid, cacheGrid, &meanDifference, &maxDifference);
+    std::cout << "  cells different from the previous implementation (> " << TAD_TOLERANCE << "): " << nrDifferent
+              << "  mean, max difference: " << meanDifference << "  " << maxDifference << std::endl;
+    if (nrDifferent > TAD_MAX_DIFFERENT_FRACTION * nrValidCells)
+    {
+        std::cout << "  TOLERANCE exceeded: more than " << TAD_MAX_DIFFERENT_FRACTION * 100 << "% of the cells" << std::endl;
+        isOk = false;
+    }
+
+    if (! isEqualGrid(cacheGrid, cacheScanGrid))
+    {
+        std::cout << "  MISMATCH between spatial index and linear scan" << std::endl;
+        isOk = false;
+    }
+
+    // maps read from the files of the first cache
+    if (! tadFolder.empty())
+    {
+        Crit3DTopoDistanceCache diskCache;
+        diskCache.initialize(&myDTM, tadFolder);
+        mySettings.setTopoDistanceCache(&diskCache);
+
+        start = std::chrono::steady_clock::now();
+        diskCache.setPointsMaps(myPoints, 1);
+        double timeRead = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        interpolationRasterParallel(myPoints, &mySettings, airTemperature, myDTM, &diskGrid, nullptr, 1, nullptr);
+        std::cout << "  reading the maps [s]: " << timeRead << std::endl;
+
+        if (! isEqualGrid(cacheGrid, diskGrid))
+        {
+            std::cout << "  MISMATCH between computed and read maps" << std::endl;
+            isOk = false;
+        }
+    }
+
+    // reduced resolution
+    Crit3DTopoDistanceCache coarseCache;
+    coarseCache.initialize(&myDTM, "");
+    coarseCache.setResolutionFactor(TAD_RESOLUTION_FACTOR);
+    mySettings.setTopoDistanceCache(&coarseCache);
+
+    start = std::chrono::steady_clock::now();
+    coarseCache.setPointsMaps(myPoints, 1);
+    double timeCoarse = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    interpolationRasterParallel(myPoints, &mySettings, airTemperature, myDTM, &coarseGrid, nullptr, 1, nullptr);
+    // reduced resolution is not a default: the accuracy cost is reported, not checked
+    nrDifferent = countDifferentCells(marchGrid, coarseGrid, TAD_TOLERANCE);
+    getDifference(marchGrid, coarseGrid, &meanDifference, &maxDifference);
+    std::cout << "  computing the maps, resolution factor " << TAD_RESOLUTION_FACTOR << " [s]: " << timeCoarse
+              << "  (" << coarseCache.getMemorySize() / 1048576. << " MB)" << std::endl;
+    std::cout << "  cells different from the previous implementation (> " << TAD_TOLERANCE << "): " << nrDifferent
+              << "  mean, max difference: " << meanDifference << "  " << maxDifference << std::endl;
+
+    // co-located stations share one map: computed (and written) once by the workers
+    std::vector<gis::Crit3DPoint> colocatedPoints;
+    for (unsigned i = 0; i < 8; i++)
+    {
+        colocatedPoints.push_back(*(myPoints[i].point));
+        colocatedPoints.push_back(*(myPoints[i].point));
+    }
+    Crit3DTopoDistanceCache colocatedCache;
+    colocatedCache.initialize(&myDTM, tadFolder);
+    colocatedCache.setResolutionFactor(TAD_RESOLUTION_FACTOR);
+
+    int nrPointsDone = 0;
+    bool isColocatedOk = colocatedCache.computeMaps(colocatedPoints, 4, [&](int nrDone) { nrPointsDone = nrDone; });
+    std::cout << "  co-located stations: " << colocatedPoints.size() << " points, "
+              << colocatedCache.getNrMaps() << " maps" << std::endl;
+    if (! isColocatedOk || colocatedCache.getNrMaps() != 8 || nrPointsDone != int(colocatedPoints.size()))
+    {
+        std::cout << "  MISMATCH in the maps of co-located stations" << std::endl;
+        isOk = false;
+    }
+
+    mySettings.setTopoDistanceCache(nullptr);
+
+    return isOk ? 0 : -1;
+}
@@ -0,0 +1,48 @@
+#-------------------------------------------------------------------
+#
+#   TestInterpolation
+#   benchmark of the raster interpolation (serial and parallel)
+#   this project is part of CRITERIA3D distribution
+#
+#-------------------------------------------------------------------
+
+QT       -= gui core
+
+CONFIG += c++11
+
+CONFIG += console
+CONFIG -= app_bundle
+
+CONFIG += debug_and_release
+
+TEMPLATE = app
+
+unix:{
+    CONFIG(debug, debug|release) {
+        TARGET = debug/testInterpolation
+    } else {
+        TARGET = release/testInterpolation
+    }
+    LIBS += -lpthread
+}
+win32:{
+    TARGET = testInterpolation
+}
+
+INCLUDEPATH += ../crit3dDate ../mathFunctions ../gis ../meteo ../interpolation
+
+SOURCES += main.cpp
+
+CONFIG(debug, debug|release) {
+    LIBS += -L../interpolation/debug -linterpolation
+    LIBS += -L../meteo/debug -lmeteo
+    LIBS += -L../gis/debug -lgis
+    LIBS += -L../crit3dDate/debug -lcrit3dDate
+    LIBS += -L../mathFunctions/debug -lmathFunctions
+} else {
+    LIBS += -L../interpolation/release -linterpolation
+    LIBS += -L../meteo/release -lmeteo
+    LIBS += -L../gis/release -lgis
+    LIBS += -L../crit3dDate/release -lcrit3dDate
+    LIBS += -L../mathFunctions/release -lmathFunctions
+}
@@ -0,0 +1,441 @@
+/*!
+   \name testSoilFluxes3D
+   \brief micro-benchmarks of the soilFluxes3D solver
+   \brief matrixLayout: one Gauss-Seidel sweep with the previous row layout
+   (array of {index, val} rows closed by NOLINK) and with the ELL layout of Tmatrix
+   \brief hydraulicTables: accuracy of the tabulated Van Genuchten - Mualem functions
+   and time of the analytic and batch (tabulated) evaluation of Se, K and dTheta/dH
+   \brief timeStepControl: simulation of rain and dry-down on a sloping grid
+   with the default time step control (halving / doubling) and with the PI controller
+   \brief domainThreads: the default domain initialized on one thread and computed on another,
+   and a domain created and computed on a worker thread while the default domain is used
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <chrono>
+#include <iostream>
+#include <vector>
+#include <thread>
+
+#include "commonConstants.h"
+#include "soilFluxes3D.h"
+#include "types.h"
+#include "domain.h"
+#include "solver.h"
+#include "soilPhysics.h"
+#include "hydraulicTable.h"
+
+
+/*! previous layout of the system matrix */
+struct TmatrixElement {
+    long index;
+    double val;
+};
+
+
+double sweepRowLayout(const TCrit3Dnode *nodes, TmatrixElement **matrix, double *x, const double *knownTerm,
+                      long nrNodes, int maxNrColumns)
+{
+    double norm, newX, psi, infinityNorm = 0.;
+    for (long i = 0; i < nrNodes; i++)
+    {
+        newX = knownTerm[i];
+        int j = 1;
+        while ((j < maxNrColumns) && (matrix[i][j].index != NOLINK))
+        {
+            newX -= matrix[i][j].val * x[matrix[i][j].index];
+            j++;
+        }
+
+        if (nodes[i].isSurface)
+            if (newX < nodes[i].z)
+                newX = nodes[i].z;
+
+        psi = fabs(newX - nodes[i].z);
+        if (psi > 1.0)
+            norm = (fabs(newX - x[i])) / psi;
+        else
+            norm = fabs(newX - x[i]);
+
+        if (norm > infinityNorm) infinityNorm = norm;
+        x[i] = newX;
+    }
+    return infinityNorm;
+}
+
+
+/*!
+ * \brief build a grid of nrRows x nrCols x nrLayers nodes with 8 lateral links
+ * and fill both matrix layouts with the same diagonally dominant values
+ */
+bool buildDomain(int nrRows, int nrCols, int nrLayers, TmatrixElement ***rowMatrix)
+{
+    long nrNodesLayer = long(nrRows) * nrCols;
+    long nrNodes = nrNodesLayer * nrLayers;
+
+    if (soilFluxes3D::initialize(nrNodes, nrLayers, 8, true, false, false) != CRIT3D_OK)
+        return false;
+
+    TCrit3DDomain *myDomain = getCurrentDomain();
+    *rowMatrix = (TmatrixElement **) calloc(size_t(nrNodes), sizeof(TmatrixElement *));
+
+    for (int layer = 0; layer < nrLayers; layer++)
+        for (int row = 0; row < nrRows; row++)
+            for (int col = 0; col < nrCols; col++)
+            {
+                long i = layer * nrNodesLayer + row * nrCols + col;
+                float z = -0.1f * layer;
+                soilFluxes3D::setNode(i, float(col), float(row), z, 1., (layer == 0), false, BOUNDARY_NONE, 0.f);
+
+                TmatrixElement *rowElements = (TmatrixElement *) calloc(size_t(myDomain->structure.maxNrColumns), sizeof(TmatrixElement));
+                (*rowMatrix)[i] = rowElements;
+
+                long linked[10];
+                int nrLinks = 0;
+                if (layer > 0) linked[nrLinks++] = i - nrNodesLayer;
+                for (int dr = -1; dr <= 1; dr++)
+                    for (int dc = -1; dc <= 1; dc++)
+                        if ((dr != 0 || dc != 0) && row+dr >= 0 && row+dr < nrRows && col+dc >= 0 && col+dc < nrCols)
+                            linked[nrLinks++] = i + dr * nrCols + dc;
+                if (layer < nrLayers - 1) linked[nrLinks++] = i + nrNodesLayer;
+
+                long first = i * myDomain->A.nrColumns;
+                for (int k = 0; k < nrLinks; k++)
+                {
+                    double val = -1. / (nrLinks + 1);
+                    myDomain->A.index[first + k] = int(linked[k]);
+                    myDomain->A.val[first + k] = val;
+                    rowElements[k+1].index = linked[k];
+                    rowElements[k+1].val = val;
+                }
+                for (int k = nrLinks + 1; k < myDomain->structure.maxNrColumns; k++)
+                    rowElements[k].index = NOLINK;
+
+                myDomain->A.nrLinks[i] = nrLinks;
+                myDomain->A.diagonal[i] = 1.;
+                rowElements[0].index = i;
+                rowElements[0].val = 1.;
+                myDomain->b[i] = z + 0.01 * (i % 13);
+            }
+
+    return true;
+}
+
+
+void matrixLayout(int nrRows, int nrCols, int nrLayers, int nrSweeps)
+{
+    TmatrixElement **rowMatrix = nullptr;
+    if (! buildDomain(nrRows, nrCols, nrLayers, &rowMatrix))
+    {
+        std::cout << "Error in buildDomain" << std::endl;
+        return;
+    }
+
+    TCrit3DDomain *myDomain = getCurrentDomain();
+    long nrNodes = myDomain->structure.nrNodes;
+    double *xRow = (double *) calloc(size_t(nrNodes), sizeof(double));
+    for (long i = 0; i < nrNodes; i++)
+        myDomain->X[i] = xRow[i] = myDomain->node[i].z;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int k = 0; k < nrSweeps; k++)
+        sweepRowLayout(myDomain->node, rowMatrix, xRow, myDomain->b, nrNodes, myDomain->structure.maxNrColumns);
+    double timeRow = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    for (int k = 0; k < nrSweeps; k++)
+        GaussSeidelIterationWater(myDomain, UP);
+    double timeELL = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    double maxDifference = 0.;
+    for (long i = 0; i < nrNodes; i++)
+        maxDifference = std::max(maxDifference, fabs(myDomain->X[i] - xRow[i]));
+
+    std::cout << "nodes: " << nrNodes << "  sweeps: " << nrSweeps << std::endl;
+    std::cout << "row layout [ms/sweep]: " << timeRow / nrSweeps << std::endl;
+    std::cout << "ELL layout [ms/sweep]: " << timeELL / nrSweeps << std::endl;
+    std::cout << "max difference: " << maxDifference << std::endl;
+
+    for (long i = 0; i < nrNodes; i++)
+        free(rowMatrix[i]);
+    free(rowMatrix);
+    free(xRow);
+    soilFluxes3D::cleanMemory();
+}
+
+
+/*!
+ * \brief soil columns of three textures (sand, loam, clay: Carsel and Parrish, 1988)
+ * with matric potential from -0.001 m to -1000 m
+ */
+void hydraulicTables(long nrNodes, int nrRepetitions)
+{
+    const char *textureName[3] = {"sand", "loam", "clay"};
+    double alpha[3] = {14.5, 3.6, 0.8};
+    double n[3] = {2.68, 1.56, 1.09};
+    double thetaR[3] = {0.045, 0.078, 0.068};
+    double thetaS[3] = {0.43, 0.43, 0.38};
+    double kSat[3] = {8.25E-5, 2.89E-6, 5.56E-7};
+
+    if (soilFluxes3D::initialize(nrNodes, 1, 0, true, false, false) != CRIT3D_OK)
+    {
+        std::cout << "Error in initialize" << std::endl;
+        return;
+    }
+    soilFluxes3D::setHydraulicProperties(MODIFIEDVANGENUCHTEN, MEAN_LOGARITHMIC, 10.f);
+    soilFluxes3D::setHydraulicTables(true);
+    TCrit3DDomain *myDomain = getCurrentDomain();
+
+    std::cout << "texture  max error Se  max error K  max error dSe/dPsi" << std::endl;
+    for (int s = 0; s < 3; s++)
+    {
+        soilFluxes3D::setSoilProperties(s, 0, alpha[s], n[s], 1. - 1. / n[s], 0.005, thetaR[s], thetaS[s], kSat[s], 0.5, 0.02, 0.2);
+
+        double errorSe, errorK, errorC;
+        soilFluxes3D::getHydraulicTableAccuracy(s, 0, &errorSe, &errorK, &errorC);
+        std::cout << textureName[s] << "  " << errorSe << "  " << errorK << "  " << errorC << std::endl;
+    }
+
+    for (long i = 0; i < nrNodes; i++)
+    {
+        soilFluxes3D::setNode(i, 0.f, 0.f, 0.f, 1., false, false, BOUNDARY_NONE, 0.f);
+        soilFluxes3D::setNodeSoil(i, int(i % 3), 0);
+        double psi = pow(10., -3. + 6. * double(i % 1000) / 1000.);
+        soilFluxes3D::setMatricPotential(i, -psi);
+        myDomain->nodeState.H[i] = -psi * (1. + 1E-3 * (i % 7));
+    }
+
+    unsigned nrValues = unsigned(nrNodes);
+    std::vector<double> seExact(nrValues), kExact(nrValues), cExact(nrValues), cTable(nrValues);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int k = 0; k < nrRepetitions; k++)
+        for (long i = 0; i < nrNodes; i++)
+        {
+            seExact[unsigned(i)] = myDomain->nodeState.Se[i] = computeSe(myDomain, unsigned(i));
+            kExact[unsigned(i)] = computeK(myDomain, unsigned(i));
+            cExact[unsigned(i)] = dTheta_dH(myDomain, unsigned(i));
+        }
+    double timeExact = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    for (int k = 0; k < nrRepetitions; k++)
+    {
+        computeSeBatch(myDomain, 0, nrNodes);
+        computeConductivityCapacityBatch(myDomain, 0, nrNodes, cTable.data());
+    }
+    double timeTable = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    double maxErrorSe = 0., maxErrorK = 0., maxErrorC = 0.;
+    for (long i = 0; i < nrNodes; i++)
+    {
+        unsigned u = unsigned(i);
+        maxErrorSe = std::max(maxErrorSe, fabs(myDomain->nodeState.Se[i] - seExact[u]));
+        maxErrorK = std::max(maxErrorK, fabs(myDomain->nodeState.k[i] / kExact[u] - 1.));
+        maxErrorC = std::max(maxErrorC, fabs(cTable[u] / cExact[u] - 1.));
+    }
+
+    std::cout << "nodes: " << nrNodes << "  repetitions: " << nrRepetitions << std::endl;
+    std::cout << "analytic [ms]: " << timeExact / nrRepetitions << std::endl;
+    std::cout << "tables [ms]: " << timeTable / nrRepetitions << std::endl;
+    std::cout << "max error Se: " << maxErrorSe << "  K: " << maxErrorK << "  dTheta/dH: " << maxErrorC << std::endl;
+
+    soilFluxes3D::cleanMemory();
+}
+
+
+/*!
+ * \brief sloping grid of nrRows x nrCols cells (10 m) with a surface layer and nrLayers-1 soil layers (0.1 m),
+ * runoff and lateral drainage on the lower edge, free drainage at the bottom
+ */
+bool buildSlope(int nrRows, int nrCols, int nrLayers)
+{
+    long nrNodesLayer = long(nrRows) * nrCols;
+    long nrNodes = nrNodesLayer * nrLayers;
+    double cellSize = 10.;
+    double thickness = 0.1;
+
+    if (soilFluxes3D::initialize(nrNodes, nrLayers, 8, true, false, false) != CRIT3D_OK)
+        return false;
+
+    soilFluxes3D::setNumericalParameters(30.f, 1800.f, 100, 10, 12, 2);
+    soilFluxes3D::setNumericalSolutionMethod(RELAXATION);
+    soilFluxes3D::setHydraulicProperties(MODIFIEDVANGENUCHTEN, MEAN_LOGARITHMIC, 10.f);
+    soilFluxes3D::setSoilProperties(0, 0, 2.0, 1.4, 1. - 1. / 1.4, 0.01, 0.05, 0.45, 1E-5, 0.5, 0.02, 0.2);
+    soilFluxes3D::setSoilProperties(0, 1, 1.0, 1.3, 1. - 1. / 1.3, 0.01, 0.08, 0.40, 3E-6, 0.5, 0.02, 0.3);
+    soilFluxes3D::setSurfaceProperties(0, 0.24, 0.002);
+
+    for (int layer = 0; layer < nrLayers; layer++)
+        for (int row = 0; row < nrRows; row++)
+            for (int col = 0; col < nrCols; col++)
+            {
+                long i = layer * nrNodesLayer + row * nrCols + col;
+                double z = 100. + 0.3 * row + 0.1 * col - (layer == 0 ? 0. : (layer - 0.5) * thickness);
+                bool isEdge = (row == 0);
+
+                if (layer == 0)
+                    soilFluxes3D::setNode(i, float(col * cellSize), float(row * cellSize), float(z), cellSize * cellSize,
+                                          true, isEdge, isEdge ? BOUNDARY_RUNOFF : BOUNDARY_NONE, isEdge ? 0.03f : 0.f);
+                else if (layer == nrLayers - 1)
+                    soilFluxes3D::setNode(i, float(col * cellSize), float(row * cellSize), float(z), cellSize * cellSize * thickness,
+                                          false, true, BOUNDARY_FREEDRAINAGE, 0.f);
+                else
+                    soilFluxes3D::setNode(i, float(col * cellSize), float(row * cellSize), float(z), cellSize * cellSize * thickness,
+                                          false, isEdge, isEdge ? BOUNDARY_FREELATERALDRAINAGE : BOUNDARY_NONE, isEdge ? 0.03f : 0.f);
+
+                if (layer > 0) soilFluxes3D::setNodeLink(i, i - nrNodesLayer, UP, float(cellSize * cellSize));
+                if (layer < nrLayers - 1) soilFluxes3D::setNodeLink(i, i + nrNodesLayer, DOWN, float(cellSize * cellSize));
+
+                double lateralArea = (layer == 0 ? cellSize : cellSize * thickness) * 0.5;
+                for (int dr = -1; dr <= 1; dr++)
+                    for (int dc = -1; dc <= 1; dc++)
+                        if ((dr != 0 || dc != 0) && row+dr >= 0 && row+dr < nrRows && col+dc >= 0 && col+dc < nrCols)
+                            soilFluxes3D::setNodeLink(i, i + dr * nrCols + dc, LATERAL, float(lateralArea));
+
+                if (layer == 0)
+                {
+                    soilFluxes3D::setNodeSurface(i, 0);
+                    soilFluxes3D::setWaterContent(i, 0.);
+                }
+                else
+                {
+                    soilFluxes3D::setNodeSoil(i, 0, layer < nrLayers / 2 ? 0 : 1);
+                    soilFluxes3D::setMatricPotential(i, -1. - 0.2 * layer);
+                }
+            }
+
+    return true;
+}
+
+
+/*!
+ * \brief nrHours of simulation: 3 hours of rain (4 mm/h) on the surface, then evaporation
+ * (0.3 mm/h) from the first soil layer. The PI controller is opt-in (setAdaptiveTimeStep)
+ */
+void timeStepControl(int nrRows, int nrCols, int nrLayers, int nrHours)
+{
+    const char *controlName[2] = {"halving/doubling", "PI controller"};
+
+    std::cout << "control  time [ms]  accepted  rejected  approximations  mean dt [s]  water content [m3]" << std::endl;
+    for (int control = 0; control < 2; control++)
+    {
+        if (! buildSlope(nrRows, nrCols, nrLayers))
+        {
+            std::cout << "Error in buildSlope" << std::endl;
+            return;
+        }
+        soilFluxes3D::setAdaptiveTimeStep(control == 1);
+        soilFluxes3D::initializeBalance();
+
+        long nrNodesLayer = long(nrRows) * nrCols;
+        double cellArea = 100.;
+        int nrAccepted = 0, nrRejected = 0, nrApproximations = 0;
+
+        auto start = std::chrono::steady_clock::now();
+        for (int hour = 0; hour < nrHours; hour++)
+        {
+            for (long i = 0; i < nrNodesLayer; i++)
+            {
+                soilFluxes3D::setWaterSinkSource(i, hour < 3 ? cellArea * 0.004 / 3600. : 0.);
+                soilFluxes3D::setWaterSinkSource(nrNodesLayer + i, hour < 3 ? 0. : -cellArea * 0.0003 / 3600.);
+            }
+
+            soilFluxes3D::initializeBalance();
+            soilFluxes3D::computePeriod(3600.);
+
+            TsolverStatistics statistics;
+            soilFluxes3D::getSolverStatistics(&statistics);
+            nrAccepted += statistics.nrAcceptedSteps;
+            nrRejected += statistics.nrRejectedSteps;
+            nrApproximations += statistics.nrApproximations;
+        }
+        double time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << controlName[control] << "  " << time << "  " << nrAccepted << "  " << nrRejected << "  "
+                  << nrApproximations << "  " << 3600. * nrHours / nrAccepted << "  "
+                  << soilFluxes3D::getTotalWaterContent() << std::endl;
+
+        soilFluxes3D::cleanMemory();
+    }
+}
+
+
+/*!
+ * \brief 3 hours of rain on the slope of buildSlope, computed in the selected domain of the calling thread
+ */
+double computeRain(int nrRows, int nrCols)
+{
+    long nrNodesLayer = long(nrRows) * nrCols;
+    for (int hour = 0; hour < 3; hour++)
+    {
+        for (long i = 0; i < nrNodesLayer; i++)
+            soilFluxes3D::setWaterSinkSource(i, 100. * 0.004 / 3600.);
+
+        soilFluxes3D::initializeBalance();
+        soilFluxes3D::computePeriod(3600.);
+    }
+    return soilFluxes3D::getTotalWaterContent();
+}
+
+
+/*!
+ * \brief the default domain is shared by the threads that do not select a domain:
+ * initialize on a worker thread and compute on the main thread must give the single thread result,
+ * a domain created and selected on a worker thread does not interfere with the default domain
+ */
+void domainThreads(int nrRows, int nrCols, int nrLayers)
+{
+    buildSlope(nrRows, nrCols, nrLayers);
+    soilFluxes3D::initializeBalance();
+    double waterSingleThread = computeRain(nrRows, nrCols);
+    soilFluxes3D::cleanMemory();
+
+    bool isBuilt = false;
+    std::thread builder([&] { isBuilt = buildSlope(nrRows, nrCols, nrLayers); });
+    builder.join();
+    if (! isBuilt)
+    {
+        std::cout << "Error in buildSlope" << std::endl;
+        return;
+    }
+    soilFluxes3D::initializeBalance();
+
+    double waterWorker = NODATA;
+    std::thread worker([&]
+    {
+        TCrit3DDomain *workerDomain = soilFluxes3D::createDomain();
+        soilFluxes3D::selectDomain(workerDomain);
+        if (buildSlope(nrRows, nrCols, nrLayers))
+        {
+            soilFluxes3D::initializeBalance();
+            waterWorker = computeRain(nrRows, nrCols);
+        }
+        soilFluxes3D::deleteDomain(workerDomain);
+    });
+    double waterDefault = computeRain(nrRows, nrCols);
+    worker.join();
+    soilFluxes3D::cleanMemory();
+
+    std::cout << "water content [m3] single thread: " << waterSingleThread
+              << "  default domain across threads: " << waterDefault
+              << "  created domain on a worker: " << waterWorker << std::endl;
+    if (waterDefault != waterSingleThread || waterWorker != waterSingleThread)
+        std::cout << "Error: different results" << std::endl;
+}
+
+
+int main()
+{
+    // 100 x 100 cells x 50 layers = 500k nodes
+    matrixLayout(100, 100, 50, 20);
+
+    hydraulicTables(300000, 5);
+
+    timeStepControl(30, 30, 10, 12);
+
+    domainThreads(20, 20, 8);
+
+    return 0;
+}
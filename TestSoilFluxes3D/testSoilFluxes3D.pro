@@ -0,0 +1,32 @@
+#---------------------------------------------------------
+#
+#   testSoilFluxes3D
+#   micro-benchmarks of the soilFluxes3D solver
+#   this project is part of CRITERIA3D distribution
+#
+#---------------------------------------------------------
+
+QT       -= core gui
+
+TARGET = testSoilFluxes3D
+CONFIG   += console
+CONFIG   -= app_bundle
+
+INCLUDEPATH += ../soilFluxes3D/header ../mathFunctions
+
+CONFIG += debug_and_release
+
+*-g++*:QMAKE_CXXFLAGS += -fopenmp
+*-g++*:QMAKE_LFLAGS += -fopenmp
+
+CONFIG(debug, debug|release) {
+    LIBS += -L../soilFluxes3D/debug -lsoilFluxes3D
+    LIBS += -L../mathFunctions/debug -lmathFunctions
+} else {
+    LIBS += -L../soilFluxes3D/release -lsoilFluxes3D
+    LIBS += -L../mathFunctions/release -lmathFunctions
+}
+
+TEMPLATE = app
+
+SOURCES += main.cpp
@@ -17,6 +17,9 @@ INCLUDEPATH += ../crit3dDate ../mathFunctions ../gis ../meteo ../interpolation .
 
 CONFIG += debug_and_release
 
+# soilFluxes3D parallel solver
+*-g++*:QMAKE_LFLAGS += -fopenmp
+
 unix:{
     LIBS += -L../MapGraphics/release -lMapGraphics
 }
@@ -1791,7 +1791,8 @@ bool Vine3DProject::loadStates(QDate myDate, QString myArea)
     loadPlantState(this, powderyCurrentColoniesVar, myDate, statePath, myArea);
     loadPlantState(this, powderySporulatingColoniesVar, myDate, statePath, myArea);
 
-    if (!loadWaterBalanceState(this, myDate, myArea, statePath, waterMatricPotential)) return false;
+    if (! loadSoilFluxesState(this, myDate, myArea, statePath))
+        if (!loadWaterBalanceState(this, myDate, myArea, statePath, waterMatricPotential)) return false;
 
     this->logInfo("Load state: " + myDate.toString("yyyy-MM-dd"));
     return(true);
@@ -1834,7 +1835,8 @@ bool Vine3DProject::saveStateAndOutput(QDate myDate, QString myArea)
     if (!savePlantState(this, powderyCurrentColoniesVar, myDate, statePath, myArea)) return(false);
     if (!savePlantState(this, powderySporulatingColoniesVar, myDate, statePath, myArea)) return(false);
 
-    if (!saveWaterBalanceState(this, myDate, myArea, statePath, waterMatricPotential)) return (false);
+    // water state: binary snapshot of soilFluxes3D (the ESRI maps are only read from previous states)
+    if (!saveSoilFluxesState(this, myDate, myArea, statePath)) return (false);
 
     QString notes = "";
     if (!savePlantOutput(this, daysFromFloweringVar, myDate, outputPath, myArea, notes, false, true)) return(false);
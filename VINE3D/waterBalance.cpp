@@ -1,5 +1,6 @@
 #include <math.h>
 #include <vector>
+#include <QFile>
 #include "commonConstants.h"
 #include "gis.h"
 #include "dataHandler.h"
@@ -625,14 +626,11 @@ bool waterBalanceSinkSource(Vine3DProject* myProject, double* totalPrecipitation
                 }
             }
 
-    for (long i = 0; i < myProject->WBSettings->nrNodes; i++)
+    myResult = soilFluxes3D::setWaterSinkSources(0, myProject->WBSettings->nrNodes, myWaterSinkSource.data());
+    if (isCrit3dError(myResult, &myError))
     {
-        myResult = soilFluxes3D::setWaterSinkSource(i, myWaterSinkSource.at(size_t(i)));
-        if (isCrit3dError(myResult, &myError))
-        {
-            myProject->errorString = "initializeSoilMoisture:" + myError;
-            return(false);
-        }
+        myProject->errorString = "initializeSoilMoisture:" + myError;
+        return(false);
     }
 
     return(true);
@@ -1110,6 +1108,42 @@ bool loadWaterBalanceState(Vine3DProject* myProject, QDate myDate, QString myAre
 }
 
 
+QString getSoilFluxesStateFileName(QDate myDate, QString myArea, QString statePath)
+{
+    return statePath + myDate.toString("yyyyMMdd") + "_" + myArea + "_soilFluxes3D.state";
+}
+
+
+// binary snapshot of the whole soilFluxes3D state (water, heat, balances, time step)
+bool saveSoilFluxesState(Vine3DProject* myProject, QDate myDate, QString myArea, QString statePath)
+{
+    QString fileName = getSoilFluxesStateFileName(myDate, myArea, statePath);
+    int result = soilFluxes3D::saveState(fileName.toStdString().c_str());
+    if (result != CRIT3D_OK)
+    {
+        myProject->logError("Error in saving soilFluxes3D state: " + fileName + " error: " + QString::number(result));
+        return false;
+    }
+    return true;
+}
+
+
+// fast restart: false if the snapshot is missing or does not match the current domain
+bool loadSoilFluxesState(Vine3DProject* myProject, QDate myDate, QString myArea, QString statePath)
+{
+    QString fileName = getSoilFluxesStateFileName(myDate, myArea, statePath);
+    if (! QFile::exists(fileName)) return false;
+
+    int result = soilFluxes3D::loadState(fileName.toStdString().c_str());
+    if (result != CRIT3D_OK)
+    {
+        myProject->logInfo("soilFluxes3D state not valid: " + fileName + " error: " + QString::number(result));
+        return false;
+    }
+    return true;
+}
+
+
 //[m] upper depth of layer
 double getLayerTop(Vine3DProject* myProject, int i)
 {
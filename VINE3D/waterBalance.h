@@ -57,6 +57,10 @@
     bool loadWaterBalanceState(Vine3DProject* myProject, QDate myDate, QString myArea,
                                QString myStatePath, criteria3DVariable myVar);
 
+    bool saveSoilFluxesState(Vine3DProject* myProject, QDate myDate, QString myArea, QString myStatePath);
+
+    bool loadSoilFluxesState(Vine3DProject* myProject, QDate myDate, QString myArea, QString myStatePath);
+
     bool waterBalance(Vine3DProject* myProject);
 
     bool getCriteria3DVarMap(Vine3DProject* myProject, criteria3DVariable myVar, int layerIndex,
@@ -294,7 +294,7 @@ bool climateOnPoint(QString *myError, Crit3DMeteoPointsDbHandler* meteoPointsDbH
         }
         else
         {
-            if (meteoPointTemp->nrObsDataDaysD == 0)
+            if (meteoPointTemp->getNrObsDataDaysD() == 0)
             {
                 dataLoaded = false;
             }
@@ -310,7 +310,7 @@ bool climateOnPoint(QString *myError, Crit3DMeteoPointsDbHandler* meteoPointsDbH
         clima->setCurrentYearEnd(clima->yearEnd());
 
         outputValues.clear();
-        meteoPointTemp->nrObsDataDaysD = 0;
+        meteoPointTemp->cleanObsDataD();
         meteoPointTemp->nrObsDataDaysH = 0;
 
         dataLoaded = preElaboration(myError, meteoPointsDbHandler, meteoGridDbHandler, meteoPointTemp, isMeteoGrid, clima->variable(), elab1MeteoComp, startDate, endDate, outputValues, &percValue, meteoSettings, clima->getElabSettings());
@@ -724,7 +724,7 @@ float loadDailyVarSeries(QString *myError, Crit3DMeteoPointsDbHandler *meteoPoin
     }
     else
     {
-        if (meteoPoint->nrObsDataDaysD == 0)
+        if (meteoPoint->getNrObsDataDaysD() == 0)
         {
             meteoPoint->initializeObsDataD(int(dailyValues.size()), getCrit3DDate(firstDateDB));
         }
@@ -783,7 +783,7 @@ float loadDailyVarSeries_SaveOutput(QString *myError, Crit3DMeteoPointsDbHandler
     }
     else
     {
-        if (meteoPoint->nrObsDataDaysD == 0)
+        if (meteoPoint->getNrObsDataDaysD() == 0)
         {
             meteoPoint->initializeObsDataD(int(dailyValues.size()), getCrit3DDate(firstDateDB));
         }
@@ -1107,7 +1107,6 @@ float computeWinkler(Crit3DMeteoPoint* meteoPoint, Crit3DDate firstDate, Crit3DD
     float computeWinkler = 0;
 
     Crit3DQuality qualityCheck;
-    int index;
     int count = 0;
     bool checkData;
     float Tavg;
@@ -1115,34 +1114,33 @@ float computeWinkler(Crit3DMeteoPoint* meteoPoint, Crit3DDate firstDate, Crit3DD
 
     int numberOfDays = difference(firstDate, finishDate) +1;
 
-    Crit3DDate presentDate = firstDate;
-    for (int i = 0; i < numberOfDays; i++)
+    // days not loaded are missing data
+    TDailySeries tAvgSeries = meteoPoint->getDailySeries(dailyAirTemperatureAvg, firstDate, finishDate);
+    TDailySeries tMinSeries = meteoPoint->getDailySeries(dailyAirTemperatureMin, firstDate, finishDate);
+    TDailySeries tMaxSeries = meteoPoint->getDailySeries(dailyAirTemperatureMax, firstDate, finishDate);
+
+    for (long i = 0; i < tAvgSeries.size; i++)
     {
-        index = difference(meteoPoint->obsDataD[0].date, presentDate);
         checkData = false;
-        if (index < meteoPoint->nrObsDataDaysD)
-        {
 
-            // TO DO nella versione vb il check prevede anche l'immissione del parametro height
-            quality::qualityType qualityTavg = qualityCheck.syntacticQualitySingleValue(dailyAirTemperatureAvg, meteoPoint->obsDataD[index].tAvg);
-            if (qualityTavg == quality::accepted)
+        // TO DO nella versione vb il check prevede anche l'immissione del parametro height
+        quality::qualityType qualityTavg = qualityCheck.syntacticQualitySingleValue(dailyAirTemperatureAvg, tAvgSeries[i]);
+        if (qualityTavg == quality::accepted)
+        {
+            Tavg = tAvgSeries[i];
+            checkData = true;
+        }
+        else
+        {
+            quality::qualityType qualityTmin = qualityCheck.syntacticQualitySingleValue(dailyAirTemperatureMin, tMinSeries[i]);
+            quality::qualityType qualityTmax = qualityCheck.syntacticQualitySingleValue(dailyAirTemperatureMax, tMaxSeries[i]);
+            if (qualityTmin  == quality::accepted && qualityTmax == quality::accepted)
             {
-                Tavg = meteoPoint->obsDataD[index].tAvg;
+                Tavg = (tMinSeries[i] + tMaxSeries[i])/2;
                 checkData = true;
             }
-            else
-            {
-                quality::qualityType qualityTmin = qualityCheck.syntacticQualitySingleValue(dailyAirTemperatureMin, meteoPoint->obsDataD[index].tMin);
-                quality::qualityType qualityTmax = qualityCheck.syntacticQualitySingleValue(dailyAirTemperatureMax, meteoPoint->obsDataD[index].tMax);
-                if (qualityTmin  == quality::accepted && qualityTmax == quality::accepted)
-                {
-                    Tavg = (meteoPoint->obsDataD[index].tMin + meteoPoint->obsDataD[index].tMax)/2;
-                    checkData = true;
-                }
-
-            }
-
         }
+
         if (checkData)
         {
             if (Tavg > WINKLERTHRESHOLD)
@@ -1156,7 +1154,6 @@ float computeWinkler(Crit3DMeteoPoint* meteoPoint, Crit3DDate firstDate, Crit3DD
             computeWinkler = computeWinkler + Tavg;
             count = count + 1;
         }
-        presentDate = presentDate.addDays(1);
     }
     if (numberOfDays != 0)
     {
@@ -1202,7 +1199,6 @@ float computeHuglin(Crit3DMeteoPoint* meteoPoint, Crit3DDate firstDate, Crit3DDa
     const float K = 1.04f;                      //coeff. K di Huglin lunghezza giorno (=1.04 per ER)
 
     Crit3DQuality qualityCheck;
-    int index;
     int count = 0;
     bool checkData;
     float Tavg;
@@ -1211,42 +1207,40 @@ float computeHuglin(Crit3DMeteoPoint* meteoPoint, Crit3DDate firstDate, Crit3DDa
 
     int numberOfDays = difference(firstDate, finishDate) +1;
 
-    Crit3DDate presentDate = firstDate;
-    for (int i = 0; i < numberOfDays; i++)
+    // days not loaded are missing data
+    TDailySeries tAvgSeries = meteoPoint->getDailySeries(dailyAirTemperatureAvg, firstDate, finishDate);
+    TDailySeries tMinSeries = meteoPoint->getDailySeries(dailyAirTemperatureMin, firstDate, finishDate);
+    TDailySeries tMaxSeries = meteoPoint->getDailySeries(dailyAirTemperatureMax, firstDate, finishDate);
+
+    for (long i = 0; i < tAvgSeries.size; i++)
     {
-        index = difference(meteoPoint->obsDataD[0].date, presentDate);
         checkData = false;
-        if ( index < meteoPoint->nrObsDataDaysD)
-        {
 
-            // TO DO nella versione vb il check prevede anche l'immissione del parametro height
-            quality::qualityType qualityTavg = qualityCheck.syntacticQualitySingleValue(dailyAirTemperatureAvg, meteoPoint->obsDataD[index].tAvg);
-            quality::qualityType qualityTmax = qualityCheck.syntacticQualitySingleValue(dailyAirTemperatureMax, meteoPoint->obsDataD[index].tMax);
-            if (qualityTavg == quality::accepted && qualityTmax == quality::accepted)
+        // TO DO nella versione vb il check prevede anche l'immissione del parametro height
+        quality::qualityType qualityTavg = qualityCheck.syntacticQualitySingleValue(dailyAirTemperatureAvg, tAvgSeries[i]);
+        quality::qualityType qualityTmax = qualityCheck.syntacticQualitySingleValue(dailyAirTemperatureMax, tMaxSeries[i]);
+        if (qualityTavg == quality::accepted && qualityTmax == quality::accepted)
+        {
+            Tmax = tMaxSeries[i];
+            Tavg = tAvgSeries[i];
+            checkData = true;
+        }
+        else
+        {
+            quality::qualityType qualityTmin = qualityCheck.syntacticQualitySingleValue(dailyAirTemperatureMin, tMinSeries[i]);
+            if (qualityTmin  == quality::accepted && qualityTmax == quality::accepted)
             {
-                Tmax = meteoPoint->obsDataD[index].tMax;
-                Tavg = meteoPoint->obsDataD[index].tAvg;
+                Tmax = tMaxSeries[i];
+                Tavg = (tMinSeries[i] + Tmax)/2;
                 checkData = true;
             }
-            else
-            {
-                quality::qualityType qualityTmin = qualityCheck.syntacticQualitySingleValue(dailyAirTemperatureMin, meteoPoint->obsDataD[index].tMin);
-                if (qualityTmin  == quality::accepted && qualityTmax == quality::accepted)
-                {
-                    Tmax = meteoPoint->obsDataD[index].tMax;
-                    Tavg = (meteoPoint->obsDataD[index].tMin + Tmax)/2;
-                    checkData = true;
-                }
-
-            }
-
         }
+
         if (checkData)
         {
             computeHuglin = computeHuglin + K * ((Tavg - threshold) + (Tmax - threshold)) / 2;
             count = count + 1;
         }
-        presentDate = presentDate.addDays(1);
     }
     if (numberOfDays != 0)
     {
@@ -1266,47 +1260,35 @@ float computeFregoni(Crit3DMeteoPoint* meteoPoint, Crit3DDate firstDate, Crit3DD
     float computeFregoni = 0;
 
     Crit3DQuality qualityCheck;
-    int index;
     int count = 0;
     int myDaysBelow = 0;
-    bool checkData;
     float tMin, tMax;
-    float tRange;
     float sumTRange = 0;
 
 
     int numberOfDays = difference(firstDate, finishDate) +1;
 
-    Crit3DDate presentDate = firstDate;
-    for (int i = 0; i < numberOfDays; i++)
-    {
-        index = difference(meteoPoint->obsDataD[0].date, presentDate);
-        checkData = false;
-        if ( index < meteoPoint->nrObsDataDaysD)
-        {
+    // days not loaded are missing data
+    TDailySeries tMinSeries = meteoPoint->getDailySeries(dailyAirTemperatureMin, firstDate, finishDate);
+    TDailySeries tMaxSeries = meteoPoint->getDailySeries(dailyAirTemperatureMax, firstDate, finishDate);
 
-            // TO DO nella versione vb il check prevede anche l'immissione del parametro height
-            quality::qualityType qualityTmin = qualityCheck.syntacticQualitySingleValue(dailyAirTemperatureMin, meteoPoint->obsDataD[index].tMin);
-            quality::qualityType qualityTmax = qualityCheck.syntacticQualitySingleValue(dailyAirTemperatureMax, meteoPoint->obsDataD[index].tMax);
-            if (qualityTmin == quality::accepted && qualityTmax == quality::accepted)
-            {
-                tMin = meteoPoint->obsDataD[index].tMin;
-                tMax = meteoPoint->obsDataD[index].tMax;
-                tRange = tMax - tMin;
-                checkData = true;
-            }
+    for (long i = 0; i < tMinSeries.size; i++)
+    {
+        tMin = tMinSeries[i];
+        tMax = tMaxSeries[i];
 
-        }
-        if (checkData)
+        // TO DO nella versione vb il check prevede anche l'immissione del parametro height
+        quality::qualityType qualityTmin = qualityCheck.syntacticQualitySingleValue(dailyAirTemperatureMin, tMin);
+        quality::qualityType qualityTmax = qualityCheck.syntacticQualitySingleValue(dailyAirTemperatureMax, tMax);
+        if (qualityTmin == quality::accepted && qualityTmax == quality::accepted)
         {
-            sumTRange = sumTRange + tRange;
+            sumTRange = sumTRange + (tMax - tMin);
             if (tMin < threshold)
             {
                 myDaysBelow = myDaysBelow + 1;
             }
             count = count + 1;
         }
-        presentDate = presentDate.addDays(1);
     }
     if (numberOfDays != 0)
     {
@@ -1326,38 +1308,29 @@ float computeFregoni(Crit3DMeteoPoint* meteoPoint, Crit3DDate firstDate, Crit3DD
 
 float computeCorrectedSum(Crit3DMeteoPoint* meteoPoint, Crit3DDate firstDate, Crit3DDate finishDate, float param, float minimumPercentage)
 {
-    float computeCorrectedSum;
+    float computeCorrectedSum = 0;
 
     Crit3DQuality qualityCheck;
-    int index;
     int count = 0;
-    bool checkData;
     float tMin, tMax, tAvg;
     float numTmp, numerator, denominator;
 
 
     int numberOfDays = difference(firstDate, finishDate) +1;
 
-    Crit3DDate presentDate = firstDate;
-    for (int i = 0; i < numberOfDays; i++)
-    {
-        index = difference(meteoPoint->obsDataD[0].date, presentDate);
-        checkData = false;
-        if ( index < meteoPoint->nrObsDataDaysD)
-        {
+    // days not loaded are missing data
+    TDailySeries tMinSeries = meteoPoint->getDailySeries(dailyAirTemperatureMin, firstDate, finishDate);
+    TDailySeries tMaxSeries = meteoPoint->getDailySeries(dailyAirTemperatureMax, firstDate, finishDate);
 
-            // TO DO nella versione vb il check prevede anche l'immissione del parametro height
-            quality::qualityType qualityTmin = qualityCheck.syntacticQualitySingleValue(dailyAirTemperatureMin, meteoPoint->obsDataD[index].tMin);
-            quality::qualityType qualityTmax = qualityCheck.syntacticQualitySingleValue(dailyAirTemperatureMax, meteoPoint->obsDataD[index].tMax);
-            if (qualityTmin == quality::accepted && qualityTmax == quality::accepted)
-            {
-                tMax = meteoPoint->obsDataD[index].tMax;
-                tMin = meteoPoint->obsDataD[index].tMin;
-                checkData = true;
-            }
+    for (long i = 0; i < tMinSeries.size; i++)
+    {
+        tMin = tMinSeries[i];
+        tMax = tMaxSeries[i];
 
-        }
-        if (checkData)
+        // TO DO nella versione vb il check prevede anche l'immissione del parametro height
+        quality::qualityType qualityTmin = qualityCheck.syntacticQualitySingleValue(dailyAirTemperatureMin, tMin);
+        quality::qualityType qualityTmax = qualityCheck.syntacticQualitySingleValue(dailyAirTemperatureMax, tMax);
+        if (qualityTmin == quality::accepted && qualityTmax == quality::accepted)
         {
             if (param < tMax)
             {
@@ -1379,7 +1352,6 @@ float computeCorrectedSum(Crit3DMeteoPoint* meteoPoint, Crit3DDate firstDate, Cr
             }
             count = count + 1;
         }
-        presentDate = presentDate.addDays(1);
     }
     if (numberOfDays != 0)
     {
@@ -1437,61 +1409,70 @@ bool elaborateDailyAggregatedVarFromDaily(meteoVariable myVar, Crit3DMeteoPoint
 
     float res;
     int nrValidValues = 0;
-    Crit3DDate date = meteoPoint.obsDataD[0].date;
+    Crit3DDate date = meteoPoint.firstDateD;
     Crit3DQuality qualityCheck;
 
-    for (int index = 0; index < meteoPoint.nrObsDataDaysD; index++)
+    float* tMin = meteoPoint.getDailyColumn(dailyAirTemperatureMin);
+    float* tMax = meteoPoint.getDailyColumn(dailyAirTemperatureMax);
+    float* tAvg = meteoPoint.getDailyColumn(dailyAirTemperatureAvg);
+    float* prec = meteoPoint.getDailyColumn(dailyPrecipitation);
+    float* rhMin = meteoPoint.getDailyColumn(dailyAirRelHumidityMin);
+    float* rhMax = meteoPoint.getDailyColumn(dailyAirRelHumidityMax);
+    float* rhAvg = meteoPoint.getDailyColumn(dailyAirRelHumidityAvg);
+    float* et0_hs = meteoPoint.getDailyColumn(dailyReferenceEvapotranspirationHS);
+
+    for (int index = 0; index < meteoPoint.getNrObsDataDaysD(); index++)
     {
         switch(myVar)
         {
         case dailyThomDaytime:
-                res = thomDayTime(meteoPoint.obsDataD[index].tMax, meteoPoint.obsDataD[index].rhMin);
+                res = thomDayTime(tMax[index], rhMin[index]);
             break;
         case dailyThomNighttime:
-                res = thomNightTime(meteoPoint.obsDataD[index].tMin, meteoPoint.obsDataD[index].rhMax);
+                res = thomNightTime(tMin[index], rhMax[index]);
                 break;
         case dailyBIC:
-                res = computeDailyBIC(meteoPoint.obsDataD[index].prec, meteoPoint.obsDataD[index].et0_hs);
+                res = computeDailyBIC(prec[index], et0_hs[index]);
                 break;
         case dailyAirTemperatureRange:
-                res = dailyThermalRange(meteoPoint.obsDataD[index].tMin, meteoPoint.obsDataD[index].tMax);
+                res = dailyThermalRange(tMin[index], tMax[index]);
                 break;
         case dailyAirTemperatureAvg:
                 {
-                    quality::qualityType qualityTavg = qualityCheck.syntacticQualitySingleValue(dailyAirTemperatureAvg, meteoPoint.obsDataD[index].tAvg);
+                    quality::qualityType qualityTavg = qualityCheck.syntacticQualitySingleValue(dailyAirTemperatureAvg, tAvg[index]);
                     if (qualityTavg == quality::accepted)
                     {
-                        res = meteoPoint.obsDataD[index].tAvg;
+                        res = tAvg[index];
                     }
                     else
                     {
-                        res = dailyAverageT(meteoPoint.obsDataD[index].tMin, meteoPoint.obsDataD[index].tMax);
-                        meteoPoint.obsDataD[index].tAvg = res;
+                        res = dailyAverageT(tMin[index], tMax[index]);
+                        tAvg[index] = res;
                     }
                     break;
                 }
         case dailyReferenceEvapotranspirationHS:
         {
-            quality::qualityType qualityEtp = qualityCheck.syntacticQualitySingleValue(dailyReferenceEvapotranspirationHS, meteoPoint.obsDataD[index].et0_hs);
+            quality::qualityType qualityEtp = qualityCheck.syntacticQualitySingleValue(dailyReferenceEvapotranspirationHS, et0_hs[index]);
             if (qualityEtp == quality::accepted)
             {
-                res = meteoPoint.obsDataD[index].et0_hs;
+                res = et0_hs[index];
             }
             else
             {
-                res = dailyEtpHargreaves(meteoPoint.obsDataD[index].tMin, meteoPoint.obsDataD[index].tMax, date, meteoPoint.latitude);
-                meteoPoint.obsDataD[index].et0_hs = res;
+                res = dailyEtpHargreaves(tMin[index], tMax[index], date, meteoPoint.latitude);
+                et0_hs[index] = res;
             }
             break;
         }
         case dailyAirDewTemperatureAvg:
-                res = dewPoint(meteoPoint.obsDataD[index].rhAvg, meteoPoint.obsDataD[index].tAvg); // RHavg, Tavg
+                res = dewPoint(rhAvg[index], tAvg[index]); // RHavg, Tavg
                 break;
         case dailyAirDewTemperatureMin:
-                res = dewPoint(meteoPoint.obsDataD[index].rhMax, meteoPoint.obsDataD[index].tMin); // RHmax, Tmin
+                res = dewPoint(rhMax[index], tMin[index]); // RHmax, Tmin
                 break;
         case dailyAirDewTemperatureMax:
-                res = dewPoint(meteoPoint.obsDataD[index].rhMin, meteoPoint.obsDataD[index].tMax); // RHmin, Tmax
+                res = dewPoint(rhMin[index], tMax[index]); // RHmin, Tmax
                 break;
         default:
                 res = NODATA;
@@ -1507,7 +1488,7 @@ bool elaborateDailyAggregatedVarFromDaily(meteoVariable myVar, Crit3DMeteoPoint
         date = date.addDays(1);
     }
 
-    *percValue = nrValidValues / meteoPoint.nrObsDataDaysD;
+    *percValue = nrValidValues / meteoPoint.getNrObsDataDaysD();
     if (nrValidValues > 0)
         return true;
     else
@@ -1839,7 +1820,7 @@ float computeStatistic(std::vector<float> &inputValues, Crit3DMeteoPoint* meteoP
         {
             case lastDayBelowThreshold:
             {
-                return computeLastDayBelowThreshold(inputValues, meteoPoint->obsDataD[0].date ,firstDate, lastDate, param1);
+                return computeLastDayBelowThreshold(inputValues, meteoPoint->firstDateD ,firstDate, lastDate, param1);
             }
             case winkler:
             {
@@ -1905,13 +1886,13 @@ float computeStatistic(std::vector<float> &inputValues, Crit3DMeteoPoint* meteoP
 
                         float value = NODATA;
 
-                        if (meteoPoint->obsDataD[0].date > presentDate)
+                        if (meteoPoint->firstDateD > presentDate)
                         {
                             value = NODATA;
                         }
                         else
                         {
-                            index = difference(meteoPoint->obsDataD[0].date, presentDate);
+                            index = difference(meteoPoint->firstDateD, presentDate);
                             if (index < inputValues.size())
                             {
                                 value = inputValues.at(index);
@@ -1984,7 +1965,7 @@ float computeStatistic(std::vector<float> &inputValues, Crit3DMeteoPoint* meteoP
             {
                 case lastDayBelowThreshold:
                 {
-                    primary = computeLastDayBelowThreshold(inputValues, meteoPoint->obsDataD[0].date ,firstDate, lastDate, param1);
+                    primary = computeLastDayBelowThreshold(inputValues, meteoPoint->firstDateD ,firstDate, lastDate, param1);
                     break;
                 }
                 case winkler:
@@ -2023,13 +2004,13 @@ float computeStatistic(std::vector<float> &inputValues, Crit3DMeteoPoint* meteoP
                     {
                         float value = NODATA;
 
-                        if (meteoPoint->obsDataD[0].date > presentDate)
+                        if (meteoPoint->firstDateD > presentDate)
                         {
                             value = NODATA;
                         }
                         else
                         {
-                            index = difference(meteoPoint->obsDataD[0].date, presentDate);
+                            index = difference(meteoPoint->firstDateD, presentDate);
                             if (index < inputValues.size())
                             {
                                 value = inputValues.at(index);
@@ -36,6 +36,9 @@
 
 const long daysInMonth[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
 
+// days before the first day of the month (not leap years), index: 0 - 11
+const int daysBeforeMonth[12] = {0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334};
+
 
 // index: 1 - 12
 int getDaysInMonth(int month, int year)
@@ -163,37 +166,12 @@ Crit3DDate& operator -- (Crit3DDate& myDate)
 
 Crit3DDate Crit3DDate::addDays(int nrDays) const
 {
-    Crit3DDate myDate = *this;
-    if (nrDays >= 0)
-    {
-        for (int i=0; i<nrDays; i++)
-            ++myDate;
-    }
-    else
-    {
-        for (int i=0; i>nrDays; i--)
-            --myDate;
-    }
-
-    return (myDate);
+    return getDateFromDayNumber(getDayNumberFromDate(*this) + nrDays);
 }
 
 int Crit3DDate::daysTo(const Crit3DDate& myDate) const
 {
-    Crit3DDate myDateMin = min(*this, myDate);
-    Crit3DDate myDateMax = max(*this, myDate);
-
-    int myDiff = 0;
-    while (myDateMin < myDateMax)
-    {
-        myDiff++;
-        ++myDateMin;
-    }
-
-    if (myDateMax == myDate)
-        return (myDiff);
-    else
-        return (-myDiff);
+    return getDayNumberFromDate(myDate) - getDayNumberFromDate(*this);
 }
 
 Crit3DDate max(const Crit3DDate& myDate1, const Crit3DDate& myDate2)
@@ -243,17 +221,46 @@ bool isNullDate(Crit3DDate myDate)
 }
 
 
+// number of days from myDatefirst to myDatelast, 0 if myDatelast is not after myDatefirst
 int difference(Crit3DDate myDatefirst, Crit3DDate myDatelast)
 {
+    int myDiff = getDayNumberFromDate(myDatelast) - getDayNumberFromDate(myDatefirst);
+    return (myDiff > 0 ? myDiff : 0);
+}
 
-    int myDiff = 0;
-    while (myDatefirst < myDatelast)
-    {
-        myDiff++;
-        ++myDatefirst;
-    }
 
-    return myDiff;
+/*!
+ * \brief serial day number: days from 1970-01-01 (proleptic gregorian calendar)
+ * the year is shifted to start in March, so that the leap day is the last day of the year
+ */
+int getDayNumberFromDate(const Crit3DDate& myDate)
+{
+    int year = myDate.year - (myDate.month <= 2 ? 1 : 0);
+    int era = (year >= 0 ? year : year - 399) / 400;
+    int yearOfEra = year - era * 400;                                                   // [0, 399]
+    int month = myDate.month > 2 ? myDate.month - 3 : myDate.month + 9;                 // [0, 11] from March
+    int dayOfYear = (153 * month + 2) / 5 + myDate.day - 1;                             // [0, 365]
+    int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;       // [0, 146096]
+
+    return era * 146097 + dayOfEra - 719468;
+}
+
+
+Crit3DDate getDateFromDayNumber(int dayNumber)
+{
+    dayNumber += 719468;
+    int era = (dayNumber >= 0 ? dayNumber : dayNumber - 146096) / 146097;
+    int dayOfEra = dayNumber - era * 146097;
+    int yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    int dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    int month = (5 * dayOfYear + 2) / 153;
+
+    Crit3DDate myDate;
+    myDate.day = dayOfYear - (153 * month + 2) / 5 + 1;
+    myDate.month = month < 10 ? month + 3 : month - 9;
+    myDate.year = yearOfEra + era * 400 + (myDate.month <= 2 ? 1 : 0);
+
+    return myDate;
 }
 
 
@@ -272,15 +279,13 @@ bool isLeapYear(int year)
 
 int getDoyFromDate(const Crit3DDate& myDate)
 {
-    int myDoy = 0;
+    if (myDate.month < 1 || myDate.month > 12)
+        return myDate.day;
 
-    if(myDate.month > 2 && isLeapYear(myDate.year))
-      myDoy = 1;
-
-    for(int myMonth = 0; myMonth < myDate.month - 1; myMonth++)
-      myDoy += daysInMonth[myMonth];
+    int myDoy = daysBeforeMonth[myDate.month - 1] + myDate.day;
 
-    myDoy += myDate.day;
+    if(myDate.month > 2 && isLeapYear(myDate.year))
+      myDoy++;
 
     return myDoy;
 }
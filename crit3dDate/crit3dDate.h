@@ -101,6 +101,9 @@
     int getDoyFromDate(const Crit3DDate& myDate);
     Crit3DDate getDateFromDoy(int myYear, int myDoy);
 
+    int getDayNumberFromDate(const Crit3DDate& myDate);
+    Crit3DDate getDateFromDayNumber(int dayNumber);
+
     Crit3DDate max(const Crit3DDate& myDate1, const Crit3DDate& myDate2);
     Crit3DDate min(const Crit3DDate& myDate1, const Crit3DDate& myDate2);
 
@@ -295,7 +295,7 @@ bool Criteria1D::loadMeteo(QString idMeteo, QString idForecast, QString *myError
             // previsioni indietro di un giorno: accettato ma tolgo un giorno
             if (firstForecastDate == lastObsDate)
             {
-                meteoPoint.nrObsDataDaysD--;
+                meteoPoint.shrinkObsDataD(meteoPoint.getNrObsDataDaysD() - 1);
             }
             else
             {
@@ -311,33 +311,36 @@ bool Criteria1D::loadMeteo(QString idMeteo, QString idForecast, QString *myError
         // estende il dato precedente se mancante
         float previousTmin = NODATA;
         float previousTmax = NODATA;
+        float* tMin = meteoPoint.getDailyColumn(dailyAirTemperatureMin);
+        float* tMax = meteoPoint.getDailyColumn(dailyAirTemperatureMax);
         long lastObservedIndex = long(firstObsDate.daysTo(lastObsDate));
-        for (long i = lastObservedIndex; i < meteoPoint.nrObsDataDaysD; i++)
+        for (long i = lastObservedIndex; i < meteoPoint.getNrObsDataDaysD(); i++)
         {
             // tmin
-            if (int(meteoPoint.obsDataD[i].tMin) != int(NODATA))
-                previousTmin = meteoPoint.obsDataD[i].tMin;
+            if (int(tMin[i]) != int(NODATA))
+                previousTmin = tMin[i];
             else if (int(previousTmin) != int(NODATA))
-                meteoPoint.obsDataD[i].tMin = previousTmin;
+                tMin[i] = previousTmin;
 
             // tmax
-            if (int(meteoPoint.obsDataD[i].tMax) != int(NODATA))
-                previousTmax = meteoPoint.obsDataD[i].tMax;
+            if (int(tMax[i]) != int(NODATA))
+                previousTmax = tMax[i];
             else if (int(previousTmax) != int(NODATA))
-                meteoPoint.obsDataD[i].tMax = previousTmax;
+                tMax[i] = previousTmax;
         }
     }
 
     // fill watertable (all data)
     // estende il dato precedente se mancante
     float previousWatertable = NODATA;
-    for (long i = 0; i < meteoPoint.nrObsDataDaysD; i++)
+    float* waterTable = meteoPoint.getDailyColumn(dailyWaterTableDepth);
+    for (long i = 0; i < meteoPoint.getNrObsDataDaysD(); i++)
     {
         // watertable
-        if (int(meteoPoint.obsDataD[i].waterTable) != int(NODATA))
-            previousWatertable = meteoPoint.obsDataD[i].waterTable;
+        if (int(waterTable[i]) != int(NODATA))
+            previousWatertable = waterTable[i];
         else if (int(previousWatertable) != int(NODATA))
-            meteoPoint.obsDataD[i].waterTable = previousWatertable;
+            waterTable[i] = previousWatertable;
     }
 
     return true;
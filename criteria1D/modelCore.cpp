@@ -57,9 +57,9 @@ bool runModel(Criteria1D* myCase, Criteria1DUnit *myUnit, QString* myError)
 
     // set computation period (all meteo data)
     Crit3DDate firstDate, lastDate;
-    long lastIndex = myCase->meteoPoint.nrObsDataDaysD-1;
-    firstDate = myCase->meteoPoint.obsDataD[0].date;
-    lastDate = myCase->meteoPoint.obsDataD[lastIndex].date;
+    long lastIndex = myCase->meteoPoint.getNrObsDataDaysD()-1;
+    firstDate = myCase->meteoPoint.firstDateD;
+    lastDate = myCase->meteoPoint.firstDateD.addDays(lastIndex);
 
     if (myCase->isSeasonalForecast)
         myCase->initializeSeasonalForecast(firstDate, lastDate);
@@ -98,8 +98,8 @@ bool computeModel(Criteria1D* myCase, const Crit3DDate& firstDate, const Crit3DD
         doy = getDoyFromDate(myDate);
 
         // daily meteo
-        myIndex = myCase->meteoPoint.obsDataD[0].date.daysTo(myDate);
-        if ((myIndex < 0) || (myIndex >= myCase->meteoPoint.nrObsDataDaysD))
+        myIndex = myCase->meteoPoint.firstDateD.daysTo(myDate);
+        if ((myIndex < 0) || (myIndex >= myCase->meteoPoint.getNrObsDataDaysD()))
         {
             *myError = "Missing weather data: " + QString::fromStdString(myDate.toStdString());
             return false;
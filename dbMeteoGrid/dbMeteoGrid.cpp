@@ -2,6 +2,9 @@
 #include "utilities.h"
 #include "commonConstants.h"
 #include <stdexcept>
+#include <algorithm>
+#include <atomic>
+#include <thread>
 #include <qdebug.h> //debug
 #include <iostream> //debug
 
@@ -13,6 +16,8 @@ Crit3DMeteoGridDbHandler::Crit3DMeteoGridDbHandler()
 
 Crit3DMeteoGridDbHandler::~Crit3DMeteoGridDbHandler()
 {
+    clearPreloadedData();
+    _connectionPool.close();
     delete _meteoGrid;
 }
 
@@ -789,6 +794,8 @@ bool Crit3DMeteoGridDbHandler::openDatabase(QString *myError)
 
 void Crit3DMeteoGridDbHandler::closeDatabase()
 {
+    _connectionPool.close();
+
     if ((_db.isValid()) && (_db.isOpen()))
     {
         _db.removeDatabase(_db.connectionName());
@@ -1318,6 +1325,362 @@ bool Crit3DMeteoGridDbHandler::loadGridHourlyDataFixedFields(QString *myError, Q
     return true;
 }
 
+/*!
+ * \brief loadGridAllDailyData
+ * load the daily data [first, last] of all the active cells, in parallel
+ * progress: number of cells done (see loadGridCells), it can be empty
+ */
+bool Crit3DMeteoGridDbHandler::loadGridAllDailyData(QString *myError, QDate first, QDate last, int nrThreads,
+                                                    std::function<void(int)> progress)
+{
+    return loadGridAllData(myError, daily, QDateTime(first, QTime(0, 0)), QDateTime(last, QTime(0, 0)), nrThreads, progress);
+}
+
+
+/*!
+ * \brief loadGridAllHourlyData
+ * load the hourly data [first, last] of all the active cells, in parallel
+ * progress: number of cells done (see loadGridCells), it can be empty
+ */
+bool Crit3DMeteoGridDbHandler::loadGridAllHourlyData(QString *myError, QDateTime first, QDateTime last, int nrThreads,
+                                                     std::function<void(int)> progress)
+{
+    return loadGridAllData(myError, hourly, first, last, nrThreads, progress);
+}
+
+
+/*!
+ * \brief loadGridAllData
+ * load the data [first, last] of all the active cells with a table
+ * \return false if a query fails or no cell has data (see loadGridCells)
+ */
+bool Crit3DMeteoGridDbHandler::loadGridAllData(QString *myError, frequencyType frequency, QDateTime first, QDateTime last,
+                                               int nrThreads, std::function<void(int)> progress)
+{
+    const TXMLTable& table = (frequency == daily) ? _tableDaily : _tableHourly;
+
+    QSet<QString> existingTables;
+    foreach (QString tableName, _db.tables())
+    {
+        existingTables.insert(tableName);
+    }
+
+    std::vector<Crit3DMeteoPoint*> cellPoints;
+    QStringList cellTables;
+    int nrRows = _gridStructure.header().nrRows;
+    int nrCols = _gridStructure.header().nrCols;
+    std::string id;
+    for (int row = 0; row < nrRows; row++)
+    {
+        for (int col = 0; col < nrCols; col++)
+        {
+            if (! _meteoGrid->getMeteoPointActiveId(row, col, &id))
+                continue;
+
+            QString tableName = table.prefix + QString::fromStdString(id) + table.postFix;
+            if (existingTables.contains(tableName))
+            {
+                cellPoints.push_back(_meteoGrid->meteoPointPointer(row, col));
+                cellTables << tableName;
+            }
+        }
+    }
+
+    return loadGridCells(myError, frequency, first, last, cellPoints, cellTables, nrThreads, progress);
+}
+
+
+/*!
+ * \brief loadGridCells
+ * load the data [first, last] of the cells (points and their tables): the cells are
+ * shared among nrThreads workers (0 = number of cores, at most MAX_GRID_CONNECTIONS)
+ * of the connection pool, each one with its own connection, kept open for the next loadings.
+ * Every query reads GRID_CELLS_PER_QUERY cell tables (UNION ALL of the cell selections)
+ * to reduce the round trips.
+ * progress (number of cells done) is called by the calling thread, it can be empty
+ * \return false if a query fails (the cells of that query have no data) or no cell has data
+ */
+bool Crit3DMeteoGridDbHandler::loadGridCells(QString *myError, frequencyType frequency, QDateTime first, QDateTime last,
+                                             const std::vector<Crit3DMeteoPoint*>& cellPoints, const QStringList& cellTables,
+                                             int nrThreads, std::function<void(int)> progress)
+{
+    const int MAX_GRID_CONNECTIONS = 8;
+    const int GRID_CELLS_PER_QUERY = 50;
+
+    const TXMLTable& table = (frequency == daily) ? _tableDaily : _tableHourly;
+    bool isFixedFields = _gridStructure.isFixedFields();
+    QString timeFormat = (frequency == daily) ? "yyyy-MM-dd" : "yyyy-MM-dd hh:mm";
+    QString firstStr = first.toString(timeFormat);
+    QString lastStr = last.toString(timeFormat);
+    Crit3DDate firstDate = getCrit3DDate(first.date());
+
+    int numberOfDays = int(first.date().daysTo(last.date()));
+    if (frequency == daily || last.time() > QTime(0, 0))
+        numberOfDays++;
+    numberOfDays = std::max(1, numberOfDays);
+
+    // selected fields and variables: the maps of the handler are not read by the workers
+    QString fieldList = QString("`%1`").arg(table.fieldTime);
+    std::vector<meteoVariable> fieldVariables;
+    std::map<int, meteoVariable> codeVariables;
+    for (unsigned int i = 0; i < table.varcode.size(); i++)
+    {
+        int varCode = table.varcode[i].varCode;
+        meteoVariable myVar = (frequency == daily) ? getDailyVarEnum(varCode) : getHourlyVarEnum(varCode);
+        if (isFixedFields)
+        {
+            fieldList += QString(", `%1`").arg(table.varcode[i].varField);
+            fieldVariables.push_back(myVar);
+        }
+        else
+            codeVariables[varCode] = myVar;
+    }
+    if (! isFixedFields)
+        fieldList += ", VariableCode, Value";
+
+    int nrCells = int(cellPoints.size());
+    if (nrCells == 0)
+    {
+        *myError = "No Data Available";
+        return false;
+    }
+
+    int nrQueries = (nrCells + GRID_CELLS_PER_QUERY - 1) / GRID_CELLS_PER_QUERY;
+    if (nrThreads <= 0)
+        nrThreads = std::min(int(std::thread::hardware_concurrency()), MAX_GRID_CONNECTIONS);
+    nrThreads = std::max(1, std::min(nrThreads, nrQueries));
+
+    std::atomic<int> nextQuery(0);
+    std::atomic<int> nrDoneCells(0);
+    std::atomic<int> nrFailedCells(0);
+    std::vector<char> isCellData(unsigned(nrCells), 0);
+    std::vector<QString> threadError(unsigned(nrThreads));
+
+    auto loadCells = [&](QSqlDatabase& db, int threadIndex)
+    {
+        QSqlQuery qry(db);
+        qry.setForwardOnly(true);
+
+        int q;
+        while ((q = nextQuery++) < nrQueries)
+        {
+            int firstCell = q * GRID_CELLS_PER_QUERY;
+            int lastCell = std::min(firstCell + GRID_CELLS_PER_QUERY, nrCells) - 1;
+
+            QStringList selections;
+            for (int c = firstCell; c <= lastCell; c++)
+            {
+                if (frequency == daily)
+                    cellPoints[unsigned(c)]->initializeObsDataD(numberOfDays, firstDate);
+                else
+                    cellPoints[unsigned(c)]->initializeObsDataH(1, numberOfDays, firstDate);
+
+                selections << QString("SELECT %1 AS cell_index, %2 FROM `%3` WHERE `%4` >= '%5' AND `%4` <= '%6'")
+                              .arg(c).arg(fieldList).arg(cellTables[c]).arg(table.fieldTime).arg(firstStr).arg(lastStr);
+            }
+
+            if (! qry.exec(selections.join(" UNION ALL ")))
+            {
+                threadError[unsigned(threadIndex)] = qry.lastError().text();
+                nrFailedCells += lastCell - firstCell + 1;
+                nrDoneCells += lastCell - firstCell + 1;
+                _connectionPool.notifyProgress();
+                continue;
+            }
+
+            QDate myDate;
+            QDateTime myDateTime;
+            float value;
+            while (qry.next())
+            {
+                int c = qry.value(0).toInt();
+                if (c < firstCell || c > lastCell) continue;
+                Crit3DMeteoPoint* meteoPoint = cellPoints[unsigned(c)];
+
+                int hour = 0, minute = 0;
+                if (frequency == daily)
+                {
+                    if (! getValue(qry.value(1), &myDate)) continue;
+                }
+                else
+                {
+                    if (! getValue(qry.value(1), &myDateTime)) continue;
+                    myDate = myDateTime.date();
+                    hour = myDateTime.time().hour();
+                    minute = myDateTime.time().minute();
+                }
+                Crit3DDate date = getCrit3DDate(myDate);
+
+                auto setValue = [&](meteoVariable myVar, float myValue)
+                {
+                    bool isSet;
+                    if (frequency == daily)
+                        isSet = meteoPoint->setMeteoPointValueD(date, myVar, myValue);
+                    else
+                        isSet = meteoPoint->setMeteoPointValueH(date, hour, minute, myVar, myValue);
+                    if (isSet) isCellData[unsigned(c)] = 1;
+                };
+
+                if (isFixedFields)
+                {
+                    for (unsigned int i = 0; i < fieldVariables.size(); i++)
+                    {
+                        getValue(qry.value(int(i) + 2), &value);
+                        setValue(fieldVariables[i], value);
+                    }
+                }
+                else
+                {
+                    auto it = codeVariables.find(qry.value(2).toInt());
+                    if (it == codeVariables.end()) continue;
+                    getValue(qry.value(3), &value);
+                    setValue(it->second, value);
+                }
+            }
+
+            nrDoneCells += lastCell - firstCell + 1;
+            _connectionPool.notifyProgress();
+        }
+
+        qry.clear();
+    };
+
+    _connectionPool.setDatabase(_db);
+    QString poolError;
+    int lastProgress = 0;
+    auto reportProgress = [&]()
+    {
+        if (progress && nrDoneCells != lastProgress)
+        {
+            lastProgress = nrDoneCells;
+            progress(lastProgress);
+        }
+    };
+
+    if (! _connectionPool.run(nrThreads, loadCells, &poolError, reportProgress))
+    {
+        *myError = poolError;
+        return false;
+    }
+    reportProgress();
+
+    // a failed query leaves its cells without data: the loading is not complete
+    if (nrFailedCells > 0)
+    {
+        for (unsigned t = 0; t < threadError.size(); t++)
+            if (! threadError[t].isEmpty())
+                *myError = threadError[t];
+        *myError = QString("%1 of %2 cells not loaded: %3").arg(int(nrFailedCells)).arg(nrCells).arg(*myError);
+        return false;
+    }
+
+    int nrDataCells = int(std::count(isCellData.begin(), isCellData.end(), 1));
+    if (nrDataCells == 0)
+    {
+        *myError = "No Data Available";
+        return false;
+    }
+
+    return true;
+}
+
+
+/*!
+ * \brief preloadGridDailyData
+ * load all the daily data [first, last] of the cells in idList in memory (loadGridCells):
+ * until clearPreloadedData, loadGridDailyVar and loadGridDailyVarFixedFields
+ * read these cells from memory instead of the db (elaboration of the grid)
+ */
+bool Crit3DMeteoGridDbHandler::preloadGridDailyData(QString *myError, const std::vector<std::string>& idList, QDate first, QDate last)
+{
+    clearPreloadedData();
+
+    QSet<QString> existingTables;
+    foreach (QString tableName, _db.tables())
+    {
+        existingTables.insert(tableName);
+    }
+
+    std::vector<Crit3DMeteoPoint*> cellPoints;
+    QStringList cellTables;
+    for (unsigned i = 0; i < idList.size(); i++)
+    {
+        QString tableName = _tableDaily.prefix + QString::fromStdString(idList[i]) + _tableDaily.postFix;
+        if (! existingTables.contains(tableName))
+            continue;
+
+        Crit3DMeteoPoint* meteoPoint = new Crit3DMeteoPoint();
+        meteoPoint->id = idList[i];
+        _preloadedCells[idList[i]] = meteoPoint;
+        cellPoints.push_back(meteoPoint);
+        cellTables << tableName;
+    }
+
+    // any failed query: nothing is preloaded, all the cells are read from the db
+    if (! loadGridCells(myError, daily, QDateTime(first, QTime(0, 0)), QDateTime(last, QTime(0, 0)), cellPoints, cellTables, 0, nullptr))
+    {
+        clearPreloadedData();
+        return false;
+    }
+
+    _preloadedFirstDate = first;
+    _preloadedLastDate = last;
+    return true;
+}
+
+
+void Crit3DMeteoGridDbHandler::clearPreloadedData()
+{
+    for (auto it = _preloadedCells.begin(); it != _preloadedCells.end(); ++it)
+    {
+        it->second->cleanObsDataD();
+        delete it->second;
+    }
+    _preloadedCells.clear();
+}
+
+
+/*!
+ * \brief getPreloadedDailyVar
+ * daily values [first, last] of a preloaded cell, as read from the db by loadGridDailyVar:
+ * from the first to the last day with data, NODATA for the missing days
+ * \return false if the cell or the period are not preloaded
+ */
+bool Crit3DMeteoGridDbHandler::getPreloadedDailyVar(const QString& meteoPoint, meteoVariable variable, QDate first, QDate last,
+                                                    QDate* firstDateDB, std::vector<float>& dailyVarList)
+{
+    auto it = _preloadedCells.find(meteoPoint.toStdString());
+    if (it == _preloadedCells.end() || first < _preloadedFirstDate || last > _preloadedLastDate)
+        return false;
+
+    Crit3DMeteoPoint* myPoint = it->second;
+    int nrDays = int(first.daysTo(last)) + 1;
+    int firstIndex = NODATA, lastIndex = NODATA;
+    std::vector<float> values(unsigned(std::max(0, nrDays)));
+
+    Crit3DDate myDate = getCrit3DDate(first);
+    for (int i = 0; i < nrDays; i++)
+    {
+        values[unsigned(i)] = myPoint->getMeteoPointValueD(myDate, variable);
+        if (values[unsigned(i)] != NODATA)
+        {
+            if (firstIndex == NODATA) firstIndex = i;
+            lastIndex = i;
+        }
+        myDate = myDate.addDays(1);
+    }
+
+    dailyVarList.clear();
+    if (firstIndex != NODATA)
+    {
+        *firstDateDB = first.addDays(firstIndex);
+        dailyVarList.assign(values.begin() + firstIndex, values.begin() + lastIndex + 1);
+    }
+
+    return true;
+}
+
+
 std::vector<float> Crit3DMeteoGridDbHandler::loadGridDailyVar(QString *myError, QString meteoPoint, meteoVariable variable, QDate first, QDate last, QDate* firstDateDB)
 {
     QSqlQuery qry(_db);
@@ -1339,6 +1702,9 @@ std::vector<float> Crit3DMeteoGridDbHandler::loadGridDailyVar(QString *myError,
         return dailyVarList;
     }
 
+    if (getPreloadedDailyVar(meteoPoint, variable, first, last, firstDateDB, dailyVarList))
+        return dailyVarList;
+
     if (!_meteoGrid->findMeteoPointFromId(&row, &col, meteoPoint.toStdString()) )
     {
         *myError = "Missing MeteoPoint id";
@@ -1422,6 +1788,9 @@ std::vector<float> Crit3DMeteoGridDbHandler::loadGridDailyVarFixedFields(QString
         return dailyVarList;
     }
 
+    if (getPreloadedDailyVar(meteoPoint, variable, first, last, firstDateDB, dailyVarList))
+        return dailyVarList;
+
     for (unsigned int i=0; i < _tableDaily.varcode.size(); i++)
     {
         if(_tableDaily.varcode[i].varCode == varCode)
@@ -1665,6 +2034,7 @@ std::vector<float> Crit3DMeteoGridDbHandler::loadGridHourlyVarFixedFields(QStrin
 bool Crit3DMeteoGridDbHandler::saveCellGridDailyData(QString *myError, QString meteoPointID, int row, int col, QDate firstDate, QDate lastDate, QList<meteoVariable> meteoVariableList)
 {
     QSqlQuery qry(_db);
+    Crit3DMeteoPoint* meteoPoint = meteoGrid()->meteoPointPointer(row, col);
     QString tableD = _tableDaily.prefix + meteoPointID + _tableDaily.postFix;
 
 
@@ -1686,7 +2056,7 @@ bool Crit3DMeteoGridDbHandler::saveCellGridDailyData(QString *myError, QString m
             QDate date = firstDate.addDays(i);
             foreach (meteoVariable meteoVar, meteoVariableList)
             {
-                float value = meteoGrid()->meteoPoint(row,col).getMeteoPointValueD(getCrit3DDate(date), meteoVar);
+                float value = meteoPoint->getMeteoPointValueD(getCrit3DDate(date), meteoVar);
                 QString valueS = QString("'%1'").arg(value);
                 if (value == NODATA)
                     valueS = "NULL";
@@ -1712,6 +2082,7 @@ bool Crit3DMeteoGridDbHandler::saveCellGridDailyData(QString *myError, QString m
 bool Crit3DMeteoGridDbHandler::saveCellGridDailyDataFF(QString *myError, QString meteoPointID, int row, int col, QDate firstDate, QDate lastDate)
 {
     QSqlQuery qry(_db);
+    Crit3DMeteoPoint* meteoPoint = meteoGrid()->meteoPointPointer(row, col);
     QString tableD = _tableDaily.prefix + meteoPointID + _tableDaily.postFix;
     QString tableFields;
 
@@ -1742,7 +2113,7 @@ bool Crit3DMeteoGridDbHandler::saveCellGridDailyDataFF(QString *myError, QString
             statement += QString(" ('%1',").arg(date.toString("yyyy-MM-dd"));
             for (unsigned int i=0; i < _tableDaily.varcode.size(); i++)
             {
-                float value = meteoGrid()->meteoPoint(row,col).getMeteoPointValueD(getCrit3DDate(date), getDailyVarFieldEnum(_tableDaily.varcode[i].varField));
+                float value = meteoPoint->getMeteoPointValueD(getCrit3DDate(date), getDailyVarFieldEnum(_tableDaily.varcode[i].varField));
                 QString valueS = QString("'%1'").arg(value);
                 if (value == NODATA)
                     valueS = "NULL";
@@ -1848,6 +2219,7 @@ bool Crit3DMeteoGridDbHandler::saveCellCurrentGridDailyFF(QString *myError, QStr
 bool Crit3DMeteoGridDbHandler::saveCellGridHourlyData(QString *myError, QString meteoPointID, int row, int col, QDateTime firstDate, QDateTime lastDate, QList<meteoVariable> meteoVariableList)
 {
     QSqlQuery qry(_db);
+    Crit3DMeteoPoint* meteoPoint = meteoGrid()->meteoPointPointer(row, col);
     QString tableH = _tableHourly.prefix + meteoPointID + _tableHourly.postFix;
 
 
@@ -1869,7 +2241,7 @@ bool Crit3DMeteoGridDbHandler::saveCellGridHourlyData(QString *myError, QString
             QDateTime dateTime = firstDate.addSecs(i*3600);
             foreach (meteoVariable meteoVar, meteoVariableList)
             {
-                float value = meteoGrid()->meteoPoint(row,col).getMeteoPointValueH(getCrit3DDate(dateTime.date()), dateTime.time().hour(), dateTime.time().minute(), meteoVar);
+                float value = meteoPoint->getMeteoPointValueH(getCrit3DDate(dateTime.date()), dateTime.time().hour(), dateTime.time().minute(), meteoVar);
                 QString valueS = QString("'%1'").arg(value);
                 if (value == NODATA)
                     valueS = "NULL";
@@ -1893,6 +2265,7 @@ bool Crit3DMeteoGridDbHandler::saveCellGridHourlyData(QString *myError, QString
 bool Crit3DMeteoGridDbHandler::saveCellGridHourlyDataFF(QString *myError, QString meteoPointID, int row, int col, QDateTime firstDate, QDateTime lastDate)
 {
     QSqlQuery qry(_db);
+    Crit3DMeteoPoint* meteoPoint = meteoGrid()->meteoPointPointer(row, col);
     QString tableH = _tableHourly.prefix + meteoPointID + _tableHourly.postFix;
     QString tableFields;
 
@@ -1923,7 +2296,7 @@ bool Crit3DMeteoGridDbHandler::saveCellGridHourlyDataFF(QString *myError, QStrin
             statement += QString(" ('%1',").arg(dateTime.toString("yyyy-MM-dd hh:mm"));
             for (unsigned int i=0; i < _tableHourly.varcode.size(); i++)
             {
-                float value = meteoGrid()->meteoPoint(row,col).getMeteoPointValueH(getCrit3DDate(dateTime.date()), dateTime.time().hour(), dateTime.time().minute(), getHourlyVarFieldEnum(_tableHourly.varcode[i].varField));
+                float value = meteoPoint->getMeteoPointValueH(getCrit3DDate(dateTime.date()), dateTime.time().hour(), dateTime.time().minute(), getHourlyVarFieldEnum(_tableHourly.varcode[i].varField));
                 QString valueS = QString("'%1'").arg(value);
                 if (value == NODATA)
                     valueS = "NULL";
@@ -2025,6 +2398,260 @@ bool Crit3DMeteoGridDbHandler::saveCellCurrentGridHourlyFF(QString *myError, QSt
 }
 
 
+/*!
+ * \brief saveGridDailyData
+ * save the daily data [firstDate, lastDate] of all the active cells
+ */
+bool Crit3DMeteoGridDbHandler::saveGridDailyData(QString *myError, QDate firstDate, QDate lastDate, QList<meteoVariable> meteoVariableList)
+{
+    int nrDays = int(firstDate.daysTo(lastDate)) + 1;
+    return saveGridValues(myError, daily, QDateTime(firstDate, QTime(0, 0), Qt::UTC), nrDays, meteoVariableList, false);
+}
+
+
+/*!
+ * \brief saveGridHourlyData
+ * save the hourly data [firstDate, lastDate] (hourly steps) of all the active cells
+ */
+bool Crit3DMeteoGridDbHandler::saveGridHourlyData(QString *myError, QDateTime firstDate, QDateTime lastDate, QList<meteoVariable> meteoVariableList)
+{
+    QDateTime firstTime(firstDate.date(), firstDate.time(), Qt::UTC);
+    QDateTime lastTime(lastDate.date(), lastDate.time(), Qt::UTC);
+    int nrHours = int(firstTime.secsTo(lastTime) / 3600) + 1;
+    return saveGridValues(myError, hourly, firstTime, nrHours, meteoVariableList, false);
+}
+
+
+/*!
+ * \brief saveGridCurrentDaily
+ * save the current value of all the active cells (a whole grid timestep)
+ */
+bool Crit3DMeteoGridDbHandler::saveGridCurrentDaily(QString *myError, QDate date, meteoVariable meteoVar)
+{
+    return saveGridValues(myError, daily, QDateTime(date, QTime(0, 0), Qt::UTC), 1, QList<meteoVariable>() << meteoVar, true);
+}
+
+
+bool Crit3DMeteoGridDbHandler::saveGridCurrentHourly(QString *myError, QDateTime dateTime, meteoVariable meteoVar)
+{
+    return saveGridValues(myError, hourly, QDateTime(dateTime.date(), dateTime.time(), Qt::UTC), 1, QList<meteoVariable>() << meteoVar, true);
+}
+
+
+QString Crit3DMeteoGridDbHandler::getCreateTableStatement(frequencyType frequency, const QString& tableName)
+{
+    const TXMLTable& table = (frequency == daily) ? _tableDaily : _tableHourly;
+    QString timeType = (frequency == daily) ? "date" : "datetime";
+
+    if (! _gridStructure.isFixedFields())
+    {
+        return QString("CREATE TABLE IF NOT EXISTS `%1` "
+                       "(`%2` %3, VariableCode tinyint(3) UNSIGNED, Value float(6,1), PRIMARY KEY(`%2`,VariableCode))")
+                        .arg(tableName).arg(table.fieldTime).arg(timeType);
+    }
+
+    const QMap<QString, QString>& mapVarType = (frequency == daily) ? _mapDailyMySqlVarType : _mapHourlyMySqlVarType;
+    QString tableFields;
+    for (unsigned int i = 0; i < table.varcode.size(); i++)
+    {
+        tableFields += ", " + table.varcode[i].varField.toLower() + " " + mapVarType.value(table.varcode[i].varPragaName);
+    }
+
+    return QString("CREATE TABLE IF NOT EXISTS `%1` (`%2` %3").arg(tableName).arg(table.fieldTime).arg(timeType)
+            + tableFields + QString(", PRIMARY KEY(`%1`))").arg(table.fieldTime);
+}
+
+
+/*!
+ * \brief saveGridValues
+ * write nrTimes steps (days or hours) from firstTime of all the active cells.
+ * Times and variable codes (or fields) are computed once and the points are read by pointer.
+ * The missing cell tables are created before the transaction (DDL commits implicitly on MySQL),
+ * then the rows of each cell table are written with multi-row statements
+ * (at most MAX_SAVE_ROWS rows each), all in one transaction.
+ * Fixed fields use INSERT ... ON DUPLICATE KEY UPDATE: REPLACE would clear the other variables of the row
+ * isCurrentValue: the value saved is the currentValue of the cell (nrTimes = 1)
+ */
+bool Crit3DMeteoGridDbHandler::saveGridValues(QString *myError, frequencyType frequency, const QDateTime& firstTime, int nrTimes,
+                                              const QList<meteoVariable>& meteoVariableList, bool isCurrentValue)
+{
+    const int MAX_SAVE_ROWS = 5000;
+
+    if (nrTimes <= 0 || meteoVariableList.isEmpty())
+    {
+        *myError = "No data to save";
+        return false;
+    }
+
+    const TXMLTable& table = (frequency == daily) ? _tableDaily : _tableHourly;
+    bool isFixedFields = _gridStructure.isFixedFields();
+    int nrVariables = meteoVariableList.size();
+
+    // variable codes (or fields)
+    std::vector<int> varCodes;
+    QString fieldList, updateList;
+    for (int v = 0; v < nrVariables; v++)
+    {
+        meteoVariable myVar = meteoVariableList[v];
+        if (isFixedFields)
+        {
+            QString varField = (frequency == daily) ? getDailyVarField(myVar) : getHourlyVarField(myVar);
+            if (varField.isEmpty())
+            {
+                *myError = "Variable not existing: " + QString::fromStdString(getVariableString(myVar));
+                return false;
+            }
+            varField = varField.toLower();
+            fieldList += QString(", `%1`").arg(varField);
+            updateList += QString("%1`%2` = VALUES(`%2`)").arg(v == 0 ? "" : ", ").arg(varField);
+        }
+        else
+        {
+            int varCode = (frequency == daily) ? getDailyVarCode(myVar) : getHourlyVarCode(myVar);
+            if (varCode == NODATA)
+            {
+                *myError = "Variable not existing: " + QString::fromStdString(getVariableString(myVar));
+                return false;
+            }
+            varCodes.push_back(varCode);
+        }
+    }
+
+    // times
+    QString timeFormat = (frequency == daily) ? "yyyy-MM-dd" : "yyyy-MM-dd hh:mm";
+    QStringList timeList;
+    std::vector<Crit3DDate> dateList;
+    std::vector<int> hourList, minuteList;
+    for (int t = 0; t < nrTimes; t++)
+    {
+        QDateTime myTime = (frequency == daily) ? firstTime.addDays(t) : firstTime.addSecs(t * 3600);
+        timeList << myTime.toString(timeFormat);
+        dateList.push_back(getCrit3DDate(myTime.date()));
+        hourList.push_back(myTime.time().hour());
+        minuteList.push_back(myTime.time().minute());
+    }
+
+    // active cells
+    int nrRows = _gridStructure.header().nrRows;
+    int nrCols = _gridStructure.header().nrCols;
+    std::vector<QString> tableNames;
+    std::vector<Crit3DMeteoPoint*> meteoPoints;
+    std::string id;
+
+    for (int row = 0; row < nrRows; row++)
+    {
+        for (int col = 0; col < nrCols; col++)
+        {
+            if (! _meteoGrid->getMeteoPointActiveId(row, col, &id))
+                continue;
+
+            tableNames.push_back(table.prefix + QString::fromStdString(id) + table.postFix);
+            meteoPoints.push_back(_meteoGrid->meteoPointPointer(row, col));
+        }
+    }
+
+    // missing tables
+    QSqlQuery qry(_db);
+    QSet<QString> existingSet;
+    foreach (QString tableName, _db.tables())
+    {
+        existingSet.insert(tableName);
+    }
+
+    for (unsigned i = 0; i < tableNames.size(); i++)
+    {
+        if (existingSet.contains(tableNames[i]))
+            continue;
+
+        if (! qry.exec(getCreateTableStatement(frequency, tableNames[i])))
+        {
+            *myError = qry.lastError().text();
+            return false;
+        }
+        existingSet.insert(tableNames[i]);
+    }
+
+    if (! _db.transaction())
+    {
+        *myError = _db.lastError().text();
+        return false;
+    }
+
+    for (unsigned i = 0; i < tableNames.size(); i++)
+    {
+        Crit3DMeteoPoint* meteoPoint = meteoPoints[i];
+
+        QString header;
+        if (isFixedFields)
+            header = QString("INSERT INTO `%1` (`%2`%3) VALUES").arg(tableNames[i]).arg(table.fieldTime).arg(fieldList);
+        else
+            header = QString("REPLACE INTO `%1` VALUES").arg(tableNames[i]);
+
+        QString statement = header;
+        int nrStatementRows = 0;
+        for (int t = 0; t < nrTimes; t++)
+        {
+            if (isFixedFields)
+                statement += " ('" + timeList[t] + "'";
+
+            for (int v = 0; v < nrVariables; v++)
+            {
+                float value;
+                if (isCurrentValue)
+                    value = meteoPoint->currentValue;
+                else if (frequency == daily)
+                    value = meteoPoint->getMeteoPointValueD(dateList[unsigned(t)], meteoVariableList[v]);
+                else
+                    value = meteoPoint->getMeteoPointValueH(dateList[unsigned(t)], hourList[unsigned(t)], minuteList[unsigned(t)], meteoVariableList[v]);
+
+                QString valueS = (value == NODATA) ? "NULL" : QString("'%1'").arg(value);
+
+                if (isFixedFields)
+                {
+                    statement += "," + valueS;
+                }
+                else
+                {
+                    statement += QString(" ('%1','%2',%3),").arg(timeList[t]).arg(varCodes[unsigned(v)]).arg(valueS);
+                    nrStatementRows++;
+                }
+            }
+
+            if (isFixedFields)
+            {
+                statement += "),";
+                nrStatementRows++;
+            }
+
+            if (nrStatementRows >= MAX_SAVE_ROWS || t == nrTimes - 1)
+            {
+                statement.chop(1);
+                if (isFixedFields)
+                    statement += " ON DUPLICATE KEY UPDATE " + updateList;
+
+                if (! qry.exec(statement))
+                {
+                    *myError = qry.lastError().text();
+                    _db.rollback();
+                    return false;
+                }
+                statement = header;
+                nrStatementRows = 0;
+            }
+        }
+    }
+
+    if (! _db.commit())
+    {
+        *myError = _db.lastError().text();
+        _db.rollback();
+        return false;
+    }
+
+    return true;
+}
+
+
 QDate Crit3DMeteoGridDbHandler::firstDate() const
 {
     return _firstDate;
@@ -2075,17 +2702,17 @@ TXMLConnection Crit3DMeteoGridDbHandler::connection() const
     return _connection;
 }
 
-Crit3DMeteoGridStructure Crit3DMeteoGridDbHandler::gridStructure() const
+const Crit3DMeteoGridStructure& Crit3DMeteoGridDbHandler::gridStructure() const
 {
     return _gridStructure;
 }
 
-TXMLTable Crit3DMeteoGridDbHandler::tableDaily() const
+const TXMLTable& Crit3DMeteoGridDbHandler::tableDaily() const
 {
     return _tableDaily;
 }
 
-TXMLTable Crit3DMeteoGridDbHandler::tableHourly() const
+const TXMLTable& Crit3DMeteoGridDbHandler::tableHourly() const
 {
     return _tableHourly;
 }
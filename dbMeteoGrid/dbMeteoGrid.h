@@ -9,6 +9,11 @@
 #ifndef METEOGRID_H
     #include "meteoGrid.h"
 #endif
+#ifndef GRIDCONNECTIONPOOL_H
+    #include "gridConnectionPool.h"
+#endif
+
+#include <map>
 
 
 struct TXMLConnection
@@ -57,7 +62,7 @@ class Crit3DMeteoGridDbHandler
 
         TXMLConnection connection() const;
 
-        Crit3DMeteoGridStructure gridStructure() const;
+        const Crit3DMeteoGridStructure& gridStructure() const;
 
         Crit3DMeteoGrid *meteoGrid() const;
 
@@ -71,9 +76,9 @@ class Crit3DMeteoGridDbHandler
 
         void setLastDate(const QDate &lastDate);
 
-        TXMLTable tableDaily() const;
+        const TXMLTable& tableDaily() const;
 
-        TXMLTable tableHourly() const;
+        const TXMLTable& tableHourly() const;
 
         QString tableDailyModel() const;
 
@@ -123,6 +128,16 @@ class Crit3DMeteoGridDbHandler
 
         bool loadGridHourlyDataFixedFields(QString *myError, QString meteoPoint, QDateTime first, QDateTime last);
 
+        bool loadGridAllDailyData(QString *myError, QDate first, QDate last, int nrThreads = 0,
+                                  std::function<void(int)> progress = nullptr);
+
+        bool loadGridAllHourlyData(QString *myError, QDateTime first, QDateTime last, int nrThreads = 0,
+                                   std::function<void(int)> progress = nullptr);
+
+        bool preloadGridDailyData(QString *myError, const std::vector<std::string>& idList, QDate first, QDate last);
+
+        void clearPreloadedData();
+
         std::vector<float> loadGridDailyVar(QString *myError, QString meteoPoint, meteoVariable variable, QDate first, QDate last, QDate *firstDateDB);
 
         std::vector<float> loadGridDailyVarFixedFields(QString *myError, QString meteoPoint, meteoVariable variable, QDate first, QDate last, QDate* firstDateDB);
@@ -148,6 +163,13 @@ class Crit3DMeteoGridDbHandler
 
         bool saveCellCurrentGridHourlyFF(QString *myError, QString meteoPointID, QDateTime dateTime, QString varPragaName, float value);
 
+        bool saveGridDailyData(QString *myError, QDate firstDate, QDate lastDate, QList<meteoVariable> meteoVariableList);
+
+        bool saveGridHourlyData(QString *myError, QDateTime firstDate, QDateTime lastDate, QList<meteoVariable> meteoVariableList);
+
+        bool saveGridCurrentDaily(QString *myError, QDate date, meteoVariable meteoVar);
+
+        bool saveGridCurrentHourly(QString *myError, QDateTime dateTime, meteoVariable meteoVar);
 
 
 
@@ -177,6 +199,26 @@ private:
         QMap<QString, QString> _mapDailyMySqlVarType;
         QMap<QString, QString> _mapHourlyMySqlVarType;
 
+        Crit3DGridConnectionPool _connectionPool;
+
+        std::map<std::string, Crit3DMeteoPoint*> _preloadedCells;
+        QDate _preloadedFirstDate;
+        QDate _preloadedLastDate;
+
+        bool loadGridAllData(QString *myError, frequencyType frequency, QDateTime first, QDateTime last, int nrThreads,
+                             std::function<void(int)> progress);
+
+        bool loadGridCells(QString *myError, frequencyType frequency, QDateTime first, QDateTime last,
+                           const std::vector<Crit3DMeteoPoint*>& cellPoints, const QStringList& cellTables, int nrThreads,
+                           std::function<void(int)> progress);
+
+        bool getPreloadedDailyVar(const QString& meteoPoint, meteoVariable variable, QDate first, QDate last,
+                                  QDate* firstDateDB, std::vector<float>& dailyVarList);
+
+        QString getCreateTableStatement(frequencyType frequency, const QString& tableName);
+
+        bool saveGridValues(QString *myError, frequencyType frequency, const QDateTime& firstTime, int nrTimes,
+                            const QList<meteoVariable>& meteoVariableList, bool isCurrentValue);
 
 };
 
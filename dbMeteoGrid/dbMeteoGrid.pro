@@ -32,7 +32,9 @@ INCLUDEPATH += ../mathFunctions ../gis ../crit3dDate  ../meteo ../utilities
 
 SOURCES += \
         dbMeteoGrid.cpp \
+        gridConnectionPool.cpp
 
 HEADERS += \
-        dbMeteoGrid.h
+        dbMeteoGrid.h \
+        gridConnectionPool.h
 
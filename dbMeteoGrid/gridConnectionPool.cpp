@@ -0,0 +1,188 @@
+#include "gridConnectionPool.h"
+
+#include <QSqlError>
+#include <algorithm>
+
+
+Crit3DGridConnectionPool::Crit3DGridConnectionPool()
+{
+    _port = 0;
+    _poolName = "grid_" + QString::number(quintptr(this), 16);
+
+    _nrActiveWorkers = 0;
+    _nrDoneWorkers = 0;
+    _generation = 0;
+    _isStopped = false;
+    _isProgressChanged = false;
+}
+
+
+Crit3DGridConnectionPool::~Crit3DGridConnectionPool()
+{
+    close();
+}
+
+
+/*!
+ * \brief setDatabase
+ * copy the connection parameters of db: if they are changed
+ * the workers (and their connections) are closed
+ */
+void Crit3DGridConnectionPool::setDatabase(const QSqlDatabase& db)
+{
+    if (db.driverName() == _driverName && db.hostName() == _hostName && db.databaseName() == _dbName
+        && db.userName() == _userName && db.password() == _password && db.port() == _port)
+        return;
+
+    close();
+
+    _driverName = db.driverName();
+    _hostName = db.hostName();
+    _dbName = db.databaseName();
+    _userName = db.userName();
+    _password = db.password();
+    _port = db.port();
+}
+
+
+// stop the workers and close their connections
+void Crit3DGridConnectionPool::close()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _isStopped = true;
+    }
+    _taskReady.notify_all();
+
+    for (unsigned i = 0; i < _workers.size(); i++)
+        _workers[i].join();
+
+    _workers.clear();
+    _errors.clear();
+    _isStopped = false;
+}
+
+
+int Crit3DGridConnectionPool::getNrWorkers() const
+{
+    return int(_workers.size());
+}
+
+
+/*!
+ * \brief run
+ * execute task(connection, worker index) on nrWorkers workers and wait for them:
+ * the workers are created when required. Only one run at a time (calling thread)
+ * progress (it can be empty) is called by the calling thread when a task calls notifyProgress
+ * \return false if no worker could open its connection
+ */
+bool Crit3DGridConnectionPool::run(int nrWorkers, std::function<void(QSqlDatabase&, int)> task, QString* myError,
+                                   std::function<void()> progress)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+
+    nrWorkers = std::max(1, nrWorkers);
+    while (int(_workers.size()) < nrWorkers)
+    {
+        _errors.push_back("");
+        _workers.push_back(std::thread(&Crit3DGridConnectionPool::workerLoop, this, int(_workers.size()), _generation));
+    }
+
+    for (unsigned i = 0; i < _errors.size(); i++)
+        _errors[i].clear();
+
+    _task = task;
+    _nrActiveWorkers = nrWorkers;
+    _nrDoneWorkers = 0;
+    _isProgressChanged = false;
+    _generation++;
+    _taskReady.notify_all();
+
+    while (true)
+    {
+        _taskDone.wait(lock, [&]{ return _nrDoneWorkers == _nrActiveWorkers || _isProgressChanged; });
+        if (_nrDoneWorkers == _nrActiveWorkers) break;
+
+        _isProgressChanged = false;
+        if (progress)
+        {
+            lock.unlock();
+            progress();
+            lock.lock();
+        }
+    }
+    _task = nullptr;
+
+    int nrErrors = 0;
+    for (int i = 0; i < nrWorkers; i++)
+    {
+        if (! _errors[unsigned(i)].isEmpty())
+        {
+            *myError = _errors[unsigned(i)];
+            nrErrors++;
+        }
+    }
+
+    return (nrErrors < nrWorkers);
+}
+
+
+// called by the tasks: the calling thread of run reports the progress
+void Crit3DGridConnectionPool::notifyProgress()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _isProgressChanged = true;
+    _taskDone.notify_all();
+}
+
+
+// lastGeneration: generation of the pool when the worker is created (before its first task)
+void Crit3DGridConnectionPool::workerLoop(int index, long lastGeneration)
+{
+    QString connectionName = _poolName + "_" + QString::number(index);
+    bool isAdded = false;
+
+    {
+        QSqlDatabase db;
+        std::unique_lock<std::mutex> lock(_mutex);
+
+        while (true)
+        {
+            _taskReady.wait(lock, [&]{ return _isStopped || _generation != lastGeneration; });
+            if (_isStopped) break;
+
+            lastGeneration = _generation;
+            if (index >= _nrActiveWorkers) continue;
+
+            lock.unlock();
+
+            QString error;
+            if (! isAdded)
+            {
+                db = QSqlDatabase::addDatabase(_driverName, connectionName);
+                db.setHostName(_hostName);
+                db.setDatabaseName(_dbName);
+                db.setUserName(_userName);
+                db.setPassword(_password);
+                if (_port > 0) db.setPort(_port);
+                isAdded = true;
+            }
+
+            if (! db.isOpen() && ! db.open())
+                error = db.lastError().text();
+            else
+                _task(db, index);
+
+            lock.lock();
+            _errors[unsigned(index)] = error;
+            _nrDoneWorkers++;
+            _taskDone.notify_all();
+        }
+
+        lock.unlock();
+        if (isAdded) db.close();
+    }
+
+    if (isAdded)
+        QSqlDatabase::removeDatabase(connectionName);
+}
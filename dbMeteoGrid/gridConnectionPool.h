@@ -0,0 +1,60 @@
+#ifndef GRIDCONNECTIONPOOL_H
+#define GRIDCONNECTIONPOOL_H
+
+#include <QString>
+#include <QSqlDatabase>
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+/*!
+ * \brief pool of worker threads for the parallel reading of the meteo grid db
+ * a QSqlDatabase connection can be used only in the thread that created it:
+ * each worker opens its own connection (grid_<pool>_<index>) the first time it is
+ * used and keeps it open until the pool is closed, so the connections are
+ * reused by all the loadings of the grid
+ */
+class Crit3DGridConnectionPool
+{
+public:
+    Crit3DGridConnectionPool();
+    ~Crit3DGridConnectionPool();
+
+    void setDatabase(const QSqlDatabase& db);
+    void close();
+    int getNrWorkers() const;
+
+    bool run(int nrWorkers, std::function<void(QSqlDatabase&, int)> task, QString* myError,
+             std::function<void()> progress = nullptr);
+    void notifyProgress();
+
+private:
+    QString _driverName;
+    QString _hostName;
+    QString _dbName;
+    QString _userName;
+    QString _password;
+    int _port;
+    QString _poolName;
+
+    std::vector<std::thread> _workers;
+    std::vector<QString> _errors;
+    std::function<void(QSqlDatabase&, int)> _task;
+    int _nrActiveWorkers;
+    int _nrDoneWorkers;
+    long _generation;
+    bool _isStopped;
+    bool _isProgressChanged;
+
+    std::mutex _mutex;
+    std::condition_variable _taskReady;
+    std::condition_variable _taskDone;
+
+    void workerLoop(int index, long lastGeneration);
+};
+
+
+#endif // GRIDCONNECTIONPOOL_H
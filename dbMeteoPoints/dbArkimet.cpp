@@ -147,42 +147,63 @@ QList<int> DbArkimet::getHourlyVar()
 
 
 
-void DbArkimet::initStationsDailyTables(QDate startDate, QDate endDate, QStringList stations)
+// create the station tables and delete the period to be downloaded:
+// it runs in the transaction of saveDailyData, so the old data are kept if the insert fails
+bool DbArkimet::initStationsDailyTables(QDate startDate, QDate endDate, QStringList stations)
 {
-
     for (int i = 0; i < stations.size(); i++)
     {
         QString statement = QString("CREATE TABLE IF NOT EXISTS `%1_D` "
                                     "(date_time TEXT, id_variable INTEGER, value REAL, PRIMARY KEY(date_time,id_variable))").arg(stations[i]);
 
-        QSqlQuery qry(statement, _db);
-        qry.exec();
+        QSqlQuery qry(_db);
+        if (! qry.exec(statement))
+        {
+            error = qry.lastError().text();
+            return false;
+        }
 
         statement = QString("DELETE FROM `%1_D` WHERE date_time >= DATE('%2') AND date_time < DATE('%3', '+1 day')")
                         .arg(stations[i]).arg(startDate.toString("yyyy-MM-dd")).arg(endDate.toString("yyyy-MM-dd"));
 
-        qry = QSqlQuery(statement, _db);
-        qry.exec();
+        if (! qry.exec(statement))
+        {
+            error = qry.lastError().text();
+            return false;
+        }
     }
 
+    return true;
 }
 
 
-void DbArkimet::initStationsHourlyTables(QDate startDate, QDate endDate, QStringList stations)
+// create the station tables and delete the period to be downloaded:
+// it runs in the transaction of saveHourlyData, so the old data are kept if the insert fails
+bool DbArkimet::initStationsHourlyTables(QDate startDate, QDate endDate, QStringList stations)
 {
     for (int i = 0; i < stations.size(); i++)
     {
-        QString statement = QString("CREATE TABLE IF NOT EXISTS `%1_H` (date_time TEXT, id_variable INTEGER, value REAL, PRIMARY KEY(date_time,id_variable))").arg(stations[i]);
+        QString statement = QString("CREATE TABLE IF NOT EXISTS `%1_H` "
+                                    "(date_time TEXT, id_variable INTEGER, value REAL, PRIMARY KEY(date_time,id_variable))").arg(stations[i]);
 
-        QSqlQuery qry(statement, _db);
-        qry.exec();
+        QSqlQuery qry(_db);
+        if (! qry.exec(statement))
+        {
+            error = qry.lastError().text();
+            return false;
+        }
 
         statement = QString("DELETE FROM `%1_H` WHERE date_time >= DATE('%2') AND date_time < DATE('%3', '+1 day')")
                         .arg(stations[i]).arg(startDate.toString("yyyy-MM-dd")).arg(endDate.toString("yyyy-MM-dd"));
 
-        qry = QSqlQuery(statement, _db);
-        qry.exec();
+        if (! qry.exec(statement))
+        {
+            error = qry.lastError().text();
+            return false;
+        }
     }
+
+    return true;
 }
 
 
@@ -299,10 +320,17 @@ bool DbArkimet::saveDailyData(QDate startDate, QDate endDate)
     while (qry.next())
         stations.append(qry.value(0).toString());
 
-    // create station tables
-    initStationsDailyTables(startDate, endDate, stations);
+    // delete the old data, insert the new ones and update point_dates in the same transaction
+    checkPointDates();
+    _db.transaction();
+
+    if (! initStationsDailyTables(startDate, endDate, stations))
+    {
+        qDebug() << error;
+        _db.rollback();
+        return false;
+    }
 
-    // insert data
     foreach (QString id_point, stations)
     {
         statement = QString("INSERT INTO `%1_D` ").arg(id_point);
@@ -313,15 +341,23 @@ bool DbArkimet::saveDailyData(QDate startDate, QDate endDate)
         if (_db.lastError().type() != QSqlError::NoError)
         {
             qDebug() << _db.lastError();
+            _db.rollback();
+            return false;
+        }
+
+        if (! updatePointDates(id_point, daily))
+        {
+            qDebug() << error;
+            _db.rollback();
             return false;
         }
     }
 
-    return true;
+    return _db.commit();
 }
 
 
-bool DbArkimet::saveHourlyData()
+bool DbArkimet::saveHourlyData(QDate startDate, QDate endDate)
 {
     if (queryString == "")
         return false;
@@ -344,6 +380,18 @@ bool DbArkimet::saveHourlyData()
     while (qry.next())
         stations.append(qry.value(0).toString());
 
+    // delete the old data, insert the new ones and update point_dates in the same transaction
+    QStringList savedStations = stations;
+    checkPointDates();
+    _db.transaction();
+
+    if (! initStationsHourlyTables(startDate, endDate, stations))
+    {
+        qDebug() << error;
+        _db.rollback();
+        return false;
+    }
+
     // First step: INSERT data with frequency = 3600
     foreach (QString id_point, stations)
     {
@@ -367,7 +415,7 @@ bool DbArkimet::saveHourlyData()
         stations.append(qry.value(0).toString());
 
     // no more data
-    if (stations.isEmpty()) return true;
+    if (stations.isEmpty()) return commitHourlyData(savedStations);
 
     // WIND DIRECTION
     statement = QString("INSERT INTO `%1_H` ");
@@ -408,6 +456,23 @@ bool DbArkimet::saveHourlyData()
             qDebug() << "error in delete " << station << qry.lastError();
     }
 
-    return true;
+    return commitHourlyData(savedStations);
+}
+
+
+// update point_dates of the saved stations and commit the transaction of saveHourlyData
+bool DbArkimet::commitHourlyData(const QStringList& stations)
+{
+    foreach (QString station, stations)
+    {
+        if (! updatePointDates(station, hourly))
+        {
+            qDebug() << error;
+            _db.rollback();
+            return false;
+        }
+    }
+
+    return _db.commit();
 }
 
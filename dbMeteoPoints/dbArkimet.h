@@ -23,19 +23,23 @@ class DbArkimet : public Crit3DMeteoPointsDbHandler
         int getId(QString VarName);
         QList<VariablesList> getVariableProperties(QList<int> id);
 
-        void initStationsDailyTables(QDate startDate, QDate endDate, QStringList stations);
-        void initStationsHourlyTables(QDate startDate, QDate endDate, QStringList stations);
+        bool initStationsDailyTables(QDate startDate, QDate endDate, QStringList stations);
+        bool initStationsHourlyTables(QDate startDate, QDate endDate, QStringList stations);
 
         void createTmpTableHourly();
         void deleteTmpTableHourly();
         void createTmpTableDaily();
         void deleteTmpTableDaily();
 
-        bool saveHourlyData();
+        bool saveHourlyData(QDate startDate, QDate endDate);
         bool saveDailyData(QDate startDate, QDate endDate);
 
         void appendQueryHourly(QString dateTime, QString idPoint, QString idVariable, QString varName, QString value, QString frequency, bool isFirstData);
         void appendQueryDaily(QString date, QString idPoint, QString idVar, QString value, bool isFirstData);
+
+    private:
+        bool commitHourlyData(const QStringList& stations);
+
 signals:
 
     protected slots:
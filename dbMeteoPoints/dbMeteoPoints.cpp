@@ -5,6 +5,7 @@
 #include "interpolationSettings.h"
 
 #include <QDebug>
+#include <QFileInfo>
 
 #include <QSqlDatabase>
 #include <QSqlQuery>
@@ -14,6 +15,171 @@
 #include <QStringBuilder>
 #include <QUuid>
 
+#include <math.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+
+// meteo variable of each id_variable of the db, indexed directly by the id
+static const std::vector<meteoVariable>& getMeteoVarTable()
+{
+    static const std::vector<meteoVariable> meteoVarFromId = []()
+    {
+        int maxId = 0;
+        for (auto it = MapIdMeteoVar.begin(); it != MapIdMeteoVar.end(); ++it)
+            maxId = std::max(maxId, it->first);
+
+        std::vector<meteoVariable> table(unsigned(maxId + 1), noMeteoVar);
+        for (auto it = MapIdMeteoVar.begin(); it != MapIdMeteoVar.end(); ++it)
+            table[unsigned(it->first)] = it->second;
+
+        return table;
+    }();
+
+    return meteoVarFromId;
+}
+
+
+static meteoVariable getMeteoVarFromId(int idVar)
+{
+    const std::vector<meteoVariable>& meteoVarFromId = getMeteoVarTable();
+    if (idVar < 0 || idVar >= int(meteoVarFromId.size()))
+        return noMeteoVar;
+
+    return meteoVarFromId[unsigned(idVar)];
+}
+
+
+// date_time field (yyyy-MM-dd or yyyy-MM-dd HH:mm:ss) parsed without QDate:
+// serial day number, hour and minutes
+static bool parseDateTime(const QString& dateStr, int* dayNumber, int* hour, int* minute)
+{
+    if (dateStr.size() < 10)
+        return false;
+
+    const QChar* c = dateStr.constData();
+    auto getNumber = [c](int first, int nrDigits)
+    {
+        int number = 0;
+        for (int k = first; k < first + nrDigits; k++)
+        {
+            int digit = c[k].digitValue();
+            if (digit < 0) return int(NODATA);
+            number = number * 10 + digit;
+        }
+        return number;
+    };
+
+    int year = getNumber(0, 4);
+    int month = getNumber(5, 2);
+    int day = getNumber(8, 2);
+    if (year == NODATA || month < 1 || month > 12 || day < 1 || day > 31)
+        return false;
+
+    *hour = 0;
+    *minute = 0;
+    if (dateStr.size() >= 16)
+    {
+        *hour = getNumber(11, 2);
+        *minute = getNumber(14, 2);
+        if (*hour == NODATA || *minute == NODATA)
+            return false;
+    }
+
+    *dayNumber = getDayNumberFromDate(Crit3DDate(day, month, year));
+    return true;
+}
+
+
+// read the daily table of the point into its (already initialized) daily columns
+static bool readDailyTable(QSqlQuery& query, const QString& startDate, const QString& endDate, Crit3DMeteoPoint* meteoPoint)
+{
+    QString tableName = QString::fromStdString(meteoPoint->id) + "_D";
+    QString statement = QString("SELECT date_time, id_variable, value FROM `%1` "
+                                "WHERE date_time >= DATE(:startDate) AND date_time < DATE(:endDate, '+1 day')").arg(tableName);
+
+    query.prepare(statement);
+    query.bindValue(":startDate", startDate);
+    query.bindValue(":endDate", endDate);
+    if (! query.exec())
+        return false;
+
+    int firstDayNumber = getDayNumberFromDate(meteoPoint->firstDateD);
+    int dayNumber, hour, minute;
+
+    while (query.next())
+    {
+        if (! parseDateTime(query.value(0).toString(), &dayNumber, &hour, &minute))
+            continue;
+
+        long index = dayNumber - firstDayNumber;
+        if (index < 0 || index >= meteoPoint->getNrObsDataDaysD())
+            continue;
+
+        float* column = meteoPoint->getDailyColumn(getMeteoVarFromId(query.value(1).toInt()));
+        if (column != nullptr)
+            column[index] = query.value(2).toFloat();
+    }
+
+    return true;
+}
+
+
+// read the hourly table of the point into its (already initialized) hourly columns
+static bool readHourlyTable(QSqlQuery& query, const QString& startDate, const QString& endDate, Crit3DMeteoPoint* meteoPoint)
+{
+    QString tableName = QString::fromStdString(meteoPoint->id) + "_H";
+    QString statement = QString("SELECT date_time, id_variable, value FROM `%1` "
+                                "WHERE date_time >= DATE(:startDate) AND date_time < DATE(:endDate, '+1 day')").arg(tableName);
+
+    query.prepare(statement);
+    query.bindValue(":startDate", startDate);
+    query.bindValue(":endDate", endDate);
+    if (! query.exec())
+        return false;
+
+    int firstDayNumber = getDayNumberFromDate(meteoPoint->obsDataH[0].date);
+    int nrDayValues = meteoPoint->nrDayValuesH();
+    int hourlyFraction = meteoPoint->hourlyFraction;
+    int dayNumber, hour, minute;
+
+    while (query.next())
+    {
+        if (! parseDateTime(query.value(0).toString(), &dayNumber, &hour, &minute))
+            continue;
+
+        long i = dayNumber - firstDayNumber;
+        int h = hourlyFraction * hour + int(ceil(float(minute) / float(60 / hourlyFraction)));
+        if (i < 0 || i >= meteoPoint->nrObsDataDaysH || h < 0 || h >= hourlyFraction * 24)
+            continue;
+
+        // as setMeteoPointValueH: 00:00 is also the last value of the day before
+        meteoVariable variable = getMeteoVarFromId(query.value(1).toInt());
+        float value = query.value(2).toFloat();
+
+        if (variable == leafWetness)
+        {
+            meteoPoint->obsDataHLeafW[i * nrDayValues + h] = int(value);
+            if (i != 0 && h == 0)
+                meteoPoint->obsDataHLeafW[(i-1) * nrDayValues + 24] = int(value);
+            continue;
+        }
+
+        float* column = meteoPoint->getHourlyColumn(variable);
+        if (column == nullptr)
+            continue;
+
+        column[i * nrDayValues + h] = value;
+        if (i != 0 && h == 0)
+            column[(i-1) * nrDayValues + 24] = value;
+    }
+
+    return true;
+}
+
 
 Crit3DMeteoPointsDbHandler::Crit3DMeteoPointsDbHandler(QString provider_, QString host_, QString dbname_, int port_,
                                                        QString user_, QString pass_)
@@ -38,8 +204,9 @@ Crit3DMeteoPointsDbHandler::Crit3DMeteoPointsDbHandler(QString provider_, QStrin
     }
 
     if (!_db.open())
-       error = _db.lastError().text();    
-
+       error = _db.lastError().text();
+    else if (provider_ == "QSQLITE")
+       openPointDates();
 }
 
 Crit3DMeteoPointsDbHandler::Crit3DMeteoPointsDbHandler(QString dbname_)
@@ -57,7 +224,8 @@ Crit3DMeteoPointsDbHandler::Crit3DMeteoPointsDbHandler(QString dbname_)
 
     if (!_db.open())
        error = _db.lastError().text();
-
+    else
+       openPointDates();
 }
 
 Crit3DMeteoPointsDbHandler::~Crit3DMeteoPointsDbHandler()
@@ -178,231 +346,422 @@ QStringList Crit3DMeteoPointsDbHandler::getDatasetsList()
 }
 
 
-QDateTime Crit3DMeteoPointsDbHandler::getLastDate(frequencyType frequency)
+// suffix of the station tables and frequency field of point_dates
+static QString getDayHour(frequencyType frequency)
 {
-    QSqlQuery qry(_db);
-    QStringList tables;
-    QDateTime lastDay(QDate(1800, 1, 1), QTime(0, 0, 0));
-
-    QString dayHour;
     if (frequency == daily)
-        dayHour = "D";
+        return "D";
     else if (frequency == hourly)
-        dayHour = "H";
+        return "H";
+    else
+        return "";
+}
 
-    qry.prepare( "SELECT name FROM sqlite_master WHERE type='table' AND name like :dayHour ESCAPE '^'");
-    qry.bindValue(":dayHour",  "%^_" + dayHour  + "%");
 
-    if( !qry.exec() )
+/*!
+ * \brief createPointDates
+ * (re)build the table point_dates: first and last date_time of each station table.
+ * It replaces the scan of all the station tables in getFirstDay/getLastDate,
+ * the write paths keep it updated with updatePointDates
+ */
+bool Crit3DMeteoPointsDbHandler::createPointDates()
+{
+    QSqlQuery qry(_db);
+
+    if (! _db.transaction())
     {
-        qDebug() << qry.lastError();
+        error = _db.lastError().text();
+        return false;
     }
-    else
+
+    if (! qry.exec("DROP TABLE IF EXISTS point_dates")
+        || ! qry.exec("CREATE TABLE point_dates (id_point TEXT, frequency TEXT, first_date TEXT, last_date TEXT, "
+                      "PRIMARY KEY(frequency, id_point))")
+        || ! qry.exec("CREATE INDEX point_dates_first ON point_dates(frequency, first_date)")
+        || ! qry.exec("CREATE INDEX point_dates_last ON point_dates(frequency, last_date)"))
     {
-        while (qry.next())
-        {
-            QString table = qry.value(0).toString();
-            tables << table;
-        }
+        error = qry.lastError().text();
+        _db.rollback();
+        return false;
     }
 
-    QDateTime date;
-    QString dateStr, statement;
+    // station tables: <id_point>_D, <id_point>_H (GLOB is case sensitive)
+    QStringList tables;
+    if (! qry.exec("SELECT name FROM sqlite_master WHERE type='table' AND (name GLOB '*_D' OR name GLOB '*_H')"))
+    {
+        error = qry.lastError().text();
+        _db.rollback();
+        return false;
+    }
+    while (qry.next())
+        tables << qry.value(0).toString();
+
     foreach (QString table, tables)
     {
-        //statement = QString( "SELECT date_time FROM `%1` ORDER BY datetime(date_time) DESC Limit 1").arg(table);
-        statement = QString( "SELECT MAX(date_time) FROM `%1` AS dateTime").arg(table);
-        if( !qry.exec(statement) )
-        {
-            //qDebug() << qry.lastError();
-        }
-        else
+        frequencyType frequency = (table.right(1) == "D") ? daily : hourly;
+        if (! updatePointDates(table.left(table.size() - 2), frequency))
         {
-            if (qry.next())
-            {
-                dateStr = qry.value(0).toString();
-                if (!dateStr.isEmpty())
-                {
-                    if (frequency == daily)
-                    {
-                        date = QDateTime::fromString(dateStr,"yyyy-MM-dd");
-                    }
-                    else if (frequency == hourly)
-                    {
-                        date = QDateTime::fromString(dateStr,"yyyy-MM-dd HH:mm:ss");
-                        if (date.time().hour() == 0)
-                        {
-                            date = date.addDays(-1);
-                        }
-                    }
-
-                    if (date > lastDay)
-                    {
-                        lastDay = date;
-                    }
-                }
-            }
+            _db.rollback();
+            return false;
         }
     }
 
-    return lastDay;
+    return _db.commit();
 }
 
 
-QDateTime Crit3DMeteoPointsDbHandler::getFirstDay(frequencyType frequency)
+// rebuild point_dates if it is missing (db written by a previous version)
+bool Crit3DMeteoPointsDbHandler::checkPointDates()
+{
+    if (_db.tables().contains("point_dates"))
+        return true;
+
+    return createPointDates();
+}
+
+
+// one-time rebuild of point_dates when a writable SQLite db is opened:
+// a read only db is not written, getDateLimit falls back to the station tables
+void Crit3DMeteoPointsDbHandler::openPointDates()
 {
+    if (! QFileInfo(_db.databaseName()).isWritable())
+        return;
+
+    if (! checkPointDates())
+    {
+        qDebug() << "point_dates rebuild failed:" << error;
+        error = "";
+    }
+}
 
+
+/*!
+ * \brief updatePointDates
+ * update first and last date of a station table in point_dates:
+ * MIN and MAX are in separate subqueries, so that each one is a single
+ * search on the primary key (date_time, id_variable) of the station table.
+ * It must be called in the same transaction as the write to the station table
+ */
+bool Crit3DMeteoPointsDbHandler::updatePointDates(QString idPoint, frequencyType frequency)
+{
+    QString dayHour = getDayHour(frequency);
     QSqlQuery qry(_db);
-    QStringList tables;
-    QDateTime firstDay(QDate::currentDate().addDays(1), QTime(0, 0, 0));
 
-    QString dayHour;
-    if (frequency == daily)
-        dayHour = "D";
-    else if (frequency == hourly)
-        dayHour = "H";
+    qry.prepare("DELETE FROM point_dates WHERE id_point = :idPoint AND frequency = :dayHour");
+    qry.bindValue(":idPoint", idPoint);
+    qry.bindValue(":dayHour", dayHour);
+    if (! qry.exec())
+    {
+        error = qry.lastError().text();
+        return false;
+    }
 
-    qry.prepare( "SELECT name FROM sqlite_master WHERE type='table' AND name like :dayHour ESCAPE '^'");
-    qry.bindValue(":dayHour",  "%^" + dayHour  + "%");
+    QString statement = QString("INSERT INTO point_dates (id_point, frequency, first_date, last_date) "
+                                "SELECT :idPoint, :dayHour, first_date, last_date FROM "
+                                "(SELECT (SELECT MIN(date_time) FROM `%1_%2`) AS first_date, "
+                                "(SELECT MAX(date_time) FROM `%1_%2`) AS last_date) "
+                                "WHERE first_date IS NOT NULL").arg(idPoint).arg(dayHour);
+    qry.prepare(statement);
+    qry.bindValue(":idPoint", idPoint);
+    qry.bindValue(":dayHour", dayHour);
+    if (! qry.exec())
+    {
+        error = qry.lastError().text();
+        return false;
+    }
 
-    if( !qry.exec() )
+    return true;
+}
+
+
+/*!
+ * \brief getDateLimit
+ * first (isFirst) or last date_time of the station tables, read from point_dates.
+ * If point_dates is missing (db written by a previous version, or read only)
+ * MIN/MAX are computed on each station table: the db is not written
+ * \return the date_time string, empty if there are no data
+ */
+QString Crit3DMeteoPointsDbHandler::getDateLimit(frequencyType frequency, bool isFirst)
+{
+    QString dayHour = getDayHour(frequency);
+    QString function = isFirst ? "MIN" : "MAX";
+    QSqlQuery qry(_db);
+
+    if (_db.tables().contains("point_dates"))
+    {
+        QString field = isFirst ? "first_date" : "last_date";
+        qry.prepare(QString("SELECT %1(%2) FROM point_dates WHERE frequency = :dayHour").arg(function).arg(field));
+        qry.bindValue(":dayHour", dayHour);
+
+        if (! qry.exec())
+        {
+            qDebug() << qry.lastError();
+            return "";
+        }
+        return qry.next() ? qry.value(0).toString() : "";
+    }
+
+    // station tables: <id_point>_D, <id_point>_H (GLOB is case sensitive)
+    QStringList tables;
+    if (! qry.exec(QString("SELECT name FROM sqlite_master WHERE type='table' AND name GLOB '*_%1'").arg(dayHour)))
     {
         qDebug() << qry.lastError();
+        return "";
     }
-    else
+    while (qry.next())
+        tables << qry.value(0).toString();
+
+    // date_time strings are ISO formatted: string and date order are the same
+    QString dateLimit = "";
+    foreach (QString table, tables)
     {
-        while (qry.next())
+        if (qry.exec(QString("SELECT %1(date_time) FROM `%2`").arg(function).arg(table)) && qry.next())
         {
-            QString table = qry.value(0).toString();
-            tables << table;
+            QString dateStr = qry.value(0).toString();
+            if (! dateStr.isEmpty() && (dateLimit.isEmpty() || (isFirst == (dateStr < dateLimit))))
+                dateLimit = dateStr;
         }
     }
 
-    QString statement;
-    foreach (QString table, tables)
+    return dateLimit;
+}
+
+
+QDateTime Crit3DMeteoPointsDbHandler::getLastDate(frequencyType frequency)
+{
+    QDateTime lastDay(QDate(1800, 1, 1), QTime(0, 0, 0));
+
+    QString dateStr = getDateLimit(frequency, false);
+    if (! dateStr.isEmpty())
     {
-        //statement = QString( "SELECT date_time FROM `%1` ORDER BY datetime(date_time) ASC Limit 1").arg(table);
-        statement = QString( "SELECT MIN(date_time) FROM `%1` AS dateTime").arg(table);
-        if( !qry.exec(statement) )
+        if (frequency == daily)
         {
-            qDebug() << qry.lastError();
+            lastDay = QDateTime::fromString(dateStr,"yyyy-MM-dd");
         }
-        else
+        else if (frequency == hourly)
         {
-            if (qry.next())
+            lastDay = QDateTime::fromString(dateStr,"yyyy-MM-dd HH:mm:ss");
+            if (lastDay.time().hour() == 0)
             {
-                QString dateStr = qry.value(0).toString();
-                if (!dateStr.isEmpty())
-                {
-                    QDateTime date = QDateTime::fromString(dateStr,"yyyy-MM-dd HH:mm:ss");
-                    if (date < firstDay)
-                    {
-                        firstDay = date;
-                    }
-                }
+                lastDay = lastDay.addDays(-1);
             }
         }
     }
-    if (firstDay.date() == QDate::currentDate().addDays(1))
+
+    return lastDay;
+}
+
+
+QDateTime Crit3DMeteoPointsDbHandler::getFirstDay(frequencyType frequency)
+{
+    QDateTime firstDay(QDate(1800, 1, 1), QTime(0, 0, 0));
+
+    QString dateStr = getDateLimit(frequency, true);
+    if (! dateStr.isEmpty())
     {
-        firstDay.date() = QDate(1800,1,1);
-        firstDay.time() = QTime(0, 0, 0);
+        if (frequency == daily)
+            firstDay = QDateTime::fromString(dateStr,"yyyy-MM-dd");
+        else if (frequency == hourly)
+            firstDay = QDateTime::fromString(dateStr,"yyyy-MM-dd HH:mm:ss");
     }
 
     return firstDay;
-
 }
 
 
 bool Crit3DMeteoPointsDbHandler::loadDailyData(Crit3DDate dateStart, Crit3DDate dateEnd, Crit3DMeteoPoint *meteoPoint)
 {
-    QString dateStr;
-    meteoVariable variable;
-    QDate d;
-    int idVar;
-    float value;
-
     int numberOfDays = difference(dateStart, dateEnd) +1;
     QString startDate = QString::fromStdString(dateStart.toStdString());
     QString endDate = QString::fromStdString(dateEnd.toStdString());
 
     QSqlQuery myQuery(_db);
+    myQuery.setForwardOnly(true);
 
     meteoPoint->initializeObsDataD(numberOfDays, dateStart);
 
-    QString tableName = QString::fromStdString(meteoPoint->id) + "_D";
-
-    QString statement = QString( "SELECT * FROM `%1` WHERE date_time >= DATE('%2') AND date_time < DATE('%3', '+1 day')")
-                                .arg(tableName).arg(startDate).arg(endDate);
+    _cache.updateDbStamp();
+    if (_cache.readData(meteoPoint, daily))
+        return true;
 
-    if( !myQuery.exec(statement) )
-    {
-        //qDebug() << myQuery.lastError();
+    if (! readDailyTable(myQuery, startDate, endDate, meteoPoint))
         return false;
-    }
-    else
-    {
-        while (myQuery.next())
-        {
-            dateStr = myQuery.value(0).toString();
-            d = QDate::fromString(dateStr, "yyyy-MM-dd");
-
-            idVar = myQuery.value(1).toInt();
-            variable = MapIdMeteoVar.at(idVar);
-
-            value = myQuery.value(2).toFloat();
-
-            meteoPoint->setMeteoPointValueD(Crit3DDate(d.day(), d.month(), d.year()), variable, value);
-        }
-    }
 
+    _cache.writeData(meteoPoint, daily);
     return true;
 }
 
 
 bool Crit3DMeteoPointsDbHandler::loadHourlyData(Crit3DDate dateStart, Crit3DDate dateEnd, Crit3DMeteoPoint *meteoPoint)
 {
-    QString dateStr;
-    meteoVariable variable;
-    QDateTime d;
-    int idVar;
-    float value;
-
     int numberOfDays = difference(dateStart, dateEnd)+1;
     int myHourlyFraction = 1;
     QString startDate = QString::fromStdString(dateStart.toStdString());
     QString endDate = QString::fromStdString(dateEnd.toStdString());
 
     QSqlQuery qry(_db);
+    qry.setForwardOnly(true);
 
     meteoPoint->initializeObsDataH(myHourlyFraction, numberOfDays, dateStart);
 
-    QString tableName = QString::fromStdString(meteoPoint->id) + "_H";
+    _cache.updateDbStamp();
+    if (_cache.readData(meteoPoint, hourly))
+        return true;
 
-    QString statement = QString( "SELECT * FROM `%1` WHERE date_time >= DATE('%2') AND date_time < DATE('%3', '+1 day')")
-                                 .arg(tableName).arg(startDate).arg(endDate);
-    if( !qry.exec(statement) )
+    if (! readHourlyTable(qry, startDate, endDate, meteoPoint))
     {
         qDebug() << qry.lastError();
         return false;
     }
-    else
+
+    _cache.writeData(meteoPoint, hourly);
+    return true;
+}
+
+
+/*!
+ * \brief loadAllData
+ * load daily and hourly data of all the meteo points: the points are shared among
+ * nrThreads workers (0 = number of cores), each one with its own db connection.
+ * Progress (number of points loaded) is emitted by the calling thread with loadingProgress
+ * each time the workers notify it
+ * \return true if all the points have been loaded and the tables (or the cache)
+ * of at least one point have been read, as loadDailyData and loadHourlyData
+ */
+bool Crit3DMeteoPointsDbHandler::loadAllData(Crit3DDate dateStart, Crit3DDate dateEnd, Crit3DMeteoPoint *meteoPoints, int nrMeteoPoints, int nrThreads)
+{
+    if (nrMeteoPoints <= 0) return false;
+
+    if (nrThreads <= 0)
+        nrThreads = int(std::thread::hardware_concurrency());
+    nrThreads = std::max(1, std::min(nrThreads, nrMeteoPoints));
+
+    int numberOfDays = difference(dateStart, dateEnd) +1;
+    int myHourlyFraction = 1;
+    QString startDate = QString::fromStdString(dateStart.toStdString());
+    QString endDate = QString::fromStdString(dateEnd.toStdString());
+
+    // connections are created in the worker threads: copy the parameters
+    QString driverName = _db.driverName();
+    QString dbName = _db.databaseName();
+    QString hostName = _db.hostName();
+    QString userName = _db.userName();
+    QString password = _db.password();
+    int port = _db.port();
+
+    std::atomic<int> nextPoint(0);
+    std::atomic<int> nrLoadedPoints(0);
+    std::atomic<int> nrFinishedThreads(0);
+    std::atomic<bool> isData(false);
+    std::vector<QString> connectionError(unsigned(nrThreads));
+
+    std::mutex progressMutex;
+    std::condition_variable progressChanged;
+    auto notifyProgress = [&]()
     {
-        while (qry.next())
+        std::lock_guard<std::mutex> lock(progressMutex);
+        progressChanged.notify_one();
+    };
+
+    // the cache is only read by the workers, one file for each point
+    _cache.updateDbStamp();
+
+    auto loadPoints = [&](int threadIndex)
+    {
+        QString connectionName = QUuid::createUuid().toString();
         {
-            dateStr = qry.value(0).toString();
-            d = QDateTime::fromString(dateStr,"yyyy-MM-dd HH:mm:ss");
+            QSqlDatabase db = QSqlDatabase::addDatabase(driverName, connectionName);
+            db.setDatabaseName(dbName);
+            if (driverName == "QSQLITE")
+            {
+                db.setConnectOptions("QSQLITE_OPEN_READONLY");
+            }
+            else
+            {
+                db.setHostName(hostName);
+                db.setPort(port);
+                db.setUserName(userName);
+                db.setPassword(password);
+            }
 
-            idVar = qry.value(1).toInt();
-            variable = MapIdMeteoVar.at(idVar);
+            if (! db.open())
+            {
+                connectionError[unsigned(threadIndex)] = db.lastError().text();
+            }
+            else
+            {
+                QSqlQuery query(db);
+                query.setForwardOnly(true);
+
+                int i;
+                while ((i = nextPoint++) < nrMeteoPoints)
+                {
+                    meteoPoints[i].initializeObsDataD(numberOfDays, dateStart);
+                    meteoPoints[i].initializeObsDataH(myHourlyFraction, numberOfDays, dateStart);
+
+                    if (_cache.readData(&(meteoPoints[i]), daily))
+                        isData = true;
+                    else if (readDailyTable(query, startDate, endDate, &(meteoPoints[i])))
+                    {
+                        _cache.writeData(&(meteoPoints[i]), daily);
+                        isData = true;
+                    }
+
+                    if (_cache.readData(&(meteoPoints[i]), hourly))
+                        isData = true;
+                    else if (readHourlyTable(query, startDate, endDate, &(meteoPoints[i])))
+                    {
+                        _cache.writeData(&(meteoPoints[i]), hourly);
+                        isData = true;
+                    }
 
-            value = qry.value(2).toFloat();
+                    nrLoadedPoints++;
+                    notifyProgress();
+                }
 
-            meteoPoint->setMeteoPointValueH(Crit3DDate(d.date().day(), d.date().month(), d.date().year()),
-                                                   d.time().hour(), d.time().minute(), variable, value);
+                query.clear();
+                db.close();
+            }
+        }
+        QSqlDatabase::removeDatabase(connectionName);
+        nrFinishedThreads++;
+        notifyProgress();
+    };
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < nrThreads; t++)
+        workers.push_back(std::thread(loadPoints, t));
+
+    // progress is emitted by the calling thread: the receivers are usually widgets
+    int lastProgress = 0;
+    while (nrFinishedThreads < nrThreads)
+    {
+        {
+            std::unique_lock<std::mutex> lock(progressMutex);
+            progressChanged.wait(lock, [&]{ return nrLoadedPoints != lastProgress || nrFinishedThreads == nrThreads; });
+        }
+
+        if (nrLoadedPoints != lastProgress)
+        {
+            lastProgress = nrLoadedPoints;
+            emit loadingProgress(lastProgress);
         }
     }
-    return true;
+
+    for (unsigned t = 0; t < workers.size(); t++)
+        workers[t].join();
+
+    emit loadingProgress(nrLoadedPoints);
+
+    if (nrLoadedPoints < nrMeteoPoints)
+    {
+        for (unsigned t = 0; t < connectionError.size(); t++)
+            if (! connectionError[t].isEmpty())
+                error = connectionError[t];
+        return false;
+    }
+
+    return isData;
 }
 
 
@@ -538,6 +897,19 @@ void Crit3DMeteoPointsDbHandler::setDb(const QSqlDatabase &db)
     _db = db;
 }
 
+
+/*!
+ * \brief setCacheActive
+ * binary cache of the loaded data (see Crit3DMeteoPointsCache), only for SQLite db
+ */
+void Crit3DMeteoPointsDbHandler::setCacheActive(bool isActive)
+{
+    if (isActive && _db.driverName() == "QSQLITE")
+        _cache.initialize(_db.databaseName());
+    else
+        _cache.initialize("");
+}
+
 bool Crit3DMeteoPointsDbHandler::readPointProxyValues(Crit3DMeteoPoint* myPoint, Crit3DInterpolationSettings* interpolationSettings)
 {
     if (myPoint == nullptr) return false;
@@ -13,6 +13,9 @@
 #ifndef INTERPOLATIONSETTINGS_H
     #include "interpolationSettings.h"
 #endif
+#ifndef METEOPOINTSCACHE_H
+    #include "meteoPointsCache.h"
+#endif
 
 
 class Crit3DMeteoPointsDbHandler : public QObject
@@ -35,6 +38,8 @@ public:
         void setDatasetsActive(QString active);
         QDateTime getLastDate(frequencyType frequency);
         QDateTime getFirstDay(frequencyType frequency);
+        bool createPointDates();
+        bool updatePointDates(QString idPoint, frequencyType frequency);
 
         bool readPointProxyValues(Crit3DMeteoPoint* myPoint, Crit3DInterpolationSettings* interpolationSettings);
 
@@ -43,14 +48,21 @@ public:
         bool loadDailyData(Crit3DDate dateStart, Crit3DDate dateEnd, Crit3DMeteoPoint *meteoPoint);
         std::vector<float> loadDailyVar(QString *myError, meteoVariable variable, Crit3DDate dateStart, Crit3DDate dateEnd, QDate* firstDateDB, Crit3DMeteoPoint *meteoPoint);
         bool loadHourlyData(Crit3DDate dateStart, Crit3DDate dateEnd, Crit3DMeteoPoint *meteoPoint);
+        bool loadAllData(Crit3DDate dateStart, Crit3DDate dateEnd, Crit3DMeteoPoint *meteoPoints, int nrMeteoPoints, int nrThreads = 0);
         std::vector<float> loadHourlyVar(QString *myError, meteoVariable variable, Crit3DDate dateStart, Crit3DDate dateEnd, QDateTime* firstDateDB, Crit3DMeteoPoint *meteoPoint);
         void closeDatabase();
         QSqlDatabase getDb() const;
         void setDb(const QSqlDatabase &db);
+        void setCacheActive(bool isActive);
 
 protected:
         QSqlDatabase _db;
+        Crit3DMeteoPointsCache _cache;
+        bool checkPointDates();
+        void openPointDates();
+        QString getDateLimit(frequencyType frequency, bool isFirst);
 signals:
+        void loadingProgress(int nrLoadedPoints);
 
 protected slots:
 };
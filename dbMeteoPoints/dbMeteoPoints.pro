@@ -33,12 +33,14 @@ SOURCES += \
     download.cpp \
     variableslist.cpp \
     dbArkimet.cpp \
-    dbMeteoPoints.cpp
+    dbMeteoPoints.cpp \
+    meteoPointsCache.cpp
 
 HEADERS += \
     download.h \
     variableslist.h \
     dbArkimet.h \
-    dbMeteoPoints.h
+    dbMeteoPoints.h \
+    meteoPointsCache.h
 
 
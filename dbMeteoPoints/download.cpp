@@ -318,9 +318,6 @@ bool Download::downloadDailyData(QDate startDate, QDate endDate, QString dataset
 
 bool Download::downloadHourlyData(QDate startDate, QDate endDate, QString dataset, QStringList stations, QList<int> variables)
 {
-    // create station tables
-    _dbMeteo->initStationsHourlyTables(startDate, endDate, stations);
-
     QList<VariablesList> variableList = _dbMeteo->getVariableProperties(variables);
 
     QString product = QString(";product: VM2,%1").arg(variables[0]);
@@ -438,7 +435,7 @@ bool Download::downloadHourlyData(QDate startDate, QDate endDate, QString datase
             if (_dbMeteo->queryString != "")
             {
                _dbMeteo->createTmpTableHourly();
-               _dbMeteo->saveHourlyData();
+               _dbMeteo->saveHourlyData(startDate, endDate);
                _dbMeteo->deleteTmpTableHourly();
             }
         }
@@ -0,0 +1,260 @@
+#include "meteoPointsCache.h"
+#include "commonConstants.h"
+#include "meteo.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDateTime>
+
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+#define CACHE_VERSION 2
+
+struct TCacheHeader
+{
+    char magic[4];
+    qint32 version;
+    qint64 dbTime;                  // modification time [ms] of the db (and of its wal file)
+    qint64 dbSize;
+    qint32 frequency;
+    qint32 firstDayNumber;
+    qint32 nrDays;
+    qint32 hourlyFraction;
+    qint32 nrVariables;             // followed by the id_variable of the db of each column (qint32)
+};
+
+
+static_assert(sizeof(int) == sizeof(float), "the cache columns have values of 4 bytes");
+
+// column of the variable in the meteo point: float, int for the hourly leaf wetness
+static void* getColumn(Crit3DMeteoPoint* meteoPoint, meteoVariable myVar, frequencyType frequency)
+{
+    if (frequency == daily)
+        return meteoPoint->getDailyColumn(myVar);
+    else if (myVar == leafWetness)
+        return meteoPoint->obsDataHLeafW;
+    else
+        return meteoPoint->getHourlyColumn(myVar);
+}
+
+
+static bool getPeriod(Crit3DMeteoPoint* meteoPoint, frequencyType frequency, int* firstDayNumber, int* nrDays, int* nrDayValues)
+{
+    if (frequency == daily)
+    {
+        if (meteoPoint->getNrObsDataDaysD() <= 0) return false;
+        *firstDayNumber = getDayNumberFromDate(meteoPoint->firstDateD);
+        *nrDays = int(meteoPoint->getNrObsDataDaysD());
+        *nrDayValues = 1;
+    }
+    else if (frequency == hourly)
+    {
+        if (meteoPoint->nrObsDataDaysH <= 0) return false;
+        *firstDayNumber = getDayNumberFromDate(meteoPoint->obsDataH[0].date);
+        *nrDays = int(meteoPoint->nrObsDataDaysH);
+        *nrDayValues = meteoPoint->nrDayValuesH();
+    }
+    else
+        return false;
+
+    return true;
+}
+
+
+Crit3DMeteoPointsCache::Crit3DMeteoPointsCache()
+{
+    _dbName = "";
+    _path = "";
+    _dbTime = NODATA;
+    _dbSize = NODATA;
+}
+
+
+/*!
+ * \brief initialize
+ * the cache is in the directory <dbName>.cache, created if missing
+ * an empty dbName deactivates the cache
+ */
+void Crit3DMeteoPointsCache::initialize(QString dbName)
+{
+    _dbName = dbName;
+    _path = "";
+
+    if (dbName.isEmpty()) return;
+
+    QString path = dbName + ".cache";
+    if (QDir().mkpath(path))
+        _path = path;
+}
+
+
+bool Crit3DMeteoPointsCache::isActive() const
+{
+    return ! _path.isEmpty();
+}
+
+
+/*!
+ * \brief updateDbStamp
+ * read the modification time and the size of the db: it has to be called
+ * before each loading, the files written with a different stamp are not valid
+ */
+void Crit3DMeteoPointsCache::updateDbStamp()
+{
+    if (! isActive()) return;
+
+    QFileInfo dbInfo(_dbName);
+    _dbTime = dbInfo.lastModified().toMSecsSinceEpoch();
+    _dbSize = dbInfo.size();
+
+    QFileInfo walInfo(_dbName + "-wal");
+    if (walInfo.exists())
+    {
+        _dbTime = std::max(_dbTime, walInfo.lastModified().toMSecsSinceEpoch());
+        _dbSize += walInfo.size();
+    }
+}
+
+
+QString Crit3DMeteoPointsCache::getFileName(const std::string& idPoint, frequencyType frequency) const
+{
+    QString suffix = (frequency == daily) ? "_D.bin" : "_H.bin";
+    return _path + "/" + QString::fromStdString(idPoint) + suffix;
+}
+
+
+/*!
+ * \brief readData
+ * copy the data of the (already initialized) period of the meteo point from its cache file
+ * the file is mapped in memory: one copy for each variable column
+ * \return false if the file is missing, not valid or it does not cover the period
+ */
+bool Crit3DMeteoPointsCache::readData(Crit3DMeteoPoint* meteoPoint, frequencyType frequency) const
+{
+    if (! isActive()) return false;
+
+    int firstDayNumber, nrDays, nrDayValues;
+    if (! getPeriod(meteoPoint, frequency, &firstDayNumber, &nrDays, &nrDayValues))
+        return false;
+
+    QFile file(getFileName(meteoPoint->id, frequency));
+    if (! file.open(QIODevice::ReadOnly)) return false;
+
+    qint64 fileSize = file.size();
+    if (fileSize < qint64(sizeof(TCacheHeader))) return false;
+
+    uchar* map = file.map(0, fileSize);
+    if (map == nullptr) return false;
+
+    TCacheHeader header;
+    memcpy(&header, map, sizeof(TCacheHeader));
+
+    int hourlyFraction = (frequency == daily) ? 0 : meteoPoint->hourlyFraction;
+    qint64 nrFileValues = qint64(header.nrDays) * nrDayValues;
+    qint64 dataOffset = qint64(sizeof(TCacheHeader)) + qint64(header.nrVariables) * qint64(sizeof(qint32));
+
+    if (memcmp(header.magic, "MPC", 4) != 0 || header.version != CACHE_VERSION
+        || header.dbTime != _dbTime || header.dbSize != _dbSize
+        || header.frequency != qint32(frequency) || header.hourlyFraction != hourlyFraction
+        || header.nrVariables < 0 || header.nrDays < 0
+        || fileSize != dataOffset + header.nrVariables * nrFileValues * qint64(sizeof(float))
+        || firstDayNumber < header.firstDayNumber
+        || firstDayNumber + nrDays > header.firstDayNumber + header.nrDays)
+    {
+        file.unmap(map);
+        return false;
+    }
+
+    const uchar* idList = map + sizeof(TCacheHeader);
+    const uchar* data = map + dataOffset;
+    qint64 firstValue = qint64(firstDayNumber - header.firstDayNumber) * nrDayValues;
+    size_t nrValues = size_t(nrDays) * size_t(nrDayValues);
+
+    for (int v = 0; v < header.nrVariables; v++)
+    {
+        qint32 idVar;
+        memcpy(&idVar, idList + v * sizeof(qint32), sizeof(qint32));
+
+        auto itVar = MapIdMeteoVar.find(idVar);
+        if (itVar == MapIdMeteoVar.end()) continue;
+
+        void* column = getColumn(meteoPoint, itVar->second, frequency);
+        if (column == nullptr) continue;
+
+        memcpy(column, data + (v * nrFileValues + firstValue) * qint64(sizeof(float)), nrValues * sizeof(float));
+
+        // as the db loading: the last value (00:00 of the next day) is outside the period
+        if (frequency == hourly)
+        {
+            if (itVar->second == leafWetness)
+                ((int*) column)[nrValues - 1] = int(NODATA);
+            else
+                ((float*) column)[nrValues - 1] = NODATA;
+        }
+    }
+
+    file.unmap(map);
+    return true;
+}
+
+
+/*!
+ * \brief writeData
+ * write the loaded period of the meteo point in its cache file
+ * (the file is replaced only when it is completely written)
+ */
+bool Crit3DMeteoPointsCache::writeData(Crit3DMeteoPoint* meteoPoint, frequencyType frequency) const
+{
+    if (! isActive()) return false;
+
+    int firstDayNumber, nrDays, nrDayValues;
+    if (! getPeriod(meteoPoint, frequency, &firstDayNumber, &nrDays, &nrDayValues))
+        return false;
+
+    // variables of the db stored in the meteo point
+    std::vector<qint32> idList;
+    std::vector<void*> columns;
+    for (auto it = MapIdMeteoVar.begin(); it != MapIdMeteoVar.end(); ++it)
+    {
+        void* column = getColumn(meteoPoint, it->second, frequency);
+        if (column != nullptr && std::find(columns.begin(), columns.end(), column) == columns.end())
+        {
+            idList.push_back(qint32(it->first));
+            columns.push_back(column);
+        }
+    }
+
+    TCacheHeader header;
+    memset(&header, 0, sizeof(TCacheHeader));
+    memcpy(header.magic, "MPC", 4);
+    header.version = CACHE_VERSION;
+    header.dbTime = _dbTime;
+    header.dbSize = _dbSize;
+    header.frequency = qint32(frequency);
+    header.firstDayNumber = firstDayNumber;
+    header.nrDays = nrDays;
+    header.hourlyFraction = (frequency == daily) ? 0 : meteoPoint->hourlyFraction;
+    header.nrVariables = qint32(idList.size());
+
+    QSaveFile file(getFileName(meteoPoint->id, frequency));
+    if (! file.open(QIODevice::WriteOnly)) return false;
+
+    qint64 nrBytes = qint64(nrDays) * nrDayValues * qint64(sizeof(float));
+    bool isOk = file.write((const char*) &header, sizeof(TCacheHeader)) == qint64(sizeof(TCacheHeader));
+    if (isOk && ! idList.empty())
+        isOk = file.write((const char*) idList.data(), qint64(idList.size() * sizeof(qint32))) == qint64(idList.size() * sizeof(qint32));
+    for (unsigned v = 0; isOk && v < columns.size(); v++)
+        isOk = file.write((const char*) columns[v], nrBytes) == nrBytes;
+
+    if (! isOk)
+    {
+        file.cancelWriting();
+        return false;
+    }
+
+    return file.commit();
+}
@@ -0,0 +1,39 @@
+#ifndef METEOPOINTSCACHE_H
+#define METEOPOINTSCACHE_H
+
+#include <QString>
+
+#ifndef METEOPOINT_H
+    #include "meteoPoint.h"
+#endif
+
+/*!
+ * \brief binary cache of the data of the meteo points db
+ * one file for each point and frequency (<dbName>.cache/<id>_D.bin, <id>_H.bin):
+ * header (first day, number of days, hourly fraction, db stamp, variables)
+ * followed by one column of 4 byte values for each variable (float, int for the
+ * hourly leaf wetness), with the same stride of the meteo point columns. The files are invalid when the db is modified.
+ */
+class Crit3DMeteoPointsCache
+{
+public:
+    Crit3DMeteoPointsCache();
+
+    void initialize(QString dbName);
+    bool isActive() const;
+    void updateDbStamp();
+
+    bool readData(Crit3DMeteoPoint* meteoPoint, frequencyType frequency) const;
+    bool writeData(Crit3DMeteoPoint* meteoPoint, frequencyType frequency) const;
+
+private:
+    QString _dbName;
+    QString _path;
+    qint64 _dbTime;
+    qint64 _dbSize;
+
+    QString getFileName(const std::string& idPoint, frequencyType frequency) const;
+};
+
+
+#endif // METEOPOINTSCACHE_H
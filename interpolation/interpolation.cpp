@@ -26,6 +26,11 @@
 #include <stdlib.h>
 #include <math.h>
 #include <vector>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 #include "commonConstants.h"
 #include "basicMath.h"
@@ -34,6 +39,7 @@
 #include "meteoPoint.h"
 #include "gis.h"
 #include "spatialControl.h"
+#include "topoDistanceCache.h"
 #include "interpolation.h"
 
 
@@ -134,85 +140,49 @@ int sortPointsByDistance(int maxIndex, vector <Crit3DInterpolationDataPoint> &my
     return outIndex;
 }
 
-float shepardFindRadius(Crit3DInterpolationSettings* mySettings,
-                        std::vector <Crit3DInterpolationDataPoint> myPoints,
-                        std::vector <Crit3DInterpolationDataPoint> myOutPoints)
-{
-    unsigned int i;
-    std::vector <Crit3DInterpolationDataPoint> neighbourPoints;
-    neighbourPoints.clear();
 
-    // define a first neighborhood inside initial radius
-    for (i=1; i < myPoints.size(); i++)
-        if (myPoints.at(i).distance <= mySettings->getShepardInitialRadius() && myPoints.at(i).distance > 0 && myPoints.at(i).index != mySettings->getIndexPointCV())
-            neighbourPoints.push_back(myPoints.at(i));
 
-    if (neighbourPoints.size() <= SHEPARD_MIN_NRPOINTS)
+/*!
+ * \brief computePointDistance
+ * distance of myPoint from (x, y, z): euclidean, with TAD plus kh * topographic distance + kz * deltaZ.
+ * The topographic distance is read from the map of the point (see Crit3DTopoDistanceCache),
+ * otherwise it is computed on the current DEM
+ */
+static void computePointDistance(Crit3DInterpolationDataPoint &myPoint, Crit3DInterpolationSettings* mySettings,
+                                 float x, float y, float z)
+{
+    myPoint.distance = gis::computeDistance(x, y, float(myPoint.point->utm.x), float(myPoint.point->utm.y));
+    myPoint.deltaZ = float(fabs(myPoint.point->z - z));
+
+    if (mySettings->getUseTAD())
     {
-        sortPointsByDistance(SHEPARD_MIN_NRPOINTS + 1, myPoints, myOutPoints);
-        if (myOutPoints.size() > SHEPARD_MIN_NRPOINTS)
+        float topoDistance = 0.;
+        float kh = mySettings->getTopoDist_Kh();
+        if (kh != 0)
         {
-            myOutPoints.pop_back();
-            return myOutPoints.at(SHEPARD_MIN_NRPOINTS).distance;
+            topoDistance = NODATA;
+            if (myPoint.topographicDistance != nullptr)
+                topoDistance = myPoint.topographicDistance->getValue(x, y);
+
+            if (int(topoDistance) == int(NODATA))
+                topoDistance = topographicDistance(x, y, z, float(myPoint.point->utm.x), float(myPoint.point->utm.y),
+                                                   float(myPoint.point->z), myPoint.distance, *(mySettings->getCurrentDEM()));
         }
-        else
-            return myOutPoints.at(myOutPoints.size()-1).distance + 1;
-    }
-    else if (neighbourPoints.size() > SHEPARD_MAX_NRPOINTS)
-    {
-        sortPointsByDistance(SHEPARD_MAX_NRPOINTS + 1, neighbourPoints, myOutPoints);
-        myOutPoints.pop_back();
-        return myOutPoints.at(SHEPARD_MAX_NRPOINTS).distance;
-    }
-    else
-    {
-        myOutPoints = neighbourPoints;
-        return mySettings->getShepardInitialRadius();
+
+        myPoint.distance += (kh * topoDistance) + (mySettings->getTopoDist_Kz() * myPoint.deltaZ);
     }
 }
 
 
-
 void computeDistances(vector <Crit3DInterpolationDataPoint> &myPoints,  Crit3DInterpolationSettings* mySettings,
                       float x, float y, float z, bool excludeSupplemental)
 {
-    int row, col;
-
     for (unsigned long i = 0; i < myPoints.size() ; i++)
     {
         if (excludeSupplemental && ! checkLapseRateCode(myPoints.at(i).lapseRateCode, mySettings->getUseLapseRateCode(), false))
             myPoints.at(i).distance = 0;
         else
-        {            
-            myPoints.at(i).distance = gis::computeDistance(x, y, float((myPoints.at(i)).point->utm.x) , float((myPoints.at(i)).point->utm.y));
-            myPoints.at(i).deltaZ = float(fabs(myPoints.at(i).point->z - z));
-
-            if (mySettings->getUseTAD())
-            {
-                float topoDistance = 0.;
-                float kh = mySettings->getTopoDist_Kh();
-                if (kh != 0)
-                {
-                    topoDistance = NODATA;
-                    if (myPoints.at(i).topographicDistance != nullptr)
-                    {
-                        if (! gis::isOutOfGridXY(x, y, myPoints.at(i).topographicDistance->header))
-                        {
-                            gis::getRowColFromXY(*(myPoints.at(i).topographicDistance->header), x, y, &row, &col);
-                            topoDistance = myPoints.at(i).topographicDistance->value[row][col];
-                        }
-                    }
-
-                    if (topoDistance = NODATA)
-                        topoDistance = topographicDistance(x, y, z, (float)myPoints.at(i).point->utm.x,
-                                                           (float)myPoints.at(i).point->utm.y,
-                                                           (float)myPoints.at(i).point->z, myPoints.at(i).distance,
-                                                           *(mySettings->getCurrentDEM()));
-                }
-
-                myPoints.at(i).distance += (kh * topoDistance) + (mySettings->getTopoDist_Kz() * myPoints.at(i).deltaZ);
-            }
-        }
+            computePointDistance(myPoints.at(i), mySettings, x, y, z);
     }
 
     return;
@@ -740,42 +710,151 @@ bool regressionOrographyT(std::vector <Crit3DInterpolationDataPoint> &myPoints,
 
 }
 
-float computeShepard(vector <Crit3DInterpolationDataPoint> myPoints, Crit3DInterpolationSettings* settings, float X, float Y)
+static bool isShepardCandidate(const Crit3DInterpolationDataPoint &myPoint, Crit3DInterpolationSettings* settings)
 {
-    std::vector <Crit3DInterpolationDataPoint> validPoints;
-    std::vector <Crit3DInterpolationDataPoint> neighbourPoints;
-    unsigned int i;
-    float radius;
+    return (myPoint.isActive && myPoint.distance > 0 && myPoint.index != settings->getIndexPointCV());
+}
 
-    neighbourPoints.clear();
 
-    // define a first neighborhood inside initial radius
-    for (i=1; i < myPoints.size(); i++)
-        if (myPoints.at(i).distance <= settings->getShepardInitialRadius() && myPoints.at(i).distance > 0 && myPoints.at(i).index != settings->getIndexPointCV())
-            neighbourPoints.push_back(myPoints.at(i));
+static bool isNearerPoint(const vector <Crit3DInterpolationDataPoint> &myPoints, int pos1, int pos2)
+{
+    if (myPoints[unsigned(pos1)].distance != myPoints[unsigned(pos2)].distance)
+        return myPoints[unsigned(pos1)].distance < myPoints[unsigned(pos2)].distance;
+    return pos1 < pos2;
+}
+
+
+static void sortNearestPositions(const vector <Crit3DInterpolationDataPoint> &myPoints, vector <int> &positions, unsigned nrNearest)
+{
+    nrNearest = std::min(nrNearest, unsigned(positions.size()));
+    std::partial_sort(positions.begin(), positions.begin() + nrNearest, positions.end(),
+                      [&myPoints](int pos1, int pos2) { return isNearerPoint(myPoints, pos1, pos2); });
+    positions.resize(nrNearest);
+}
+
+
+/*!
+ * \brief shepardNeighbourhood
+ * select the points used by shepard (positions in myPoints) and the radius of the neighbourhood:
+ * the points inside the initial radius, if they are more than SHEPARD_MIN_NRPOINTS
+ * (the nearest SHEPARD_MAX_NRPOINTS at most), otherwise the nearest SHEPARD_MIN_NRPOINTS.
+ * The distances are computed only for the points in the rings of the spatial index
+ * (if it is valid for myPoints) that can contain the neighbours: with TAD the distance
+ * is not shorter than the euclidean one (kh, kz >= 0), so the same rings are enough
+ */
+static void shepardNeighbourhood(vector <Crit3DInterpolationDataPoint> &myPoints, Crit3DInterpolationSettings* settings,
+                                 float X, float Y, float Z, bool excludeSupplemental,
+                                 vector <int> &validPositions, float* radius)
+{
+    float initialRadius = settings->getShepardInitialRadius();
+    Crit3DSpatialIndex* pointsIndex = settings->getPointsIndex();
+    vector <int> candidates, ringPositions;
+    unsigned i;
+
+    validPositions.clear();
+    *radius = NODATA;
+
+    bool useIndex = pointsIndex->isValid(myPoints);
+    if (settings->getUseTAD() && (settings->getTopoDist_Kh() < 0 || settings->getTopoDist_Kz() < 0))
+        useIndex = false;
+    double bucketSize = 0;
+    int ring = 0, maxRing = -1;
 
-    if (neighbourPoints.size() <= SHEPARD_MIN_NRPOINTS)
+    if (useIndex)
     {
-        sortPointsByDistance(SHEPARD_MIN_NRPOINTS + 1, myPoints, validPoints);
-        if (validPoints.size() > SHEPARD_MIN_NRPOINTS)
+        bucketSize = pointsIndex->getBucketSize();
+        maxRing = pointsIndex->getMaxRing(X, Y);
+    }
+    else
+    {
+        computeDistances(myPoints, settings, X, Y, Z, excludeSupplemental);
+        for (i = 0; i < myPoints.size(); i++)
+            if (isShepardCandidate(myPoints[i], settings))
+                candidates.push_back(int(i));
+    }
+
+    // visit the rings: the points of the next ring are at least (ring - 1) * bucketSize far
+    auto visitRing = [&]()
+    {
+        ringPositions.clear();
+        pointsIndex->getRing(X, Y, ring, ringPositions);
+        for (i = 0; i < ringPositions.size(); i++)
+        {
+            Crit3DInterpolationDataPoint* myPoint = &(myPoints[unsigned(ringPositions[i])]);
+            if (excludeSupplemental && ! checkLapseRateCode(myPoint->lapseRateCode, settings->getUseLapseRateCode(), false))
+                continue;
+
+            computePointDistance(*myPoint, settings, X, Y, Z);
+            if (isShepardCandidate(*myPoint, settings))
+                candidates.push_back(ringPositions[i]);
+        }
+        ring++;
+    };
+
+    if (useIndex)
+        while (ring <= maxRing && (ring - 1) * bucketSize <= initialRadius)
+            visitRing();
+
+    // first neighbourhood inside initial radius (in the order of myPoints)
+    for (i = 0; i < candidates.size(); i++)
+        if (myPoints[unsigned(candidates[i])].distance <= initialRadius)
+            validPositions.push_back(candidates[i]);
+    std::sort(validPositions.begin(), validPositions.end());
+
+    if (validPositions.size() <= SHEPARD_MIN_NRPOINTS)
+    {
+        unsigned nrNearest = SHEPARD_MIN_NRPOINTS + 1;
+        if (useIndex)
+        {
+            while (ring <= maxRing)
+            {
+                if (candidates.size() >= nrNearest)
+                {
+                    sortNearestPositions(myPoints, candidates, nrNearest);
+                    if (myPoints[unsigned(candidates.back())].distance < (ring - 1) * bucketSize)
+                        break;
+                }
+                visitRing();
+            }
+        }
+
+        sortNearestPositions(myPoints, candidates, nrNearest);
+        validPositions = candidates;
+        if (validPositions.empty()) return;
+
+        if (validPositions.size() > SHEPARD_MIN_NRPOINTS)
         {
-            radius = validPoints.at(SHEPARD_MIN_NRPOINTS).distance;
-            validPoints.pop_back();
+            *radius = myPoints[unsigned(validPositions.back())].distance;
+            validPositions.pop_back();
         }
         else
-            radius = validPoints.at(validPoints.size()-1).distance + 1;
+            *radius = myPoints[unsigned(validPositions.back())].distance + 1;
     }
-    else if (neighbourPoints.size() > SHEPARD_MAX_NRPOINTS)
+    else if (validPositions.size() > SHEPARD_MAX_NRPOINTS)
     {
-        sortPointsByDistance(SHEPARD_MAX_NRPOINTS + 1, neighbourPoints, validPoints);
-        radius = validPoints.at(SHEPARD_MAX_NRPOINTS).distance;
-        validPoints.pop_back();
+        sortNearestPositions(myPoints, validPositions, SHEPARD_MAX_NRPOINTS + 1);
+        *radius = myPoints[unsigned(validPositions.back())].distance;
+        validPositions.pop_back();
     }
     else
-    {
-        validPoints = neighbourPoints;
-        radius = settings->getShepardInitialRadius();
-    }
+        *radius = initialRadius;
+}
+
+
+float computeShepard(vector <Crit3DInterpolationDataPoint> &myPoints, Crit3DInterpolationSettings* settings,
+                     float X, float Y, float Z, bool excludeSupplemental)
+{
+    vector <int> validPositions;
+    float radius;
+    unsigned int i;
+
+    shepardNeighbourhood(myPoints, settings, X, Y, Z, excludeSupplemental, validPositions, &radius);
+    if (validPositions.empty())
+        return NODATA;
+
+    vector <Crit3DInterpolationDataPoint*> validPoints(validPositions.size());
+    for (i=0; i < validPositions.size(); i++)
+        validPoints[i] = &(myPoints[unsigned(validPositions[i])]);
 
     unsigned int j;
     float weightSum, radius_27_4, radius_3, tmp, cosine, result;
@@ -789,13 +868,13 @@ float computeShepard(vector <Crit3DInterpolationDataPoint> myPoints, Crit3DInter
     radius_3 = radius / 3;
     radius_27_4 = (27 / 4) / radius;
     for (i=0; i < validPoints.size(); i++)
-        if (validPoints.at(i).distance > 0)
+        if (validPoints.at(i)->distance > 0)
         {
-            if (validPoints.at(i).distance <= radius_3)
-                S.at(i) = 1 / (validPoints.at(i).distance);
-            else if (validPoints.at(i).distance <= radius)
+            if (validPoints.at(i)->distance <= radius_3)
+                S.at(i) = 1 / (validPoints.at(i)->distance);
+            else if (validPoints.at(i)->distance <= radius)
             {
-                tmp = (validPoints.at(i).distance / radius) - 1;
+                tmp = (validPoints.at(i)->distance / radius) - 1;
                 S.at(i) = radius_27_4 * tmp * tmp;
             }
             else
@@ -814,7 +893,7 @@ float computeShepard(vector <Crit3DInterpolationDataPoint> myPoints, Crit3DInter
         for (j=0; j < validPoints.size(); j++)
             if (i != j)
             {
-                cosine = ((X - (float)validPoints.at(i).point->utm.x) * (X - (float)validPoints.at(j).point->utm.x) + (Y - (float)validPoints.at(i).point->utm.y) * (Y - (float)validPoints.at(j).point->utm.y)) / (validPoints.at(i).distance * validPoints.at(j).distance);
+                cosine = ((X - (float)validPoints.at(i)->point->utm.x) * (X - (float)validPoints.at(j)->point->utm.x) + (Y - (float)validPoints.at(i)->point->utm.y) * (Y - (float)validPoints.at(j)->point->utm.y)) / (validPoints.at(i)->distance * validPoints.at(j)->distance);
                 t.at(i) = t.at(i) + S.at(j) * (1 - cosine);
             }
 
@@ -834,11 +913,37 @@ float computeShepard(vector <Crit3DInterpolationDataPoint> myPoints, Crit3DInter
 
     result = 0;
     for (i=0; i<validPoints.size(); i++)
-        result += weight.at(i) * validPoints.at(i).value;
+        result += weight.at(i) * validPoints.at(i)->value;
 
     return result;
 }
 
+/*!
+ * \brief computeKriging
+ * with the model built by preInterpolation, if it is valid for these points;
+ * otherwise (e.g. cross validation) with a temporary model, using the same variogram
+ */
+float computeKriging(vector <Crit3DInterpolationDataPoint> &myPoints, Crit3DInterpolationSettings* settings,
+                     float X, float Y, bool excludeSupplemental)
+{
+    Crit3DKriging* krigingModel = settings->getKrigingModel();
+    float myValue = NODATA;
+
+    if (krigingModel->isValid(myPoints, excludeSupplemental, settings->getIndexPointCV()))
+    {
+        krigingModel->estimate(1, &X, &Y, &myValue, nullptr);
+        return myValue;
+    }
+
+    Crit3DKriging tmpModel;
+    const Crit3DVariogram* myVariogram = krigingModel->isInitialized() ? &(krigingModel->getVariogram()) : nullptr;
+    if (tmpModel.initialize(myPoints, settings->getKrigingType(), settings->getKrigingNrNeighbours(), excludeSupplemental,
+                            settings->getUseLapseRateCode(), settings->getIndexPointCV(), myVariogram))
+        tmpModel.estimate(1, &X, &Y, &myValue, nullptr);
+
+    return myValue;
+}
+
 float inverseDistanceWeighted(vector <Crit3DInterpolationDataPoint> &myPointList)
 {
     double sum, sumWeights, weight;
@@ -982,7 +1087,7 @@ void detrendPoints(std::vector <Crit3DInterpolationDataPoint> &myPoints, Crit3DI
     }
 }
 
-float retrend(meteoVariable myVar, vector <float> myProxyValues, Crit3DInterpolationSettings* mySettings)
+float retrend(meteoVariable myVar, const vector <float> &myProxyValues, Crit3DInterpolationSettings* mySettings)
 {
 
     if (! getUseDetrendingVar(myVar)) return 0.;
@@ -1191,6 +1296,10 @@ bool preInterpolation(std::vector <Crit3DInterpolationDataPoint> &myPoints, Crit
                       Crit3DMeteoPoint* myMeteoPoints, int nrMeteoPoints,
                       meteoVariable myVar, Crit3DTime myTime)
 {
+    // the points can change (optimal detrending): the index and the kriging model are built at the end
+    mySettings->getPointsIndex()->clear();
+    mySettings->getKrigingModel()->clear();
+
     if (myVar == precipitation || myVar == dailyPrecipitation)
     {
         int nrPrecNotNull;
@@ -1217,58 +1326,79 @@ bool preInterpolation(std::vector <Crit3DInterpolationDataPoint> &myPoints, Crit
             topographicDistanceOptimize(myVar, myMeteoPoints, nrMeteoPoints, myPoints, mySettings, myTime);
     }
 
+    mySettings->getPointsIndex()->initialize(myPoints);
+
+    if (mySettings->getInterpolationMethod() == kriging)
+        mySettings->getKrigingModel()->initialize(myPoints, mySettings->getKrigingType(), mySettings->getKrigingNrNeighbours(),
+                                                  true, mySettings->getUseLapseRateCode(), mySettings->getIndexPointCV(), nullptr);
+
     return (true);
 }
 
 
-float interpolate(vector <Crit3DInterpolationDataPoint> &myPoints, Crit3DInterpolationSettings* mySettings,
-                  meteoVariable myVar, float myX, float myY, float myZ, std::vector <float> myProxyValues,
-                  bool excludeSupplemental)
-
+/*!
+ * \brief postInterpolation
+ * physical limits of the interpolated (retrended) value
+ */
+static float postInterpolation(meteoVariable myVar, float myResult)
 {
-    if ((myVar == precipitation || myVar == dailyPrecipitation) && mySettings->getPrecipitationAllZero()) return 0.;
+    if (myVar == precipitation || myVar == dailyPrecipitation)
+    {
+        if (myResult < float(PREC_THRESHOLD))
+            return 0.;
+    }
+    else if (myVar == airRelHumidity || myVar == dailyAirRelHumidityAvg
+             || myVar == dailyAirRelHumidityMax || myVar == dailyAirRelHumidityMin)
+        myResult = maxValue(minValue(myResult, 100), 0);
+    else if (myVar == dailyAirTemperatureRange || myVar == leafWetness || myVar == dailyLeafWetness
+             || myVar == globalIrradiance || myVar == dailyGlobalRadiation || myVar == atmTransmissivity
+             || myVar == windIntensity || myVar == dailyWindIntensityAvg || myVar == dailyWindIntensityMax
+             || myVar == atmPressure)
+        myResult = maxValue(myResult, 0);
 
-    float myResult = NODATA;
+    return myResult;
+}
 
-    computeDistances(myPoints, mySettings, myX, myY, myZ, excludeSupplemental);
+
+/*!
+ * \brief interpolateDetrended
+ * interpolated value of the residuals of the points (before retrend), NODATA if it is not possible
+ */
+static float interpolateDetrended(vector <Crit3DInterpolationDataPoint> &myPoints, Crit3DInterpolationSettings* mySettings,
+                                  float myX, float myY, float myZ, bool excludeSupplemental)
+{
+    float myResult = NODATA;
 
     if (mySettings->getInterpolationMethod() == idw)
     {
+        computeDistances(myPoints, mySettings, myX, myY, myZ, excludeSupplemental);
         myResult = inverseDistanceWeighted(myPoints);
     }
     else if (mySettings->getInterpolationMethod() == kriging)
     {
-        //TODO kriging
-        myResult = NODATA;
+        myResult = computeKriging(myPoints, mySettings, myX, myY, excludeSupplemental);
     }
     else if (mySettings->getInterpolationMethod() == shepard)
     {
-        myResult = computeShepard(myPoints, mySettings, myX, myY);
+        myResult = computeShepard(myPoints, mySettings, myX, myY, myZ, excludeSupplemental);
     }
 
-    if (int(myResult) != int(NODATA))
-    {
-        myResult += retrend(myVar, myProxyValues, mySettings);
-    }
-    else
-        return NODATA;
+    return myResult;
+}
 
-    if (myVar == precipitation || myVar == dailyPrecipitation)
-    {
-        if (myResult < float(PREC_THRESHOLD))
-            return 0.;
-    }
-    else if (myVar == airRelHumidity || myVar == dailyAirRelHumidityAvg
-             || myVar == dailyAirRelHumidityMax || myVar == dailyAirRelHumidityMin)
-        myResult = maxValue(minValue(myResult, 100), 0);
-    else if (myVar == dailyAirTemperatureRange || myVar == leafWetness || myVar == dailyLeafWetness
-             || myVar == globalIrradiance || myVar == dailyGlobalRadiation || myVar == atmTransmissivity
-             || myVar == windIntensity || myVar == dailyWindIntensityAvg || myVar == dailyWindIntensityMax
-             || myVar == atmPressure)
-        myResult = maxValue(myResult, 0);
 
-    return myResult;
+float interpolate(vector <Crit3DInterpolationDataPoint> &myPoints, Crit3DInterpolationSettings* mySettings,
+                  meteoVariable myVar, float myX, float myY, float myZ, const std::vector <float> &myProxyValues,
+                  bool excludeSupplemental)
+
+{
+    if ((myVar == precipitation || myVar == dailyPrecipitation) && mySettings->getPrecipitationAllZero()) return 0.;
+
+    float myResult = interpolateDetrended(myPoints, mySettings, myX, myY, myZ, excludeSupplemental);
+    if (int(myResult) == int(NODATA))
+        return NODATA;
 
+    return postInterpolation(myVar, myResult + retrend(myVar, myProxyValues, mySettings));
 }
 
 std::vector <float> getProxyValuesXY(float x, float y, Crit3DInterpolationSettings* mySettings)
@@ -1299,3 +1429,322 @@ std::vector <float> getProxyValuesXY(float x, float y, Crit3DInterpolationSettin
     return myValues;
 }
 
+
+/*!
+ * \brief trend of a proxy on the cells of a raster: the proxy cell of each row and column
+ * (the raster coordinates of a row, or a column, are the same for all the cells)
+ */
+struct TproxyTrend
+{
+    const gis::Crit3DRasterGrid* grid;
+    bool isAligned;                 // same rows and columns of the raster
+    std::vector<int> rowMap;        // row of the proxy grid, NODATA outside
+    std::vector<int> colMap;
+    bool isHeight;
+    bool useInversion;
+    float slope;
+    float lapseRateH0, lapseRateH1, inversionLapseRate;
+};
+
+
+/*!
+ * \brief initializeTrendRaster
+ * the terms of retrend() for the cells of myGrid: the significant proxies of the current combination
+ * (with a loaded grid), with the row/column remap of the proxy grid on myGrid
+ */
+static void initializeTrendRaster(meteoVariable myVar, Crit3DInterpolationSettings* mySettings,
+                                  const gis::Crit3DRasterGrid& myGrid, std::vector<TproxyTrend> &proxyTrends)
+{
+    proxyTrends.clear();
+    if (! getUseDetrendingVar(myVar)) return;
+
+    Crit3DProxyCombination* myCombination = mySettings->getCurrentCombination();
+    int nrRows = myGrid.header->nrRows;
+    int nrCols = myGrid.header->nrCols;
+    float x, y;
+    int row, col;
+
+    for (int pos=0; pos < mySettings->getProxyNr(); pos++)
+    {
+        Crit3DProxy* myProxy = mySettings->getProxy(pos);
+        gis::Crit3DRasterGrid* proxyGrid = myProxy->getGrid();
+        if (! myCombination->getValue(pos) || ! myProxy->getIsSignificant()
+            || proxyGrid == nullptr || ! proxyGrid->isLoaded)
+            continue;
+
+        TproxyTrend myTrend;
+        myTrend.grid = proxyGrid;
+        myTrend.slope = myProxy->getRegressionSlope();
+        myTrend.isHeight = (getProxyPragaName(myProxy->getName()) == height);
+        myTrend.useInversion = (myTrend.isHeight && mySettings->getUseThermalInversion() && myProxy->getInversionIsSignificative());
+        myTrend.lapseRateH0 = myProxy->getLapseRateH0();
+        myTrend.lapseRateH1 = myProxy->getLapseRateH1();
+        myTrend.inversionLapseRate = myProxy->getInversionLapseRate();
+
+        // as getValueFromXY on the cell center
+        const gis::Crit3DRasterHeader* proxyHeader = proxyGrid->header;
+        double xMax = proxyHeader->llCorner->x + proxyHeader->nrCols * proxyHeader->cellSize;
+        double yMax = proxyHeader->llCorner->y + proxyHeader->nrRows * proxyHeader->cellSize;
+        myTrend.isAligned = (proxyHeader->nrRows == nrRows && proxyHeader->nrCols == nrCols);
+
+        myTrend.rowMap.resize(unsigned(nrRows));
+        for (row = 0; row < nrRows; row++)
+        {
+            gis::getUtmXYFromRowColSinglePrecision(myGrid, row, 0, &x, &y);
+            if (double(y) < proxyHeader->llCorner->y || double(y) >= yMax)
+                myTrend.rowMap[unsigned(row)] = NODATA;
+            else
+                myTrend.rowMap[unsigned(row)] = (proxyHeader->nrRows - 1) - int(floor((double(y) - proxyHeader->llCorner->y) / proxyHeader->cellSize));
+            myTrend.isAligned = myTrend.isAligned && (myTrend.rowMap[unsigned(row)] == row);
+        }
+
+        myTrend.colMap.resize(unsigned(nrCols));
+        for (col = 0; col < nrCols; col++)
+        {
+            gis::getUtmXYFromRowColSinglePrecision(myGrid, 0, col, &x, &y);
+            if (double(x) < proxyHeader->llCorner->x || double(x) >= xMax)
+                myTrend.colMap[unsigned(col)] = NODATA;
+            else
+                myTrend.colMap[unsigned(col)] = int(floor((double(x) - proxyHeader->llCorner->x) / proxyHeader->cellSize));
+            myTrend.isAligned = myTrend.isAligned && (myTrend.colMap[unsigned(col)] == col);
+        }
+
+        proxyTrends.push_back(myTrend);
+    }
+}
+
+
+/*!
+ * \brief computeTrendRow
+ * retrend() of all the cells of a row (nrCols values): one pass on each proxy row,
+ * without branches on the aligned proxies (the loops can be vectorized)
+ */
+static void computeTrendRow(const std::vector<TproxyTrend> &proxyTrends, int row, int nrCols,
+                            std::vector<float> &proxyValues, float* trend)
+{
+    int col;
+    for (col = 0; col < nrCols; col++)
+        trend[col] = 0;
+
+    for (unsigned i = 0; i < proxyTrends.size(); i++)
+    {
+        const TproxyTrend* myTrend = &(proxyTrends[i]);
+        int proxyRow = myTrend->rowMap[unsigned(row)];
+        if (proxyRow == NODATA) continue;
+
+        float flag = myTrend->grid->header->flag;
+        const float* values = myTrend->grid->value[proxyRow];
+        if (! myTrend->isAligned)
+        {
+            proxyValues.resize(unsigned(nrCols));
+            for (col = 0; col < nrCols; col++)
+            {
+                int proxyCol = myTrend->colMap[unsigned(col)];
+                proxyValues[unsigned(col)] = (proxyCol == NODATA) ? flag : values[proxyCol];
+            }
+            values = proxyValues.data();
+        }
+
+        float slope = myTrend->slope;
+        if (myTrend->useInversion)
+        {
+            float H0 = myTrend->lapseRateH0;
+            float H1 = myTrend->lapseRateH1;
+            float belowSlope = myTrend->inversionLapseRate;
+            for (col = 0; col < nrCols; col++)
+            {
+                float value = values[col];
+                float term = (value <= H1) ? (maxValue(value - H0, 0) * belowSlope)
+                                           : ((H1 - H0) * belowSlope) + (value - H1) * slope;
+                trend[col] += (value != flag && value != NODATA) ? term : 0;
+            }
+        }
+        else if (myTrend->isHeight)
+        {
+            for (col = 0; col < nrCols; col++)
+            {
+                float value = values[col];
+                trend[col] += (value != flag && value != NODATA) ? maxValue(value, 0) * slope : 0;
+            }
+        }
+        else
+        {
+            for (col = 0; col < nrCols; col++)
+            {
+                float value = values[col];
+                trend[col] += (value != flag && value != NODATA) ? value * slope : 0;
+            }
+        }
+    }
+}
+
+
+/*!
+ * \brief interpolationRasterParallel
+ * interpolate myVar on all the valid cells of myDTM (myGrid has to be initialized on myDTM).
+ * The rows are divided in tiles of RASTER_TILE_ROWS, shared among nrThreads workers
+ * (0 = number of cores, the calling thread is one of them).
+ * interpolate() writes distance and deltaZ of the points: each worker has its own copy
+ * of myPoints, the settings, the DEM and the proxy grids are only read.
+ * The retrend of each row is computed on the proxy rows (see computeTrendRow).
+ * Kriging: the cells of each row are estimated in one batch by the model of preInterpolation,
+ * the kriging variance is written in varianceGrid (if not null, initialized on myDTM).
+ * progress (number of rows done) is called by the calling thread, it can be empty
+ */
+bool interpolationRasterParallel(std::vector <Crit3DInterpolationDataPoint> &myPoints, Crit3DInterpolationSettings* mySettings,
+                                 meteoVariable myVar, const gis::Crit3DRasterGrid& myDTM, gis::Crit3DRasterGrid* myGrid,
+                                 gis::Crit3DRasterGrid* varianceGrid, int nrThreads, std::function<void(int)> progress)
+{
+    int nrRows = myGrid->header->nrRows;
+    int nrCols = myGrid->header->nrCols;
+    if (nrRows <= 0 || nrCols <= 0) return false;
+
+    int nrTiles = (nrRows + RASTER_TILE_ROWS - 1) / RASTER_TILE_ROWS;
+    if (nrThreads <= 0)
+        nrThreads = int(std::thread::hardware_concurrency());
+    nrThreads = std::max(1, std::min(nrThreads, nrTiles));
+
+    bool isPrecipitationZero = ((myVar == precipitation || myVar == dailyPrecipitation) && mySettings->getPrecipitationAllZero());
+    bool useKrigingModel = (mySettings->getInterpolationMethod() == kriging && ! isPrecipitationZero);
+    Crit3DKriging* krigingModel = mySettings->getKrigingModel();
+    if (useKrigingModel && ! krigingModel->isValid(myPoints, true, mySettings->getIndexPointCV()))
+    {
+        if (! krigingModel->initialize(myPoints, mySettings->getKrigingType(), mySettings->getKrigingNrNeighbours(),
+                                       true, mySettings->getUseLapseRateCode(), mySettings->getIndexPointCV(), nullptr))
+            return false;
+    }
+
+    std::vector <TproxyTrend> proxyTrends;
+    if (! isPrecipitationZero)
+        initializeTrendRaster(myVar, mySettings, *myGrid, proxyTrends);
+
+    std::atomic<int> nextTile(0);
+    std::atomic<int> nrRowsDone(0);
+    std::atomic<int> nrFinishedThreads(0);
+
+    std::mutex progressMutex;
+    std::condition_variable progressChanged;
+    auto notifyProgress = [&]()
+    {
+        std::lock_guard<std::mutex> lock(progressMutex);
+        progressChanged.notify_one();
+    };
+
+    auto interpolateTiles = [&](bool isCallingThread)
+    {
+        std::vector <Crit3DInterpolationDataPoint> threadPoints = myPoints;
+        std::vector <int> cols;
+        std::vector <float> cellX, cellY, values, variances;
+        std::vector <float> trendRow(size_t(nrCols), 0), proxyValues;
+        float myX, myY;
+        int tile;
+
+        while ((tile = nextTile++) < nrTiles)
+        {
+            int firstRow = tile * RASTER_TILE_ROWS;
+            int lastRow = std::min(firstRow + RASTER_TILE_ROWS, nrRows);
+
+            for (int myRow = firstRow; myRow < lastRow; myRow++)
+            {
+                if (isPrecipitationZero)
+                {
+                    for (int myCol = 0; myCol < nrCols; myCol++)
+                        if (myDTM.value[myRow][myCol] != myGrid->header->flag)
+                            myGrid->value[myRow][myCol] = 0;
+                    continue;
+                }
+
+                computeTrendRow(proxyTrends, myRow, nrCols, proxyValues, trendRow.data());
+
+                if (useKrigingModel)
+                {
+                    cols.clear();
+                    cellX.clear();
+                    cellY.clear();
+                    for (int myCol = 0; myCol < nrCols; myCol++)
+                        if (myDTM.value[myRow][myCol] != myGrid->header->flag)
+                        {
+                            gis::getUtmXYFromRowColSinglePrecision(*myGrid, myRow, myCol, &myX, &myY);
+                            cols.push_back(myCol);
+                            cellX.push_back(myX);
+                            cellY.push_back(myY);
+                        }
+
+                    int nrCells = int(cols.size());
+                    values.assign(unsigned(nrCells), NODATA);
+                    variances.assign(unsigned(nrCells), NODATA);
+                    krigingModel->estimate(nrCells, cellX.data(), cellY.data(), values.data(),
+                                           (varianceGrid == nullptr) ? nullptr : variances.data());
+
+                    for (unsigned i = 0; i < cols.size(); i++)
+                    {
+                        if (int(values[i]) == int(NODATA))
+                        {
+                            myGrid->value[myRow][cols[i]] = NODATA;
+                            continue;
+                        }
+                        myGrid->value[myRow][cols[i]] = postInterpolation(myVar, values[i] + trendRow[unsigned(cols[i])]);
+                        if (varianceGrid != nullptr)
+                            varianceGrid->value[myRow][cols[i]] = variances[i];
+                    }
+                }
+                else
+                {
+                    for (int myCol = 0; myCol < nrCols; myCol++)
+                    {
+                        float myZ = myDTM.value[myRow][myCol];
+                        if (myZ != myGrid->header->flag)
+                        {
+                            gis::getUtmXYFromRowColSinglePrecision(*myGrid, myRow, myCol, &myX, &myY);
+                            float myResult = interpolateDetrended(threadPoints, mySettings, myX, myY, myZ, true);
+                            if (int(myResult) == int(NODATA))
+                                myGrid->value[myRow][myCol] = NODATA;
+                            else
+                                myGrid->value[myRow][myCol] = postInterpolation(myVar, myResult + trendRow[unsigned(myCol)]);
+                        }
+                    }
+                }
+            }
+
+            nrRowsDone += lastRow - firstRow;
+            if (isCallingThread)
+            {
+                if (progress) progress(nrRowsDone);
+            }
+            else
+                notifyProgress();
+        }
+
+        nrFinishedThreads++;
+        notifyProgress();
+    };
+
+    std::vector<std::thread> workers;
+    for (int t = 1; t < nrThreads; t++)
+        workers.push_back(std::thread(interpolateTiles, false));
+
+    interpolateTiles(true);
+
+    // the calling thread reports the progress of the workers until they finish
+    int lastProgress = nrRowsDone;
+    while (nrFinishedThreads < nrThreads)
+    {
+        {
+            std::unique_lock<std::mutex> lock(progressMutex);
+            progressChanged.wait(lock, [&]{ return nrRowsDone != lastProgress || nrFinishedThreads == nrThreads; });
+        }
+
+        if (nrRowsDone != lastProgress)
+        {
+            lastProgress = nrRowsDone;
+            if (progress) progress(lastProgress);
+        }
+    }
+
+    for (unsigned t = 0; t < workers.size(); t++)
+        workers[t].join();
+
+    if (progress) progress(nrRowsDone);
+
+    return true;
+}
@@ -36,11 +36,12 @@
         #include "interpolationPoint.h"
     #endif
 
+    #include <functional>
+
     class Crit3DMeteoPoint;
 
     bool preInterpolation(std::vector<Crit3DInterpolationDataPoint> &myPoints, Crit3DInterpolationSettings *mySettings, Crit3DMeteoPoint *myMeteoPoints, int nrMeteoPoints, meteoVariable myVar, Crit3DTime myTime);
 
-    bool krigingEstimateVariogram(float *myDist, float *mySemiVar,int sizeMyVar, int nrMyPoints,float myMaxDistance, double *mySill, double *myNugget, double *myRange, double *mySlope, TkrigingMode *myMode, int nrPointData);
     bool krigLinearPrep(double *mySlope, double *myNugget, int nrPointData);
 
     void clearInterpolationPoints();
@@ -48,7 +49,11 @@
     bool neighbourhoodVariability(std::vector<Crit3DInterpolationDataPoint> &myInterpolationPoints, Crit3DInterpolationSettings *mySettings, float x, float y, float z, int nMax,
                                   float* devSt, float* devStDeltaZ, float* minDistance);
 
-    float interpolate(std::vector<Crit3DInterpolationDataPoint> &myPoints, Crit3DInterpolationSettings *mySettings, meteoVariable myVar, float myX, float myY, float myZ, std::vector<float> myProxyValues, bool excludeSupplemental);
+    float interpolate(std::vector<Crit3DInterpolationDataPoint> &myPoints, Crit3DInterpolationSettings *mySettings, meteoVariable myVar, float myX, float myY, float myZ, const std::vector<float> &myProxyValues, bool excludeSupplemental);
     std::vector <float> getProxyValuesXY(float x, float y, Crit3DInterpolationSettings* mySettings);
 
+    bool interpolationRasterParallel(std::vector <Crit3DInterpolationDataPoint> &myPoints, Crit3DInterpolationSettings* mySettings,
+                                     meteoVariable myVar, const gis::Crit3DRasterGrid& myDTM, gis::Crit3DRasterGrid* myGrid,
+                                     gis::Crit3DRasterGrid* varianceGrid, int nrThreads, std::function<void(int)> progress);
+
 #endif // INTERPOLATION_H
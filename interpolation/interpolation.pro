@@ -29,12 +29,16 @@ SOURCES += interpolation.cpp \
     interpolationSettings.cpp \
     interpolationPoint.cpp \
     kriging.cpp \
-    spatialControl.cpp
+    spatialControl.cpp \
+    spatialIndex.cpp \
+    topoDistanceCache.cpp
 
 HEADERS += interpolation.h \
     interpolationSettings.h \
     interpolationPoint.h \
     kriging.h \
     interpolationConstants.h \
-    spatialControl.h
+    spatialControl.h \
+    spatialIndex.h \
+    topoDistanceCache.h
 
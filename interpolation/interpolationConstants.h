@@ -7,6 +7,13 @@
     #define SHEPARD_MIN_NRPOINTS 4
     #define SHEPARD_AVG_NRPOINTS 7
     #define SHEPARD_MAX_NRPOINTS 10
+    #define RASTER_TILE_ROWS 8
+    #define KRIGING_NR_LAGS 15
+    #define KRIGING_NR_RANGES 40
+    #define KRIGING_BATCH_SIZE 256
+    #define KRIGING_CACHE_SIZE 256
+    #define TOPODISTANCE_RESOLUTION 0.2
+    #define TOPODISTANCE_CACHE_MB 512
 
     #ifndef _STRING_
         #include <string>
@@ -48,5 +55,12 @@
                        KRIGING_LINEAR=4
                       };
 
+    enum TkrigingType { KRIGING_ORDINARY, KRIGING_UNIVERSAL };
+
+    const std::map<std::string, TkrigingType> krigingTypeNames = {
+      { "ordinary", KRIGING_ORDINARY },
+      { "universal", KRIGING_UNIVERSAL }
+    };
+
 
 #endif // INTERPOLATIONCONSTS_H
@@ -36,7 +36,6 @@ Crit3DInterpolationDataPoint::Crit3DInterpolationDataPoint()
     deltaZ = NODATA;
     value = NODATA;
     lapseRateCode = primary;
-    topographicDistance = nullptr;
     point = new gis::Crit3DPoint();
 }
 
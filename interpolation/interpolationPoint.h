@@ -7,6 +7,9 @@
     #ifndef METEO_H
         #include "meteo.h"
     #endif
+    #include <memory>
+
+    class Crit3DTopoDistanceMap;
 
     class Crit3DInterpolationDataPoint {
     private:
@@ -19,7 +22,7 @@
         float deltaZ;
         float value;
         lapseRateCodeType lapseRateCode;
-        gis::Crit3DRasterGrid* topographicDistance;
+        std::shared_ptr<const Crit3DTopoDistanceMap> topographicDistance;
         std::vector <float> proxyValues;
 
         Crit3DInterpolationDataPoint();
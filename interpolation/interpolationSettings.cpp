@@ -113,6 +113,16 @@ void Crit3DInterpolationSettings::setCurrentDEM(gis::Crit3DRasterGrid *value)
     currentDEM = value;
 }
 
+Crit3DTopoDistanceCache *Crit3DInterpolationSettings::getTopoDistanceCache() const
+{
+    return topoDistanceCache;
+}
+
+void Crit3DInterpolationSettings::setTopoDistanceCache(Crit3DTopoDistanceCache *value)
+{
+    topoDistanceCache = value;
+}
+
 float Crit3DInterpolationSettings::getTopoDist_Kh() const
 {
     return topoDist_Kh;
@@ -193,6 +203,46 @@ std::vector<Crit3DProxy> Crit3DInterpolationSettings::getCurrentProxy() const
     return currentProxy;
 }
 
+Crit3DSpatialIndex* Crit3DInterpolationSettings::getPointsIndex()
+{
+    return &pointsIndex;
+}
+
+TkrigingType Crit3DInterpolationSettings::getKrigingType() const
+{
+    return krigingType;
+}
+
+void Crit3DInterpolationSettings::setKrigingType(TkrigingType value)
+{
+    krigingType = value;
+}
+
+int Crit3DInterpolationSettings::getKrigingNrNeighbours() const
+{
+    return krigingNrNeighbours;
+}
+
+void Crit3DInterpolationSettings::setKrigingNrNeighbours(int value)
+{
+    krigingNrNeighbours = value;
+}
+
+bool Crit3DInterpolationSettings::getComputeKrigingVariance() const
+{
+    return computeKrigingVariance;
+}
+
+void Crit3DInterpolationSettings::setComputeKrigingVariance(bool value)
+{
+    computeKrigingVariance = value;
+}
+
+Crit3DKriging* Crit3DInterpolationSettings::getKrigingModel()
+{
+    return &krigingModel;
+}
+
 void Crit3DInterpolationSettings::setCurrentProxy(const std::vector<Crit3DProxy> &value)
 {
     currentProxy = value;
@@ -213,6 +263,7 @@ void Crit3DInterpolationSettings::initializeProxy()
 void Crit3DInterpolationSettings::initialize()
 {
     currentDEM = nullptr;
+    topoDistanceCache = nullptr;
     interpolationMethod = idw;
     useThermalInversion = true;
     useTAD = false;
@@ -225,6 +276,9 @@ void Crit3DInterpolationSettings::initialize()
     indexHeight = NODATA;
 
     isKrigingReady = false;
+    krigingType = KRIGING_ORDINARY;
+    krigingNrNeighbours = 0;
+    computeKrigingVariance = false;
     precipitationAllZero = false;
     maxHeightInversion = 1000.;
     shepardInitialRadius = NODATA;
@@ -453,7 +507,7 @@ void Crit3DProxy::setRegressionSlope(float myValue)
 float Crit3DProxy::getRegressionSlope()
 { return regressionSlope;}
 
-float Crit3DProxy::getValue(unsigned int pos, std::vector <float> proxyValues)
+float Crit3DProxy::getValue(unsigned int pos, const std::vector <float> &proxyValues)
 {
     if (pos < proxyValues.size())
         return proxyValues.at(pos);
@@ -487,7 +541,7 @@ void Crit3DInterpolationSettings::addProxy(Crit3DProxy myProxy, bool isActive_)
 std::string Crit3DInterpolationSettings::getProxyName(int pos)
 { return currentProxy.at(pos).getName();}
 
-float Crit3DInterpolationSettings::getProxyValue(unsigned int pos, std::vector <float> proxyValues)
+float Crit3DInterpolationSettings::getProxyValue(unsigned int pos, const std::vector <float> &proxyValues)
 {
     if (pos < currentProxy.size())
         return currentProxy.at(pos).getValue(pos, proxyValues);
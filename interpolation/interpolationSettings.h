@@ -10,9 +10,17 @@
     #ifndef METEOGRID_H
         #include "meteoGrid.h"
     #endif
+    #ifndef SPATIALINDEX_H
+        #include "spatialIndex.h"
+    #endif
+    #ifndef KRIGING_H
+        #include "kriging.h"
+    #endif
 
     #include <deque>
 
+    class Crit3DTopoDistanceCache;
+
     std::string getKeyStringInterpolationMethod(TInterpolationMethod value);
     TProxyVar getProxyPragaName(std::string name_);
 
@@ -51,7 +59,7 @@
         float getRegressionR2();
         void setRegressionSlope(float myValue);
         float getRegressionSlope();
-        float getValue(unsigned int pos, std::vector <float> proxyValues);
+        float getValue(unsigned int pos, const std::vector <float> &proxyValues);
         float getLapseRateH1() const;
         void setLapseRateH1(float value);
         float getLapseRateH0() const;
@@ -93,6 +101,7 @@
     {
     private:
         gis::Crit3DRasterGrid* currentDEM; //for TAD
+        Crit3DTopoDistanceCache* topoDistanceCache; //maps of TAD on currentDEM (can be null)
 
         TInterpolationMethod interpolationMethod;
 
@@ -121,6 +130,13 @@
         bool currentClimateParametersLoaded;
         Crit3DClimateParameters currentClimateParameters;
 
+        Crit3DSpatialIndex pointsIndex;     // built by preInterpolation
+
+        TkrigingType krigingType;
+        int krigingNrNeighbours;            // 0: all the points
+        bool computeKrigingVariance;        // the kriging variance costs more than the estimate
+        Crit3DKriging krigingModel;         // built by preInterpolation
+
     public:
         Crit3DInterpolationSettings();
 
@@ -133,7 +149,7 @@
         std::string getProxyName(int pos);
         int getProxyNr();
         void addProxy(Crit3DProxy myProxy, bool isActive_);
-        float getProxyValue(unsigned int pos, std::vector <float> proxyValues);
+        float getProxyValue(unsigned int pos, const std::vector <float> &proxyValues);
         bool getCombination(int combinationInteger, Crit3DProxyCombination* outCombination);
 
         void setClimateParameters(Crit3DClimateParameters* myParameters);
@@ -170,6 +186,8 @@
         void setIndexPointCV(int value);
         gis::Crit3DRasterGrid *getCurrentDEM() const;
         void setCurrentDEM(gis::Crit3DRasterGrid *value);
+        Crit3DTopoDistanceCache *getTopoDistanceCache() const;
+        void setTopoDistanceCache(Crit3DTopoDistanceCache *value);
         float getTopoDist_Kh() const;
         void setTopoDist_Kh(float value);
         float getTopoDist_Kz() const;
@@ -187,6 +205,14 @@
         void setCurrentCombination(Crit3DProxyCombination *value);
         std::vector<Crit3DProxy> getCurrentProxy() const;
         void setCurrentProxy(const std::vector<Crit3DProxy> &value);
+        Crit3DSpatialIndex* getPointsIndex();
+        TkrigingType getKrigingType() const;
+        void setKrigingType(TkrigingType value);
+        int getKrigingNrNeighbours() const;
+        void setKrigingNrNeighbours(int value);
+        bool getComputeKrigingVariance() const;
+        void setComputeKrigingVariance(bool value);
+        Crit3DKriging* getKrigingModel();
     };
 
 #endif // INTERPOLATIONSETTINGS_H
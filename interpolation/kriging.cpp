@@ -1,330 +1,800 @@
 /*!
-     \brief Kriging Interpolator
+    \copyright 2016 Fausto Tomei, Gabriele Antolini,
+    Alberto Pistocchi, Marco Bittelli, Antonio Volta, Laura Costantini
 
-     based on: Chao-yi Lang
-     July, 1995
-     lang@cs.cornell.edu
+    This file is part of CRITERIA3D.
+    CRITERIA3D has been developed under contract issued by A.R.P.A. Emilia-Romagna
+
+    CRITERIA3D is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    CRITERIA3D is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with CRITERIA3D.  If not, see <http://www.gnu.org/licenses/>.
+
+    contacts:
+    fausto.tomei@gmail.com
+    ftomei@arpae.it
 */
 
-    #include <malloc.h>
-    #include <math.h>
-    #include <stdio.h>
+#include <math.h>
+#include <map>
+#include <atomic>
+#include <algorithm>
+
+#include "commonConstants.h"
+#include "meteo.h"
+#include "interpolationPoint.h"
+#include "kriging.h"
+
+#define MAX_DRIFT 3
+
+
+Crit3DVariogram::Crit3DVariogram()
+{
+    mode = KRIGING_LINEAR;
+    nugget = 0;
+    sill = 0;
+    range = 0;
+    slope = 0;
+}
+
+
+/*!
+ * \brief getSemivariance
+ * practical range: the bounded models reach 95% of the sill (spherical: the sill) at h = range
+ */
+double Crit3DVariogram::getSemivariance(double h) const
+{
+    if (h <= 0) return 0;
+
+    double t = (range > 0) ? h / range : 0;
+    switch (mode)
+    {
+        case KRIGING_SPHERICAL:
+            if (h < range)
+                return nugget + (sill - nugget) * (1.5 * t - 0.5 * t * t * t);
+            else
+                return sill;
+
+        case KRIGING_EXPONENTIAL:
+            return nugget + (sill - nugget) * (1. - exp(-3. * t));
 
-    #include "kriging.h"
+        case KRIGING_GAUSSIAN:
+            return nugget + (sill - nugget) * (1. - exp(-3. * t * t));
 
-    /*! global variables */
-    short mode;
-    int dim;
-    double range, nugget, sill, sill_nugget, slope;
-    double *D, *V, *weight, *VM, *pos, *val;
+        default:
+            return nugget + slope * h;
+    }
+}
 
 
-    /*!
-     * \brief no pivoting - assume rank n
-     * \param A matrix double pointer
-     * \return true on success, false otherwise
-     */
-    bool matrixInversion(double *A)
+/*!
+ * \brief fitNuggetSill
+ * weighted least squares of semivariance = c0 + c1 * basis, with c0 >= 0 and c1 >= 0
+ * \return the weighted sum of the squared residuals
+ */
+static double fitNuggetSill(const std::vector<double> &basis, const std::vector<double> &semivariance,
+                            const std::vector<double> &weight, double* c0, double* c1)
+{
+    double sw = 0, sg = 0, sgg = 0, sy = 0, sgy = 0;
+    unsigned i;
+
+    for (i = 0; i < basis.size(); i++)
     {
-        double *inverseA, rapporto;
-        int i, j, iter, first_row;
+        sw += weight[i];
+        sg += weight[i] * basis[i];
+        sgg += weight[i] * basis[i] * basis[i];
+        sy += weight[i] * semivariance[i];
+        sgy += weight[i] * basis[i] * semivariance[i];
+    }
 
-        inverseA = (double *) malloc(sizeof(double) * dim *dim);
+    double det = sw * sgg - sg * sg;
+    *c1 = (det > EPSILON * sw * sgg) ? (sw * sgy - sg * sy) / det : 0;
+    *c0 = (sy - *c1 * sg) / sw;
 
-        /*! inizializza = matrice Identit */
-        for (i = 0; i < dim; i++)
-            for(j = 0; j < dim; j++)
-                inverseA[i*dim+j] = (i == j) ? 1. : 0. ;
+    if (*c0 < 0)
+    {
+        *c0 = 0;
+        *c1 = (sgg > 0) ? sgy / sgg : 0;
+    }
+    if (*c1 < 0)
+    {
+        *c1 = 0;
+        *c0 = sy / sw;
+    }
+
+    double sse = 0;
+    for (i = 0; i < basis.size(); i++)
+    {
+        double residual = semivariance[i] - *c0 - *c1 * basis[i];
+        sse += weight[i] * residual * residual;
+    }
+
+    return sse;
+}
+
+
+/*!
+ * \brief krigingFitVariogram
+ * experimental semivariogram of the residuals (KRIGING_NR_LAGS lags up to half of the maximum distance),
+ * then weighted (number of pairs) least squares fit of the spherical, exponential and gaussian models
+ * (KRIGING_NR_RANGES ranges) and of the linear model: the best fit is chosen.
+ * Pure nugget (linear with slope 0) if the lags are not enough
+ */
+bool krigingFitVariogram(const std::vector<double> &x, const std::vector<double> &y,
+                         const std::vector<double> &residuals, Crit3DVariogram* variogram)
+{
+    unsigned n = unsigned(residuals.size());
+    unsigned i, j;
+    if (n < 2) return false;
+
+    double maxDistance = 0;
+    for (i = 0; i < n; i++)
+        for (j = i+1; j < n; j++)
+            maxDistance = std::max(maxDistance, (x[i]-x[j]) * (x[i]-x[j]) + (y[i]-y[j]) * (y[i]-y[j]));
+    maxDistance = sqrt(maxDistance);
+
+    double mean = 0, variance = 0;
+    for (i = 0; i < n; i++)
+        mean += residuals[i] / n;
+    for (i = 0; i < n; i++)
+        variance += (residuals[i] - mean) * (residuals[i] - mean) / (n - 1);
+
+    // experimental semivariogram
+    double maxLag = maxDistance / 2;
+    std::vector<double> sumH(KRIGING_NR_LAGS, 0), sumSquares(KRIGING_NR_LAGS, 0), nrPairs(KRIGING_NR_LAGS, 0);
+    if (maxLag > 0)
+    {
+        for (i = 0; i < n; i++)
+            for (j = i+1; j < n; j++)
+            {
+                double h = sqrt((x[i]-x[j]) * (x[i]-x[j]) + (y[i]-y[j]) * (y[i]-y[j]));
+                if (h > maxLag) continue;
+                int lag = std::min(int(h / maxLag * KRIGING_NR_LAGS), KRIGING_NR_LAGS - 1);
+                sumH[lag] += h;
+                sumSquares[lag] += (residuals[i] - residuals[j]) * (residuals[i] - residuals[j]);
+                nrPairs[lag]++;
+            }
+    }
+
+    std::vector<double> lagH, semivariance, weight;
+    for (int lag = 0; lag < KRIGING_NR_LAGS; lag++)
+        if (nrPairs[lag] > 0)
+        {
+            lagH.push_back(sumH[lag] / nrPairs[lag]);
+            semivariance.push_back(sumSquares[lag] / (2 * nrPairs[lag]));
+            weight.push_back(nrPairs[lag]);
+        }
+
+    *variogram = Crit3DVariogram();
+    if (lagH.size() < 3)
+    {
+        variogram->nugget = variance;
+        return true;
+    }
 
-        /*! step 1: A diventa triangolare sup , inverseA triangolare inf */
-        for (iter = 0; iter < (dim-1); iter++)
+    // linear
+    double c0, c1;
+    double bestSse = fitNuggetSill(lagH, semivariance, weight, &c0, &c1);
+    variogram->nugget = c0;
+    variogram->slope = c1;
+
+    // bounded models
+    TkrigingMode modes[3] = {KRIGING_SPHERICAL, KRIGING_EXPONENTIAL, KRIGING_GAUSSIAN};
+    double minRange = lagH.front() / 2;
+    double maxRange = 2 * maxDistance;
+    std::vector<double> basis(lagH.size());
+    Crit3DVariogram unitModel;
+    unitModel.sill = 1;
+
+    for (int m = 0; m < 3; m++)
+        for (int r = 0; r < KRIGING_NR_RANGES; r++)
         {
-            first_row = iter + 1;
-            for(i = first_row; i < dim; i++)
+            unitModel.mode = modes[m];
+            unitModel.range = minRange * pow(maxRange / minRange, double(r) / (KRIGING_NR_RANGES - 1));
+            for (i = 0; i < lagH.size(); i++)
+                basis[i] = unitModel.getSemivariance(lagH[i]);
+
+            double sse = fitNuggetSill(basis, semivariance, weight, &c0, &c1);
+            if (sse < bestSse)
             {
-                rapporto = A[i*dim+iter] / A[iter*dim+iter];
-                A[i*dim+iter] = 0.;
-                for(j = first_row; j < dim; j++)
-                    A[i*dim+j] -= rapporto * A[iter*dim+j];
-                for(j = 0; j <= iter; j++)
-                    inverseA[i*dim+j] -= rapporto * inverseA[iter*dim+j];
+                bestSse = sse;
+                variogram->mode = modes[m];
+                variogram->nugget = c0;
+                variogram->sill = c0 + c1;
+                variogram->range = unitModel.range;
+                variogram->slope = 0;
             }
         }
 
-        /*! step 2: A diventa diagonale */
-        for (iter = dim - 1; iter > 0; iter--)
+    return true;
+}
+
+
+Crit3DKrigingSystem::Crit3DKrigingSystem()
+{
+    nrPoints = 0;
+    nrDrift = 0;
+    covarianceShift = 0;
+    xRef = 0;
+    yRef = 0;
+    coordScale = 1;
+}
+
+
+int Crit3DKrigingSystem::getNrPoints() const
+{
+    return nrPoints;
+}
+
+
+double Crit3DKrigingSystem::getCovariance(double h) const
+{
+    return covarianceShift - variogram.getSemivariance(h);
+}
+
+
+void Crit3DKrigingSystem::getDrift(double myX, double myY, double* drift) const
+{
+    drift[0] = 1;
+    if (nrDrift > 1)
+    {
+        drift[1] = (myX - xRef) / coordScale;
+        drift[2] = (myY - yRef) / coordScale;
+    }
+}
+
+
+static bool choleskyDecomposition(std::vector<double> &a, int n)
+{
+    for (int j = 0; j < n; j++)
+    {
+        double* rowJ = &(a[unsigned(j * n)]);
+        double s = rowJ[j];
+        for (int k = 0; k < j; k++)
+            s -= rowJ[k] * rowJ[k];
+        if (s <= 0) return false;
+        rowJ[j] = sqrt(s);
+
+        for (int i = j+1; i < n; i++)
+        {
+            double* rowI = &(a[unsigned(i * n)]);
+            double t = rowI[j];
+            for (int k = 0; k < j; k++)
+                t -= rowI[k] * rowJ[k];
+            rowI[j] = t / rowJ[j];
+        }
+    }
+
+    // upper triangle
+    for (int i = 0; i < n; i++)
+        for (int j = i+1; j < n; j++)
+            a[unsigned(i * n + j)] = 0;
+
+    return true;
+}
+
+
+/*! solve L L^T x = b (in place) */
+static void choleskySolve(const std::vector<double> &l, int n, double* b)
+{
+    for (int i = 0; i < n; i++)
+    {
+        const double* rowI = &(l[unsigned(i * n)]);
+        double s = b[i];
+        for (int k = 0; k < i; k++)
+            s -= rowI[k] * b[k];
+        b[i] = s / rowI[i];
+    }
+    for (int i = n-1; i >= 0; i--)
+    {
+        double s = b[i];
+        for (int k = i+1; k < n; k++)
+            s -= l[unsigned(k * n + i)] * b[k];
+        b[i] = s / l[unsigned(i * n + i)];
+    }
+}
+
+
+/*! inverse of a small matrix (Gauss-Jordan with partial pivoting) */
+static bool smallMatrixInversion(std::vector<double> &a, int n)
+{
+    std::vector<double> inverse(unsigned(n * n), 0);
+    for (int i = 0; i < n; i++)
+        inverse[unsigned(i * n + i)] = 1;
+
+    for (int col = 0; col < n; col++)
+    {
+        int pivot = col;
+        for (int i = col+1; i < n; i++)
+            if (fabs(a[unsigned(i * n + col)]) > fabs(a[unsigned(pivot * n + col)]))
+                pivot = i;
+        if (fabs(a[unsigned(pivot * n + col)]) < EPSILON) return false;
+
+        for (int j = 0; j < n; j++)
+        {
+            std::swap(a[unsigned(col * n + j)], a[unsigned(pivot * n + j)]);
+            std::swap(inverse[unsigned(col * n + j)], inverse[unsigned(pivot * n + j)]);
+        }
+
+        double diagonal = a[unsigned(col * n + col)];
+        for (int j = 0; j < n; j++)
         {
-            first_row = iter - 1;
-            for(i = first_row; i >= 0; i--)
+            a[unsigned(col * n + j)] /= diagonal;
+            inverse[unsigned(col * n + j)] /= diagonal;
+        }
+
+        for (int i = 0; i < n; i++)
+        {
+            if (i == col) continue;
+            double factor = a[unsigned(i * n + col)];
+            for (int j = 0; j < n; j++)
             {
-                rapporto = A[i*dim+iter] / A[iter*dim+iter];
-                A[i*dim+iter] = 0.;
-                for(j = 0; j < dim; j++)
-                    inverseA[i*dim+j] -= rapporto * inverseA[iter*dim+j];
+                a[unsigned(i * n + j)] -= factor * a[unsigned(col * n + j)];
+                inverse[unsigned(i * n + j)] -= factor * inverse[unsigned(col * n + j)];
             }
         }
+    }
 
-        /*! step 3: divide per la diagonale e ottiene inverseA */
-        for(i = 0; i < dim; i++)
-            for (j = 0; j < dim; j++)
-                inverseA[i*dim+j] /= A[i*dim+i];
+    a = inverse;
+    return true;
+}
 
-        /*! salva matrice inversa e libera memoria */
-        for(i = 0; i < dim; i++)
-            for (j = 0; j < dim; j++)
-                A[i*dim+j] = inverseA[i*dim+j];
 
-        free(inverseA);
+/*!
+ * \brief initialize
+ * the covariance shift c is the sill of the bounded models (the semivariance at the maximum distance
+ * for the linear model): with the constant drift the solution does not depend on c,
+ * it is doubled if the covariance matrix is not positive definite
+ * \return false if the drift system is singular
+ */
+bool Crit3DKrigingSystem::initialize(const std::vector<double> &myX, const std::vector<double> &myY, const std::vector<double> &myZ,
+                                     const Crit3DVariogram &myVariogram, TkrigingType type,
+                                     double myXRef, double myYRef, double myCoordScale)
+{
+    nrPoints = int(myZ.size());
+    nrDrift = (type == KRIGING_UNIVERSAL) ? 3 : 1;
+    variogram = myVariogram;
+    xRef = myXRef;
+    yRef = myYRef;
+    coordScale = myCoordScale;
+    x = myX;
+    y = myY;
+
+    int n = nrPoints;
+    if (n < nrDrift) return false;
+
+    std::vector<double> distance(unsigned(n * n), 0);
+    double maxDistance = 0;
+    for (int i = 0; i < n; i++)
+        for (int j = i+1; j < n; j++)
+        {
+            double h = sqrt((x[i]-x[j]) * (x[i]-x[j]) + (y[i]-y[j]) * (y[i]-y[j]));
+            distance[unsigned(i * n + j)] = distance[unsigned(j * n + i)] = h;
+            maxDistance = std::max(maxDistance, h);
+        }
 
-        return true;
+    if (variogram.mode == KRIGING_LINEAR)
+        covarianceShift = variogram.getSemivariance(maxDistance);
+    else
+        covarianceShift = variogram.sill;
+    if (covarianceShift <= 0) covarianceShift = 1;
+
+    bool isPositiveDefinite = false;
+    for (int attempt = 0; attempt < 20 && ! isPositiveDefinite; attempt++)
+    {
+        cholesky.resize(unsigned(n * n));
+        for (int i = 0; i < n; i++)
+            for (int j = 0; j <= i; j++)
+                cholesky[unsigned(i * n + j)] = (i == j) ? covarianceShift * (1 + EPSILON)
+                                                         : getCovariance(distance[unsigned(i * n + j)]);
+
+        isPositiveDefinite = choleskyDecomposition(cholesky, n);
+        if (! isPositiveDefinite)
+            covarianceShift *= 2;
     }
+    if (! isPositiveDefinite) return false;
 
+    // K^-1 z
+    alpha = myZ;
+    choleskySolve(cholesky, n, alpha.data());
 
+    // K^-1 F and (F^T K^-1 F)^-1
+    double drift[MAX_DRIFT];
+    driftWeights.assign(unsigned(nrDrift * n), 0);
+    for (int i = 0; i < n; i++)
+    {
+        getDrift(x[i], y[i], drift);
+        for (int q = 0; q < nrDrift; q++)
+            driftWeights[unsigned(q * n + i)] = drift[q];
+    }
+    for (int q = 0; q < nrDrift; q++)
+        choleskySolve(cholesky, n, &(driftWeights[unsigned(q * n)]));
 
-    /*!
-     * \brief costruisce la matrice delle distanze e il variogramma
-     * \param myPos pos[N*2]	[i*2]   x i-esima stazione  [i*2+1] y i-esima stazione
-     * \param myVal dati stazione
-     * \param nrItems numero di stazioni
-     * \param myMode mode 1-Spher mode 2-Expon mode 3-Gauss mode 4-Linear mode
-     * \param myRange
-     * \param myNugget
-     * \param mySill
-     * \param mySlope
-     * \return
-     */
-    bool krigingVariogram(double *myPos, double *myVal, int nrItems, short myMode,
-                          double myRange, double myNugget, double mySill, double mySlope)
+    driftSystemInv.assign(unsigned(nrDrift * nrDrift), 0);
+    driftAlpha.assign(unsigned(nrDrift), 0);
+    for (int i = 0; i < n; i++)
     {
-        int i, j;
-        double dx, dy, tmp;
-        double *Cd;
-
-        /*! global variables */
-        mode	= myMode;
-        dim		= nrItems + 1;
-        range = myRange;
-        nugget = myNugget;
-        sill = mySill;
-        slope = mySlope;
-        sill_nugget = sill - nugget;
-
-        krigingFreeMemory();
-
-        V		= (double *) malloc (sizeof (double) * dim * dim );
-        Cd		= (double *) malloc (sizeof (double) * dim * dim );
-        D		= (double *) malloc (sizeof (double) * dim);
-        weight	= (double *) malloc (sizeof (double) * dim);
-        pos		= (double *) malloc (sizeof (double) * nrItems * 2);
-        val		= (double *) malloc (sizeof (double) * nrItems);
-
-        /*! salva matrici posizione e valore */
-        for (i=0; i < nrItems; i++)
+        getDrift(x[i], y[i], drift);
+        for (int q = 0; q < nrDrift; q++)
         {
-            pos[i*2]	= myPos[i*2];
-            pos[i*2+1]	= myPos[i*2+1];
-            val[i]		= myVal[i];
+            driftAlpha[unsigned(q)] += drift[q] * alpha[unsigned(i)];
+            for (int r = 0; r < nrDrift; r++)
+                driftSystemInv[unsigned(q * nrDrift + r)] += drift[q] * driftWeights[unsigned(r * n + i)];
         }
+    }
+
+    return smallMatrixInversion(driftSystemInv, nrDrift);
+}
 
-        /*! matrice (triangolare sup) delle distanze */
-        for (i=0; i < nrItems; i++)
+
+/*!
+ * \brief estimate
+ * kriging estimate (and variance, if variances is not null) of a batch of target points.
+ * value = k^T K^-1 z - mu^T F^T K^-1 z, with mu = (F^T K^-1 F)^-1 (F^T K^-1 k - f)
+ * variance = c - k^T K^-1 k + (F^T K^-1 k - f)^T mu
+ * the covariance vectors k of the batch are stored by point (the targets are contiguous),
+ * the variance needs one forward substitution for all the batch
+ */
+void Crit3DKrigingSystem::estimate(int nrCells, const float* cellX, const float* cellY, float* values, float* variances) const
+{
+    int n = nrPoints;
+    std::vector<double> covariance, estimate, driftResidual, mu;
+    double drift[MAX_DRIFT];
+
+    for (int first = 0; first < nrCells; first += KRIGING_BATCH_SIZE)
+    {
+        int m = std::min(KRIGING_BATCH_SIZE, nrCells - first);
+        const float* batchX = cellX + first;
+        const float* batchY = cellY + first;
+
+        covariance.resize(unsigned(n * m));
+        for (int i = 0; i < n; i++)
         {
-            for (j=i; j < nrItems; j++)
+            double* rowI = &(covariance[unsigned(i * m)]);
+            for (int c = 0; c < m; c++)
             {
-                dx = pos[i*2]-pos[j*2];
-                dy = pos[i*2+1]-pos[j*2+1];
-                Cd[(i*dim)+j] = sqrt(dx * dx + dy * dy);
+                double dx = x[unsigned(i)] - double(batchX[c]);
+                double dy = y[unsigned(i)] - double(batchY[c]);
+                rowI[c] = getCovariance(sqrt(dx * dx + dy * dy));
             }
         }
 
-        /*! inizializza ultima riga e colonna del variogramma
-        * es:	0 0 0 1
-        *		0 0 0 1
-        *		0 0 0 1
-        *		1 1 1 0 */
+        // k^T K^-1 z and F^T K^-1 k - f
+        estimate.assign(unsigned(m), 0);
+        driftResidual.assign(unsigned(nrDrift * m), 0);
+        for (int i = 0; i < n; i++)
+        {
+            const double* rowI = &(covariance[unsigned(i * m)]);
+            double a = alpha[unsigned(i)];
+            for (int c = 0; c < m; c++)
+                estimate[unsigned(c)] += a * rowI[c];
+
+            for (int q = 0; q < nrDrift; q++)
+            {
+                double w = driftWeights[unsigned(q * n + i)];
+                double* residualQ = &(driftResidual[unsigned(q * m)]);
+                for (int c = 0; c < m; c++)
+                    residualQ[c] += w * rowI[c];
+            }
+        }
 
-        for (i = 0; i < nrItems; i++)
+        mu.assign(unsigned(nrDrift * m), 0);
+        for (int c = 0; c < m; c++)
         {
-            V[i*dim +dim -1] = 1;
-            V[(dim-1)*dim +i] = 1;
+            getDrift(double(batchX[c]), double(batchY[c]), drift);
+            for (int q = 0; q < nrDrift; q++)
+                driftResidual[unsigned(q * m + c)] -= drift[q];
+
+            for (int q = 0; q < nrDrift; q++)
+                for (int r = 0; r < nrDrift; r++)
+                    mu[unsigned(q * m + c)] += driftSystemInv[unsigned(q * nrDrift + r)] * driftResidual[unsigned(r * m + c)];
+
+            double value = estimate[unsigned(c)];
+            for (int q = 0; q < nrDrift; q++)
+                value -= mu[unsigned(q * m + c)] * driftAlpha[unsigned(q)];
+            values[first + c] = float(value);
         }
-        V[(dim-1)*(dim)+i] = 0;
 
-        /*! calcola il variogramma e lo salva in V */
-        for (i = 0; i < nrItems; i++)
+        if (variances == nullptr) continue;
+
+        // L^-1 k: forward substitution of the batch
+        for (int i = 0; i < n; i++)
         {
-            for (j = i; j < nrItems; j++)
+            double* rowI = &(covariance[unsigned(i * m)]);
+            const double* choleskyI = &(cholesky[unsigned(i * n)]);
+            for (int k = 0; k < i; k++)
             {
-                tmp = Cd[i*dim+j] / range;
-                switch (mode)
-                {
-                /*! Spherical */
-                    case 1 :
-                            if (Cd[i*dim+j] < range)
-                            {
-                                V[i*dim+j] = V[j*dim+i] = nugget + sill_nugget *
-                                            (1.5 * tmp - 0.5 * tmp * tmp * tmp);
-                            }
-                            else V[i*dim+j] = V[j*dim+i] = nugget + sill_nugget;
-                            break;
-                /*! Exponential */
-                    case 2 :
-                            V[i*dim+j] = V[j*dim+i] = nugget + sill_nugget *
-                                        (1. - exp(-3.* tmp));
-                            break;
-
-                /*! Gaussian */
-                    case 3 :
-                            V[i*dim+j] = V[j*dim+i] = nugget + sill_nugget *
-                                        (1. - exp(-4.* tmp * tmp));
-                            break;
-
-                /*! Linear */
-                    case 4 :
-                            V[i*dim+j] = V[j*dim+i] = nugget + slope * Cd[i*dim+j];
-                            break;
-
-                /*! Default: linear */
-                    default:
-                            V[i*dim+j] = V[j*dim+i] = nugget + slope * Cd[i*dim+j];
-                            break;
-                }
+                double l = choleskyI[k];
+                const double* rowK = &(covariance[unsigned(k * m)]);
+                for (int c = 0; c < m; c++)
+                    rowI[c] -= l * rowK[c];
             }
+            double diagonal = choleskyI[i];
+            for (int c = 0; c < m; c++)
+                rowI[c] /= diagonal;
+        }
+
+        std::fill(estimate.begin(), estimate.end(), covarianceShift);
+        for (int i = 0; i < n; i++)
+        {
+            const double* rowI = &(covariance[unsigned(i * m)]);
+            for (int c = 0; c < m; c++)
+                estimate[unsigned(c)] -= rowI[c] * rowI[c];
         }
 
-        /*! inverte variogramma e libera memoria*/
-        matrixInversion(V);
+        for (int c = 0; c < m; c++)
+        {
+            double variance = estimate[unsigned(c)];
+            for (int q = 0; q < nrDrift; q++)
+                variance += driftResidual[unsigned(q * m + c)] * mu[unsigned(q * m + c)];
+            variances[first + c] = float(std::max(variance, 0.));
+        }
+    }
+}
 
-        free(Cd);
 
-        return true;
+// each model has a different generation: the neighbourhood caches of the threads are cleaned when it changes
+static std::atomic<long> krigingGeneration(0);
+
+struct TkrigingCache
+{
+    long generation = -1;
+    std::map<std::vector<int>, Crit3DKrigingSystem> systems;
+};
+
+static thread_local TkrigingCache krigingCache;
+
+
+Crit3DKriging::Crit3DKriging()
+{
+    clear();
+}
+
+
+void Crit3DKriging::clear()
+{
+    krigingPoints.clear();
+    krigingIndex.clear();
+    variogram = Crit3DVariogram();
+    type = KRIGING_ORDINARY;
+    nrNeighbours = 0;
+    excludeSupplemental = true;
+    indexPointCV = NODATA;
+    xRef = 0;
+    yRef = 0;
+    coordScale = 1;
+    globalSystem = Crit3DKrigingSystem();
+    generation = -1;
+
+    nrPoints = 0;
+    firstPoint = nullptr;
+    lastPoint = nullptr;
+}
+
+
+/*!
+ * \brief getSystem
+ * kriging system of the points in positions (universal kriging falls back to ordinary
+ * if the drift system is singular)
+ */
+bool Crit3DKriging::getSystem(const std::vector<int> &positions, Crit3DKrigingSystem* mySystem) const
+{
+    std::vector<double> x, y, z;
+    for (unsigned i = 0; i < positions.size(); i++)
+    {
+        const Crit3DInterpolationDataPoint* myPoint = &(krigingPoints[unsigned(positions[i])]);
+        x.push_back(myPoint->point->utm.x);
+        y.push_back(myPoint->point->utm.y);
+        z.push_back(double(myPoint->value));
     }
 
+    if (mySystem->initialize(x, y, z, variogram, type, xRef, yRef, coordScale))
+        return true;
+
+    return (type == KRIGING_UNIVERSAL
+            && mySystem->initialize(x, y, z, variogram, KRIGING_ORDINARY, xRef, yRef, coordScale));
+}
+
 
 /*!
- * \brief assegna i pesi dei punti misura rispetto a P(x,y) e li salva nella matrice weight
- * \param x_p x point
- * \param y_p y point
- * \return true on success, false otherwise
+ * \brief initialize
+ * the points used are the active points with data (supplemental points excluded
+ * as in interpolate, cross validation point excluded).
+ * The variogram is fitted on the residuals of the drift (least squares), if myVariogram is null.
+ * myNrNeighbours = 0: global system, factorized here
  */
-bool krigingSetWeight(double x_p, double y_p)
+bool Crit3DKriging::initialize(const std::vector <Crit3DInterpolationDataPoint> &myPoints, TkrigingType myType, int myNrNeighbours,
+                               bool myExcludeSupplemental, bool useLapseRateCode, int myIndexPointCV,
+                               const Crit3DVariogram* myVariogram)
+{
+    clear();
+    if (myPoints.empty()) return false;
+
+    type = myType;
+    excludeSupplemental = myExcludeSupplemental;
+    indexPointCV = myIndexPointCV;
+
+    std::vector<double> x, y, z;
+    for (unsigned i = 0; i < myPoints.size(); i++)
     {
-        int i, j;
-        double dx, dy, tmp, h;
+        const Crit3DInterpolationDataPoint* myPoint = &(myPoints[i]);
+        if (! myPoint->isActive || int(myPoint->value) == int(NODATA) || myPoint->index == indexPointCV)
+            continue;
+        if (excludeSupplemental && ! checkLapseRateCode(myPoint->lapseRateCode, useLapseRateCode, false))
+            continue;
+
+        krigingPoints.push_back(*myPoint);
+        x.push_back(myPoint->point->utm.x);
+        y.push_back(myPoint->point->utm.y);
+        z.push_back(double(myPoint->value));
+    }
+
+    unsigned n = unsigned(krigingPoints.size());
+    if (n == 0) return false;
+
+    double xMin = *std::min_element(x.begin(), x.end());
+    double xMax = *std::max_element(x.begin(), x.end());
+    double yMin = *std::min_element(y.begin(), y.end());
+    double yMax = *std::max_element(y.begin(), y.end());
+    xRef = (xMin + xMax) / 2;
+    yRef = (yMin + yMax) / 2;
+    coordScale = std::max(std::max(xMax - xMin, yMax - yMin), 1.);
 
-        /*! calcola le distanze tra P e i punti di misura e calcola il variogramma (memorizzato in D) */
-        for (i=0; i < dim-1; i++)
+    if (myVariogram != nullptr)
+        variogram = *myVariogram;
+    else
+    {
+        // residuals of the drift
+        std::vector<double> residuals = z;
+        if (type == KRIGING_UNIVERSAL && n > MAX_DRIFT)
+        {
+            std::vector<double> normal(MAX_DRIFT * MAX_DRIFT, 0), rhs(MAX_DRIFT, 0);
+            double f[MAX_DRIFT];
+            for (unsigned i = 0; i < n; i++)
             {
-            dx = pos[i*2] - x_p;
-            dy = pos[i*2+1] - y_p;
-            h = sqrt(dx * dx + dy * dy);
-            tmp = h / range;
-            switch( mode )
+                f[0] = 1;
+                f[1] = (x[i] - xRef) / coordScale;
+                f[2] = (y[i] - yRef) / coordScale;
+                for (int q = 0; q < MAX_DRIFT; q++)
                 {
-            /*! Sferico */
-                case 1 :
-                         if ( h < range )
-                            D[i] = nugget + sill_nugget * (1.5 * tmp - 0.5 * tmp * tmp * tmp);
-                         else
-                            D[i] = nugget + sill_nugget;
-                         break;
-            /*! Esponenziale */
-                case 2 :
-                         D[i] = nugget + sill_nugget * (1. - exp(-3.* tmp));
-                         break;
-
-            /*! Gaussiano */
-                case 3 :
-                         D[i] = nugget + sill_nugget * (1. - exp(-4.* tmp * tmp));
-                         break;
-
-            /*! Lineare */
-                case 4 :
-                         D[i] = nugget + slope * h;
-                         break;
-
-            /*! Default: Lineare */
-                default:
-                         D[i] = nugget + slope * h;
-                         break;
+                    rhs[unsigned(q)] += f[q] * z[i];
+                    for (int r = 0; r < MAX_DRIFT; r++)
+                        normal[unsigned(q * MAX_DRIFT + r)] += f[q] * f[r];
                 }
-        }
-        D[dim-1] = 1;
-
-        /*! calcola i pesi */
-        for (i=0; i < dim-1; i++)
-            {
-            weight[i] = 0;
-            for (j=0; j < dim; j++)
-                weight[i] += V[i*dim+j] * D[j];
             }
+            if (smallMatrixInversion(normal, MAX_DRIFT))
+                for (unsigned i = 0; i < n; i++)
+                {
+                    f[0] = 1;
+                    f[1] = (x[i] - xRef) / coordScale;
+                    f[2] = (y[i] - yRef) / coordScale;
+                    for (int q = 0; q < MAX_DRIFT; q++)
+                        for (int r = 0; r < MAX_DRIFT; r++)
+                            residuals[i] -= f[q] * normal[unsigned(q * MAX_DRIFT + r)] * rhs[unsigned(r)];
+                }
+        }
 
-        return true;
+        if (n < 2)
+            variogram.nugget = 1;
+        else if (! krigingFitVariogram(x, y, residuals, &variogram))
+            return false;
     }
 
+    nrNeighbours = (myNrNeighbours > 0 && unsigned(myNrNeighbours) < n) ? std::max(myNrNeighbours, 2 * MAX_DRIFT) : 0;
+    if (unsigned(nrNeighbours) >= n) nrNeighbours = 0;
 
-/*!
- * \brief return interpolated value in the point (x_p, y_p)
- * \return result
- */
-double krigingResult()
+    if (nrNeighbours == 0)
     {
-        double result = 0.0;
+        std::vector<int> positions(n);
+        for (unsigned i = 0; i < n; i++)
+            positions[i] = int(i);
+        if (! getSystem(positions, &globalSystem))
+            return false;
+    }
+    else
+        krigingIndex.initialize(krigingPoints);
 
-        for (int i=0; i < dim-1; i++)
-            result += weight[i] * val[i];
+    generation = ++krigingGeneration;
+    nrPoints = int(myPoints.size());
+    firstPoint = myPoints.front().point;
+    lastPoint = myPoints.back().point;
 
-        return result;
-    }
+    return true;
+}
 
 
+bool Crit3DKriging::isInitialized() const
+{
+    return (generation >= 0);
+}
+
 
 /*!
- * \brief Root Mean Square Error
- * \return result
+ * \brief isValid
+ * true if the model has been built on these points (or on a copy of them), with the same options
  */
-double krigingRMSE()
-    {
-        double error = 0.0;
+bool Crit3DKriging::isValid(const std::vector <Crit3DInterpolationDataPoint> &myPoints, bool myExcludeSupplemental, int myIndexPointCV) const
+{
+    return (generation >= 0 && int(myPoints.size()) == nrPoints
+            && myPoints.front().point == firstPoint && myPoints.back().point == lastPoint
+            && myExcludeSupplemental == excludeSupplemental && myIndexPointCV == indexPointCV);
+}
+
+
+const Crit3DVariogram& Crit3DKriging::getVariogram() const
+{
+    return variogram;
+}
+
 
-        for (int i=0; i < dim-1; i++)
-            error += weight[i] * D[i];
+/*!
+ * \brief estimate
+ * estimate (and variance, if variances is not null) of a batch of target points.
+ * Moving neighbourhood: consecutive targets with the same neighbours are solved together,
+ * the factorized systems are cached by the calling thread
+ */
+bool Crit3DKriging::estimate(int nrCells, const float* cellX, const float* cellY, float* values, float* variances) const
+{
+    if (generation < 0) return false;
 
-        return sqrt(fabs(error));
+    if (nrNeighbours == 0)
+    {
+        globalSystem.estimate(nrCells, cellX, cellY, values, variances);
+        return true;
     }
 
+    if (krigingCache.generation != generation)
+    {
+        krigingCache.systems.clear();
+        krigingCache.generation = generation;
+    }
 
+    std::vector<int> neighbours, nextNeighbours;
+    int first = 0;
+    if (nrCells > 0)
+    {
+        krigingIndex.getNearest(krigingPoints, cellX[0], cellY[0], unsigned(nrNeighbours), neighbours);
+        std::sort(neighbours.begin(), neighbours.end());
+    }
 
-void krigingFreeMemory()
+    while (first < nrCells)
     {
-        if (V != nullptr)
+        // consecutive targets with the same neighbours
+        int last = first + 1;
+        while (last < nrCells)
         {
-            free(V);
-            V = nullptr;
+            krigingIndex.getNearest(krigingPoints, cellX[last], cellY[last], unsigned(nrNeighbours), nextNeighbours);
+            std::sort(nextNeighbours.begin(), nextNeighbours.end());
+            if (nextNeighbours != neighbours) break;
+            last++;
         }
-        if (VM != nullptr)
-        {
-            free(VM);
-            VM = nullptr;
-        }
-        if (pos != nullptr)
-        {
-            free(pos);
-            pos = nullptr;
-        }
-        if (val != nullptr)
-        {
-            free(val);
-            val = nullptr;
-        }
-        if (D != nullptr)
-        {
-            free(D);
-            D = nullptr;
-        }
-        if (weight != nullptr)
+
+        auto it = krigingCache.systems.find(neighbours);
+        if (it == krigingCache.systems.end())
         {
-            free(weight);
-            weight = nullptr;
+            if (krigingCache.systems.size() >= KRIGING_CACHE_SIZE)
+                krigingCache.systems.clear();
+
+            Crit3DKrigingSystem mySystem;
+            if (! getSystem(neighbours, &mySystem))
+                return false;
+            it = krigingCache.systems.insert(std::make_pair(neighbours, mySystem)).first;
         }
+
+        it->second.estimate(last - first, cellX + first, cellY + first, values + first,
+                            (variances == nullptr) ? nullptr : variances + first);
+
+        first = last;
+        neighbours.swap(nextNeighbours);
     }
+
+    return true;
+}
@@ -1,17 +1,116 @@
 #ifndef KRIGING_H
 #define KRIGING_H
 
-    bool matrixInversion(double *A);
+    #include <vector>
 
-    bool krigingVariogram(double *myPos, double *mtVal, int nrItems, short myMode,
-                         double myRange, double myNugget, double mySill, double mySlope);
+    #ifndef INTERPOLATIONCONSTS_H
+        #include "interpolationConstants.h"
+    #endif
+    #ifndef SPATIALINDEX_H
+        #include "spatialIndex.h"
+    #endif
 
-    bool krigingSetWeight(double x_p, double y_p);
+    class Crit3DInterpolationDataPoint;
 
-    double krigingResult();
+    /*!
+     * \brief variogram model: spherical, exponential and gaussian are bounded (nugget, sill, range),
+     * linear is unbounded (nugget, slope)
+     */
+    class Crit3DVariogram
+    {
+    public:
+        TkrigingMode mode;
+        double nugget;
+        double sill;
+        double range;
+        double slope;
 
-    double krigingRMSE();
+        Crit3DVariogram();
+
+        double getSemivariance(double h) const;
+    };
+
+    bool krigingFitVariogram(const std::vector<double> &x, const std::vector<double> &y,
+                             const std::vector<double> &residuals, Crit3DVariogram* variogram);
+
+
+    /*!
+     * \brief kriging system of a set of points, factorized once:
+     * covariance C(h) = c - semivariance(h), Cholesky factor of the covariance matrix K
+     * and the terms of the solution that do not depend on the target point
+     * (drift: constant for ordinary kriging, constant and coordinates for universal kriging)
+     */
+    class Crit3DKrigingSystem
+    {
+    private:
+        int nrPoints;
+        int nrDrift;
+        Crit3DVariogram variogram;
+        double covarianceShift;
+        double xRef, yRef, coordScale;
+
+        std::vector<double> x, y;
+        std::vector<double> cholesky;           // lower triangular, nrPoints x nrPoints
+        std::vector<double> alpha;              // K^-1 z
+        std::vector<double> driftWeights;       // (K^-1 F)^T, nrDrift x nrPoints
+        std::vector<double> driftSystemInv;     // (F^T K^-1 F)^-1, nrDrift x nrDrift
+        std::vector<double> driftAlpha;         // F^T K^-1 z
+
+        double getCovariance(double h) const;
+        void getDrift(double myX, double myY, double* drift) const;
+
+    public:
+        Crit3DKrigingSystem();
+
+        int getNrPoints() const;
+
+        bool initialize(const std::vector<double> &myX, const std::vector<double> &myY, const std::vector<double> &myZ,
+                        const Crit3DVariogram &myVariogram, TkrigingType type,
+                        double myXRef, double myYRef, double myCoordScale);
+
+        void estimate(int nrCells, const float* cellX, const float* cellY, float* values, float* variances) const;
+    };
+
+
+    /*!
+     * \brief kriging model of the interpolation points of a timestep, built by preInterpolation:
+     * global system (all the points) or moving neighbourhood (the nearest nrNeighbours points,
+     * each neighbour set is factorized once and cached by the calling thread)
+     */
+    class Crit3DKriging
+    {
+    private:
+        std::vector <Crit3DInterpolationDataPoint> krigingPoints;
+        Crit3DSpatialIndex krigingIndex;
+        Crit3DVariogram variogram;
+        TkrigingType type;
+        int nrNeighbours;
+        bool excludeSupplemental;
+        int indexPointCV;
+        double xRef, yRef, coordScale;
+        Crit3DKrigingSystem globalSystem;
+        long generation;
+
+        int nrPoints;
+        gis::Crit3DPoint* firstPoint;
+        gis::Crit3DPoint* lastPoint;
+
+        bool getSystem(const std::vector<int> &positions, Crit3DKrigingSystem* mySystem) const;
+
+    public:
+        Crit3DKriging();
+
+        void clear();
+        bool initialize(const std::vector <Crit3DInterpolationDataPoint> &myPoints, TkrigingType myType, int myNrNeighbours,
+                        bool myExcludeSupplemental, bool useLapseRateCode, int myIndexPointCV,
+                        const Crit3DVariogram* myVariogram);
+
+        bool isInitialized() const;
+        bool isValid(const std::vector <Crit3DInterpolationDataPoint> &myPoints, bool myExcludeSupplemental, int myIndexPointCV) const;
+        const Crit3DVariogram& getVariogram() const;
+
+        bool estimate(int nrCells, const float* cellX, const float* cellY, float* values, float* variances) const;
+    };
 
-    void krigingFreeMemory();
 
 #endif // KRIGING_H
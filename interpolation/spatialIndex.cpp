@@ -0,0 +1,212 @@
+/*!
+    \copyright 2016 Fausto Tomei, Gabriele Antolini,
+    Alberto Pistocchi, Marco Bittelli, Antonio Volta, Laura Costantini
+
+    This file is part of CRITERIA3D.
+    CRITERIA3D has been developed under contract issued by A.R.P.A. Emilia-Romagna
+
+    CRITERIA3D is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    CRITERIA3D is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with CRITERIA3D.  If not, see <http://www.gnu.org/licenses/>.
+
+    contacts:
+    fausto.tomei@gmail.com
+    ftomei@arpae.it
+*/
+
+#include <math.h>
+#include <algorithm>
+
+#include "interpolationPoint.h"
+#include "spatialIndex.h"
+
+#define NRPOINTS_PER_BUCKET 2
+
+
+Crit3DSpatialIndex::Crit3DSpatialIndex()
+{
+    clear();
+}
+
+
+void Crit3DSpatialIndex::clear()
+{
+    xMin = 0;
+    yMin = 0;
+    bucketSize = 0;
+    nrRows = 0;
+    nrCols = 0;
+    first.clear();
+    positions.clear();
+
+    nrPoints = 0;
+    firstPoint = nullptr;
+    lastPoint = nullptr;
+}
+
+
+/*!
+ * \brief initialize
+ * the bucket size is chosen to have about NRPOINTS_PER_BUCKET points in each bucket
+ */
+void Crit3DSpatialIndex::initialize(const std::vector <Crit3DInterpolationDataPoint> &myPoints)
+{
+    clear();
+    if (myPoints.empty()) return;
+
+    double xMax, yMax;
+    xMin = xMax = myPoints[0].point->utm.x;
+    yMin = yMax = myPoints[0].point->utm.y;
+    for (unsigned i = 1; i < myPoints.size(); i++)
+    {
+        xMin = std::min(xMin, myPoints[i].point->utm.x);
+        xMax = std::max(xMax, myPoints[i].point->utm.x);
+        yMin = std::min(yMin, myPoints[i].point->utm.y);
+        yMax = std::max(yMax, myPoints[i].point->utm.y);
+    }
+
+    double area = std::max(xMax - xMin, 1.) * std::max(yMax - yMin, 1.);
+    bucketSize = sqrt(area * NRPOINTS_PER_BUCKET / myPoints.size());
+    nrCols = int((xMax - xMin) / bucketSize) + 1;
+    nrRows = int((yMax - yMin) / bucketSize) + 1;
+
+    // counting sort of the positions by bucket
+    std::vector<int> bucket(myPoints.size());
+    first.assign(unsigned(nrRows * nrCols + 1), 0);
+    for (unsigned i = 0; i < myPoints.size(); i++)
+    {
+        int col = std::min(int((myPoints[i].point->utm.x - xMin) / bucketSize), nrCols - 1);
+        int row = std::min(int((myPoints[i].point->utm.y - yMin) / bucketSize), nrRows - 1);
+        bucket[i] = row * nrCols + col;
+        first[unsigned(bucket[i] + 1)]++;
+    }
+    for (unsigned b = 1; b < first.size(); b++)
+        first[b] += first[b-1];
+
+    positions.resize(myPoints.size());
+    std::vector<int> next(first.begin(), first.end() - 1);
+    for (unsigned i = 0; i < myPoints.size(); i++)
+        positions[unsigned(next[unsigned(bucket[i])]++)] = int(i);
+
+    nrPoints = int(myPoints.size());
+    firstPoint = myPoints.front().point;
+    lastPoint = myPoints.back().point;
+}
+
+
+/*!
+ * \brief isValid
+ * true if the index has been built on these points (or on a copy of them)
+ */
+bool Crit3DSpatialIndex::isValid(const std::vector <Crit3DInterpolationDataPoint> &myPoints) const
+{
+    return (nrPoints > 0 && int(myPoints.size()) == nrPoints
+            && myPoints.front().point == firstPoint && myPoints.back().point == lastPoint);
+}
+
+
+double Crit3DSpatialIndex::getBucketSize() const
+{
+    return bucketSize;
+}
+
+
+static void getBucket(double xMin, double yMin, double bucketSize, int nrRows, int nrCols,
+                      float x, float y, int* row, int* col)
+{
+    *col = std::max(0, std::min(int(floor((x - xMin) / bucketSize)), nrCols - 1));
+    *row = std::max(0, std::min(int(floor((y - yMin) / bucketSize)), nrRows - 1));
+}
+
+
+/*!
+ * \brief getMaxRing
+ * the rings after this one are empty
+ */
+int Crit3DSpatialIndex::getMaxRing(float x, float y) const
+{
+    if (nrPoints == 0) return -1;
+
+    int row, col;
+    getBucket(xMin, yMin, bucketSize, nrRows, nrCols, x, y, &row, &col);
+
+    return std::max(std::max(row, nrRows - 1 - row), std::max(col, nrCols - 1 - col));
+}
+
+
+/*!
+ * \brief getRing
+ * append the positions of the points in the buckets of the ring
+ */
+void Crit3DSpatialIndex::getRing(float x, float y, int ring, std::vector<int> &outPositions) const
+{
+    if (nrPoints == 0 || ring < 0) return;
+
+    int row0, col0;
+    getBucket(xMin, yMin, bucketSize, nrRows, nrCols, x, y, &row0, &col0);
+
+    for (int row = std::max(0, row0 - ring); row <= std::min(nrRows - 1, row0 + ring); row++)
+    {
+        bool isBorderRow = (row == row0 - ring || row == row0 + ring);
+        int step = isBorderRow ? 1 : 2 * ring;
+
+        for (int col = col0 - ring; col <= col0 + ring; col += std::max(step, 1))
+        {
+            if (col < 0 || col >= nrCols) continue;
+
+            int b = row * nrCols + col;
+            for (int i = first[unsigned(b)]; i < first[unsigned(b + 1)]; i++)
+                outPositions.push_back(positions[unsigned(i)]);
+        }
+    }
+}
+
+
+/*!
+ * \brief getNearest
+ * positions of the nrNearest points nearest to (x, y), sorted by distance
+ * (myPoints are the points used to build the index)
+ */
+void Crit3DSpatialIndex::getNearest(const std::vector <Crit3DInterpolationDataPoint> &myPoints, float x, float y,
+                                    unsigned nrNearest, std::vector<int> &outPositions) const
+{
+    outPositions.clear();
+    if (nrPoints == 0 || nrNearest == 0) return;
+
+    std::vector<int> ringPositions;
+    std::vector< std::pair<double, int> > candidates;
+    int maxRing = getMaxRing(x, y);
+
+    for (int ring = 0; ring <= maxRing; ring++)
+    {
+        // the points of this ring are at least (ring - 1) * bucketSize far
+        if (candidates.size() >= nrNearest && candidates[nrNearest - 1].first < (ring - 1) * bucketSize)
+            break;
+
+        ringPositions.clear();
+        getRing(x, y, ring, ringPositions);
+        for (unsigned i = 0; i < ringPositions.size(); i++)
+        {
+            const gis::Crit3DPoint* myPoint = myPoints[unsigned(ringPositions[i])].point;
+            double dx = myPoint->utm.x - double(x);
+            double dy = myPoint->utm.y - double(y);
+            candidates.push_back(std::make_pair(sqrt(dx * dx + dy * dy), ringPositions[i]));
+        }
+
+        unsigned nrSorted = std::min(nrNearest, unsigned(candidates.size()));
+        std::partial_sort(candidates.begin(), candidates.begin() + nrSorted, candidates.end());
+        candidates.resize(nrSorted);
+    }
+
+    for (unsigned i = 0; i < candidates.size(); i++)
+        outPositions.push_back(candidates[i].second);
+}
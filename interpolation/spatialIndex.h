@@ -0,0 +1,47 @@
+#ifndef SPATIALINDEX_H
+#define SPATIALINDEX_H
+
+    #include <vector>
+
+    namespace gis
+    {
+        class Crit3DPoint;
+    }
+
+    class Crit3DInterpolationDataPoint;
+
+    /*!
+     * \brief uniform bucket grid over the coordinates of the interpolation points
+     * the points of each bucket are stored contiguously (first[bucket] .. first[bucket+1]),
+     * as positions in the vector of points used to build it.
+     * The queries visit the buckets in square rings around the bucket of (x, y):
+     * the points of ring r are at least (r-1) * bucketSize far from (x, y)
+     */
+    class Crit3DSpatialIndex
+    {
+    private:
+        double xMin, yMin;
+        double bucketSize;
+        int nrRows, nrCols;
+        std::vector<int> first;
+        std::vector<int> positions;
+
+        int nrPoints;
+        gis::Crit3DPoint* firstPoint;
+        gis::Crit3DPoint* lastPoint;
+
+    public:
+        Crit3DSpatialIndex();
+
+        void clear();
+        void initialize(const std::vector <Crit3DInterpolationDataPoint> &myPoints);
+        bool isValid(const std::vector <Crit3DInterpolationDataPoint> &myPoints) const;
+
+        double getBucketSize() const;
+        int getMaxRing(float x, float y) const;
+        void getRing(float x, float y, int ring, std::vector<int> &outPositions) const;
+        void getNearest(const std::vector <Crit3DInterpolationDataPoint> &myPoints, float x, float y,
+                        unsigned nrNearest, std::vector<int> &outPositions) const;
+    };
+
+#endif // SPATIALINDEX_H
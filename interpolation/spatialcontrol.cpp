@@ -4,6 +4,7 @@
 #include "commonConstants.h"
 #include "spatialControl.h"
 #include "interpolation.h"
+#include "topoDistanceCache.h"
 #include "statistics.h"
 
 float findThreshold(meteoVariable myVar, float value, float stdDev, float nrStdDev, float stdDevZ, float minDistance)
@@ -282,7 +283,6 @@ bool passDataToInterpolation(Crit3DMeteoPoint* meteoPoints, int nrMeteoPoints,
             myPoint.point->z = meteoPoints[i].point.z;
             myPoint.lapseRateCode = meteoPoints[i].lapseRateCode;
             myPoint.proxyValues = meteoPoints[i].proxyValues;
-            myPoint.topographicDistance = meteoPoints[i].topographicDistance;
             myPoint.isActive = true;
 
             if (int(xMin) == int(NODATA))
@@ -307,6 +307,11 @@ bool passDataToInterpolation(Crit3DMeteoPoint* meteoPoints, int nrMeteoPoints,
         }
     }
 
+    // maps of topographic distance (loaded or computed by the cache)
+    Crit3DTopoDistanceCache* topoDistanceCache = mySettings->getTopoDistanceCache();
+    if (mySettings->getUseTAD() && topoDistanceCache != nullptr && topoDistanceCache->isActive(mySettings->getCurrentDEM()))
+        topoDistanceCache->setPointsMaps(myInterpolationPoints, 0);
+
     if (nrValid > 0)
     {
         mySettings->computeShepardInitialRadius((xMax - xMin)*(yMax-yMin), nrValid);
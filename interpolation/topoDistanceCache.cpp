@@ -0,0 +1,582 @@
+/*!
+    \copyright 2016 Fausto Tomei, Gabriele Antolini,
+    Alberto Pistocchi, Marco Bittelli, Antonio Volta, Laura Costantini
+
+    This file is part of CRITERIA3D.
+    CRITERIA3D has been developed under contract issued by A.R.P.A. Emilia-Romagna
+
+    CRITERIA3D is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    CRITERIA3D is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with CRITERIA3D.  If not, see <http://www.gnu.org/licenses/>.
+
+    contacts:
+    fausto.tomei@gmail.com
+    ftomei@arpae.it
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "commonConstants.h"
+#include "gis.h"
+#include "interpolationConstants.h"
+#include "interpolationPoint.h"
+#include "topoDistanceCache.h"
+
+#define TOPODISTANCE_VERSION 1
+#define TOPODISTANCE_NODATA 65535
+
+struct TtopoDistanceHeader
+{
+    char magic[4];
+    int32_t version;
+    uint64_t demHash;
+    double x, y, z;                 // station
+    int32_t resolutionFactor;
+    int32_t nrRows, nrCols;
+    double xMin, yMax, cellSize;
+    float resolution;               // followed by nrRows * nrCols values (uint16)
+};
+
+
+static bool isSamePosition(double x1, double y1, double z1, const gis::Crit3DPoint &point)
+{
+    return (fabs(x1 - point.utm.x) < 0.05 && fabs(y1 - point.utm.y) < 0.05 && fabs(z1 - point.z) < 0.05);
+}
+
+
+/*!
+ * \brief getDemHash
+ * FNV-1a hash of the header and of the values of the DEM
+ */
+static uint64_t getDemHash(const gis::Crit3DRasterGrid &dem)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    auto addBytes = [&hash](const void* data, size_t size)
+    {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; i++)
+        {
+            hash ^= bytes[i];
+            hash *= 1099511628211ULL;
+        }
+    };
+
+    addBytes(&(dem.header->nrRows), sizeof(int));
+    addBytes(&(dem.header->nrCols), sizeof(int));
+    addBytes(&(dem.header->cellSize), sizeof(double));
+    addBytes(&(dem.header->llCorner->x), sizeof(double));
+    addBytes(&(dem.header->llCorner->y), sizeof(double));
+    addBytes(&(dem.header->flag), sizeof(float));
+    for (int row = 0; row < dem.header->nrRows; row++)
+        addBytes(dem.value[row], size_t(dem.header->nrCols) * sizeof(float));
+
+    return hash;
+}
+
+
+Crit3DTopoDistanceMap::Crit3DTopoDistanceMap()
+{
+    nrRows = 0;
+    nrCols = 0;
+    xMin = 0;
+    yMax = 0;
+    cellSize = 0;
+}
+
+
+/*!
+ * \brief compute
+ * topographic distance of the point from each map cell: with resolutionFactor 1 the cells of the DEM,
+ * otherwise from the central (or the first valid) DEM cell of each block
+ */
+bool Crit3DTopoDistanceMap::compute(const gis::Crit3DPoint &point, const gis::Crit3DRasterGrid &dem, int resolutionFactor)
+{
+    if (! dem.isLoaded || resolutionFactor < 1) return false;
+
+    nrRows = (dem.header->nrRows + resolutionFactor - 1) / resolutionFactor;
+    nrCols = (dem.header->nrCols + resolutionFactor - 1) / resolutionFactor;
+    cellSize = dem.header->cellSize * resolutionFactor;
+    xMin = dem.header->llCorner->x;
+    yMax = dem.header->llCorner->y + dem.header->nrRows * dem.header->cellSize;
+    values.assign(size_t(nrRows) * size_t(nrCols), TOPODISTANCE_NODATA);
+
+    float x, y, z, distance;
+    int demRow, demCol;
+
+    for (int row = 0; row < nrRows; row++)
+        for (int col = 0; col < nrCols; col++)
+        {
+            int firstRow = row * resolutionFactor;
+            int firstCol = col * resolutionFactor;
+            int lastRow = std::min(firstRow + resolutionFactor, dem.header->nrRows) - 1;
+            int lastCol = std::min(firstCol + resolutionFactor, dem.header->nrCols) - 1;
+
+            demRow = (firstRow + lastRow) / 2;
+            demCol = (firstCol + lastCol) / 2;
+            if (dem.value[demRow][demCol] == dem.header->flag)
+            {
+                demRow = NODATA;
+                for (int r = firstRow; r <= lastRow && demRow == NODATA; r++)
+                    for (int c = firstCol; c <= lastCol; c++)
+                        if (dem.value[r][c] != dem.header->flag)
+                        {
+                            demRow = r;
+                            demCol = c;
+                            break;
+                        }
+                if (demRow == NODATA) continue;
+            }
+
+            z = dem.value[demRow][demCol];
+            gis::getUtmXYFromRowColSinglePrecision(dem, demRow, demCol, &x, &y);
+            distance = gis::computeDistance(x, y, float(point.utm.x), float(point.utm.y));
+            float topoDistance = gis::topographicDistance(x, y, z, float(point.utm.x), float(point.utm.y),
+                                                          float(point.z), distance, dem);
+
+            long quantized = lround(topoDistance / TOPODISTANCE_RESOLUTION);
+            values[size_t(row) * size_t(nrCols) + size_t(col)] = uint16_t(std::min(quantized, long(TOPODISTANCE_NODATA - 1)));
+        }
+
+    return true;
+}
+
+
+/*!
+ * \brief getValue
+ * \return topographic distance [m] of the cell containing (x, y), NODATA outside the DEM
+ */
+float Crit3DTopoDistanceMap::getValue(float x, float y) const
+{
+    double dx = (double(x) - xMin) / cellSize;
+    double dy = (yMax - double(y)) / cellSize;
+    if (dx < 0 || dy < 0) return NODATA;
+
+    int row = int(dy);
+    int col = int(dx);
+    if (row >= nrRows || col >= nrCols) return NODATA;
+
+    uint16_t value = values[size_t(row) * size_t(nrCols) + size_t(col)];
+    if (value == TOPODISTANCE_NODATA) return NODATA;
+
+    return float(value * TOPODISTANCE_RESOLUTION);
+}
+
+
+size_t Crit3DTopoDistanceMap::getMemorySize() const
+{
+    return sizeof(Crit3DTopoDistanceMap) + values.size() * sizeof(uint16_t);
+}
+
+
+/*!
+ * \brief read
+ * \return false if the file is missing or it was written for another DEM, point or resolution
+ */
+bool Crit3DTopoDistanceMap::read(const std::string &fileName, uint64_t demHash, const gis::Crit3DPoint &point, int resolutionFactor)
+{
+    FILE* filePointer = fopen(fileName.c_str(), "rb");
+    if (filePointer == nullptr) return false;
+
+    TtopoDistanceHeader header;
+    bool isOk = (fread(&header, sizeof(TtopoDistanceHeader), 1, filePointer) == 1);
+
+    isOk = isOk && memcmp(header.magic, "TAD", 4) == 0 && header.version == TOPODISTANCE_VERSION
+            && header.demHash == demHash && header.resolutionFactor == resolutionFactor
+            && isSamePosition(header.x, header.y, header.z, point)
+            && header.resolution == float(TOPODISTANCE_RESOLUTION)
+            && header.nrRows > 0 && header.nrCols > 0;
+
+    if (isOk)
+    {
+        nrRows = header.nrRows;
+        nrCols = header.nrCols;
+        xMin = header.xMin;
+        yMax = header.yMax;
+        cellSize = header.cellSize;
+        values.resize(size_t(nrRows) * size_t(nrCols));
+        isOk = (fread(values.data(), sizeof(uint16_t), values.size(), filePointer) == values.size());
+    }
+
+    fclose(filePointer);
+
+    if (! isOk)
+    {
+        nrRows = 0;
+        nrCols = 0;
+        values.clear();
+    }
+
+    return isOk;
+}
+
+
+/*!
+ * \brief write
+ * the file is written with a temporary name and then renamed
+ */
+bool Crit3DTopoDistanceMap::write(const std::string &fileName, uint64_t demHash, const gis::Crit3DPoint &point, int resolutionFactor) const
+{
+    TtopoDistanceHeader header;
+    memset(&header, 0, sizeof(TtopoDistanceHeader));
+    memcpy(header.magic, "TAD", 4);
+    header.version = TOPODISTANCE_VERSION;
+    header.demHash = demHash;
+    header.x = point.utm.x;
+    header.y = point.utm.y;
+    header.z = point.z;
+    header.resolutionFactor = resolutionFactor;
+    header.nrRows = nrRows;
+    header.nrCols = nrCols;
+    header.xMin = xMin;
+    header.yMax = yMax;
+    header.cellSize = cellSize;
+    header.resolution = float(TOPODISTANCE_RESOLUTION);
+
+    std::string tmpFileName = fileName + ".tmp";
+    FILE* filePointer = fopen(tmpFileName.c_str(), "wb");
+    if (filePointer == nullptr) return false;
+
+    bool isOk = (fwrite(&header, sizeof(TtopoDistanceHeader), 1, filePointer) == 1);
+    isOk = isOk && (fwrite(values.data(), sizeof(uint16_t), values.size(), filePointer) == values.size());
+    isOk = (fclose(filePointer) == 0) && isOk;
+
+    if (isOk)
+    {
+        remove(fileName.c_str());
+        isOk = (rename(tmpFileName.c_str(), fileName.c_str()) == 0);
+    }
+    if (! isOk)
+        remove(tmpFileName.c_str());
+
+    return isOk;
+}
+
+
+Crit3DTopoDistanceCache::Crit3DTopoDistanceCache()
+{
+    dem = nullptr;
+    demHash = 0;
+    folder = "";
+    resolutionFactor = 1;
+    maxMemory = size_t(TOPODISTANCE_CACHE_MB) * 1024 * 1024;
+    memory = 0;
+}
+
+
+/*!
+ * \brief initialize
+ * the maps are computed on myDEM (it has to be initialized again when the DEM changes)
+ * and written in myFolder (it has to exist; empty: memory only)
+ */
+void Crit3DTopoDistanceCache::initialize(const gis::Crit3DRasterGrid* myDEM, const std::string &myFolder)
+{
+    clear();
+
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    dem = myDEM;
+    demHash = (myDEM != nullptr && myDEM->isLoaded) ? getDemHash(*myDEM) : 0;
+    folder = myFolder;
+    if (! folder.empty() && folder.back() != '/' && folder.back() != '\\')
+        folder += "/";
+}
+
+
+void Crit3DTopoDistanceCache::clear()
+{
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    maps.clear();
+    lruKeys.clear();
+    memory = 0;
+}
+
+
+bool Crit3DTopoDistanceCache::isActive(const gis::Crit3DRasterGrid* myDEM) const
+{
+    return (dem != nullptr && dem == myDEM && dem->isLoaded);
+}
+
+
+/*!
+ * \brief setResolutionFactor: map cell size = resolutionFactor * DEM cell size (the cached maps are released)
+ * 1 (default) reproduces the topographic distance of each cell (quantization only).
+ * Factor > 1 is not a default, it trades accuracy for time and memory: on DEM_ER_450m (250 stations)
+ * factor 4 computes the maps in 1/14 of the time and 1/16 of the memory, but 28% of the
+ * interpolated cells change by more than 0.01 (mean 0.02, max 1.9 degrees). Ini key: topographicDistanceFactor
+ */
+void Crit3DTopoDistanceCache::setResolutionFactor(int value)
+{
+    if (value < 1 || value == resolutionFactor) return;
+    clear();
+    resolutionFactor = value;
+}
+
+
+int Crit3DTopoDistanceCache::getResolutionFactor() const
+{
+    return resolutionFactor;
+}
+
+
+void Crit3DTopoDistanceCache::setMaxMemoryMB(int value)
+{
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    maxMemory = size_t(std::max(value, 0)) * 1024 * 1024;
+}
+
+
+int Crit3DTopoDistanceCache::getNrMaps()
+{
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    return int(maps.size());
+}
+
+
+size_t Crit3DTopoDistanceCache::getMemorySize()
+{
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    return memory;
+}
+
+
+std::string Crit3DTopoDistanceCache::getKey(const gis::Crit3DPoint &point) const
+{
+    char key[128];
+    snprintf(key, sizeof(key), "%.1f_%.1f_%.1f_%d", point.utm.x, point.utm.y, point.z, resolutionFactor);
+    return std::string(key);
+}
+
+
+std::shared_ptr<const Crit3DTopoDistanceMap> Crit3DTopoDistanceCache::findMap(const std::string &key)
+{
+    std::lock_guard<std::mutex> lock(cacheMutex);
+
+    auto it = maps.find(key);
+    if (it == maps.end()) return nullptr;
+
+    lruKeys.splice(lruKeys.begin(), lruKeys, it->second.second);
+    return it->second.first;
+}
+
+
+/*!
+ * \brief insertMap
+ * the least recently used maps are released over maxMemory (the last one is always kept)
+ * \return the map in the cache (another thread can have inserted it before)
+ */
+std::shared_ptr<const Crit3DTopoDistanceMap> Crit3DTopoDistanceCache::insertMap(const std::string &key, std::shared_ptr<const Crit3DTopoDistanceMap> myMap)
+{
+    std::lock_guard<std::mutex> lock(cacheMutex);
+
+    auto it = maps.find(key);
+    if (it != maps.end())
+        return it->second.first;
+
+    lruKeys.push_front(key);
+    maps[key] = std::make_pair(myMap, lruKeys.begin());
+    memory += myMap->getMemorySize();
+
+    while (memory > maxMemory && lruKeys.size() > 1)
+    {
+        auto itLast = maps.find(lruKeys.back());
+        memory -= itLast->second.first->getMemorySize();
+        maps.erase(itLast);
+        lruKeys.pop_back();
+    }
+
+    return myMap;
+}
+
+
+/*! \brief loadMap: read the file of the point, otherwise compute the map and write it */
+std::shared_ptr<const Crit3DTopoDistanceMap> Crit3DTopoDistanceCache::loadMap(const gis::Crit3DPoint &point)
+{
+    std::shared_ptr<Crit3DTopoDistanceMap> myMap = std::make_shared<Crit3DTopoDistanceMap>();
+    char hash[32];
+    snprintf(hash, sizeof(hash), "%016llx", (unsigned long long)demHash);
+    std::string fileName = folder + "TAD_" + hash + "_" + getKey(point) + ".bin";
+
+    if (! folder.empty() && myMap->read(fileName, demHash, point, resolutionFactor))
+        return myMap;
+
+    if (! myMap->compute(point, *dem, resolutionFactor))
+        return nullptr;
+
+    if (! folder.empty())
+        myMap->write(fileName, demHash, point, resolutionFactor);
+
+    return myMap;
+}
+
+
+std::shared_ptr<const Crit3DTopoDistanceMap> Crit3DTopoDistanceCache::getMap(const gis::Crit3DPoint &point)
+{
+    if (dem == nullptr || ! dem->isLoaded) return nullptr;
+
+    std::string key = getKey(point);
+    std::shared_ptr<const Crit3DTopoDistanceMap> myMap = findMap(key);
+    if (myMap != nullptr) return myMap;
+
+    myMap = loadMap(point);
+    if (myMap == nullptr) return nullptr;
+
+    return insertMap(key, myMap);
+}
+
+
+/*!
+ * \brief getMaps
+ * the maps that are not in memory are loaded (or computed) by nrThreads workers
+ * (0 = number of cores, the calling thread is one of them).
+ * Points with the same key (co-located stations) share one map: it is computed once
+ * progress (number of points done) is called by the calling thread, it can be empty
+ */
+bool Crit3DTopoDistanceCache::getMaps(const std::vector<const gis::Crit3DPoint*> &points,
+                                      std::vector<std::shared_ptr<const Crit3DTopoDistanceMap>> &outMaps,
+                                      int nrThreads, std::function<void(int)> progress)
+{
+    if (dem == nullptr || ! dem->isLoaded) return false;
+
+    outMaps.assign(points.size(), nullptr);
+
+    // missing maps: indices of the points of each key
+    std::map<std::string, std::vector<unsigned>> missingKeys;
+    int nrMissingPoints = 0;
+    for (unsigned i = 0; i < points.size(); i++)
+    {
+        std::string key = getKey(*(points[i]));
+        outMaps[i] = findMap(key);
+        if (outMaps[i] == nullptr)
+        {
+            missingKeys[key].push_back(i);
+            nrMissingPoints++;
+        }
+    }
+
+    if (! missingKeys.empty())
+    {
+        std::vector<const std::vector<unsigned>*> missing;
+        for (auto it = missingKeys.begin(); it != missingKeys.end(); ++it)
+            missing.push_back(&(it->second));
+
+        if (nrThreads <= 0)
+            nrThreads = int(std::thread::hardware_concurrency());
+        nrThreads = std::max(1, std::min(nrThreads, int(missing.size())));
+
+        std::atomic<int> nextMap(0);
+        std::atomic<int> nrFinishedThreads(0);
+        std::atomic<int> nrPointsDone(int(points.size()) - nrMissingPoints);
+
+        std::mutex progressMutex;
+        std::condition_variable progressChanged;
+        auto notifyProgress = [&]()
+        {
+            std::lock_guard<std::mutex> lock(progressMutex);
+            progressChanged.notify_one();
+        };
+
+        auto loadMaps = [&](bool isCallingThread)
+        {
+            int m;
+            while ((m = nextMap++) < int(missing.size()))
+            {
+                const std::vector<unsigned> &indices = *(missing[unsigned(m)]);
+                std::shared_ptr<const Crit3DTopoDistanceMap> myMap = getMap(*(points[indices[0]]));
+                for (unsigned k = 0; k < indices.size(); k++)
+                    outMaps[indices[k]] = myMap;
+
+                nrPointsDone += int(indices.size());
+                if (isCallingThread)
+                {
+                    if (progress) progress(nrPointsDone);
+                }
+                else
+                    notifyProgress();
+            }
+            nrFinishedThreads++;
+            notifyProgress();
+        };
+
+        std::vector<std::thread> workers;
+        for (int t = 1; t < nrThreads; t++)
+            workers.push_back(std::thread(loadMaps, false));
+
+        loadMaps(true);
+
+        // the calling thread reports the progress of the workers until they finish
+        int lastProgress = nrPointsDone;
+        while (nrFinishedThreads < nrThreads)
+        {
+            {
+                std::unique_lock<std::mutex> lock(progressMutex);
+                progressChanged.wait(lock, [&]{ return nrPointsDone != lastProgress || nrFinishedThreads == nrThreads; });
+            }
+
+            if (nrPointsDone != lastProgress)
+            {
+                lastProgress = nrPointsDone;
+                if (progress) progress(lastProgress);
+            }
+        }
+
+        for (unsigned t = 0; t < workers.size(); t++)
+            workers[t].join();
+    }
+
+    if (progress) progress(int(points.size()));
+
+    for (unsigned i = 0; i < outMaps.size(); i++)
+        if (outMaps[i] == nullptr) return false;
+
+    return true;
+}
+
+
+/*!
+ * \brief computeMaps
+ * compute (or load) the maps of all the points, e.g. to write the files before the interpolations
+ */
+bool Crit3DTopoDistanceCache::computeMaps(const std::vector<gis::Crit3DPoint> &points, int nrThreads, std::function<void(int)> progress)
+{
+    std::vector<const gis::Crit3DPoint*> pointers(points.size());
+    for (unsigned i = 0; i < points.size(); i++)
+        pointers[i] = &(points[i]);
+
+    std::vector<std::shared_ptr<const Crit3DTopoDistanceMap>> myMaps;
+    return getMaps(pointers, myMaps, nrThreads, progress);
+}
+
+
+/*!
+ * \brief setPointsMaps
+ * assign its map to each interpolation point (used by computeDistances)
+ */
+bool Crit3DTopoDistanceCache::setPointsMaps(std::vector <Crit3DInterpolationDataPoint> &myPoints, int nrThreads)
+{
+    std::vector<const gis::Crit3DPoint*> pointers(myPoints.size());
+    for (unsigned i = 0; i < myPoints.size(); i++)
+        pointers[i] = myPoints[i].point;
+
+    std::vector<std::shared_ptr<const Crit3DTopoDistanceMap>> myMaps;
+    bool isOk = getMaps(pointers, myMaps, nrThreads, nullptr);
+
+    for (unsigned i = 0; i < myPoints.size(); i++)
+        myPoints[i].topographicDistance = myMaps[i];
+
+    return isOk;
+}
@@ -0,0 +1,94 @@
+#ifndef TOPODISTANCECACHE_H
+#define TOPODISTANCECACHE_H
+
+    #include <stdint.h>
+    #include <vector>
+    #include <string>
+    #include <list>
+    #include <map>
+    #include <memory>
+    #include <mutex>
+    #include <functional>
+
+    namespace gis
+    {
+        class Crit3DPoint;
+        class Crit3DRasterGrid;
+    }
+
+    class Crit3DInterpolationDataPoint;
+
+    /*!
+     * \brief topographic distance of a station from the cells of the DEM
+     * (resolutionFactor x resolutionFactor DEM cells for each map cell),
+     * quantized with TOPODISTANCE_RESOLUTION [m] on 16 bits
+     */
+    class Crit3DTopoDistanceMap
+    {
+    private:
+        int nrRows, nrCols;
+        double xMin, yMax;
+        double cellSize;
+        std::vector<uint16_t> values;
+
+    public:
+        Crit3DTopoDistanceMap();
+
+        bool compute(const gis::Crit3DPoint &point, const gis::Crit3DRasterGrid &dem, int resolutionFactor);
+        bool read(const std::string &fileName, uint64_t demHash, const gis::Crit3DPoint &point, int resolutionFactor);
+        bool write(const std::string &fileName, uint64_t demHash, const gis::Crit3DPoint &point, int resolutionFactor) const;
+
+        float getValue(float x, float y) const;
+        size_t getMemorySize() const;
+    };
+
+
+    /*!
+     * \brief cache of the topographic distance maps of the stations on a DEM:
+     * the maps are loaded (or computed and written) when they are required,
+     * one binary file for each station: <folder>/TAD_<dem hash>_<x>_<y>_<z>_<resolution factor>.bin
+     * In memory the least recently used maps are released over maxMemory
+     * (the maps assigned to the interpolation points stay valid until the points are released)
+     */
+    class Crit3DTopoDistanceCache
+    {
+    private:
+        const gis::Crit3DRasterGrid* dem;
+        uint64_t demHash;
+        std::string folder;
+        int resolutionFactor;
+        size_t maxMemory;
+        size_t memory;
+
+        std::list<std::string> lruKeys;     // most recently used first
+        std::map<std::string, std::pair<std::shared_ptr<const Crit3DTopoDistanceMap>, std::list<std::string>::iterator>> maps;
+        std::mutex cacheMutex;
+
+        std::string getKey(const gis::Crit3DPoint &point) const;
+        std::shared_ptr<const Crit3DTopoDistanceMap> findMap(const std::string &key);
+        std::shared_ptr<const Crit3DTopoDistanceMap> insertMap(const std::string &key, std::shared_ptr<const Crit3DTopoDistanceMap> myMap);
+        std::shared_ptr<const Crit3DTopoDistanceMap> loadMap(const gis::Crit3DPoint &point);
+
+        bool getMaps(const std::vector<const gis::Crit3DPoint*> &points,
+                     std::vector<std::shared_ptr<const Crit3DTopoDistanceMap>> &outMaps,
+                     int nrThreads, std::function<void(int)> progress);
+
+    public:
+        Crit3DTopoDistanceCache();
+
+        void initialize(const gis::Crit3DRasterGrid* myDEM, const std::string &myFolder);
+        void clear();
+        bool isActive(const gis::Crit3DRasterGrid* myDEM) const;
+
+        void setResolutionFactor(int value);     // default 1: factor > 1 is faster but not exact (see .cpp)
+        int getResolutionFactor() const;
+        void setMaxMemoryMB(int value);
+        int getNrMaps();
+        size_t getMemorySize();
+
+        std::shared_ptr<const Crit3DTopoDistanceMap> getMap(const gis::Crit3DPoint &point);
+        bool computeMaps(const std::vector<gis::Crit3DPoint> &points, int nrThreads, std::function<void(int)> progress);
+        bool setPointsMaps(std::vector <Crit3DInterpolationDataPoint> &myPoints, int nrThreads);
+    };
+
+#endif // TOPODISTANCECACHE_H
@@ -66,6 +66,7 @@
     #define MEMORY_ERROR -2222
     #define TOPOGRAPHY_ERROR -3333
     #define BOUNDARY_ERROR -4444
+    #define FILE_ERROR -5555
     #define MISSING_DATA_ERROR -9999
     #define PARAMETER_ERROR -7777
 
@@ -90,6 +91,8 @@
     #define BOUNDARY_NONE 99
 
     #define RELAXATION 1
+    #define RELAXATION_MULTICOLOR 2
+    #define CONJUGATE_GRADIENT 3
 
     #define MAX_SOILS 1024
     #define MAX_SURFACES 1024
@@ -28,6 +28,8 @@
 #include "statistics.h"
 #include "furtherMathFunctions.h"
 #include <iostream> //debug
+#include <algorithm>
+#include <math.h>
 
 
 Crit3DMeteoGridStructure::Crit3DMeteoGridStructure()
@@ -44,7 +46,7 @@ void Crit3DMeteoGridStructure::setName(const std::string &name)
     _name = name;
 }
 
-gis::Crit3DGridHeader Crit3DMeteoGridStructure::header() const
+const gis::Crit3DGridHeader& Crit3DMeteoGridStructure::header() const
 {
     return _header;
 }
@@ -134,7 +136,7 @@ void Crit3DMeteoGridStructure::setIsDailyDataAvailable(bool isDailyDataAvailable
     _isDailyDataAvailable = isDailyDataAvailable;
 }
 
-Crit3DMeteoGridStructure Crit3DMeteoGrid::gridStructure() const
+const Crit3DMeteoGridStructure& Crit3DMeteoGrid::gridStructure() const
 {
     return _gridStructure;
 }
@@ -144,6 +146,9 @@ Crit3DMeteoGrid::Crit3DMeteoGrid()
     _isAggregationDefined = false;
     _gisSettings.utmZone = 32;
     _isElabValue = false;
+    _aggregationDemRows = 0;
+    _aggregationDemCols = 0;
+    _aggregationDemCellSize = NODATA;
     _firstDate = Crit3DDate(1,1,1800);
     _lastDate = Crit3DDate(1,1,1800);
 }
@@ -191,12 +196,12 @@ bool Crit3DMeteoGrid::createRasterGrid()
 }
 
 
-std::vector<std::vector<Crit3DMeteoPoint *> > Crit3DMeteoGrid::meteoPoints() const
+const std::vector<std::vector<Crit3DMeteoPoint *> >& Crit3DMeteoGrid::meteoPoints() const
 {
     return _meteoPoints;
 }
 
-Crit3DMeteoPoint Crit3DMeteoGrid::meteoPoint(int row, int col)
+Crit3DMeteoPoint& Crit3DMeteoGrid::meteoPoint(int row, int col)
 {
     return *(_meteoPoints[row][col]);
 }
@@ -300,7 +305,7 @@ bool Crit3DMeteoGrid::fillMeteoPointCurrentDailyValue(Crit3DDate date, meteoVari
     {
         for (int col = 0; col < _gridStructure.header().nrCols; col++)
         {
-            if (_meteoPoints[row][col]->active && _meteoPoints[row][col]->nrObsDataDaysD != 0)
+            if (_meteoPoints[row][col]->active && _meteoPoints[row][col]->getNrObsDataDaysD() != 0)
             {
                 _meteoPoints[row][col]->currentValue = _meteoPoints[row][col]->getMeteoPointValueD(date, variable);
             }
@@ -321,7 +326,7 @@ bool Crit3DMeteoGrid::fillMeteoPointCurrentHourlyValue(Crit3DDate date, int hour
     {
         for (int col = 0; col < _gridStructure.header().nrCols; col++)
         {
-            if (_meteoPoints[row][col]->active && _meteoPoints[row][col]->nrObsDataDaysD != 0)
+            if (_meteoPoints[row][col]->active && _meteoPoints[row][col]->nrObsDataDaysH != 0)
             {
                 _meteoPoints[row][col]->currentValue = _meteoPoints[row][col]->getMeteoPointValueH(date, hour, minute, variable);
             }
@@ -430,7 +435,7 @@ void Crit3DMeteoGrid::fillMeteoRasterClimateValue()
 
 }
 
-gis::Crit3DGisSettings Crit3DMeteoGrid::getGisSettings() const
+const gis::Crit3DGisSettings& Crit3DMeteoGrid::getGisSettings() const
 {
     return _gisSettings;
 }
@@ -473,6 +478,16 @@ bool Crit3DMeteoGrid::getMeteoPointActiveId(int row, int col, std::string* id)
     return false;
 }
 
+int Crit3DMeteoGrid::getNrActiveMeteoPoints()
+{
+    int nrActive = 0;
+    for (int row = 0; row < _gridStructure.header().nrRows; row++)
+        for (int col = 0; col < _gridStructure.header().nrCols; col++)
+            if (_meteoPoints[row][col]->active) nrActive++;
+
+    return nrActive;
+}
+
 bool Crit3DMeteoGrid::isActiveMeteoPointFromId(std::string id)
 {
 
@@ -508,250 +523,270 @@ bool Crit3DMeteoGrid::findFirstActiveMeteoPoint(std::string* id, int* row, int*
     return false;
 }
 
+/*!
+ * \brief findGridAggregationPoints
+ * sparse aggregation matrix (CSR) of the active cells: the DEM cells (linear index row * nrCols + col)
+ * whose center is inside each grid cell. Every DEM cell belongs to one grid cell, so the weights
+ * are all equal and they are not stored
+ */
 void Crit3DMeteoGrid::findGridAggregationPoints(gis::Crit3DRasterGrid* myDTM)
 {
     bool excludeNoData = false;
+    int nrRows = _gridStructure.header().nrRows;
+    int nrCols = _gridStructure.header().nrCols;
 
-    for (int row = 0; row < _gridStructure.header().nrRows; row++)
+    _aggregationFirst.assign(unsigned(nrRows * nrCols + 1), 0);
+    _aggregationDemIndex.clear();
+
+    for (int row = 0; row < nrRows; row++)
     {
-        for (int col = 0; col < _gridStructure.header().nrCols; col++)
+        for (int col = 0; col < nrCols; col++)
         {
+            _aggregationFirst[unsigned(row * nrCols + col)] = int(_aggregationDemIndex.size());
+            _meteoPoints[row][col]->aggregationPointsMaxNr = 0;
+
             if (_meteoPoints[row][col]->active)
             {
                 assignCellAggregationPoints(row, col, myDTM, excludeNoData);
             }
         }
     }
+    _aggregationFirst[unsigned(nrRows * nrCols)] = int(_aggregationDemIndex.size());
+    _aggregationDemIndex.shrink_to_fit();
+
+    _aggregationDemRows = myDTM->header->nrRows;
+    _aggregationDemCols = myDTM->header->nrCols;
+    _aggregationDemCellSize = myDTM->header->cellSize;
+    _aggregationDemCorner = *(myDTM->header->llCorner);
+
     _isAggregationDefined = true;
 }
 
+
+// add the DEM cells of the grid cell [row, col] to the aggregation matrix (sorted by DEM index)
 void Crit3DMeteoGrid::assignCellAggregationPoints(int row, int col, gis::Crit3DRasterGrid* myDTM, bool excludeNoData)
 {
-
-    gis::Crit3DUtmPoint utmLL, utmUR;
-    gis::Crit3DUtmPoint utmPoint;
-    gis::Crit3DPoint point;
-    gis::Crit3DUtmPoint v[4];
+    const gis::Crit3DRasterHeader& demHeader = *(myDTM->header);
+    double cellSize = demHeader.cellSize;
+    Crit3DMeteoPoint* meteoPoint = _meteoPoints[row][col];
 
     if (_gridStructure.isTIN())
     {
         //TO DO
     }
-    else
+    else if (_gridStructure.isUTM())
     {
-        if (_gridStructure.isUTM())
-        {
-
-            _meteoPoints[row][col]->aggregationPoints.clear();
+        // DEM cells with the center inside [center - dx/2, center + dx/2) x [center - dy/2, center + dy/2)
+        double x0 = meteoPoint->point.utm.x - _gridStructure.header().dx / 2;
+        double x1 = meteoPoint->point.utm.x + _gridStructure.header().dx / 2;
+        double y0 = meteoPoint->point.utm.y - _gridStructure.header().dy / 2;
+        double y1 = meteoPoint->point.utm.y + _gridStructure.header().dy / 2;
 
-            utmLL.x = _meteoPoints[row][col]->point.utm.x - (_gridStructure.header().dx / 2) + (myDTM->header->cellSize / 2);
-            utmUR.x = _meteoPoints[row][col]->point.utm.x + (_gridStructure.header().dx / 2);
-            utmLL.y = _meteoPoints[row][col]->point.utm.y - (_gridStructure.header().dy / 2) + (myDTM->header->cellSize / 2);
-            utmUR.y = _meteoPoints[row][col]->point.utm.y + (_gridStructure.header().dy / 2);
+        int firstCol = int(ceil((x0 - demHeader.llCorner->x) / cellSize - 0.5));
+        int lastCol = int(ceil((x1 - demHeader.llCorner->x) / cellSize - 0.5)) - 1;
+        // DEM rows are north to south
+        int lastRow = demHeader.nrRows - 1 - int(ceil((y0 - demHeader.llCorner->y) / cellSize - 0.5));
+        int firstRow = demHeader.nrRows - int(ceil((y1 - demHeader.llCorner->y) / cellSize - 0.5));
 
-            _meteoPoints[row][col]->aggregationPointsMaxNr = 0;
+        // all the positions of the cell, also outside the DEM
+        meteoPoint->aggregationPointsMaxNr = std::max(0, lastCol - firstCol + 1) * std::max(0, lastRow - firstRow + 1);
 
-            for (double x = utmLL.x; x < utmUR.x; x=x+myDTM->header->cellSize)
+        for (int demRow = std::max(firstRow, 0); demRow <= std::min(lastRow, demHeader.nrRows - 1); demRow++)
+        {
+            for (int demCol = std::max(firstCol, 0); demCol <= std::min(lastCol, demHeader.nrCols - 1); demCol++)
             {
-                for (double y = utmLL.y; x < utmUR.y; y=y+myDTM->header->cellSize)
+                if (!excludeNoData || myDTM->value[demRow][demCol] != demHeader.flag)
                 {
-                    _meteoPoints[row][col]->aggregationPointsMaxNr = _meteoPoints[row][col]->aggregationPointsMaxNr + 1;
-                    if (!excludeNoData || gis::getValueFromXY(*myDTM, x, y) != myDTM->header->flag )
-                    {
-                         utmPoint.x = x;
-                         utmPoint.y = y;
-                         point.utm = utmPoint;
-                         point.z = NODATA;
-                        _meteoPoints[row][col]->aggregationPoints.push_back(point);
-                    }
+                    _aggregationDemIndex.push_back(demRow * demHeader.nrCols + demCol);
                 }
             }
         }
-        else
-        {
-
-            gis::Crit3DGeoPoint pointLatLon0;
-            gis::Crit3DGeoPoint geoPoint;
-            pointLatLon0.latitude = _gridStructure.header().llCorner->latitude + row * _gridStructure.header().dy;
-            pointLatLon0.longitude = _gridStructure.header().llCorner->longitude + col * _gridStructure.header().dx;
-            gis::getUtmFromLatLon(_gisSettings.utmZone, pointLatLon0, &utmPoint);
-            v[0] = utmPoint;
-
-            geoPoint.latitude = pointLatLon0.latitude + _gridStructure.header().dy;
-            geoPoint.longitude = pointLatLon0.longitude;
-            gis::getUtmFromLatLon(_gisSettings.utmZone, geoPoint, &utmPoint);
-            v[1] = utmPoint;
-
-            geoPoint.latitude = pointLatLon0.latitude + _gridStructure.header().dy;
-            geoPoint.longitude = pointLatLon0.longitude + _gridStructure.header().dx;
-            gis::getUtmFromLatLon(_gisSettings.utmZone, geoPoint, &utmPoint);
-            v[2] = utmPoint;
-
-            geoPoint.latitude = pointLatLon0.latitude;
-            geoPoint.longitude = pointLatLon0.longitude + _gridStructure.header().dx;
-            gis::getUtmFromLatLon(_gisSettings.utmZone, geoPoint, &utmPoint);
-            v[3] = utmPoint;
+    }
+    else
+    {
+        gis::Crit3DGeoPoint pointLatLon0;
+        pointLatLon0.latitude = _gridStructure.header().llCorner->latitude + row * _gridStructure.header().dy;
+        pointLatLon0.longitude = _gridStructure.header().llCorner->longitude + col * _gridStructure.header().dx;
+        double lat1 = pointLatLon0.latitude + _gridStructure.header().dy;
+        double lon1 = pointLatLon0.longitude + _gridStructure.header().dx;
 
-            utmLL.x = minValue(v[0].x, v[1].x);
-            utmLL.y = minValue(v[0].y, v[3].y);
-            utmUR.x = maxValue(v[2].x, v[3].x);
-            utmUR.y = maxValue(v[1].y, v[2].y);
+        // UTM bounding box of the cell corners
+        gis::Crit3DUtmPoint v[4];
+        gis::Crit3DGeoPoint geoPoint;
+        for (int i = 0; i < 4; i++)
+        {
+            geoPoint.latitude = (i == 1 || i == 2) ? lat1 : pointLatLon0.latitude;
+            geoPoint.longitude = (i == 2 || i == 3) ? lon1 : pointLatLon0.longitude;
+            gis::getUtmFromLatLon(_gisSettings.utmZone, geoPoint, &(v[i]));
+        }
 
-            gis::Crit3DRasterCell demLL, demUR;
+        double xMin = std::min(std::min(v[0].x, v[1].x), std::min(v[2].x, v[3].x));
+        double xMax = std::max(std::max(v[0].x, v[1].x), std::max(v[2].x, v[3].x));
+        double yMin = std::min(std::min(v[0].y, v[1].y), std::min(v[2].y, v[3].y));
+        double yMax = std::max(std::max(v[0].y, v[1].y), std::max(v[2].y, v[3].y));
 
-            gis::getRowColFromXY(*myDTM, utmLL.x, utmLL.y, &demLL.row, &demLL.col);
-            gis::getRowColFromXY(*myDTM, utmUR.x, utmUR.y, &demUR.row, &demUR.col);
-            _meteoPoints[row][col]->aggregationPoints.clear();
-            _meteoPoints[row][col]->aggregationPointsMaxNr = 0;
+        int firstRow, lastRow, firstCol, lastCol;
+        gis::getRowColFromXY(demHeader, xMin, yMax, &firstRow, &firstCol);
+        gis::getRowColFromXY(demHeader, xMax, yMin, &lastRow, &lastCol);
 
-            if ( ((demUR.row >= 0) && (demUR.row < myDTM->header->nrRows)) || ((demLL.row >= 0) && (demLL.row < myDTM->header->nrRows))
-                 || ((demUR.col >= 0) && (demUR.col < myDTM->header->nrCols)) || ((demLL.col >= 0) && ( demLL.col < myDTM->header->nrCols)))
+        for (int demRow = std::max(firstRow, 0); demRow <= std::min(lastRow, demHeader.nrRows - 1); demRow++)
+        {
+            for (int demCol = std::max(firstCol, 0); demCol <= std::min(lastCol, demHeader.nrCols - 1); demCol++)
             {
+                double utmX, utmY, lat, lon;
+                gis::getUtmXYFromRowCol(demHeader, demRow, demCol, &utmX, &utmY);
+                gis::getLatLonFromUtm(_gisSettings, utmX, utmY, &lat, &lon);
 
-
-                for (int myDTMRow = demUR.row; myDTMRow < demLL.row; myDTMRow++)
+                // half-open cell: each DEM cell belongs to one grid cell
+                if (lat >= pointLatLon0.latitude && lat < lat1 && lon >= pointLatLon0.longitude && lon < lon1)
                 {
-                    for (int myDTMCol = demLL.col; myDTMCol < demUR.col; myDTMCol++)
+                    meteoPoint->aggregationPointsMaxNr++;
+                    if (!excludeNoData || myDTM->value[demRow][demCol] != demHeader.flag)
                     {
-                        double utmX, utmY;
-                        gis::Crit3DGeoPoint geoP;
-                        gis::Crit3DGridHeader latLonHeader;
-
-                        gis::getUtmXYFromRowCol(*(myDTM->header), myDTMRow, myDTMCol, &utmX, &utmY);
-                        gis::getLatLonFromUtm(_gisSettings, utmX, utmY, &geoP.latitude, &geoP.longitude);
-
-                        latLonHeader.llCorner->latitude = pointLatLon0.latitude;
-                        latLonHeader.llCorner->longitude = pointLatLon0.longitude;
-                        latLonHeader.dx = _gridStructure.header().dx;
-                        latLonHeader.dy = _gridStructure.header().dy;
-                        latLonHeader.nrRows = row;
-                        latLonHeader.nrCols = col;
-
-                        if (geoP.isInsideGrid(latLonHeader))
-                        {
-                            _meteoPoints[row][col]->aggregationPointsMaxNr = _meteoPoints[row][col]->aggregationPointsMaxNr + 1;
-                            if (!excludeNoData || myDTM->getValueFromRowCol(myDTMRow, myDTMCol) != myDTM->header->flag )
-                            {
-                                 gis::getUtmXYFromRowCol(*(myDTM->header), myDTMRow, myDTMCol, &utmX, &utmY);
-                                 utmPoint.x = utmX;
-                                 utmPoint.y = utmY;
-                                 point.utm = utmPoint;
-                                 point.z = NODATA;
-                                _meteoPoints[row][col]->aggregationPoints.push_back(point);
-                            }
-                        }
+                        _aggregationDemIndex.push_back(demRow * demHeader.nrCols + demCol);
                     }
                 }
             }
-
         }
     }
     // TO DO compute std deviation
 }
 
-void Crit3DMeteoGrid::aggregateMeteoGrid(meteoVariable myVar, frequencyType freq, Crit3DDate date, int  hour, int minute, gis::Crit3DRasterGrid* myDTM, gis::Crit3DRasterGrid dataRaster, gridAggregationMethod elab)
+
+// the aggregation matrix is defined on the DEM: the data raster has to be on the same grid
+bool Crit3DMeteoGrid::isAggregationRaster(const gis::Crit3DRasterHeader& rasterHeader) const
+{
+    return (rasterHeader.nrRows == _aggregationDemRows
+            && rasterHeader.nrCols == _aggregationDemCols
+            && rasterHeader.cellSize == _aggregationDemCellSize
+            && fabs(rasterHeader.llCorner->x - _aggregationDemCorner.x) < 0.01
+            && fabs(rasterHeader.llCorner->y - _aggregationDemCorner.y) < 0.01);
+}
+
+
+/*!
+ * \brief aggregateMeteoGrid
+ * aggregate dataRaster on the grid cells with the aggregation matrix of the DEM:
+ * a data raster on the DEM grid is read by index, otherwise (different header)
+ * the value of each DEM cell is read from its coordinates
+ * \return false if no grid cell is aggregated
+ */
+bool Crit3DMeteoGrid::aggregateMeteoGrid(meteoVariable myVar, frequencyType freq, Crit3DDate date, int  hour, int minute, gis::Crit3DRasterGrid* myDTM, gis::Crit3DRasterGrid* dataRaster, gridAggregationMethod elab)
 {
     int numberOfDays = 1;
     int initialize;
+    bool isAggregated = false;
 
     if (!_isAggregationDefined)
     {
         findGridAggregationPoints(myDTM);
     }
 
+    bool isDemRaster = isAggregationRaster(*(dataRaster->header));
+
     // TO DO
     //dbGridManagement.initializeStandardDeviation
 
+    int nrCols = _gridStructure.header().nrCols;
+    int demCols = dataRaster->header->nrCols;
+    float flag = dataRaster->header->flag;
+    std::vector<double> validValues;
 
-    for (int col = 0; col < _gridStructure.header().nrCols; col++)
+    for (int row = 0; row < _gridStructure.header().nrRows; row++)
     {
-        for (int row = 0; row < _gridStructure.header().nrRows; row++)
+        for (int col = 0; col < nrCols; col++)
         {
-            if (_meteoPoints[row][col]->active)
-            {
+            int first = _aggregationFirst[unsigned(row * nrCols + col)];
+            int last = _aggregationFirst[unsigned(row * nrCols + col + 1)];
 
-                double validValues = 0;
-                for (unsigned int i = 0; i < _meteoPoints[row][col]->aggregationPoints.size(); i++)
+            if (_meteoPoints[row][col]->active && last > first)
+            {
+                validValues.clear();
+                for (int i = first; i < last; i++)
                 {
-                    double x = _meteoPoints[row][col]->aggregationPoints[i].utm.x;
-                    double y = _meteoPoints[row][col]->aggregationPoints[i].utm.y;
-                    double interpolatedValue = gis::getValueFromXY(dataRaster, x, y);
-                    if (interpolatedValue != dataRaster.header->flag)
+                    int demIndex = _aggregationDemIndex[unsigned(i)];
+                    float value;
+                    if (isDemRaster)
+                    {
+                        value = dataRaster->value[demIndex / demCols][demIndex % demCols];
+                    }
+                    else
                     {
-                        _meteoPoints[row][col]->aggregationPoints[i].z = interpolatedValue;
-                        validValues = validValues + 1;
+                        // center of the DEM cell (DEM rows are north to south)
+                        double x = _aggregationDemCorner.x + (demIndex % _aggregationDemCols + 0.5) * _aggregationDemCellSize;
+                        double y = _aggregationDemCorner.y + (_aggregationDemRows - demIndex / _aggregationDemCols - 0.5) * _aggregationDemCellSize;
+                        value = gis::getValueFromXY(*dataRaster, x, y);
+                    }
+
+                    if (value != flag)
+                    {
+                        validValues.push_back(double(value));
                     }
                 }
 
-                if (!_meteoPoints[row][col]->aggregationPoints.empty())
+                if ( (double(validValues.size()) / _meteoPoints[row][col]->aggregationPointsMaxNr) > ( GRID_MIN_COVERAGE / 100 ) )
                 {
-
-                    if ( (validValues / _meteoPoints[row][col]->aggregationPointsMaxNr) > ( GRID_MIN_COVERAGE / 100 ) )
+                    double myValue = aggregateMeteoGridPoint(validValues, _meteoPoints[row][col]->aggregationPointsMaxNr, elab);
+                    isAggregated = true;
+                    // TO DO std dev
+                    //.stdDev = AggregateMeteoGridPoint(Definitions.ELAB_STDDEVIATION, MeteoGrid.Point(myRow, myCol))
+                    if (freq == hourly)
                     {
-
-                        double myValue = aggregateMeteoGridPoint(*(_meteoPoints[row][col]), elab);
-                        // TO DO std dev
-                        //.stdDev = AggregateMeteoGridPoint(Definitions.ELAB_STDDEVIATION, MeteoGrid.Point(myRow, myCol))
-                        if (freq == hourly)
+                        if (_meteoPoints[row][col]->nrObsDataDaysH == 0)
                         {
-                            if (_meteoPoints[row][col]->nrObsDataDaysH == 0)
-                            {
-                                initialize = 1;
-                            }
-                            else
-                            {
-                                _meteoPoints[row][col]->obsDataH[0].date = date;
-                                initialize = 0;
-                            }
-                            fillMeteoPointHourlyValue(row, col, numberOfDays, initialize, date, hour, minute, myVar, float(myValue));
-                            fillMeteoPointCurrentHourlyValue(date, hour, minute, myVar);
-                            //std::cout << "id: " << _meteoPoints[row][col]->id << "row: " << row << "col: " << col << " value: " << myValue << " currentValue: " << _meteoPoints[row][col]->currentValue <<std::endl;
-
+                            initialize = 1;
+                        }
+                        else
+                        {
+                            _meteoPoints[row][col]->obsDataH[0].date = date;
+                            initialize = 0;
+                        }
+                        fillMeteoPointHourlyValue(row, col, numberOfDays, initialize, date, hour, minute, myVar, float(myValue));
+                    }
+                    else if (freq == daily)
+                    {
+                        if (_meteoPoints[row][col]->getNrObsDataDaysD() == 0)
+                        {
+                            initialize = 1;
                         }
-                        else if (freq == daily)
+                        else
                         {
-                            if (_meteoPoints[row][col]->nrObsDataDaysD == 0)
-                            {
-                                initialize = 1;
-                            }
-                            else
-                            {
-                                _meteoPoints[row][col]->obsDataD[0].date = date;
-                                initialize = 0;
-                            }
-                            fillMeteoPointDailyValue(row, col, numberOfDays, initialize, date, myVar, float(myValue));
-                            fillMeteoPointCurrentDailyValue(date, myVar);
-                            //std::cout << "id: " << _meteoPoints[row][col]->id << " row: " << row << " col: " << col << " value: " << myValue << " currentValue: " << _meteoPoints[row][col]->currentValue <<std::endl;
+                            _meteoPoints[row][col]->firstDateD = date;
+                            initialize = 0;
                         }
+                        fillMeteoPointDailyValue(row, col, numberOfDays, initialize, date, myVar, float(myValue));
                     }
                 }
-
             }
         }
     }
-}
-
-
-double Crit3DMeteoGrid::aggregateMeteoGridPoint(Crit3DMeteoPoint myPoint, gridAggregationMethod elab)
-{
-
-    std::vector <double> validValues;
 
-
-    for (unsigned int i = 0; i < myPoint.aggregationPoints.size(); i++)
+    // current values of the whole grid: once, after all the cells are aggregated
+    if (isAggregated)
     {
-        if (myPoint.aggregationPoints[i].z != NODATA)
-        {
-            validValues.push_back(myPoint.aggregationPoints[i].z);
-        }
+        if (freq == hourly)
+            fillMeteoPointCurrentHourlyValue(date, hour, minute, myVar);
+        else if (freq == daily)
+            fillMeteoPointCurrentDailyValue(date, myVar);
     }
 
+    return isAggregated;
+}
+
+
+/*!
+ * \brief aggregateMeteoGridPoint
+ * \param validValues: values of the DEM cells of the grid cell (the order is modified by the median)
+ * \param nrPoints: number of DEM cells of the grid cell
+ */
+double Crit3DMeteoGrid::aggregateMeteoGridPoint(std::vector<double>& validValues, long nrPoints, gridAggregationMethod elab)
+{
     if (validValues.empty())
     {
         return NODATA;
     }
 
-    if ( (static_cast<double>(validValues.size()) / myPoint.aggregationPointsMaxNr) < ( GRID_MIN_COVERAGE / 100.0) )
+    if ( (static_cast<double>(validValues.size()) / nrPoints) < ( GRID_MIN_COVERAGE / 100.0) )
     {
         return NODATA;
     }
@@ -773,10 +808,9 @@ double Crit3DMeteoGrid::aggregateMeteoGridPoint(Crit3DMeteoPoint myPoint, gridAg
     {
         return NODATA;
     }
-
-
 }
 
+
 bool Crit3DMeteoGrid::getIsElabValue() const
 {
     return _isElabValue;
@@ -30,7 +30,7 @@ std::string getKeyStringAggregationMethod(gridAggregationMethod value);
             std::string name() const;
             void setName(const std::string &name);
 
-            gis::Crit3DGridHeader header() const;
+            const gis::Crit3DGridHeader& header() const;
             void setHeader(const gis::Crit3DGridHeader &header);
 
             int dataType() const;
@@ -84,13 +84,13 @@ std::string getKeyStringAggregationMethod(gridAggregationMethod value);
             Crit3DMeteoGrid();
             ~Crit3DMeteoGrid();
 
-            Crit3DMeteoGridStructure gridStructure() const;
+            const Crit3DMeteoGridStructure& gridStructure() const;
             void setGridStructure(const Crit3DMeteoGridStructure &gridStructure);
 
-            std::vector<std::vector<Crit3DMeteoPoint *> > meteoPoints() const;
+            const std::vector<std::vector<Crit3DMeteoPoint *> >& meteoPoints() const;
             void setMeteoPoints(const std::vector<std::vector<Crit3DMeteoPoint *> > &meteoPoints);
 
-            Crit3DMeteoPoint meteoPoint(int row, int col);
+            Crit3DMeteoPoint& meteoPoint(int row, int col);
             Crit3DMeteoPoint* meteoPointPointer(int row, int col);
 
             void setActive(int row, int col, bool active);
@@ -112,7 +112,7 @@ std::string getKeyStringAggregationMethod(gridAggregationMethod value);
             void fillMeteoRasterAnomalyPercValue();
             void fillMeteoRasterClimateValue();
 
-            gis::Crit3DGisSettings getGisSettings() const;
+            const gis::Crit3DGisSettings& getGisSettings() const;
             void setGisSettings(const gis::Crit3DGisSettings &gisSettings);
 
             void initMeteoPoints(int nRow, int nCol);
@@ -131,6 +131,8 @@ std::string getKeyStringAggregationMethod(gridAggregationMethod value);
 
             bool getMeteoPointActiveId(int row, int col, std::string *id);
 
+            int getNrActiveMeteoPoints();
+
             bool findFirstActiveMeteoPoint(std::string* id, int* row, int* col);
 
             bool isActiveMeteoPointFromId(std::string id);
@@ -139,9 +141,9 @@ std::string getKeyStringAggregationMethod(gridAggregationMethod value);
 
             void assignCellAggregationPoints(int row, int col, gis::Crit3DRasterGrid* myDTM, bool excludeNoData);
 
-            void aggregateMeteoGrid(meteoVariable myVar, frequencyType freq, Crit3DDate date, int  hour, int minute, gis::Crit3DRasterGrid* myDTM, gis::Crit3DRasterGrid dataRaster, gridAggregationMethod elab);
+            bool aggregateMeteoGrid(meteoVariable myVar, frequencyType freq, Crit3DDate date, int  hour, int minute, gis::Crit3DRasterGrid* myDTM, gis::Crit3DRasterGrid* dataRaster, gridAggregationMethod elab);
 
-            double aggregateMeteoGridPoint(Crit3DMeteoPoint myPoint, gridAggregationMethod elab);
+            double aggregateMeteoGridPoint(std::vector<double>& validValues, long nrPoints, gridAggregationMethod elab);
 
 
             bool getIsElabValue() const;
@@ -157,6 +159,17 @@ std::string getKeyStringAggregationMethod(gridAggregationMethod value);
             Crit3DDate _firstDate;
             Crit3DDate _lastDate;
             bool _isElabValue;
+
+            // sparse aggregation matrix (CSR): DEM cells of the grid cell i are
+            // _aggregationDemIndex[_aggregationFirst[i] .. _aggregationFirst[i+1]), i = row * nrCols + col
+            std::vector<int> _aggregationFirst;
+            std::vector<int> _aggregationDemIndex;
+            int _aggregationDemRows;
+            int _aggregationDemCols;
+            double _aggregationDemCellSize;
+            gis::Crit3DUtmPoint _aggregationDemCorner;
+
+            bool isAggregationRaster(const gis::Crit3DRasterHeader& rasterHeader) const;
     };
 
 
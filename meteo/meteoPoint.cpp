@@ -26,11 +26,90 @@
 
 #include <malloc.h>
 #include <math.h>
+#include <algorithm>
+#include <string.h>
 
 #include "commonConstants.h"
 #include "meteoPoint.h"
 
 
+// hourly float variables stored in obsDataHColumns
+enum hourlyColumn {tAirColumn, precColumn, rhAirColumn, tDewColumn, irradianceColumn,
+                   et0Column, windIntColumn, transmissivityColumn, nrHourlyColumns};
+
+
+int getHourlyColumnIndex(meteoVariable myVar)
+{
+    switch(myVar)
+    {
+        case airTemperature:
+            return tAirColumn;
+        case precipitation:
+            return precColumn;
+        case airRelHumidity:
+            return rhAirColumn;
+        case airDewTemperature:
+            return tDewColumn;
+        case globalIrradiance:
+            return irradianceColumn;
+        case referenceEvapotranspiration:
+            return et0Column;
+        case windIntensity:
+            return windIntColumn;
+        case atmTransmissivity:
+            return transmissivityColumn;
+        default:
+            return NODATA;
+    }
+}
+
+
+// daily variables stored in obsDataDColumns
+enum dailyColumn {tMinColumnD, tMaxColumnD, tAvgColumnD, precColumnD, rhMinColumnD, rhMaxColumnD, rhAvgColumnD,
+                  globRadColumnD, et0HsColumnD, et0PmColumnD, windIntAvgColumnD, windDirPrevColumnD,
+                  windIntMaxColumnD, leafWColumnD, waterTableColumnD, nrDailyColumns};
+
+
+int getDailyColumnIndex(meteoVariable myVar)
+{
+    switch(myVar)
+    {
+        case dailyAirTemperatureMin:
+            return tMinColumnD;
+        case dailyAirTemperatureMax:
+            return tMaxColumnD;
+        case dailyAirTemperatureAvg:
+            return tAvgColumnD;
+        case dailyPrecipitation:
+            return precColumnD;
+        case dailyAirRelHumidityMin:
+            return rhMinColumnD;
+        case dailyAirRelHumidityMax:
+            return rhMaxColumnD;
+        case dailyAirRelHumidityAvg:
+            return rhAvgColumnD;
+        case dailyGlobalRadiation:
+            return globRadColumnD;
+        case dailyReferenceEvapotranspirationHS:
+            return et0HsColumnD;
+        case dailyReferenceEvapotranspirationPM:
+            return et0PmColumnD;
+        case dailyWindIntensityAvg:
+            return windIntAvgColumnD;
+        case dailyWindDirectionPrevailing:
+            return windDirPrevColumnD;
+        case dailyWindIntensityMax:
+            return windIntMaxColumnD;
+        case dailyLeafWetness:
+            return leafWColumnD;
+        case dailyWaterTableDepth:
+            return waterTableColumnD;
+        default:
+            return NODATA;
+    }
+}
+
+
 Crit3DMeteoPoint::Crit3DMeteoPoint()
 {
     this->dataset = "";
@@ -59,7 +138,9 @@ Crit3DMeteoPoint::Crit3DMeteoPoint()
     this->hourlyFraction = 1;
 
     this->obsDataH = nullptr;
-    this->obsDataD = nullptr;
+    this->obsDataHColumns = nullptr;
+    this->obsDataHLeafW = nullptr;
+    this->obsDataDColumns = nullptr;
 
     this->currentValue = NODATA;
     this->residual = NODATA;
@@ -76,7 +157,6 @@ Crit3DMeteoPoint::Crit3DMeteoPoint()
 
     proxyValues.clear();
     lapseRateCode = primary;
-    topographicDistance = nullptr;
 }
 
 
@@ -86,37 +166,52 @@ void Crit3DMeteoPoint::initializeObsDataH(int myHourlyFraction, int numberOfDays
 
     nrObsDataDaysH = numberOfDays;
     hourlyFraction = myHourlyFraction;
-    int nrDayValues = hourlyFraction * 24 + 1;
-    obsDataH = (TObsDataH *) calloc(unsigned(numberOfDays), sizeof(TObsDataH));
     quality = quality::missing_data;
     residual = NODATA;
 
+    // one contiguous column per variable
+    size_t nrValues = size_t(numberOfDays) * size_t(nrDayValuesH());
+    obsDataH = (TObsDataH *) calloc(unsigned(numberOfDays), sizeof(TObsDataH));
+    obsDataHColumns = (float *) malloc(nrValues * nrHourlyColumns * sizeof(float));
+    obsDataHLeafW = (int *) malloc(nrValues * sizeof(int));
+
+    std::fill(obsDataHColumns, obsDataHColumns + nrValues * nrHourlyColumns, float(NODATA));
+    std::fill(obsDataHLeafW, obsDataHLeafW + nrValues, int(NODATA));
+
+    int dayNumber = getDayNumberFromDate(firstDate);
     for (int i = 0; i < numberOfDays; i++)
     {
-        obsDataH[i].date = firstDate.addDays(i);
-        obsDataH[i].tAir = (float *) calloc(unsigned(nrDayValues), sizeof(float));
-        obsDataH[i].prec = (float *) calloc(unsigned(nrDayValues), sizeof(float));
-        obsDataH[i].rhAir = (float *) calloc(unsigned(nrDayValues), sizeof(float));
-        obsDataH[i].tDew = (float *) calloc(unsigned(nrDayValues), sizeof(float));
-        obsDataH[i].irradiance = (float *) calloc(unsigned(nrDayValues), sizeof(float));
-        obsDataH[i].et0 = (float *) calloc(unsigned(nrDayValues), sizeof(float));
-        obsDataH[i].windInt = (float *) calloc(unsigned(nrDayValues), sizeof(float));
-        obsDataH[i].leafW = (int *) calloc(unsigned(nrDayValues), sizeof(int));
-        obsDataH[i].transmissivity = (float *) calloc(unsigned(nrDayValues), sizeof(float));
-        for (int j = 0; j < nrDayValues; j++)
-        {
-            obsDataH[i].tAir[j] = NODATA;
-            obsDataH[i].prec[j] = NODATA;
-            obsDataH[i].rhAir[j] = NODATA;
-            obsDataH[i].tDew[j] = NODATA;
-            obsDataH[i].irradiance[j] = NODATA;
-            obsDataH[i].et0[j] = NODATA;
-            obsDataH[i].windInt[j] = NODATA;
-            obsDataH[i].leafW[j] = NODATA;
-            obsDataH[i].transmissivity[j] = NODATA;
-        }
+        size_t first = size_t(i) * size_t(nrDayValuesH());
+        obsDataH[i].date = getDateFromDayNumber(dayNumber + i);
+        obsDataH[i].tAir = obsDataHColumns + tAirColumn * nrValues + first;
+        obsDataH[i].prec = obsDataHColumns + precColumn * nrValues + first;
+        obsDataH[i].rhAir = obsDataHColumns + rhAirColumn * nrValues + first;
+        obsDataH[i].tDew = obsDataHColumns + tDewColumn * nrValues + first;
+        obsDataH[i].irradiance = obsDataHColumns + irradianceColumn * nrValues + first;
+        obsDataH[i].et0 = obsDataHColumns + et0Column * nrValues + first;
+        obsDataH[i].windInt = obsDataHColumns + windIntColumn * nrValues + first;
+        obsDataH[i].transmissivity = obsDataHColumns + transmissivityColumn * nrValues + first;
+        obsDataH[i].leafW = obsDataHLeafW + first;
     }
+}
 
+
+// number of values of each day (the last one is the 00:00 of the next day)
+int Crit3DMeteoPoint::nrDayValuesH() const
+{
+    return hourlyFraction * 24 + 1;
+}
+
+
+// contiguous column of an hourly variable: value of day i, index h is [i * nrDayValuesH() + h]
+// nullptr if the data are not loaded or myVar is not a float hourly variable (leaf wetness)
+float* Crit3DMeteoPoint::getHourlyColumn(meteoVariable myVar)
+{
+    int column = getHourlyColumnIndex(myVar);
+    if (obsDataHColumns == nullptr || column == NODATA)
+        return nullptr;
+
+    return obsDataHColumns + size_t(column) * size_t(nrObsDataDaysH) * size_t(nrDayValuesH());
 }
 
 void Crit3DMeteoPoint::initializeObsDataD(int numberOfDays, const Crit3DDate& firstDate)
@@ -124,28 +219,44 @@ void Crit3DMeteoPoint::initializeObsDataD(int numberOfDays, const Crit3DDate& fi
     this->cleanObsDataD();
 
     nrObsDataDaysD = numberOfDays;
-    obsDataD = (TObsDataD *) calloc(unsigned(numberOfDays), sizeof(TObsDataD));
+    firstDateD = firstDate;
+
+    // one contiguous column per variable
+    size_t nrValues = size_t(numberOfDays) * nrDailyColumns;
+    obsDataDColumns = (float *) malloc(nrValues * sizeof(float));
+    std::fill(obsDataDColumns, obsDataDColumns + nrValues, float(NODATA));
 
     quality = quality::missing_data;
     residual = NODATA;
+}
 
-    for (int i = 0; i < numberOfDays; i++)
-    {
-        obsDataD[i].date = firstDate.addDays(i);
-        obsDataD[i].tMax = NODATA;
-        obsDataD[i].tMin = NODATA;
-        obsDataD[i].tAvg = NODATA;
-        obsDataD[i].prec = NODATA;
-        obsDataD[i].rhMax = NODATA;
-        obsDataD[i].rhMin = NODATA;
-        obsDataD[i].rhAvg = NODATA;
-        obsDataD[i].globRad = NODATA;
-        obsDataD[i].et0_hs = NODATA;
-        obsDataD[i].et0_pm = NODATA;
-        obsDataD[i].windIntAvg = NODATA;
-        obsDataD[i].windDirPrev = NODATA;
-        obsDataD[i].waterTable = NODATA;
-    }
+
+// contiguous column of a daily variable: value of day i is [i]
+// nullptr if the data are not loaded or myVar is not a daily variable
+float* Crit3DMeteoPoint::getDailyColumn(meteoVariable myVar)
+{
+    int column = getDailyColumnIndex(myVar);
+    if (obsDataDColumns == nullptr || column == NODATA)
+        return nullptr;
+
+    return obsDataDColumns + size_t(column) * size_t(nrObsDataDaysD);
+}
+
+
+// values of myVar from firstDate to lastDate, limited to the loaded days
+// the view is empty if the interval does not intersect the loaded data
+TDailySeries Crit3DMeteoPoint::getDailySeries(meteoVariable myVar, const Crit3DDate& firstDate, const Crit3DDate& lastDate)
+{
+    float* column = getDailyColumn(myVar);
+    if (column == nullptr)
+        return TDailySeries();
+
+    long first = std::max(0L, long(firstDateD.daysTo(firstDate)));
+    long last = std::min(nrObsDataDaysD - 1, long(firstDateD.daysTo(lastDate)));
+    if (first > last)
+        return TDailySeries();
+
+    return TDailySeries(column + first, last - first + 1);
 }
 
 void Crit3DMeteoPoint::initializeObsDataM(int numberOfMonths, int month, int year)
@@ -192,103 +303,41 @@ void Crit3DMeteoPoint::initializeObsDataM(int numberOfMonths, int month, int yea
 
 void Crit3DMeteoPoint::emptyVarObsDataH(meteoVariable myVar, const Crit3DDate& myDate)
 {
-    if (! isDateLoadedH(myDate)) return;
-
-    int nrDayValues = hourlyFraction * 24 + 1;
-    int i = obsDataH[0].date.daysTo(myDate);
-    residual = NODATA;
-
-    if (i>=0 && i<nrObsDataDaysH)
-        if (obsDataH[i].date == myDate)
-            for (int j = 0; j < nrDayValues; j++)
-            {
-                if (myVar == airTemperature)
-                    obsDataH[i].tAir[j] = NODATA;
-                else if (myVar == precipitation)
-                    obsDataH[i].prec[j] = NODATA;
-                else if (myVar == airRelHumidity)
-                    obsDataH[i].rhAir[j] = NODATA;
-                else if (myVar == airDewTemperature)
-                    obsDataH[i].tDew[j] = NODATA;
-                else if (myVar == globalIrradiance)
-                    obsDataH[i].irradiance[j] = NODATA;
-                else if (myVar == windIntensity)
-                    obsDataH[i].windInt[j] = NODATA;
-                else if (myVar == leafWetness)
-                    obsDataH[i].leafW[j] = NODATA;
-                else if (myVar == atmTransmissivity)
-                    obsDataH[i].transmissivity[j] = NODATA;
-				else if (myVar == referenceEvapotranspiration)
-                    obsDataH[i].et0[j] = NODATA;										  
-			}
+    emptyVarObsDataH(myVar, myDate, myDate);
 }
 
 void Crit3DMeteoPoint::emptyVarObsDataH(meteoVariable myVar, const Crit3DDate& date1, const Crit3DDate& date2)
 {
     if (! isDateIntervalLoadedH(date1, date2)) return;
 
-    int nrDayValues = hourlyFraction * 24 + 1;
     int indexIni = obsDataH[0].date.daysTo(date1);
     int indexFin = obsDataH[0].date.daysTo(date2);
+    size_t first = size_t(indexIni) * size_t(nrDayValuesH());
+    size_t last = size_t(indexFin + 1) * size_t(nrDayValuesH());
     residual = NODATA;
 
-    for (int i = indexIni; i <= indexFin; i++)
-        for (int j = 0; j < nrDayValues; j++)
-        {
-            if (myVar == airTemperature)
-                obsDataH[i].tAir[j] = NODATA;
-            else if (myVar == precipitation)
-                obsDataH[i].prec[j] = NODATA;
-            else if (myVar == airRelHumidity)
-                obsDataH[i].rhAir[j] = NODATA;
-            else if (myVar == airDewTemperature)
-                obsDataH[i].tDew[j] = NODATA;
-            else if (myVar == globalIrradiance)
-                obsDataH[i].irradiance[j] = NODATA;
-            else if (myVar == windIntensity)
-                obsDataH[i].windInt[j] = NODATA;
-            else if (myVar == leafWetness)
-                obsDataH[i].leafW[j] = NODATA;
-            else if (myVar == atmTransmissivity)
-                obsDataH[i].transmissivity[j] = NODATA;
-			else if (myVar == referenceEvapotranspiration)
-                obsDataH[i].et0[j] = NODATA;
-        }
+    if (myVar == leafWetness)
+    {
+        std::fill(obsDataHLeafW + first, obsDataHLeafW + last, int(NODATA));
+        return;
+    }
+
+    float* column = getHourlyColumn(myVar);
+    if (column != nullptr)
+        std::fill(column + first, column + last, float(NODATA));
 }
 
 void Crit3DMeteoPoint::emptyVarObsDataD(meteoVariable myVar, const Crit3DDate& date1, const Crit3DDate& date2)
 {
-    if (! isDateIntervalLoadedH(date1, date2)) return;
+    if (! isDateIntervalLoadedD(date1, date2)) return;
 
-    int indexIni = obsDataD[0].date.daysTo(date1);
-    int indexFin = obsDataD[0].date.daysTo(date2);
+    int indexIni = firstDateD.daysTo(date1);
+    int indexFin = firstDateD.daysTo(date2);
     residual = NODATA;
 
-    for (int i = indexIni; i <= indexFin; i++)
-        if (myVar == dailyAirTemperatureMax)
-            obsDataD[i].tMax = NODATA;
-        else if (myVar == dailyAirTemperatureMin)
-            obsDataD[i].tMin = NODATA;
-        else if (myVar == dailyAirTemperatureMin)
-            obsDataD[i].tAvg = NODATA;
-        else if (myVar == dailyPrecipitation)
-            obsDataD[i].prec = NODATA;
-        else if (myVar == dailyAirRelHumidityMax)
-            obsDataD[i].rhMax = NODATA;
-        else if (myVar == dailyAirRelHumidityMin)
-            obsDataD[i].rhMin = NODATA;
-        else if (myVar == dailyAirRelHumidityAvg)
-            obsDataD[i].rhAvg = NODATA;
-        else if (myVar == dailyGlobalRadiation)
-            obsDataD[i].globRad = NODATA;
-        else if (myVar == dailyWindIntensityAvg)
-            obsDataD[i].windIntAvg = NODATA;
-        else if (myVar == dailyReferenceEvapotranspirationHS)
-            obsDataD[i].et0_hs = NODATA;
-        else if (myVar == dailyReferenceEvapotranspirationPM)
-            obsDataD[i].et0_pm = NODATA;
-        else if (myVar == dailyLeafWetness)
-            obsDataD[i].leafW = NODATA;
+    float* column = getDailyColumn(myVar);
+    if (column != nullptr)
+        std::fill(column + indexIni, column + indexFin + 1, float(NODATA));
 }
 
 bool Crit3DMeteoPoint::isDateLoadedH(const Crit3DDate& myDate)
@@ -317,7 +366,7 @@ bool Crit3DMeteoPoint::isDateLoadedD(const Crit3DDate& myDate)
 {
     if (nrObsDataDaysD == 0)
         return (false);
-    else if (myDate < obsDataD->date || myDate > (obsDataD->date.addDays(nrObsDataDaysD - 1)))
+    else if (myDate < firstDateD || myDate > firstDateD.addDays(nrObsDataDaysD - 1))
         return (false);
     else
         return (true);
@@ -329,7 +378,7 @@ bool Crit3DMeteoPoint::isDateIntervalLoadedD(const Crit3DDate& date1, const Crit
         return false;
     else if (date1 > date2)
         return false;
-    else if (date1 < obsDataD->date || date2 > (obsDataD->date.addDays(nrObsDataDaysD - 1)))
+    else if (date1 < firstDateD || date2 > firstDateD.addDays(nrObsDataDaysD - 1))
         return (false);
     else
         return (true);
@@ -385,19 +434,31 @@ void Crit3DMeteoPoint::cleanObsDataH()
 
     if (nrObsDataDaysH > 0)
     {
-        for (int i = 0; i < nrObsDataDaysH; i++)
-        {
-            free(obsDataH[i].tAir);
-            free(obsDataH[i].prec);
-            free(obsDataH[i].rhAir);
-            free(obsDataH[i].tDew);
-            free(obsDataH[i].irradiance);
-            free(obsDataH[i].windInt);
-            free(obsDataH[i].leafW);
-            free(obsDataH[i].transmissivity);
-        }
+        free(obsDataHColumns);
+        free(obsDataHLeafW);
         free (obsDataH);
     }
+
+    obsDataHColumns = nullptr;
+    obsDataHLeafW = nullptr;
+    obsDataH = nullptr;
+    nrObsDataDaysH = 0;
+}
+
+
+// keep only the first numberOfDays values: the columns are moved to the new (shorter) stride
+void Crit3DMeteoPoint::shrinkObsDataD(int numberOfDays)
+{
+    if (numberOfDays < 0 || numberOfDays >= nrObsDataDaysD) return;
+
+    for (int column = 1; column < nrDailyColumns; column++)
+    {
+        memmove(obsDataDColumns + size_t(column) * size_t(numberOfDays),
+                obsDataDColumns + size_t(column) * size_t(nrObsDataDaysD),
+                size_t(numberOfDays) * sizeof(float));
+    }
+
+    nrObsDataDaysD = numberOfDays;
 }
 
 
@@ -406,7 +467,16 @@ void Crit3DMeteoPoint::cleanObsDataD()
     quality = quality::missing_data;
 
     if (nrObsDataDaysD > 0)
-        free (obsDataD);
+        free(obsDataDColumns);
+
+    obsDataDColumns = nullptr;
+    nrObsDataDaysD = 0;
+}
+
+
+long Crit3DMeteoPoint::getNrObsDataDaysD() const
+{
+    return nrObsDataDaysD;
 }
 
 void Crit3DMeteoPoint::cleanObsDataM()
@@ -427,57 +497,24 @@ bool Crit3DMeteoPoint::setMeteoPointValueH(const Crit3DDate& myDate, int myHour,
     int h = hourlyFraction * myHour + subH;
     if ((h < 0) || (h >= hourlyFraction * 24)) return false;
 
-    if (myVar == airTemperature)
-        obsDataH[i].tAir[h] = myValue;
-    else if (myVar == precipitation)
-        obsDataH[i].prec[h] = myValue;
-    else if (myVar == airRelHumidity)
-        obsDataH[i].rhAir[h] = myValue;
-    else if (myVar == airDewTemperature)
-        obsDataH[i].tDew[h] = myValue;
-    else if (myVar == globalIrradiance)
-        obsDataH[i].irradiance[h] = myValue;
-    else if (myVar == referenceEvapotranspiration)
-        obsDataH[i].et0[h] = myValue;
-    else if (myVar == windIntensity)
-        obsDataH[i].windInt[h] = myValue;
-    else if (myVar == leafWetness)
-        obsDataH[i].leafW[h] = int(myValue);
-    else if (myVar == atmTransmissivity)
-        obsDataH[i].transmissivity[h] = myValue;
+    float* column = getHourlyColumn(myVar);
+    if (column == nullptr && myVar != leafWetness) return false;
+
+    size_t index = size_t(i) * size_t(nrDayValuesH()) + size_t(h);
+    if (myVar == leafWetness)
+        obsDataHLeafW[index] = int(myValue);
     else
-        return false;
+        column[index] = myValue;
 
     // check if is the first day
-    if (i != 0)
+    if (i != 0 && h == 0)
     {
-        if (h == 0)
-        {
-            // copy 00:00 to 24 day before
-            i = i-1;
-            h = 24;
-
-            if (myVar == airTemperature)
-                obsDataH[i].tAir[h] = myValue;
-            else if (myVar == precipitation)
-                obsDataH[i].prec[h] = myValue;
-            else if (myVar == airRelHumidity)
-                obsDataH[i].rhAir[h] = myValue;
-            else if (myVar == airDewTemperature)
-                obsDataH[i].tDew[h] = myValue;
-            else if (myVar == globalIrradiance)
-                obsDataH[i].irradiance[h] = myValue;
-            else if (myVar == referenceEvapotranspiration)
-                obsDataH[i].et0[h] = myValue;
-            else if (myVar == windIntensity)
-                obsDataH[i].windInt[h] = myValue;
-            else if (myVar == leafWetness)
-                obsDataH[i].leafW[h] = int(myValue);
-            else if (myVar == atmTransmissivity)
-                obsDataH[i].transmissivity[h] = myValue;
-            else
-                return false;
-        }
+        // copy 00:00 to 24 day before
+        index = size_t(i-1) * size_t(nrDayValuesH()) + 24;
+        if (myVar == leafWetness)
+            obsDataHLeafW[index] = int(myValue);
+        else
+            column[index] = myValue;
     }
 
     return true;
@@ -486,47 +523,16 @@ bool Crit3DMeteoPoint::setMeteoPointValueH(const Crit3DDate& myDate, int myHour,
 
 bool Crit3DMeteoPoint::setMeteoPointValueD(const Crit3DDate& myDate, meteoVariable myVar, float myValue)
 {
-
-    long i = obsDataD[0].date.daysTo(myDate);
+    long i = firstDateD.daysTo(myDate);
     if ((i <0) || (i >= nrObsDataDaysD)) return false;
 
-    if (myVar == dailyAirTemperatureMax)
-        obsDataD[i].tMax = myValue;
-    else if (myVar == dailyAirTemperatureMin)
-        obsDataD[i].tMin = myValue;
-    else if (myVar == dailyAirTemperatureAvg)
-        obsDataD[i].tAvg = myValue;
-    else if (myVar == dailyPrecipitation)
-        obsDataD[i].prec = myValue;
-    else if (myVar == dailyAirRelHumidityMax)
-        obsDataD[i].rhMax = myValue;
-    else if (myVar == dailyAirRelHumidityMin)
-        obsDataD[i].rhMin = myValue;
-    else if (myVar == dailyAirRelHumidityAvg)
-        obsDataD[i].rhAvg = myValue;
-    else if (myVar == dailyGlobalRadiation)
-        obsDataD[i].globRad = myValue;
-    else if (myVar == dailyReferenceEvapotranspirationHS)
-         obsDataD[i].et0_hs = myValue;
-    else if (myVar == dailyReferenceEvapotranspirationPM)
-         obsDataD[i].et0_pm = myValue;
-    else if (myVar == dailyWindIntensityAvg)
-        obsDataD[i].windIntAvg = myValue;
-    else if (myVar == dailyWindDirectionPrevailing)
-        obsDataD[i].windDirPrev = myValue;
-    else if (myVar == dailyWindIntensityMax)
-        obsDataD[i].windIntMax = myValue;
-    else if (myVar == dailyLeafWetness)
-        obsDataD[i].leafW = myValue;					
-    else if (myVar == dailyWaterTableDepth)
-        obsDataD[i].waterTable = myValue;
-    else
-        return false;
+    float* column = getDailyColumn(myVar);
+    if (column == nullptr) return false;
 
+    column[i] = myValue;
     return true;
 }
 
-
 float Crit3DMeteoPoint::getMeteoPointValueH(const Crit3DDate& myDate, int myHour, int myMinutes, meteoVariable myVar)
 {
     //check
@@ -557,33 +563,24 @@ float Crit3DMeteoPoint::getMeteoPointValueH(const Crit3DDate& myDate, int myHour
         return NODATA;
     }
 
-    if (myVar == airTemperature)
-        return (obsDataH[i].tAir[h]);
-    else if (myVar == precipitation)
-        return (obsDataH[i].prec[h]);
-    else if (myVar == airRelHumidity)
-        return (obsDataH[i].rhAir[h]);
-    else if (myVar == airDewTemperature)
+    size_t index = size_t(i) * size_t(nrDayValuesH()) + size_t(h);
+
+    if (myVar == airDewTemperature)
     {
-        if (int(obsDataH[i].tDew[h]) != int(NODATA))
-            return obsDataH[i].tDew[h];
+        float tDew = getHourlyColumn(airDewTemperature)[index];
+        if (int(tDew) != int(NODATA))
+            return tDew;
         else
-            return tDewFromRelHum(obsDataH[i].rhAir[h], obsDataH[i].tAir[h]);
+            return tDewFromRelHum(getHourlyColumn(airRelHumidity)[index], getHourlyColumn(airTemperature)[index]);
     }
-    else if (myVar == globalIrradiance)
-        return (obsDataH[i].irradiance[h]);
-    else if (myVar == referenceEvapotranspiration)
-        return (obsDataH[i].et0[h]);
-    else if (myVar == windIntensity)
-        return (obsDataH[i].windInt[h]);
     else if (myVar == leafWetness)
-        return float(obsDataH[i].leafW[h]);
-    else if (myVar == atmTransmissivity)
-        return (obsDataH[i].transmissivity[h]);
-    else
-    {
+        return float(obsDataHLeafW[index]);
+
+    float* column = getHourlyColumn(myVar);
+    if (column == nullptr)
         return (NODATA);
-    }
+    else
+        return column[index];
 }
 
 
@@ -591,44 +588,14 @@ float Crit3DMeteoPoint::getMeteoPointValueD(const Crit3DDate& myDate, meteoVaria
 {
     //check
     if (myVar == noMeteoVar) return NODATA;
-    if (obsDataD == nullptr) return NODATA;
 
-    int i = obsDataD[0].date.daysTo(myDate);
-    if ((i < 0) || (i >= nrObsDataDaysD)) return NODATA;
+    float* column = getDailyColumn(myVar);
+    if (column == nullptr) return NODATA;
 
-    if (myVar == dailyAirTemperatureMax)
-        return (obsDataD[i].tMax);
-    else if (myVar == dailyAirTemperatureMin)
-        return (obsDataD[i].tMin);
-    else if (myVar == dailyAirTemperatureAvg)
-        return (obsDataD[i].tAvg);
-    else if (myVar == dailyPrecipitation)
-        return (obsDataD[i].prec);
-    else if (myVar == dailyAirRelHumidityMax)
-        return (obsDataD[i].rhMax);
-    else if (myVar == dailyAirRelHumidityMin)
-        return float(obsDataD[i].rhMin);
-    else if (myVar == dailyAirRelHumidityAvg)
-        return (obsDataD[i].rhAvg);
-    else if (myVar == dailyGlobalRadiation)
-        return (obsDataD[i].globRad);
-    else if (myVar == dailyReferenceEvapotranspirationHS)
-        return (obsDataD[i].et0_hs);
-    else if (myVar == dailyReferenceEvapotranspirationPM)
-        return (obsDataD[i].et0_pm);
-    else if (myVar == dailyWindIntensityAvg)
-        return (obsDataD[i].windIntAvg);
-    else if (myVar == dailyWindDirectionPrevailing)
-        return (obsDataD[i].windDirPrev);
-    else if (myVar == dailyWindIntensityMax)
-        return (obsDataD[i].windIntMax);
-    else if (myVar == dailyLeafWetness)
-        return (obsDataD[i].leafW);
-    else if (myVar == dailyWaterTableDepth)
-        return (obsDataD[i].waterTable);
-    else
-        return (NODATA);
+    int i = firstDateD.daysTo(myDate);
+    if ((i < 0) || (i >= nrObsDataDaysD)) return NODATA;
 
+    return column[i];
 }
 
 
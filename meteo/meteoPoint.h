@@ -16,6 +16,8 @@
         #include "quality.h"
     #endif
 
+    // per-day view of the hourly columns: each pointer refers to the values of the day
+    // (hourlyFraction * 24 + 1 values) inside the contiguous column of the variable
     struct TObsDataH {
         Crit3DDate date;
         float* tAir;
@@ -48,6 +50,20 @@
         float waterTable;       // [m]
     };
 
+    // read-only view of consecutive daily values of a variable (no copy)
+    struct TDailySeries {
+        const float* data;
+        long size;
+
+        TDailySeries() : data(nullptr), size(0) {}
+        TDailySeries(const float* myData, long mySize) : data(myData), size(mySize) {}
+
+        const float* begin() const { return data; }
+        const float* end() const { return data + size; }
+        float operator[](long i) const { return data[i]; }
+        bool empty() const { return size == 0; }
+    };
+
     struct TObsDataM {
         int _month;
         int _year;
@@ -60,6 +76,9 @@
     };
 
     class Crit3DMeteoPoint {
+    private:
+        long nrObsDataDaysD;            // set only by initializeObsDataD, shrinkObsDataD, cleanObsDataD (column stride)
+
     public:
         std::string name;
         std::string id;
@@ -69,7 +88,6 @@
         std::string province;
         std::string municipality;
 
-        std::vector<gis::Crit3DPoint> aggregationPoints;
         long aggregationPointsMaxNr;
 
         gis::Crit3DPoint point;
@@ -84,10 +102,12 @@
         bool isForecast;
         int hourlyFraction;
         long nrObsDataDaysH;
-        long nrObsDataDaysD;
         long nrObsDataDaysM;
         TObsDataH *obsDataH;
-        TObsDataD *obsDataD;
+        float *obsDataHColumns;         // hourly float variables: one column [day * nrDayValuesH + h] per variable
+        int *obsDataHLeafW;             // hourly leaf wetness column
+        Crit3DDate firstDateD;          // date of the first daily value
+        float *obsDataDColumns;         // daily variables: one column [day] per variable
         TObsDataM *obsDataM;
         quality::qualityType quality;
         float currentValue;
@@ -102,7 +122,6 @@
 
         std::vector <float> proxyValues;
         lapseRateCodeType lapseRateCode;
-        gis::Crit3DRasterGrid* topographicDistance;
 
         Crit3DMeteoPoint();
 
@@ -114,12 +133,18 @@
         bool isDateIntervalLoadedH(const Crit3DDate& date1, const Crit3DDate& date2);
         bool isDateIntervalLoadedH(const Crit3DTime& time1, const Crit3DTime& time2);
         float obsDataConsistencyH(meteoVariable myVar, const Crit3DTime& time1, const Crit3DTime& time2);
+        int nrDayValuesH() const;
+        float* getHourlyColumn(meteoVariable myVar);
 
         void initializeObsDataD(int numberOfDays, const Crit3DDate& firstDate);
         void emptyVarObsDataD(meteoVariable myVar, const Crit3DDate& date1, const Crit3DDate& date2);
+        void shrinkObsDataD(int numberOfDays);
         void cleanObsDataD();
+        long getNrObsDataDaysD() const;
         bool isDateLoadedD(const Crit3DDate& myDate);
         bool isDateIntervalLoadedD(const Crit3DDate& date1, const Crit3DDate& date2);
+        float* getDailyColumn(meteoVariable myVar);
+        TDailySeries getDailySeries(meteoVariable myVar, const Crit3DDate& firstDate, const Crit3DDate& lastDate);
 
         void initializeObsDataM(int numberOfMonths, int month, int year);
         void cleanObsDataM();
@@ -37,26 +37,83 @@
 #include "header/boundary.h"
 #include "header/heat.h"
 #include "header/water.h"
+#include "header/domain.h"
+#include "header/hydraulicTable.h"
 
 
-Tbalance balanceCurrentTimeStep, balancePreviousTimeStep, balanceCurrentPeriod, balanceWholePeriod;
-double Courant = 0.0;
+inline void doubleTimeStep(TCrit3DDomain *myDomain)
+{
+    myDomain->parameters.current_delta_t *= 2.0;
+    myDomain->parameters.current_delta_t = minValue(myDomain->parameters.current_delta_t, myDomain->parameters.delta_t_max);
+}
 
-static double bestMBRerror;
-static bool isHalfTimeStepForced = false;
 
+void halveTimeStep(TCrit3DDomain *myDomain)
+{
+    myDomain->parameters.current_delta_t /= 2.0;
+    myDomain->parameters.current_delta_t = maxValue(myDomain->parameters.current_delta_t, myDomain->parameters.delta_t_min);
+}
 
-inline void doubleTimeStep()
+
+/*!
+ * \brief reduce the time step after a rejected step
+ * adaptive time step: the step is scaled by the predicted factor, otherwise it is halved
+ * \param factor [-] predicted ratio between the new and the current time step
+ */
+void reduceTimeStep(TCrit3DDomain *myDomain, double factor)
 {
-    myParameters.current_delta_t *= 2.0;
-    myParameters.current_delta_t = minValue(myParameters.current_delta_t, myParameters.delta_t_max);
+    if (! myDomain->parameters.isAdaptiveTimeStep)
+    {
+        halveTimeStep(myDomain);
+        return;
+    }
+
+    factor = maxValue(minValue(factor, 0.9), 0.1);
+    myDomain->parameters.current_delta_t = maxValue(myDomain->parameters.current_delta_t * factor, myDomain->parameters.delta_t_min);
 }
 
 
-void halveTimeStep()
+/*!
+ * \brief reduction factor of the time step after a mass balance failure
+ * \param MBRerror [-] current mass balance ratio (absolute value)
+ */
+inline double MBRreductionFactor(TCrit3DDomain *myDomain, double MBRerror)
 {
-    myParameters.current_delta_t /= 2.0;
-    myParameters.current_delta_t = maxValue(myParameters.current_delta_t, myParameters.delta_t_min);
+    return 0.9 * sqrt(myDomain->parameters.MBRThreshold / MBRerror);
+}
+
+
+/*!
+ * \brief PI controller of the time step (Gustafsson 1991, PI.3.4):
+ * the next step is predicted from the mass balance error of the current and previous steps,
+ * dt_next = dt * 0.9 * (tol / e_n)^(0.3/k) * (e_n-1 / e_n)^(0.4/k)  with k = 2
+ * and limited by the convergence history (Courant number and approximations used)
+ * \param MBRerror [-] mass balance ratio of the accepted step (absolute value)
+ * \param approxNr approximation of the accepted step
+ */
+void predictTimeStep(TCrit3DDomain *myDomain, double MBRerror, int approxNr)
+{
+    const double K_I = 0.15;
+    const double K_P = 0.2;
+
+    double errorRatio = maxValue(MBRerror / myDomain->parameters.MBRThreshold, 1E-4);
+    double factor = 0.9 * pow(errorRatio, -K_I);
+
+    double previousErrorRatio = fabs(myDomain->balancePreviousTimeStep.waterMBR) / myDomain->parameters.MBRThreshold;
+    if (previousErrorRatio > 0.)
+        factor *= pow(maxValue(previousErrorRatio, 1E-4) / errorRatio, K_P);
+
+    /*! slow convergence: do not increase */
+    if (approxNr >= (myDomain->parameters.maxApproximationsNumber / 2))
+        factor = minValue(factor, 1.);
+
+    /*! Courant number below 0.8 */
+    if (myDomain->courant > 0.)
+        factor = minValue(factor, 0.8 / myDomain->courant);
+
+    factor = maxValue(minValue(factor, 2.), 0.2);
+    myDomain->parameters.current_delta_t = minValue(myDomain->parameters.current_delta_t * factor, myDomain->parameters.delta_t_max);
+    myDomain->parameters.current_delta_t = maxValue(myDomain->parameters.current_delta_t, myDomain->parameters.delta_t_min);
 }
 
 
@@ -74,37 +131,42 @@ inline bool link_uguali(long n, TlinkedNode *myLink)
 
 
 
-void InitializeBalanceWater()
+void InitializeBalanceWater(TCrit3DDomain *myDomain)
 {
-     bestMBRerror = 100.;
-
-     balanceWholePeriod.storageWater = computeTotalWaterContent();
-     balanceCurrentTimeStep.storageWater = balanceWholePeriod.storageWater;
-     balancePreviousTimeStep.storageWater = balanceWholePeriod.storageWater;
-     balanceCurrentPeriod.storageWater = balanceWholePeriod.storageWater;
-
-     balanceCurrentTimeStep.sinkSourceWater = 0.;
-     balancePreviousTimeStep.sinkSourceWater = 0.;
-     balanceCurrentTimeStep.waterMBR = 0.;
-     balanceCurrentTimeStep.waterMBE = 0.;
-     balanceCurrentPeriod.sinkSourceWater = 0.;
-     balanceWholePeriod.sinkSourceWater = 0.;
-     balanceWholePeriod.waterMBE = 0.;
-     balanceWholePeriod.waterMBR = 0.;
+     myDomain->bestMBRerror = 100.;
+
+     /*! the initial storage must be computed with the same functions of the time steps */
+     if (myDomain->parameters.useHydraulicTables)
+         computeSeBatch(myDomain, 0, myDomain->structure.nrNodes);
+
+     myDomain->balanceWholePeriod.storageWater = computeTotalWaterContent(myDomain);
+     myDomain->balanceCurrentTimeStep.storageWater = myDomain->balanceWholePeriod.storageWater;
+     myDomain->balancePreviousTimeStep.storageWater = myDomain->balanceWholePeriod.storageWater;
+     myDomain->balanceCurrentPeriod.storageWater = myDomain->balanceWholePeriod.storageWater;
+
+     myDomain->balanceCurrentTimeStep.sinkSourceWater = 0.;
+     myDomain->balancePreviousTimeStep.sinkSourceWater = 0.;
+     myDomain->balanceCurrentTimeStep.waterMBR = 0.;
+     myDomain->balanceCurrentTimeStep.waterMBE = 0.;
+     myDomain->balancePreviousTimeStep.waterMBR = 0.;
+     myDomain->balanceCurrentPeriod.sinkSourceWater = 0.;
+     myDomain->balanceWholePeriod.sinkSourceWater = 0.;
+     myDomain->balanceWholePeriod.waterMBE = 0.;
+     myDomain->balanceWholePeriod.waterMBR = 0.;
 
     /*! initialize link flow */
-    for (long n = 0; n < myStructure.nrNodes; n++)
+    for (long n = 0; n < myDomain->structure.nrNodes; n++)
         {
-        myNode[n].up.sumFlow = 0.;
-        myNode[n].down.sumFlow = 0.;
-        for (short i = 0; i < myStructure.nrLateralLinks; i++)
-             myNode[n].lateral[i].sumFlow = 0.;
+        myDomain->node[n].up.sumFlow = 0.;
+        myDomain->node[n].down.sumFlow = 0.;
+        for (short i = 0; i < myDomain->structure.nrLateralLinks; i++)
+             myDomain->node[n].lateral[i].sumFlow = 0.;
         }
 
     /*! initialize boundary flow */
-    for (long n = 0; n < myStructure.nrNodes; n++)
-        if (myNode[n].boundary != nullptr)
-            myNode[n].boundary->sumBoundaryWaterFlow = 0.;
+    for (long n = 0; n < myDomain->structure.nrNodes; n++)
+        if (myDomain->node[n].boundary != nullptr)
+            myDomain->node[n].boundary->sumBoundaryWaterFlow = 0.;
 }
 
 
@@ -112,19 +174,19 @@ void InitializeBalanceWater()
  * \brief computes total water content          [m^3]
  * \return result
  */
-double computeTotalWaterContent()
+double computeTotalWaterContent(TCrit3DDomain *myDomain)
 {
    double theta, sum = 0.0;
 
-   for (unsigned long i = 0; i < unsigned(myStructure.nrNodes); i++)
-       if  (myNode[i].isSurface)
+   for (unsigned long i = 0; i < unsigned(myDomain->structure.nrNodes); i++)
+       if  (myDomain->node[i].isSurface)
        {
-           sum += (myNode[i].H - double(myNode[i].z)) * myNode[i].volume_area;
+           sum += (myDomain->nodeState.H[i] - double(myDomain->node[i].z)) * myDomain->node[i].volume_area;
        }
        else
        {
-           theta = theta_from_Se(i);
-           sum += theta * myNode[i].volume_area;
+           theta = theta_from_Se(myDomain, i);
+           sum += theta * myDomain->node[i].volume_area;
        }
    return(sum);
 }
@@ -135,49 +197,48 @@ double computeTotalWaterContent()
  * \param deltaT
  * \return result
  */
-double sumWaterFlow(double deltaT)
+double sumWaterFlow(TCrit3DDomain *myDomain, double deltaT)
 {
     double sum = 0.0;
-    for (long n = 0; n < myStructure.nrNodes; n++)
+    for (long n = 0; n < myDomain->structure.nrNodes; n++)
     {
-        if (myNode[n].Qw != 0.)
-            sum += myNode[n].Qw * deltaT;
+        if (myDomain->nodeState.Qw[n] != 0.)
+            sum += myDomain->nodeState.Qw[n] * deltaT;
     }
     return (sum);
 }
 
 
 
-void computeMassBalance(double deltaT)
+void computeMassBalance(TCrit3DDomain *myDomain, double deltaT)
 {
-     balanceCurrentTimeStep.storageWater = computeTotalWaterContent();
+     myDomain->balanceCurrentTimeStep.storageWater = computeTotalWaterContent(myDomain);
 
-	 double dStorage = balanceCurrentTimeStep.storageWater - balancePreviousTimeStep.storageWater;
+	 double dStorage = myDomain->balanceCurrentTimeStep.storageWater - myDomain->balancePreviousTimeStep.storageWater;
 
-     balanceCurrentTimeStep.sinkSourceWater = sumWaterFlow(deltaT);
+     myDomain->balanceCurrentTimeStep.sinkSourceWater = sumWaterFlow(myDomain, deltaT);
 
-     balanceCurrentTimeStep.waterMBE = dStorage - balanceCurrentTimeStep.sinkSourceWater;
+     myDomain->balanceCurrentTimeStep.waterMBE = dStorage - myDomain->balanceCurrentTimeStep.sinkSourceWater;
 
      /*! reference water: sumWaterFlow or 0.1% of storage */
-     double denominator = maxValue(fabs(balanceCurrentTimeStep.sinkSourceWater), balanceCurrentTimeStep.storageWater * 1e-3);
+     double denominator = maxValue(fabs(myDomain->balanceCurrentTimeStep.sinkSourceWater), myDomain->balanceCurrentTimeStep.storageWater * 1e-3);
 
      /*! no water - minimum 1 liter */
      denominator = maxValue(denominator, 0.001);
 
-	 balanceCurrentTimeStep.waterMBR = balanceCurrentTimeStep.waterMBE / denominator;
+	 myDomain->balanceCurrentTimeStep.waterMBR = myDomain->balanceCurrentTimeStep.waterMBE / denominator;
 }
 
 
-double getMatrixValue(long i, TlinkedNode *link)
+double getMatrixValue(TCrit3DDomain *myDomain, long i, TlinkedNode *link)
 {
 	if (link != nullptr)
         {
-        int j = 1;
-        while ((j < myStructure.maxNrColumns) && (A[i][j].index != NOLINK) && (A[i][j].index != (*link).index)) j++;
-
-        /*! Rebuild the A elements (previously normalized) */
-		if (A[i][j].index == (*link).index)
-			return (A[i][j].val * A[i][0].val);
+        long first = i * myDomain->A.nrColumns;
+        for (int j = 0; j < myDomain->A.nrLinks[i]; j++)
+            /*! Rebuild the A elements (previously normalized) */
+            if (myDomain->A.index[first + j] == (*link).index)
+                return (myDomain->A.val[first + j] * myDomain->A.diagonal[i]);
         }
 	return double(INDEX_ERROR);
 }
@@ -189,99 +250,108 @@ double getMatrixValue(long i, TlinkedNode *link)
  * \param link TlinkedNode pointer
  * \param delta_t
  */
-void update_flux(long index, TlinkedNode *link, double delta_t)
+void update_flux(TCrit3DDomain *myDomain, long index, TlinkedNode *link, double delta_t)
 {
     if (link->index != NOLINK)
-        (*link).sumFlow += float(getWaterExchange(index, link, delta_t));
+        (*link).sumFlow += float(getWaterExchange(myDomain, index, link, delta_t));
 }
 
 
 
-void saveBestStep()
+void saveBestStep(TCrit3DDomain *myDomain)
 {
-	for (long n = 0; n < myStructure.nrNodes; n++)
-		myNode[n].bestH = myNode[n].H;
+	for (long n = 0; n < myDomain->structure.nrNodes; n++)
+		myDomain->nodeState.bestH[n] = myDomain->nodeState.H[n];
 }
 
 
 
 
-void restoreBestStep(double deltaT)
+void restoreBestStep(TCrit3DDomain *myDomain, double deltaT)
 {
-    for (unsigned long n = 0; n < unsigned(myStructure.nrNodes); n++)
+    for (unsigned long n = 0; n < unsigned(myDomain->structure.nrNodes); n++)
     {
-        myNode[n].H = myNode[n].bestH;
+        myDomain->nodeState.H[n] = myDomain->nodeState.bestH[n];
 
         /*! compute new soil moisture (only sub-surface nodes) */
-        if (!myNode[n].isSurface)
-                myNode[n].Se = computeSe(n);
+        if (!myDomain->node[n].isSurface && !myDomain->parameters.useHydraulicTables)
+                myDomain->nodeState.Se[n] = computeSe(myDomain, n);
     }
 
-     computeMassBalance(deltaT);
+    /*! the storage must be computed with the same functions of the previous step */
+    if (myDomain->parameters.useHydraulicTables)
+        computeSeBatch(myDomain, 0, myDomain->structure.nrNodes);
+
+     computeMassBalance(myDomain, deltaT);
 }
 
 
-void acceptStep(double deltaT)
+void acceptStep(TCrit3DDomain *myDomain, double deltaT)
 {
     /*! update balanceCurrentPeriod and balanceWholePeriod */
-    balancePreviousTimeStep.storageWater = balanceCurrentTimeStep.storageWater;
-    balancePreviousTimeStep.sinkSourceWater = balanceCurrentTimeStep.sinkSourceWater;
-    balanceCurrentPeriod.sinkSourceWater += balanceCurrentTimeStep.sinkSourceWater;
+    myDomain->balancePreviousTimeStep.storageWater = myDomain->balanceCurrentTimeStep.storageWater;
+    myDomain->balancePreviousTimeStep.sinkSourceWater = myDomain->balanceCurrentTimeStep.sinkSourceWater;
+    myDomain->balancePreviousTimeStep.waterMBR = myDomain->balanceCurrentTimeStep.waterMBR;
+    myDomain->balanceCurrentPeriod.sinkSourceWater += myDomain->balanceCurrentTimeStep.sinkSourceWater;
 
     /*! update sum of flow */
-    for (long i = 0; i < myStructure.nrNodes; i++)
+    for (long i = 0; i < myDomain->structure.nrNodes; i++)
         {
-		update_flux(i, &(myNode[i].up), deltaT);
-        update_flux(i, &(myNode[i].down), deltaT);
-        for (short j = 0; j < myStructure.nrLateralLinks; j++)
-			update_flux(i, &(myNode[i].lateral[j]), deltaT);
+		update_flux(myDomain, i, &(myDomain->node[i].up), deltaT);
+        update_flux(myDomain, i, &(myDomain->node[i].down), deltaT);
+        for (short j = 0; j < myDomain->structure.nrLateralLinks; j++)
+			update_flux(myDomain, i, &(myDomain->node[i].lateral[j]), deltaT);
 
-        if (myNode[i].boundary != nullptr)
-            myNode[i].boundary->sumBoundaryWaterFlow += myNode[i].boundary->waterFlow * deltaT;
+        if (myDomain->node[i].boundary != nullptr)
+            myDomain->node[i].boundary->sumBoundaryWaterFlow += myDomain->node[i].boundary->waterFlow * deltaT;
         }
 
 }
 
-bool waterBalance(double deltaT, int approxNr)
+bool waterBalance(TCrit3DDomain *myDomain, double deltaT, int approxNr)
 {
-	computeMassBalance(deltaT);
-	double MBRerror = fabs(balanceCurrentTimeStep.waterMBR);
+	computeMassBalance(myDomain, deltaT);
+	double MBRerror = fabs(myDomain->balanceCurrentTimeStep.waterMBR);
 
-	isHalfTimeStepForced = false;
+	myDomain->isHalfTimeStepForced = false;
 
     /*! error better than previuosly */
-	if ((approxNr == 0) || (MBRerror < bestMBRerror))
+	if ((approxNr == 0) || (MBRerror < myDomain->bestMBRerror))
 	{
-		saveBestStep();
-		bestMBRerror = MBRerror;
+		saveBestStep(myDomain);
+		myDomain->bestMBRerror = MBRerror;
 	}
 
     /*! best case */
-    if (MBRerror < myParameters.MBRThreshold)
+    if (MBRerror < myDomain->parameters.MBRThreshold)
         {
-        acceptStep(deltaT);
-		if ((approxNr < 2) && (Courant < 0.5) && (MBRerror < (myParameters.MBRThreshold * 0.5)))
+        myDomain->statistics.nrApproximations += approxNr + 1;
+        if (myDomain->parameters.isAdaptiveTimeStep)
+            predictTimeStep(myDomain, MBRerror, approxNr);
+        acceptStep(myDomain, deltaT);
+		if ((! myDomain->parameters.isAdaptiveTimeStep) && (approxNr < 2) && (myDomain->courant < 0.5) && (MBRerror < (myDomain->parameters.MBRThreshold * 0.5)))
             {
             /*! system is stable: double time step */
-            doubleTimeStep();
+            doubleTimeStep(myDomain);
             }
         return (true);
         }
 
     /*! worst case: error high or last approximation */
-    if ((MBRerror > (bestMBRerror * 2.0))
-        ||(approxNr == (myParameters.maxApproximationsNumber-1)))
+    if ((MBRerror > (myDomain->bestMBRerror * 2.0))
+        ||(approxNr == (myDomain->parameters.maxApproximationsNumber-1)))
         {
-        if (deltaT > myParameters.delta_t_min)
+        if (deltaT > myDomain->parameters.delta_t_min)
             {
-            halveTimeStep();
-            isHalfTimeStepForced = true;
+            reduceTimeStep(myDomain, MBRreductionFactor(myDomain, MBRerror));
+            myDomain->isHalfTimeStepForced = true;
             return (false);
             }
         else
             {
-            restoreBestStep(deltaT);
-            acceptStep(deltaT);
+            myDomain->statistics.nrApproximations += approxNr + 1;
+            restoreBestStep(myDomain, deltaT);
+            acceptStep(myDomain, deltaT);
             return (true);
             }
         }
@@ -292,36 +362,36 @@ bool waterBalance(double deltaT, int approxNr)
 
 
 
-void updateBalanceWaterWholePeriod()
+void updateBalanceWaterWholePeriod(TCrit3DDomain *myDomain)
 {
     /*! update the flows in the balance (balanceWholePeriod) */
-    balanceWholePeriod.sinkSourceWater  += balanceCurrentPeriod.sinkSourceWater;
+    myDomain->balanceWholePeriod.sinkSourceWater  += myDomain->balanceCurrentPeriod.sinkSourceWater;
 
-    double deltaStoragePeriod = balanceCurrentTimeStep.storageWater - balanceCurrentPeriod.storageWater;
+    double deltaStoragePeriod = myDomain->balanceCurrentTimeStep.storageWater - myDomain->balanceCurrentPeriod.storageWater;
 
-    double deltaStorageHistorical = balanceCurrentTimeStep.storageWater - balanceWholePeriod.storageWater;
+    double deltaStorageHistorical = myDomain->balanceCurrentTimeStep.storageWater - myDomain->balanceWholePeriod.storageWater;
 
     /*! compute waterMBE and waterMBR */
-    balanceCurrentPeriod.waterMBE = fabs(deltaStoragePeriod - balanceCurrentPeriod.sinkSourceWater);
-    if ((balanceWholePeriod.storageWater == 0.) && (balanceWholePeriod.sinkSourceWater == 0.)) balanceWholePeriod.waterMBR = 1.;
-    else if (balanceCurrentTimeStep.storageWater > fabs(balanceWholePeriod.sinkSourceWater))
-        balanceWholePeriod.waterMBR = balanceCurrentTimeStep.storageWater / (balanceWholePeriod.storageWater + balanceWholePeriod.sinkSourceWater);
+    myDomain->balanceCurrentPeriod.waterMBE = fabs(deltaStoragePeriod - myDomain->balanceCurrentPeriod.sinkSourceWater);
+    if ((myDomain->balanceWholePeriod.storageWater == 0.) && (myDomain->balanceWholePeriod.sinkSourceWater == 0.)) myDomain->balanceWholePeriod.waterMBR = 1.;
+    else if (myDomain->balanceCurrentTimeStep.storageWater > fabs(myDomain->balanceWholePeriod.sinkSourceWater))
+        myDomain->balanceWholePeriod.waterMBR = myDomain->balanceCurrentTimeStep.storageWater / (myDomain->balanceWholePeriod.storageWater + myDomain->balanceWholePeriod.sinkSourceWater);
     else
-        balanceWholePeriod.waterMBR = deltaStorageHistorical / balanceWholePeriod.sinkSourceWater;
+        myDomain->balanceWholePeriod.waterMBR = deltaStorageHistorical / myDomain->balanceWholePeriod.sinkSourceWater;
 
     /*! update storageWater in balanceCurrentPeriod */
-    balanceCurrentPeriod.storageWater = balanceCurrentTimeStep.storageWater;
+    myDomain->balanceCurrentPeriod.storageWater = myDomain->balanceCurrentTimeStep.storageWater;
 }
 
 
 
-bool getForcedHalvedTime()
+bool getForcedHalvedTime(TCrit3DDomain *myDomain)
 {
-    return (isHalfTimeStepForced);
+    return (myDomain->isHalfTimeStepForced);
 }
 
-void setForcedHalvedTime(bool isForced)
+void setForcedHalvedTime(TCrit3DDomain *myDomain, bool isForced)
 {
-    isHalfTimeStepForced = isForced;
+    myDomain->isHalfTimeStepForced = isForced;
 }
 
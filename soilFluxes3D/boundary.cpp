@@ -37,10 +37,11 @@
 #include "header/soilFluxes3D.h"
 #include "header/water.h"
 #include "header/heat.h"
+#include "header/domain.h"
 
 #include <iostream>
 
-void initializeBoundary(Tboundary *myBoundary, int myType, float slope)
+void initializeBoundary(TCrit3DDomain *myDomain, Tboundary *myBoundary, int myType, float slope)
 {
     (*myBoundary).type = short(myType);
 	(*myBoundary).slope = slope;
@@ -48,7 +49,7 @@ void initializeBoundary(Tboundary *myBoundary, int myType, float slope)
     (*myBoundary).sumBoundaryWaterFlow = 0;
 	(*myBoundary).prescribedTotalPotential = NODATA;
 
-    if (myStructure.computeHeat)
+    if (myDomain->structure.computeHeat)
     {
         (*myBoundary).Heat = new(TboundaryHeat);
 
@@ -96,18 +97,18 @@ double computeSoilSurfaceResistanceCG(double theta, double thetaSat)
  * \param i
  * \return latent heat (W m-2)
  */
-double computeAtmosphericSensibleFlux(long i)
+double computeAtmosphericSensibleFlux(TCrit3DDomain *myDomain, long i)
 {
-    if (myNode[i].boundary->Heat == nullptr || ! myNode[myNode[i].up.index].isSurface)
+    if (myDomain->node[i].boundary->Heat == nullptr || ! myDomain->node[myDomain->node[i].up.index].isSurface)
         return 0;
 
-    double myPressure = PressureFromAltitude(double(myNode[i].z));
+    double myPressure = PressureFromAltitude(double(myDomain->node[i].z));
 
-    double myDeltaT = myNode[i].boundary->Heat->temperature - myNode[i].extra->Heat->T;
+    double myDeltaT = myDomain->node[i].boundary->Heat->temperature - myDomain->node[i].extra->Heat->T;
 
-    double myCvAir = AirVolumetricSpecificHeat(myPressure, myNode[i].boundary->Heat->temperature);
+    double myCvAir = AirVolumetricSpecificHeat(myPressure, myDomain->node[i].boundary->Heat->temperature);
 
-    return (myCvAir * myDeltaT * myNode[i].boundary->Heat->aerodynamicConductance);
+    return (myCvAir * myDeltaT * myDomain->node[i].boundary->Heat->aerodynamicConductance);
 }
 
 /*!
@@ -115,22 +116,22 @@ double computeAtmosphericSensibleFlux(long i)
  * \param i
  * \return vapor flux (kg m-2 s-1)
  */
-double computeAtmosphericLatentFlux(long i)
+double computeAtmosphericLatentFlux(TCrit3DDomain *myDomain, long i)
 {
-    if (myNode[i].boundary->Heat == nullptr || ! myNode[myNode[i].up.index].isSurface)
+    if (myDomain->node[i].boundary->Heat == nullptr || ! myDomain->node[myDomain->node[i].up.index].isSurface)
         return 0;
 
     double PressSat, ConcVapSat, BoundaryVapor;
 
-    PressSat = SaturationVaporPressure(myNode[i].boundary->Heat->temperature - ZEROCELSIUS);
-    ConcVapSat = VaporConcentrationFromPressure(PressSat, myNode[i].boundary->Heat->temperature);
-    BoundaryVapor = ConcVapSat * (myNode[i].boundary->Heat->relativeHumidity / 100.);
+    PressSat = SaturationVaporPressure(myDomain->node[i].boundary->Heat->temperature - ZEROCELSIUS);
+    ConcVapSat = VaporConcentrationFromPressure(PressSat, myDomain->node[i].boundary->Heat->temperature);
+    BoundaryVapor = ConcVapSat * (myDomain->node[i].boundary->Heat->relativeHumidity / 100.);
 
     // kg m-3
     double myDeltaVapor = BoundaryVapor - soilFluxes3D::getNodeVapor(i);
 
     // m s-1
-    double myTotalConductance = 1./((1./myNode[i].boundary->Heat->aerodynamicConductance) + (1. / myNode[i].boundary->Heat->soilConductance));
+    double myTotalConductance = 1./((1./myDomain->node[i].boundary->Heat->aerodynamicConductance) + (1. / myDomain->node[i].boundary->Heat->soilConductance));
 
     // kg m-2 s-1
     double myVaporFlow = myDeltaVapor * myTotalConductance;
@@ -143,28 +144,28 @@ double computeAtmosphericLatentFlux(long i)
  * \param i
  * \return vapor flux (kg m-2 s-1)
  */
-double computeAtmosphericLatentFluxSurfaceWater(long i)
+double computeAtmosphericLatentFluxSurfaceWater(TCrit3DDomain *myDomain, long i)
 {
-    if (! myNode[i].isSurface) return 0.;
-    if (&(myNode[i].down) == nullptr) return 0.;
+    if (! myDomain->node[i].isSurface) return 0.;
+    if (&(myDomain->node[i].down) == nullptr) return 0.;
 
-    long downIndex = myNode[i].down.index;
+    long downIndex = myDomain->node[i].down.index;
 
-    if (myNode[downIndex].boundary->Heat == nullptr || myNode[downIndex].boundary->type != BOUNDARY_HEAT_SURFACE) return 0.;
+    if (myDomain->node[downIndex].boundary->Heat == nullptr || myDomain->node[downIndex].boundary->type != BOUNDARY_HEAT_SURFACE) return 0.;
 
     double PressSat, ConcVapSat, BoundaryVapor;
 
     // atmospheric vapor content (kg m-3)
-    PressSat = SaturationVaporPressure(myNode[downIndex].boundary->Heat->temperature - ZEROCELSIUS);
-    ConcVapSat = VaporConcentrationFromPressure(PressSat, myNode[downIndex].boundary->Heat->temperature);
-    BoundaryVapor = ConcVapSat * (myNode[downIndex].boundary->Heat->relativeHumidity / 100.);
+    PressSat = SaturationVaporPressure(myDomain->node[downIndex].boundary->Heat->temperature - ZEROCELSIUS);
+    ConcVapSat = VaporConcentrationFromPressure(PressSat, myDomain->node[downIndex].boundary->Heat->temperature);
+    BoundaryVapor = ConcVapSat * (myDomain->node[downIndex].boundary->Heat->relativeHumidity / 100.);
 
     // surface water vapor content (kg m-3) (assuming water temperature is the same of atmosphere)
     double myDeltaVapor = BoundaryVapor - ConcVapSat;
 
     // kg m-2 s-1
     // using aerodynamic conductance of index below (boundary for heat)
-    double myVaporFlow = myDeltaVapor * myNode[downIndex].boundary->Heat->aerodynamicConductance;
+    double myVaporFlow = myDeltaVapor * myDomain->node[downIndex].boundary->Heat->aerodynamicConductance;
 
     return myVaporFlow;
 }
@@ -174,299 +175,299 @@ double computeAtmosphericLatentFluxSurfaceWater(long i)
  * \param i
  * \return latent flux (W)
  */
-double computeAtmosphericLatentHeatFlux(long i)
+double computeAtmosphericLatentHeatFlux(TCrit3DDomain *myDomain, long i)
 {
-    if (myNode[i].boundary->Heat == nullptr || ! myNode[myNode[i].up.index].isSurface)
+    if (myDomain->node[i].boundary->Heat == nullptr || ! myDomain->node[myDomain->node[i].up.index].isSurface)
         return 0;
 
     double latentHeatFlow = 0.;
 
     // J kg-1
-    double lambda = LatentHeatVaporization(myNode[i].extra->Heat->T - ZEROCELSIUS);
+    double lambda = LatentHeatVaporization(myDomain->node[i].extra->Heat->T - ZEROCELSIUS);
     // waterFlow: vapor sink source (m3 s-1)
-    latentHeatFlow = myNode[i].boundary->waterFlow * WATER_DENSITY * lambda;
+    latentHeatFlow = myDomain->node[i].boundary->waterFlow * WATER_DENSITY * lambda;
 
     return latentHeatFlow;
 }
 
-double getSurfaceWaterFraction(int i)
+double getSurfaceWaterFraction(TCrit3DDomain *myDomain, int i)
 {
-    if (! myNode[i].isSurface)
+    if (! myDomain->node[i].isSurface)
         return 0.0;
     else
     {
-        double h = maxValue(myNode[i].H - myNode[i].z, 0.0);
-        return 1.0 - maxValue(0.0, myNode[i].Soil->Pond - h) / myNode[i].Soil->Pond;
+        double h = maxValue(myDomain->nodeState.H[i] - myDomain->node[i].z, 0.0);
+        return 1.0 - maxValue(0.0, myDomain->node[i].Soil->Pond - h) / myDomain->node[i].Soil->Pond;
     }
 }
 
-void updateBoundary()
+void updateBoundary(TCrit3DDomain *myDomain)
 {
-    for (long i = 0; i < myStructure.nrNodes; i++)
-        if (myNode[i].boundary != nullptr)
-            if (myStructure.computeHeat)
-                if (myNode[i].extra->Heat != nullptr)
-                    if (myNode[i].boundary->type == BOUNDARY_HEAT_SURFACE)
+    for (long i = 0; i < myDomain->structure.nrNodes; i++)
+        if (myDomain->node[i].boundary != nullptr)
+            if (myDomain->structure.computeHeat)
+                if (myDomain->node[i].extra->Heat != nullptr)
+                    if (myDomain->node[i].boundary->type == BOUNDARY_HEAT_SURFACE)
                     {
                         // update aerodynamic conductance
-                        myNode[i].boundary->Heat->aerodynamicConductance =
-                                AerodynamicConductance(myNode[i].boundary->Heat->heightTemperature,
-                                    myNode[i].boundary->Heat->heightWind,
-                                    myNode[i].extra->Heat->T,
-                                    myNode[i].boundary->Heat->roughnessHeight,
-                                    myNode[i].boundary->Heat->temperature,
-                                    myNode[i].boundary->Heat->windSpeed);
-
-                        if (myStructure.computeWater)
+                        myDomain->node[i].boundary->Heat->aerodynamicConductance =
+                                AerodynamicConductance(myDomain->node[i].boundary->Heat->heightTemperature,
+                                    myDomain->node[i].boundary->Heat->heightWind,
+                                    myDomain->node[i].extra->Heat->T,
+                                    myDomain->node[i].boundary->Heat->roughnessHeight,
+                                    myDomain->node[i].boundary->Heat->temperature,
+                                    myDomain->node[i].boundary->Heat->windSpeed);
+
+                        if (myDomain->structure.computeWater)
                             // update soil surface conductance
                         {
-                            double theta = theta_from_sign_Psi(myNode[i].H - myNode[i].z, i);
-                            myNode[i].boundary->Heat->soilConductance = 1./ computeSoilSurfaceResistance(theta);
+                            double theta = theta_from_sign_Psi(myDomain, myDomain->nodeState.H[i] - myDomain->node[i].z, i);
+                            myDomain->node[i].boundary->Heat->soilConductance = 1./ computeSoilSurfaceResistance(theta);
                         }
                     }
 }
 
 
-void updateBoundaryWater(double deltaT)
+void updateBoundaryWater(TCrit3DDomain *myDomain, double deltaT)
 {
     double boundaryPsi, boundarySe, boundaryK, meanK;
     double const EPSILON_mm = 0.0001;          //0.1 mm
     double area, boundarySide, boundaryArea, Hs, avgH, maxFlow, flow;
 
-    for (long i = 0; i < myStructure.nrNodes; i++)
+    for (long i = 0; i < myDomain->structure.nrNodes; i++)
     {
         // extern sink/source
-        myNode[i].Qw = myNode[i].waterSinkSource;
+        myDomain->nodeState.Qw[i] = myDomain->nodeState.waterSinkSource[i];
 
-        if (myNode[i].boundary != nullptr)
+        if (myDomain->node[i].boundary != nullptr)
         {
             // initialize
-            myNode[i].boundary->waterFlow = 0.;
+            myDomain->node[i].boundary->waterFlow = 0.;
 
-            if (myNode[i].boundary->type == BOUNDARY_RUNOFF)
+            if (myDomain->node[i].boundary->type == BOUNDARY_RUNOFF)
             {
                 // current surface water available to runoff [m]
-                avgH = (myNode[i].H + myNode[i].oldH) * 0.5;
-                Hs = maxValue(avgH - (myNode[i].z + myNode[i].Soil->Pond), 0.0);
+                avgH = (myDomain->nodeState.H[i] + myDomain->nodeState.oldH[i]) * 0.5;
+                Hs = maxValue(avgH - (myDomain->node[i].z + myDomain->node[i].Soil->Pond), 0.0);
                 if (Hs > EPSILON_mm)
                 {
-                    area = myNode[i].volume_area;       //  [m^2] (surface)
+                    area = myDomain->node[i].volume_area;       //  [m^2] (surface)
                     boundarySide = sqrt(area);          //  [m] approximation: side = sqrt(area)
                     maxFlow = (Hs * area) / deltaT;     //  [m^3 s^-1] max available flow in time step
                     boundaryArea = boundarySide * Hs;   //  [m^2]
                     // [m^3 s^-1] Manning
-                    flow = boundaryArea *(pow(Hs, (2./3.)) / myNode[i].Soil->Roughness) * sqrt(myNode[i].boundary->slope);
-                    myNode[i].boundary->waterFlow = -minValue(flow, maxFlow);
+                    flow = boundaryArea *(pow(Hs, (2./3.)) / myDomain->node[i].Soil->Roughness) * sqrt(myDomain->node[i].boundary->slope);
+                    myDomain->node[i].boundary->waterFlow = -minValue(flow, maxFlow);
                 }
             }
-            else if (myNode[i].boundary->type == BOUNDARY_FREEDRAINAGE)
+            else if (myDomain->node[i].boundary->type == BOUNDARY_FREEDRAINAGE)
             {
                 // [m^3 s^-1] Darcy unit gradient
                 // dH=dz=L  ->  q=K(h)
-                double myFlux = -myNode[i].k * myNode[i].up.area;
-                myNode[i].boundary->waterFlow = myFlux;               
+                double myFlux = -myDomain->nodeState.k[i] * myDomain->node[i].up.area;
+                myDomain->node[i].boundary->waterFlow = myFlux;               
             }
 
-            else if (myNode[i].boundary->type == BOUNDARY_FREELATERALDRAINAGE)
+            else if (myDomain->node[i].boundary->type == BOUNDARY_FREELATERALDRAINAGE)
             {
                 // TODO approximation: boundary area equal to other lateral link
-				area = myNode[i].lateral[0].area;
+				area = myDomain->node[i].lateral[0].area;
                 // [m^3 s^-1] Darcy,  gradient = slope (dH=dz)
-                myNode[i].boundary->waterFlow = -myNode[i].k * area * myNode[i].boundary->slope
-                                            * myParameters.k_lateral_vertical_ratio;
+                myDomain->node[i].boundary->waterFlow = -myDomain->nodeState.k[i] * area * myDomain->node[i].boundary->slope
+                                            * myDomain->parameters.k_lateral_vertical_ratio;
             }
 
-            else if (myNode[i].boundary->type == BOUNDARY_PRESCRIBEDTOTALPOTENTIAL)
+            else if (myDomain->node[i].boundary->type == BOUNDARY_PRESCRIBEDTOTALPOTENTIAL)
             {
-                if (myNode[i].boundary->prescribedTotalPotential >= myNode[i].z)
-                    boundaryK = myNode[i].Soil->K_sat;
+                if (myDomain->node[i].boundary->prescribedTotalPotential >= myDomain->node[i].z)
+                    boundaryK = myDomain->node[i].Soil->K_sat;
                 else
                 {
-                    boundaryPsi = fabs(myNode[i].boundary->prescribedTotalPotential - myNode[i].z);
-                    boundarySe = computeSefromPsi(boundaryPsi, myNode[i].Soil);
-                    boundaryK = computeWaterConductivity(boundarySe, myNode[i].Soil);
+                    boundaryPsi = fabs(myDomain->node[i].boundary->prescribedTotalPotential - myDomain->node[i].z);
+                    boundarySe = computeSefromPsi(myDomain, boundaryPsi, myDomain->node[i].Soil);
+                    boundaryK = computeWaterConductivity(myDomain, boundarySe, myDomain->node[i].Soil);
                 }
-                meanK = computeMean(myNode[i].k, boundaryK);
-                myNode[i].boundary->waterFlow = meanK * (myNode[i].boundary->prescribedTotalPotential - myNode[i].H) * myNode[i].up.area;
+                meanK = computeMean(myDomain, myDomain->nodeState.k[i], boundaryK);
+                myDomain->node[i].boundary->waterFlow = meanK * (myDomain->node[i].boundary->prescribedTotalPotential - myDomain->nodeState.H[i]) * myDomain->node[i].up.area;
             }
 
-            else if (myNode[i].boundary->type == BOUNDARY_HEAT_SURFACE)
+            else if (myDomain->node[i].boundary->type == BOUNDARY_HEAT_SURFACE)
             {
 
-                if (myStructure.computeHeat && myStructure.computeHeatVapor)
+                if (myDomain->structure.computeHeat && myDomain->structure.computeHeatVapor)
                 {
                     long upIndex;
 
                     double surfaceWaterFraction = 0.;
-                    if (&(myNode[i].up) != nullptr)
+                    if (&(myDomain->node[i].up) != nullptr)
                     {
-                        upIndex = myNode[i].up.index;
-                        surfaceWaterFraction = getSurfaceWaterFraction(upIndex);
+                        upIndex = myDomain->node[i].up.index;
+                        surfaceWaterFraction = getSurfaceWaterFraction(myDomain, upIndex);
                     }
 
-                    double evapFromSoil = computeAtmosphericLatentFlux(i) / WATER_DENSITY * myNode[i].up.area;
+                    double evapFromSoil = computeAtmosphericLatentFlux(myDomain, i) / WATER_DENSITY * myDomain->node[i].up.area;
 
                     // surface water
                     if (surfaceWaterFraction > 0.)
                     {
-                        double waterVolume = (myNode[upIndex].H - myNode[upIndex].z) * myNode[upIndex].volume_area;
-                        double evapFromSurface = computeAtmosphericLatentFluxSurfaceWater(upIndex) / WATER_DENSITY * myNode[i].up.area;
+                        double waterVolume = (myDomain->nodeState.H[upIndex] - myDomain->node[upIndex].z) * myDomain->node[upIndex].volume_area;
+                        double evapFromSurface = computeAtmosphericLatentFluxSurfaceWater(myDomain, upIndex) / WATER_DENSITY * myDomain->node[i].up.area;
 
                         evapFromSoil *= (1. - surfaceWaterFraction);
                         evapFromSurface *= surfaceWaterFraction;
 
                         evapFromSurface = maxValue(evapFromSurface, -waterVolume / deltaT);
 
-                        if (myNode[upIndex].boundary != nullptr)
-                            myNode[upIndex].boundary->waterFlow = evapFromSurface;
+                        if (myDomain->node[upIndex].boundary != nullptr)
+                            myDomain->node[upIndex].boundary->waterFlow = evapFromSurface;
                         else
-                            myNode[upIndex].Qw += evapFromSurface;
+                            myDomain->nodeState.Qw[upIndex] += evapFromSurface;
 
                     }
 
                     if (evapFromSoil < 0.)
-                        evapFromSoil = maxValue(evapFromSoil, -(theta_from_Se(i) - myNode[i].Soil->Theta_r) * myNode[i].volume_area / deltaT);
+                        evapFromSoil = maxValue(evapFromSoil, -(theta_from_Se(myDomain, i) - myDomain->node[i].Soil->Theta_r) * myDomain->node[i].volume_area / deltaT);
                     else
-                        evapFromSoil = minValue(evapFromSoil, (myNode[i].Soil->Theta_s - myNode[i].Soil->Theta_r) * myNode[i].volume_area / deltaT);
+                        evapFromSoil = minValue(evapFromSoil, (myDomain->node[i].Soil->Theta_s - myDomain->node[i].Soil->Theta_r) * myDomain->node[i].volume_area / deltaT);
 
-                    myNode[i].boundary->waterFlow = evapFromSoil;
+                    myDomain->node[i].boundary->waterFlow = evapFromSoil;
                 }
             }            
 
-            myNode[i].Qw += myNode[i].boundary->waterFlow;
+            myDomain->nodeState.Qw[i] += myDomain->node[i].boundary->waterFlow;
         }
     }
 
 	// Culvert
-	if (myCulvert.index != NOLINK)
+	if (myDomain->culvert.index != NOLINK)
 	{
-		long i = myCulvert.index;
-		double waterLevel = 0.5 * (myNode[i].H + myNode[i].oldH) - myNode[i].z;		// [m]
+		long i = myDomain->culvert.index;
+		double waterLevel = 0.5 * (myDomain->nodeState.H[i] + myDomain->nodeState.oldH[i]) - myDomain->node[i].z;		// [m]
 		//maxFlow = (waterLevel * myNode[i].volume_area) / deltaT;					// [m^3 s^-1] max available flow in the time step
 
 		flow = 0.0;
 
-		if (waterLevel >= myCulvert.height * 1.5)
+		if (waterLevel >= myDomain->culvert.height * 1.5)
 		{
 			// pressure flow - Hazen-Williams equation
-			double equivalentDiameter = sqrt((4. * myCulvert.width * myCulvert.height) / PI);
+			double equivalentDiameter = sqrt((4. * myDomain->culvert.width * myDomain->culvert.height) / PI);
 			// roughness = 70 (rough concrete)
-			flow = (70. * pow(myCulvert.slope, 0.54) * pow(equivalentDiameter, 2.63)) / 3.591;
+			flow = (70. * pow(myDomain->culvert.slope, 0.54) * pow(equivalentDiameter, 2.63)) / 3.591;
 
 		}
-		else if (waterLevel > myCulvert.height)
+		else if (waterLevel > myDomain->culvert.height)
 		{
 			// mixed flow: open channel - pressure flow
-			area = myCulvert.width * myCulvert.height;							// [m^2]
-			double wettedPerimeter = myCulvert.width + 2.* myCulvert.height;	// [m]
+			area = myDomain->culvert.width * myDomain->culvert.height;							// [m^2]
+			double wettedPerimeter = myDomain->culvert.width + 2.* myDomain->culvert.height;	// [m]
 			double hydraulicRadius = area / wettedPerimeter;					// [m]
 
 			// maximum Manning flow [m^3 s^-1]
-			double ManningFlow = (area / myCulvert.roughness) * sqrt(myCulvert.slope) * pow(hydraulicRadius, 2. / 3.);
+			double ManningFlow = (area / myDomain->culvert.roughness) * sqrt(myDomain->culvert.slope) * pow(hydraulicRadius, 2. / 3.);
 
 			// pressure flow - Hazen-Williams equation - roughness = 70
-			double equivalentDiameter = sqrt((4. * myCulvert.width * myCulvert.height) / PI);
-			double pressureFlow = (70. * pow(myCulvert.slope, 0.54) * pow(equivalentDiameter, 2.63)) / 3.591;
+			double equivalentDiameter = sqrt((4. * myDomain->culvert.width * myDomain->culvert.height) / PI);
+			double pressureFlow = (70. * pow(myDomain->culvert.slope, 0.54) * pow(equivalentDiameter, 2.63)) / 3.591;
 
-			double weight = (waterLevel - myCulvert.height) / (myCulvert.height * 0.5);
+			double weight = (waterLevel - myDomain->culvert.height) / (myDomain->culvert.height * 0.5);
 			flow = weight * pressureFlow + (1. - weight) * ManningFlow;
 
 		}
-		else if (waterLevel > myNode[i].Soil->Pond)
+		else if (waterLevel > myDomain->node[i].Soil->Pond)
 		{
 			// open channel flow
-			area = myCulvert.width * waterLevel;							// [m^2]
-			double wettedPerimeter = myCulvert.width + 2.0 * waterLevel;	// [m]
+			area = myDomain->culvert.width * waterLevel;							// [m^2]
+			double wettedPerimeter = myDomain->culvert.width + 2.0 * waterLevel;	// [m]
 			double hydraulicRadius = area / wettedPerimeter;				// [m]
 
 			// Manning equation [m^3 s^-1] 
-			flow = (area / myCulvert.roughness) * sqrt(myCulvert.slope) * pow(hydraulicRadius, 2./3.);
+			flow = (area / myDomain->culvert.roughness) * sqrt(myDomain->culvert.slope) * pow(hydraulicRadius, 2./3.);
 		}
 
 		// set boundary
-		myNode[i].boundary->waterFlow = -flow;
-		myNode[i].Qw += myNode[i].boundary->waterFlow;
+		myDomain->node[i].boundary->waterFlow = -flow;
+		myDomain->nodeState.Qw[i] += myDomain->node[i].boundary->waterFlow;
 	}
 }
 
 
-void updateBoundaryHeat()
+void updateBoundaryHeat(TCrit3DDomain *myDomain)
 {
     double myWaterFlux, advTemperature, heatFlux;
 
-    for (long i = 1; i < myStructure.nrNodes; i++)
+    for (long i = 1; i < myDomain->structure.nrNodes; i++)
     {
-        if (isHeatNode(i))
+        if (isHeatNode(myDomain, i))
         {
-            myNode[i].extra->Heat->Qh = myNode[i].extra->Heat->sinkSource;
+            myDomain->node[i].extra->Heat->Qh = myDomain->node[i].extra->Heat->sinkSource;
 
-            if (myNode[i].boundary != nullptr)
+            if (myDomain->node[i].boundary != nullptr)
             {
-                if (myNode[i].boundary->type == BOUNDARY_HEAT_SURFACE)
+                if (myDomain->node[i].boundary->type == BOUNDARY_HEAT_SURFACE)
                 {
-                    myNode[i].boundary->Heat->advectiveHeatFlux = 0.;
-                    myNode[i].boundary->Heat->sensibleFlux = 0.;
-                    myNode[i].boundary->Heat->latentFlux = 0.;
-                    myNode[i].boundary->Heat->radiativeFlux = 0.;
+                    myDomain->node[i].boundary->Heat->advectiveHeatFlux = 0.;
+                    myDomain->node[i].boundary->Heat->sensibleFlux = 0.;
+                    myDomain->node[i].boundary->Heat->latentFlux = 0.;
+                    myDomain->node[i].boundary->Heat->radiativeFlux = 0.;
 
-                    if (myNode[i].boundary->Heat->netIrradiance != NODATA)
-                        myNode[i].boundary->Heat->radiativeFlux = myNode[i].boundary->Heat->netIrradiance;
+                    if (myDomain->node[i].boundary->Heat->netIrradiance != NODATA)
+                        myDomain->node[i].boundary->Heat->radiativeFlux = myDomain->node[i].boundary->Heat->netIrradiance;
 
-                    myNode[i].boundary->Heat->sensibleFlux += computeAtmosphericSensibleFlux(i);
+                    myDomain->node[i].boundary->Heat->sensibleFlux += computeAtmosphericSensibleFlux(myDomain, i);
 
-                    if (myStructure.computeWater && myStructure.computeHeatVapor)
-                        myNode[i].boundary->Heat->latentFlux += computeAtmosphericLatentHeatFlux(i) / myNode[i].up.area;
+                    if (myDomain->structure.computeWater && myDomain->structure.computeHeatVapor)
+                        myDomain->node[i].boundary->Heat->latentFlux += computeAtmosphericLatentHeatFlux(myDomain, i) / myDomain->node[i].up.area;
 
-                    if (myStructure.computeWater && myStructure.computeHeatAdvection)
+                    if (myDomain->structure.computeWater && myDomain->structure.computeHeatAdvection)
                     {
                         // advective heat from rain
-                        myWaterFlux = myNode[i].up.linkedExtra->heatFlux->waterFlux;
+                        myWaterFlux = myDomain->node[i].up.linkedExtra->heatFlux->waterFlux;
                         if (myWaterFlux > 0.)
                         {
-                            advTemperature = myNode[i].boundary->Heat->temperature;
-                            heatFlux =  myWaterFlux * HEAT_CAPACITY_WATER * advTemperature / myNode[i].up.area;
-                            myNode[i].boundary->Heat->advectiveHeatFlux += heatFlux;
+                            advTemperature = myDomain->node[i].boundary->Heat->temperature;
+                            heatFlux =  myWaterFlux * HEAT_CAPACITY_WATER * advTemperature / myDomain->node[i].up.area;
+                            myDomain->node[i].boundary->Heat->advectiveHeatFlux += heatFlux;
                         }
 
                         // advective heat from evaporation/condensation
-                        if (myNode[i].boundary->waterFlow < 0.)
-                            advTemperature = myNode[i].extra->Heat->T;
+                        if (myDomain->node[i].boundary->waterFlow < 0.)
+                            advTemperature = myDomain->node[i].extra->Heat->T;
                         else
-                            advTemperature = myNode[i].boundary->Heat->temperature;
+                            advTemperature = myDomain->node[i].boundary->Heat->temperature;
 
-                        myNode[i].boundary->Heat->advectiveHeatFlux += myNode[i].boundary->waterFlow * WATER_DENSITY * HEAT_CAPACITY_WATER_VAPOR * advTemperature / myNode[i].up.area;
+                        myDomain->node[i].boundary->Heat->advectiveHeatFlux += myDomain->node[i].boundary->waterFlow * WATER_DENSITY * HEAT_CAPACITY_WATER_VAPOR * advTemperature / myDomain->node[i].up.area;
 
                     }
 
-                    myNode[i].extra->Heat->Qh += myNode[i].up.area * (myNode[i].boundary->Heat->radiativeFlux +
-                                                                      myNode[i].boundary->Heat->sensibleFlux +
-                                                                      myNode[i].boundary->Heat->latentFlux +
-                                                                      myNode[i].boundary->Heat->advectiveHeatFlux);
+                    myDomain->node[i].extra->Heat->Qh += myDomain->node[i].up.area * (myDomain->node[i].boundary->Heat->radiativeFlux +
+                                                                      myDomain->node[i].boundary->Heat->sensibleFlux +
+                                                                      myDomain->node[i].boundary->Heat->latentFlux +
+                                                                      myDomain->node[i].boundary->Heat->advectiveHeatFlux);
                 }
-                else if (myNode[i].boundary->type == BOUNDARY_FREEDRAINAGE ||
-                         myNode[i].boundary->type == BOUNDARY_PRESCRIBEDTOTALPOTENTIAL)
+                else if (myDomain->node[i].boundary->type == BOUNDARY_FREEDRAINAGE ||
+                         myDomain->node[i].boundary->type == BOUNDARY_PRESCRIBEDTOTALPOTENTIAL)
                 {
-                    if (myStructure.computeWater && myStructure.computeHeatAdvection)
+                    if (myDomain->structure.computeWater && myDomain->structure.computeHeatAdvection)
                     {
-                        myWaterFlux = myNode[i].boundary->waterFlow;
+                        myWaterFlux = myDomain->node[i].boundary->waterFlow;
 
                         if (myWaterFlux < 0)
-                            advTemperature = myNode[i].extra->Heat->T;
+                            advTemperature = myDomain->node[i].extra->Heat->T;
                         else
-                            advTemperature = myNode[i].boundary->Heat->fixedTemperature;
+                            advTemperature = myDomain->node[i].boundary->Heat->fixedTemperature;
 
-                        heatFlux =  myWaterFlux * HEAT_CAPACITY_WATER * advTemperature / myNode[i].up.area;
-                        myNode[i].boundary->Heat->advectiveHeatFlux = heatFlux;
+                        heatFlux =  myWaterFlux * HEAT_CAPACITY_WATER * advTemperature / myDomain->node[i].up.area;
+                        myDomain->node[i].boundary->Heat->advectiveHeatFlux = heatFlux;
 
-                        myNode[i].extra->Heat->Qh += myNode[i].up.area * myNode[i].boundary->Heat->advectiveHeatFlux;
+                        myDomain->node[i].extra->Heat->Qh += myDomain->node[i].up.area * myDomain->node[i].boundary->Heat->advectiveHeatFlux;
                     }
 
-                    if (myNode[i].boundary->Heat->fixedTemperature != NODATA)
+                    if (myDomain->node[i].boundary->Heat->fixedTemperature != NODATA)
                     {
-                        double avgH = getHMean(i);
-                        double boundaryHeatConductivity = SoilHeatConductivity(i, myNode[i].extra->Heat->T, avgH - myNode[i].z);
-                        double deltaT = myNode[i].boundary->Heat->fixedTemperature - myNode[i].extra->Heat->T;
-                        myNode[i].extra->Heat->Qh += boundaryHeatConductivity * deltaT / myNode[i].boundary->Heat->fixedTemperatureDepth * myNode[i].up.area;
+                        double avgH = getHMean(myDomain, i);
+                        double boundaryHeatConductivity = SoilHeatConductivity(myDomain, i, myDomain->node[i].extra->Heat->T, avgH - myDomain->node[i].z);
+                        double deltaT = myDomain->node[i].boundary->Heat->fixedTemperature - myDomain->node[i].extra->Heat->T;
+                        myDomain->node[i].extra->Heat->Qh += boundaryHeatConductivity * deltaT / myDomain->node[i].boundary->Heat->fixedTemperatureDepth * myDomain->node[i].up.area;
                     }
                 }
             }
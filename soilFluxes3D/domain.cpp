@@ -0,0 +1,64 @@
+/*!
+    \name domain.cpp
+    \copyright (C) 2011 Fausto Tomei, Gabriele Antolini, Antonio Volta,
+                        Alberto Pistocchi, Marco Bittelli
+
+    This file is part of CRITERIA3D.
+    CRITERIA3D has been developed under contract issued by A.R.P.A. Emilia-Romagna
+
+    CRITERIA3D is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    CRITERIA3D is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with CRITERIA3D.  If not, see <http://www.gnu.org/licenses/>.
+
+    contacts:
+    fausto.tomei@gmail.com
+    ftomei@arpae.emr.it
+    gantolini@arpae.emr.it
+*/
+
+#include "header/types.h"
+#include "header/domain.h"
+
+
+/*! domain selected on the thread (nullptr: default domain) */
+static thread_local TCrit3DDomain *selectedDomain = nullptr;
+
+
+/*!
+ * \brief default domain of the process
+ * (used by the API on the threads that did not select a domain)
+ */
+TCrit3DDomain* getDefaultDomain()
+{
+    static TCrit3DDomain defaultDomain;
+    return &defaultDomain;
+}
+
+
+TCrit3DDomain* getCurrentDomain()
+{
+    if (selectedDomain == nullptr)
+        return getDefaultDomain();
+
+    return selectedDomain;
+}
+
+
+/*!
+ * \brief select myDomain on the current thread (nothing is copied)
+ * nullptr selects the default domain
+ */
+void setCurrentDomain(TCrit3DDomain *myDomain)
+{
+    if (myDomain == getDefaultDomain()) myDomain = nullptr;
+    selectedDomain = myDomain;
+}
@@ -32,6 +32,7 @@
 #include "../mathFunctions/commonConstants.h"
 #include "header/extra.h"
 #include "header/types.h"
+#include "header/domain.h"
 
 
 void initializeExtraHeat(TCrit3DNodeHeat* myNodeExtraHeat)
@@ -57,15 +58,15 @@ void initializeExtra(TCrit3DnodeExtra *myNodeExtra, bool computeHeat, bool compu
     }
 }
 
-void initializeNodeHeatFlux(TCrit3DLinkedNodeExtra* myLinkExtra, bool initHeat, bool initWater)
+void initializeNodeHeatFlux(TCrit3DDomain *myDomain, TCrit3DLinkedNodeExtra* myLinkExtra, bool initHeat, bool initWater)
 {
     if (myLinkExtra == nullptr) return;
     if (myLinkExtra->heatFlux == nullptr) return;
-    if (! myStructure.computeHeat) return;
+    if (! myDomain->structure.computeHeat) return;
 
-    if (myStructure.saveHeatFluxesType == SAVE_HEATFLUXES_TOTAL && initHeat)
+    if (myDomain->structure.saveHeatFluxesType == SAVE_HEATFLUXES_TOTAL && initHeat)
         myLinkExtra->heatFlux->fluxes[HEATFLUX_TOTAL] = NODATA;
-    else if (myStructure.saveHeatFluxesType == SAVE_HEATFLUXES_ALL)
+    else if (myDomain->structure.saveHeatFluxesType == SAVE_HEATFLUXES_ALL)
     {
         if (initHeat)
         {
@@ -87,7 +88,7 @@ void initializeNodeHeatFlux(TCrit3DLinkedNodeExtra* myLinkExtra, bool initHeat,
 
 }
 
-void initializeLinkExtra(TCrit3DLinkedNodeExtra* myLinkedNodeExtra, bool computeHeat, bool computeSolutes)
+void initializeLinkExtra(TCrit3DDomain *myDomain, TCrit3DLinkedNodeExtra* myLinkedNodeExtra, bool computeHeat, bool computeSolutes)
 {
     if (computeHeat)
     {
@@ -96,14 +97,14 @@ void initializeLinkExtra(TCrit3DLinkedNodeExtra* myLinkedNodeExtra, bool compute
         (*myLinkedNodeExtra).heatFlux->waterFlux = 0.;
         (*myLinkedNodeExtra).heatFlux->vaporFlux = 0.;
 
-        if (myStructure.saveHeatFluxesType == SAVE_HEATFLUXES_ALL)
+        if (myDomain->structure.saveHeatFluxesType == SAVE_HEATFLUXES_ALL)
             (*myLinkedNodeExtra).heatFlux->fluxes = new float[9];
-        else if (myStructure.saveHeatFluxesType == SAVE_HEATFLUXES_TOTAL)
+        else if (myDomain->structure.saveHeatFluxesType == SAVE_HEATFLUXES_TOTAL)
             (*myLinkedNodeExtra).heatFlux->fluxes = new float[1];
         else
             (*myLinkedNodeExtra).heatFlux->fluxes = nullptr;
 
-        initializeNodeHeatFlux(myLinkedNodeExtra, true, true);
+        initializeNodeHeatFlux(myDomain, myLinkedNodeExtra, true, true);
 
     }
     else (*myLinkedNodeExtra).heatFlux = nullptr;
@@ -2,14 +2,16 @@
 #define BALANCE_H
 
     struct TlinkedNode;
+    struct TCrit3DDomain;
 
-    void halveTimeStep();
-    bool getForcedHalvedTime();
-    void setForcedHalvedTime(bool isForced);
-    double computeTotalWaterContent();
-    double getMatrixValue(long i, TlinkedNode *link);
-    void InitializeBalanceWater();
-    bool waterBalance(double deltaT, int approxNr);
-    void updateBalanceWaterWholePeriod();
+    void halveTimeStep(TCrit3DDomain *myDomain);
+    void reduceTimeStep(TCrit3DDomain *myDomain, double factor);
+    bool getForcedHalvedTime(TCrit3DDomain *myDomain);
+    void setForcedHalvedTime(TCrit3DDomain *myDomain, bool isForced);
+    double computeTotalWaterContent(TCrit3DDomain *myDomain);
+    double getMatrixValue(TCrit3DDomain *myDomain, long i, TlinkedNode *link);
+    void InitializeBalanceWater(TCrit3DDomain *myDomain);
+    bool waterBalance(TCrit3DDomain *myDomain, double deltaT, int approxNr);
+    void updateBalanceWaterWholePeriod(TCrit3DDomain *myDomain);
 
 #endif  // BALANCE_H
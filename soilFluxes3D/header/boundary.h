@@ -2,11 +2,12 @@
 #define BOUNDARY_H
 
     struct Tboundary;
+    struct TCrit3DDomain;
 
-    void updateBoundary();
-    void updateBoundaryHeat();
-    void updateBoundaryWater(double deltaT);
-    void initializeBoundary(Tboundary *myBoundary, int myType, float slope);
+    void updateBoundary(TCrit3DDomain *myDomain);
+    void updateBoundaryHeat(TCrit3DDomain *myDomain);
+    void updateBoundaryWater(TCrit3DDomain *myDomain, double deltaT);
+    void initializeBoundary(TCrit3DDomain *myDomain, Tboundary *myBoundary, int myType, float slope);
 
 #endif  // BOUNDARY_H
 
@@ -0,0 +1,66 @@
+#ifndef DOMAIN_H
+#define DOMAIN_H
+
+    #ifndef SOILFLUXES3DTYPES
+        #include "types.h"
+    #endif
+    #ifndef SOILFLUXES3D
+        #include "soilFluxes3D.h"
+    #endif
+    #include <vector>
+
+    /*!
+     * \brief TCrit3DDomain
+     * owns the complete state of one 3D domain (nodes, matrix, balances and parameters).
+     * The solver functions work on the domain they receive: independent domains
+     * can be computed at the same time on different threads.
+     * The API works on the domain selected on the calling thread,
+     * or on the single default domain of the process when no domain has been selected
+     */
+    struct TCrit3DDomain{
+        TCrit3DStructure structure;
+        TParameters parameters;
+        Tculvert culvert;
+
+        TCrit3Dnode *node;
+        TCrit3DnodeState nodeState;
+        Tmatrix A;
+        double *b, *C, *X;
+        double *invariantFlux;              /*!< advective and latent fluxes */
+        TnodeColoring coloring;
+
+        Tbalance balanceCurrentTimeStep, balancePreviousTimeStep, balanceCurrentPeriod, balanceWholePeriod;
+        TsolverStatistics statistics;
+        double courant;                     /*!< [-] Courant number of the last water step */
+
+        std::vector<Tsoil> soilList;        /*!< [MAX_SOILS x MAX_HORIZONS] soil horizons */
+        std::vector<Tsoil> surfaceList;     /*!< [MAX_SURFACES] surface properties */
+
+        double bestMBRerror;                /*!< [-] best mass balance ratio of the current time step */
+        bool isHalfTimeStepForced;          /*!< the current time step has been rejected */
+        std::vector<double> krylovWork;     /*!< work arrays of the Krylov solvers */
+        std::vector<char> isActiveRow;      /*!< rows solved by the Krylov solvers */
+
+        TCrit3DDomain()
+            {
+                structure.initialize();
+                parameters.initialize();
+
+                node = nullptr;
+                b = C = X = invariantFlux = nullptr;
+                statistics = TsolverStatistics();
+                courant = 0.;
+
+                bestMBRerror = 100.;
+                isHalfTimeStepForced = false;
+
+                soilList.resize(MAX_SOILS * MAX_HORIZONS);
+                surfaceList.resize(MAX_SURFACES);
+            }
+        } ;
+
+    TCrit3DDomain* getDefaultDomain();
+    TCrit3DDomain* getCurrentDomain();
+    void setCurrentDomain(TCrit3DDomain *myDomain);
+
+#endif // DOMAIN_H
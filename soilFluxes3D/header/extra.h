@@ -40,8 +40,10 @@
         TCrit3DNodeHeat *Heat;      /*!< heat pointer */
        } ;
 
+    struct TCrit3DDomain;
+
     void initializeExtra(TCrit3DnodeExtra *myNodeExtra, bool computeHeat, bool computeSolutes);
-    void initializeLinkExtra(TCrit3DLinkedNodeExtra* myLinkedNodeExtra, bool computeHeat, bool computeSolutes);
-    void initializeNodeHeatFlux(TCrit3DLinkedNodeExtra* myLinkExtra, bool initHeat, bool initWater);
+    void initializeLinkExtra(TCrit3DDomain *myDomain, TCrit3DLinkedNodeExtra* myLinkedNodeExtra, bool computeHeat, bool computeSolutes);
+    void initializeNodeHeatFlux(TCrit3DDomain *myDomain, TCrit3DLinkedNodeExtra* myLinkExtra, bool initHeat, bool initWater);
 
 #endif // TYPESEXTRA_H
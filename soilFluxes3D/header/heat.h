@@ -2,24 +2,25 @@
 #define HEAT_H
 
     struct TlinkedNode;
+    struct TCrit3DDomain;
 
-    bool isHeatNode(long i);
-    double ThermalVaporFlux(long i, TlinkedNode *myLink, int myProcess, double timeStep, double timeStepWater);
-    double ThermalLiquidFlux(long i, TlinkedNode *myLink, int myProcess, double timeStep, double timeStepWater);
-    double IsothermalVaporConductivity(long i, double h, double myT);
-    double IsothermalVaporFlux(long i, TlinkedNode *myLink, double timeStep, double timeStepWater);
+    bool isHeatNode(TCrit3DDomain *myDomain, long i);
+    double ThermalVaporFlux(TCrit3DDomain *myDomain, long i, TlinkedNode *myLink, int myProcess, double timeStep, double timeStepWater);
+    double ThermalLiquidFlux(TCrit3DDomain *myDomain, long i, TlinkedNode *myLink, int myProcess, double timeStep, double timeStepWater);
+    double IsothermalVaporConductivity(TCrit3DDomain *myDomain, long i, double h, double myT);
+    double IsothermalVaporFlux(TCrit3DDomain *myDomain, long i, TlinkedNode *myLink, double timeStep, double timeStepWater);
     double SoilRelativeHumidity(double h, double myT);
-    double SoilHeatCapacity(long i, double h, double T);
-    double SoilHeatConductivity(long i, double T, double h);
+    double SoilHeatCapacity(TCrit3DDomain *myDomain, long i, double h, double T);
+    double SoilHeatConductivity(TCrit3DDomain *myDomain, long i, double T, double h);
     double VaporFromPsiTemp(double h, double T);
-    double VaporThetaV(double h, double T, long i);
-    void restoreHeat();
-    void initializeBalanceHeat();
-    void updateBalanceHeatWholePeriod();
-    void initializeHeatFluxes(bool initHeat, bool initWater);
-    void saveWaterFluxes(double dtHeat, double timeStepWater);
-    void saveHeatFlux(TlinkedNode* myLink, int fluxType, double myValue);
-    float readHeatFlux(TlinkedNode* myLink, int fluxType);
-    bool HeatComputation(double timeStep, double timeStepWater);
+    double VaporThetaV(TCrit3DDomain *myDomain, double h, double T, long i);
+    void restoreHeat(TCrit3DDomain *myDomain);
+    void initializeBalanceHeat(TCrit3DDomain *myDomain);
+    void updateBalanceHeatWholePeriod(TCrit3DDomain *myDomain);
+    void initializeHeatFluxes(TCrit3DDomain *myDomain, bool initHeat, bool initWater);
+    void saveWaterFluxes(TCrit3DDomain *myDomain, double dtHeat, double timeStepWater);
+    void saveHeatFlux(TCrit3DDomain *myDomain, TlinkedNode* myLink, int fluxType, double myValue);
+    float readHeatFlux(TCrit3DDomain *myDomain, TlinkedNode* myLink, int fluxType);
+    bool HeatComputation(TCrit3DDomain *myDomain, double timeStep, double timeStepWater);
 
 #endif
@@ -0,0 +1,13 @@
+#ifndef HYDRAULICTABLE_H
+#define HYDRAULICTABLE_H
+
+    struct Tsoil;
+    struct TCrit3DDomain;
+
+    int buildHydraulicTable(TCrit3DDomain *myDomain, Tsoil *mySoil);
+
+    void computeSeBatch(TCrit3DDomain *myDomain, long firstNode, long lastNode);
+
+    void computeConductivityCapacityBatch(TCrit3DDomain *myDomain, long firstNode, long lastNode, double *dThetadH);
+
+#endif  // HYDRAULICTABLE_H
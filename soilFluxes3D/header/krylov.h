@@ -0,0 +1,12 @@
+#ifndef KRYLOV_H
+#define KRYLOV_H
+
+    struct TCrit3DDomain;
+
+    bool conjugateGradient(TCrit3DDomain *myDomain, const char *isActive, int maxIterationsNr, double residualTolerance,
+                           int *nrIterations, double *residual);
+
+    bool biConjugateGradientStabilized(TCrit3DDomain *myDomain, const char *isActive, int maxIterationsNr, double residualTolerance,
+                                       int *nrIterations, double *residual);
+
+#endif  // KRYLOV_H
@@ -1,6 +1,14 @@
 
-void cleanArrays();
+struct TCrit3DDomain;
 
-void cleanNodes();
+void cleanArrays(TCrit3DDomain *myDomain);
 
-int initializeArrays();
+void cleanColoring(TCrit3DDomain *myDomain);
+
+void cleanNodeState(TCrit3DDomain *myDomain);
+
+void cleanNodes(TCrit3DDomain *myDomain);
+
+int initializeNodeState(TCrit3DDomain *myDomain);
+
+int initializeArrays(TCrit3DDomain *myDomain);
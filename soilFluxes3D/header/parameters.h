@@ -15,10 +15,13 @@
     int iterazioni_min;
     int iterazioni_max;
     int maxApproximationsNumber;
+    bool isAdaptiveTimeStep;
     int waterRetentionCurve;
+    bool useHydraulicTables;
     int meanType;
     float k_lateral_vertical_ratio;
     double heatWeightingFactor;
+    int nrThreads;
 
     void initialize()
         {
@@ -28,12 +31,15 @@
         current_delta_t = delta_t_max;
         iterazioni_max = 200;
         maxApproximationsNumber = 10;
+        isAdaptiveTimeStep = false;
         MBRThreshold = 1E-6;
         ResidualTolerance = 1E-10;
         waterRetentionCurve = MODIFIEDVANGENUCHTEN;
+        useHydraulicTables = false;
         meanType = MEAN_LOGARITHMIC;
         k_lateral_vertical_ratio = 10.;
         heatWeightingFactor = 0.5;
+        nrThreads = 1;
         }
     } ;
 
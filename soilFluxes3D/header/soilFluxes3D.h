@@ -8,19 +8,57 @@
 
     #ifdef BUILD_DLL
         #define DLL_EXPORT __declspec(dllexport)
-        #define __EXTERN extern "C"
+        #ifdef __cplusplus
+            #define __EXTERN extern "C"
+        #else
+            #define __EXTERN extern
+        #endif
 	    #define __STDCALL __stdcall
     #else
         #define DLL_EXPORT
         #define __EXTERN
         #define __STDCALL
     #endif
+
+    // the API is plain C: no default arguments, POD structs passed by pointer
+    #ifndef __cplusplus
+        #include <stdbool.h>
+    #endif
+
+    typedef struct TCrit3DDomain TCrit3DDomain;
+
+    /*! solver statistics of the last computePeriod */
+    typedef struct TsolverStatistics {
+        long nrLinearIterations;            /*!< iterations of the linear solver (relaxation or Krylov) */
+        double maxResidual;                 /*!< maximum final residual of the relaxation */
+        int nrAcceptedSteps;                /*!< accepted time steps */
+        int nrRejectedSteps;                /*!< rejected (recomputed) time steps, water and heat */
+        int nrApproximations;               /*!< approximations of the accepted water steps */
+        double minDeltaT;                   /*!< [s] minimum accepted time step */
+        double maxDeltaT;                   /*!< [s] maximum accepted time step */
+        double meanDeltaT;                  /*!< [s] mean accepted time step */
+    } TsolverStatistics;
+
+    /*! hourly forcing of the heat boundary nodes, struct of arrays (null members are not modified) */
+    typedef struct TheatBoundaryForcing {
+        const double *temperature;          /*!< [K] */
+        const double *relativeHumidity;     /*!< [%] */
+        const double *windSpeed;            /*!< [m s-1] */
+        const double *netIrradiance;        /*!< [W m-2] */
+    } TheatBoundaryForcing;
 	
+    #ifdef __cplusplus
     namespace soilFluxes3D {
+    #endif
 
     //TEST
     __EXTERN int DLL_EXPORT __STDCALL test();
 
+    //DOMAIN
+    __EXTERN TCrit3DDomain* DLL_EXPORT __STDCALL createDomain();
+    __EXTERN void DLL_EXPORT __STDCALL deleteDomain(TCrit3DDomain* myDomain);
+    __EXTERN int DLL_EXPORT __STDCALL selectDomain(TCrit3DDomain* myDomain);
+
     //INITIALIZATION
     __EXTERN void DLL_EXPORT __STDCALL cleanMemory();
     __EXTERN int DLL_EXPORT __STDCALL initialize(long nrNodes, int nrLayers, int nrLateralLinks, bool computeWater_, bool computeHeat_, bool computeSolutes_);
@@ -29,6 +67,9 @@
     __EXTERN int DLL_EXPORT __STDCALL setNumericalParameters(float minDeltaT, float maxDeltaT,
                               int maxIterationNumber, int maxApproximationsNumber,
                               int errorMagnitude, float MBRMagnitude);
+    __EXTERN int DLL_EXPORT __STDCALL setNumericalSolutionMethod(int numericalSolutionMethod);
+    __EXTERN int DLL_EXPORT __STDCALL setAdaptiveTimeStep(bool isEnabled);
+    __EXTERN int DLL_EXPORT __STDCALL setNumberOfThreads(int nrThreads);
 
     //TOPOLOGY
     __EXTERN int DLL_EXPORT __STDCALL setNode(long myIndex, float x, float y, float z, double volume_or_area,
@@ -36,6 +77,13 @@
 
     __EXTERN int DLL_EXPORT __STDCALL setNodeLink(long nodeIndex, long linkIndex, short direction, float S0);
 
+    __EXTERN int DLL_EXPORT __STDCALL setNodes(long firstIndex, long nrNodes, const float *x, const float *y,
+                                        const float *z, const double *volume_or_area, const bool *isSurface,
+                                        const bool *isBoundary, const int *boundaryType, const float *slope);
+
+    __EXTERN int DLL_EXPORT __STDCALL setLinksCSR(long firstIndex, long nrNodes, const long *firstLink,
+                                        const long *linkIndex, const short *direction, const float *interfaceArea);
+
 	__EXTERN int DLL_EXPORT __STDCALL setCulvert(long myIndex, double roughness, double slope, double width, double height);
 
     //SOIL
@@ -52,11 +100,15 @@
 
     //WATER
     __EXTERN int DLL_EXPORT __STDCALL setHydraulicProperties(int waterRetentionCurve, int conductivityMeanType, float horizVertRatioConductivity);
+    __EXTERN int DLL_EXPORT __STDCALL setHydraulicTables(bool isEnabled);
+    __EXTERN int DLL_EXPORT __STDCALL getHydraulicTableAccuracy(int nrSoil, int nrHorizon, double *maxErrorSe,
+                                                                double *maxErrorK, double *maxErrorC);
     __EXTERN int DLL_EXPORT __STDCALL setWaterContent(long index, double myWaterContent);
     __EXTERN int DLL_EXPORT __STDCALL setMatricPotential(long index, double potential);
     __EXTERN int DLL_EXPORT __STDCALL setTotalPotential(long index, double totalPotential);
     __EXTERN int DLL_EXPORT __STDCALL setPrescribedTotalPotential(long index, double prescribedTotalPotential);
     __EXTERN int DLL_EXPORT __STDCALL setWaterSinkSource(long index, double sinkSource);
+    __EXTERN int DLL_EXPORT __STDCALL setWaterSinkSources(long firstIndex, long nrValues, const double *sinkSource);
 
     __EXTERN double DLL_EXPORT __STDCALL getWaterContent(long index);
     __EXTERN double DLL_EXPORT __STDCALL getAvailableWaterContent(long index);
@@ -85,6 +137,8 @@
     __EXTERN int DLL_EXPORT __STDCALL setHeatBoundaryWindSpeed(long nodeIndex, double myWindSpeed);
     __EXTERN int DLL_EXPORT __STDCALL setHeatBoundaryNetIrradiance(long nodeIndex, double myNetIrradiance);
     __EXTERN int DLL_EXPORT __STDCALL setFixedTemperature(long nodeIndex, double myT, double myDepth);
+    __EXTERN int DLL_EXPORT __STDCALL setHeatBoundaryForcing(long nrNodes, const long *nodeIndex,
+                                                             const TheatBoundaryForcing *forcing);
 
     __EXTERN double DLL_EXPORT __STDCALL getTemperature(long nodeIndex);
     __EXTERN double DLL_EXPORT __STDCALL getHeatConductivity(long nodeIndex);
@@ -106,7 +160,14 @@
     __EXTERN void DLL_EXPORT __STDCALL initializeBalance();
     __EXTERN void DLL_EXPORT __STDCALL computePeriod(double myPeriod);
 	__EXTERN double DLL_EXPORT __STDCALL computeStep(double maxTime);
+    __EXTERN int DLL_EXPORT __STDCALL getSolverStatistics(TsolverStatistics *statistics);
 
-}
+    //STATE
+    __EXTERN int DLL_EXPORT __STDCALL saveState(const char *fileName);
+    __EXTERN int DLL_EXPORT __STDCALL loadState(const char *fileName);
+
+    #ifdef __cplusplus
+    }
+    #endif
 
 #endif
@@ -2,24 +2,27 @@
 #define SOILPHYSICS_H
 
     struct Tsoil;
+    struct TCrit3DDomain;
 
-    double computeWaterConductivity(double Se, Tsoil *mySoil);
-    double computeSefromPsi(double myPsi, Tsoil *mySoil);
-    double theta_from_Se(unsigned long myIndex);
-    double theta_from_Se (double Se, unsigned long myIndex);
-    double theta_from_sign_Psi (double myPsi, unsigned long myIndex);
-    double Se_from_theta (unsigned long myIndex, double myTheta);
-    double psi_from_Se(unsigned long myIndex);
-    double computeSe(unsigned long myIndex);
-    double dTheta_dH(unsigned long myIndex);
-    double dThetav_dH(unsigned long myIndex, double temperature, double dTheta_dH);
-    double computeK(unsigned long myIndex);
-    double compute_K_Mualem(double Ksat, double Se, double VG_Sc, double VG_m, double Mualem_L);
-    double getThetaMean(long i);
-    double getTheta(long i, double H);
-    double getHMean(long i);
-    double getPsiMean(long i);
-    double estimateBulkDensity(long i);
-    double getTMean(long i);
+    double computeWaterConductivity(TCrit3DDomain *myDomain, double Se, Tsoil *mySoil);
+    double computeSefromPsi(TCrit3DDomain *myDomain, double myPsi, Tsoil *mySoil);
+    double theta_from_Se(TCrit3DDomain *myDomain, unsigned long myIndex);
+    double theta_from_Se(TCrit3DDomain *myDomain, double Se, unsigned long myIndex);
+    double theta_from_sign_Psi(TCrit3DDomain *myDomain, double myPsi, unsigned long myIndex);
+    double Se_from_theta(TCrit3DDomain *myDomain, unsigned long myIndex, double myTheta);
+    double psi_from_Se(TCrit3DDomain *myDomain, unsigned long myIndex);
+    double computeSe(TCrit3DDomain *myDomain, unsigned long myIndex);
+    double dSe_dPsi(TCrit3DDomain *myDomain, double psi, Tsoil *mySoil);
+    double dTheta_dH(TCrit3DDomain *myDomain, unsigned long myIndex);
+    double dThetav_dH(TCrit3DDomain *myDomain, unsigned long myIndex, double temperature, double dTheta_dH);
+    double computeK(TCrit3DDomain *myDomain, unsigned long myIndex);
+    double computeVaporK(TCrit3DDomain *myDomain, unsigned long myIndex);
+    double compute_K_Mualem(TCrit3DDomain *myDomain, double Ksat, double Se, double VG_Sc, double VG_m, double Mualem_L);
+    double getThetaMean(TCrit3DDomain *myDomain, long i);
+    double getTheta(TCrit3DDomain *myDomain, long i, double H);
+    double getHMean(TCrit3DDomain *myDomain, long i);
+    double getPsiMean(TCrit3DDomain *myDomain, long i);
+    double estimateBulkDensity(TCrit3DDomain *myDomain, long i);
+    double getTMean(TCrit3DDomain *myDomain, long i);
 
 #endif  // SOILPHYSICS_H
@@ -1,17 +1,21 @@
 #ifndef SOLVER_H
 #define SOLVER_H
 
+    struct TCrit3DDomain;
+
     inline double square(double x) {return ((x)*(x));}
 
-    double distance(unsigned long index1, unsigned long index2);
+    double distance(TCrit3DDomain *myDomain, unsigned long index1, unsigned long index2);
 
-    double distance2D(unsigned long index1, unsigned long index2);
+    double distance2D(TCrit3DDomain *myDomain, unsigned long index1, unsigned long index2);
 
-    double computeMean(double v1, double v2);
+    double computeMean(TCrit3DDomain *myDomain, double v1, double v2);
 
     double arithmeticMean(double v1, double v2);
 
-    bool GaussSeidelRelaxation (int myApproximation, double myResidualTolerance, int myProcess);
+    double GaussSeidelIterationWater(TCrit3DDomain *myDomain, short direction);
+
+    bool GaussSeidelRelaxation(TCrit3DDomain *myDomain, int myApproximation, double myResidualTolerance, int myProcess);
 
 #endif  // SOLVER_H
 
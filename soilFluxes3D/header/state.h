@@ -0,0 +1,10 @@
+#ifndef STATE_H
+#define STATE_H
+
+    struct TCrit3DDomain;
+
+    int writeStateFile(TCrit3DDomain *myDomain, const char *fileName);
+
+    int readStateFile(TCrit3DDomain *myDomain, const char *fileName);
+
+#endif  // STATE_H
@@ -1,6 +1,8 @@
 #ifndef SOILFLUXES3DTYPES
 #define SOILFLUXES3DTYPES
 
+    #include <vector>
+    #include <memory>
     #include "parameters.h"
     #include "extra.h"
 
@@ -53,6 +55,23 @@
         } ;
 
 
+    /*! hydraulic functions of a soil horizon tabulated on a uniform grid of ln(psi):
+     *  each interval stores the cubic coefficients (monotone Hermite spline) of
+     *  Se and ln(K / Ksat). Outside [psiMin, psiMax] the analytic forms are used */
+    struct ThydraulicTable{
+        int waterRetentionCurve = NODATA;   /*!< curve used to build the table */
+        int nrIntervals = 0;
+        double lnPsiMin = 0.;               /*!< [ln m] */
+        double lnPsiMax = 0.;               /*!< [ln m] */
+        double invStep = 0.;                /*!< [-] 1 / grid step */
+        std::vector<double> coeff;          /*!< [nrIntervals * 8] coefficients of Se, lnK */
+
+        double maxErrorSe = 0.;             /*!< [-] max absolute error of Se */
+        double maxErrorK = 0.;              /*!< [-] max relative error of K */
+        double maxErrorC = 0.;              /*!< [-] max relative error of dSe/dPsi */
+        } ;
+
+
     struct Tsoil{
         double VG_alpha;            /*!< [m^-1] Van Genutchen alpha parameter */
         double VG_n;                /*!< [-] Van Genutchen n parameter */
@@ -70,18 +89,26 @@
         //for heat
         double organicMatter;       /*!< [-] fraction of organic matter */
         double clay;                /*!< [-] fraction of clay */
+
+        std::shared_ptr<const ThydraulicTable> table;   /*!< tabulated hydraulic functions (shared, read-only) */
         } ;
 
 
-     struct TCrit3Dnode{
+     /*! water state of the nodes, updated at each iteration: one array for each variable
+      *  (structure of arrays) so that the loops on all nodes read only the data they use */
+     struct TCrit3DnodeState{
+        double *Se = nullptr;               /*!< [-] degree of saturation */
+        double *k = nullptr;                /*!< [m s^-1] soil water conductivity */
+        double *H = nullptr;                /*!< [m] pressure head */
+        double *oldH = nullptr;             /*!< [m] previous pressure head */
+        double *bestH = nullptr;            /*!< [m] pressure head of best iteration */
+        double *waterSinkSource = nullptr;  /*!< [m^3 s^-1] water sink source */
+        double *Qw = nullptr;               /*!< [m^3 s^-1] water flow */
+        } ;
+
 
-        double Se;					/*!< [-] degree of saturation */
-        double k;                   /*!< [m s^-1] soil water conductivity */
-        double H;                   /*!< [m] pressure head */
-        double oldH;				/*!< [m] previous pressure head */
-        double bestH;				/*!< [m] pressure head of best iteration */
-        double waterSinkSource;     /*!< [m^3 s^-1] water sink source */
-        double Qw;                  /*!< [m^3 s^-1] water flow */
+     /*! topology and properties of the node (the water state is in TCrit3DnodeState) */
+     struct TCrit3Dnode{
 
         double volume_area;         /*!< [m^3] volume of sub-surface elements : [m^2] area of surface nodes */
         float x, y, z;              /*!< [m] coordinates of the center of the element */
@@ -98,42 +125,41 @@
         } ;
 
 
-     struct TmatrixElement {
-        long index;
-        double val;
+     /*! system matrix: fixed-width rows (ELL format) with separate index and value arrays
+      *  and the diagonal stored apart. Off-diagonal element k of row i is at i * nrColumns + k */
+     struct Tmatrix {
+        long nrRows = 0;
+        int nrColumns = 0;              /*!< max nr of off-diagonal elements of a row */
+        int *nrLinks = nullptr;         /*!< [nrRows] nr of off-diagonal elements of each row */
+        int *index = nullptr;           /*!< [nrRows * nrColumns] column index (int: less memory traffic) */
+        double *val = nullptr;          /*!< [nrRows * nrColumns] value */
+        double *diagonal = nullptr;     /*!< [nrRows] diagonal value */
         } ;
 
 
      struct Tbalance {
-        double storageWater;
-        double sinkSourceWater;
-        double waterMBE, waterMBR;
+        double storageWater = 0.0;
+        double sinkSourceWater = 0.0;
+        double waterMBE = 0.0, waterMBR = 0.0;
 
-        double storageHeat;
-        double sinkSourceHeat;
+        double storageHeat = 0.0;
+        double sinkSourceHeat = 0.0;
         double heatMBE = 0.0;
         double heatMBR = 1.0;
         } ;
 
 	struct Tculvert {
 		long index = NOLINK;
-		double width;				/*!< [m] */
-		double height;				/*!< [m] */
-		double roughness;			/*!< [s m-1/3] */
-		double slope;				/*!< [-] */
+		double width = 0.0;			/*!< [m] */
+		double height = 0.0;		/*!< [m] */
+		double roughness = 0.0;		/*!< [s m-1/3] */
+		double slope = 0.0;			/*!< [-] */
 		} ;
 
-     extern TCrit3DStructure myStructure;
-     extern TParameters myParameters;
-     extern TCrit3Dnode *myNode;
-     extern TmatrixElement **A;
-	 extern Tculvert myCulvert;
-	 extern double Courant;
-     extern double *b, *C, *X;
-     extern double *invariantFlux;         //array accessorio per flussi avvettivi e latenti
-     extern double Courant;
-	 extern double Courant;
-
-     extern Tbalance balanceCurrentTimeStep, balancePreviousTimeStep, balanceCurrentPeriod, balanceWholePeriod;
+     struct TnodeColoring {
+        int nrColors = 0;
+        long *firstNode = nullptr;      /*!< [nrColors + 1] position of the first node of each color */
+        long *node = nullptr;           /*!< [nrNodes] node indices sorted by color */
+        } ;
 
 #endif // SOILFLUXES3DTYPES
@@ -2,10 +2,11 @@
 #define WATER_H
 
     struct TlinkedNode;
+    struct TCrit3DDomain;
 
-    bool waterFlowComputation(double deltaT);
-    double getWaterExchange(long index, TlinkedNode *link, double deltaT);
-    bool computeWater(double maxTime, double *acceptedTime);
-    void restoreWater();
+    bool waterFlowComputation(TCrit3DDomain *myDomain, double deltaT);
+    double getWaterExchange(TCrit3DDomain *myDomain, long index, TlinkedNode *link, double deltaT);
+    bool computeWater(TCrit3DDomain *myDomain, double maxTime, double *acceptedTime);
+    void restoreWater(TCrit3DDomain *myDomain);
 
 #endif  // WATER_H
@@ -39,43 +39,45 @@
 #include "header/solver.h"
 #include "header/soilFluxes3D.h"
 #include "header/boundary.h"
+#include "header/domain.h"
 
-static double CourantHeat, fluxCourant;
+/*! minimum number of nodes for the parallel assembly (nrThreads > 1) */
+static const long MIN_PARALLEL_SIZE = 1024;
 
-bool isHeatNode(long i)
+bool isHeatNode(TCrit3DDomain *myDomain, long i)
 {
-    return (myStructure.computeHeat &&
-            myNode != nullptr &&
-            myNode[i].extra != nullptr &&
-            myNode[i].extra->Heat != nullptr &&
-            ! myNode[i].isSurface);
+    return (myDomain->structure.computeHeat &&
+            myDomain->node != nullptr &&
+            myDomain->node[i].extra != nullptr &&
+            myDomain->node[i].extra->Heat != nullptr &&
+            ! myDomain->node[i].isSurface);
 }
 
-bool isHeatLinkedNode(TlinkedNode* myLink)
+bool isHeatLinkedNode(TCrit3DDomain *myDomain, TlinkedNode* myLink)
 {
-    return (myStructure.computeHeat &&
+    return (myDomain->structure.computeHeat &&
             myLink != nullptr &&
             myLink->linkedExtra != nullptr &&
             myLink->linkedExtra->heatFlux != nullptr);
 }
 
-double getH_timeStep(long i, double timeStep, double timeStepWater)
+double getH_timeStep(TCrit3DDomain *myDomain, long i, double timeStep, double timeStepWater)
 {
-    return (myNode[i].H - myNode[i].oldH) / timeStepWater * timeStep + myNode[i].oldH;
+    return (myDomain->nodeState.H[i] - myDomain->nodeState.oldH[i]) / timeStepWater * timeStep + myDomain->nodeState.oldH[i];
 }
 
-double computeHeatStorage(double timeStepHeat, double timeStepWater)
+double computeHeatStorage(TCrit3DDomain *myDomain, double timeStepHeat, double timeStepWater)
 { // [J]
     double myHeatStorage = 0.;
     double myH;
-    for (long i = 1; i < myStructure.nrNodes; i++)
+    for (long i = 1; i < myDomain->structure.nrNodes; i++)
     {
         if (timeStepHeat != NODATA && timeStepWater != NODATA)
-            myH = getH_timeStep(i, timeStepHeat, timeStepWater);
+            myH = getH_timeStep(myDomain, i, timeStepHeat, timeStepWater);
         else
-            myH = myNode[i].H;
+            myH = myDomain->nodeState.H[i];
 
-        myHeatStorage += soilFluxes3D::getHeat(i, myH - myNode[i].z);
+        myHeatStorage += soilFluxes3D::getHeat(i, myH - myDomain->node[i].z);
     }
     return myHeatStorage;
 }
@@ -85,37 +87,37 @@ double computeHeatStorage(double timeStepHeat, double timeStepWater)
  * \param deltaT
  * \return result
  */
-double sumHeatFlow(double deltaT)
+double sumHeatFlow(TCrit3DDomain *myDomain, double deltaT)
 {
     double sum = 0.0;
-    for (long n = 1; n < myStructure.nrNodes; n++)
+    for (long n = 1; n < myDomain->structure.nrNodes; n++)
     {
-        if (myNode[n].extra->Heat->Qh != 0.)
-            sum += myNode[n].extra->Heat->Qh * deltaT;
+        if (myDomain->node[n].extra->Heat->Qh != 0.)
+            sum += myDomain->node[n].extra->Heat->Qh * deltaT;
     }
     return (sum);
 }
 
-void computeHeatBalance(double myTimeStep, double timeStepWater)
+void computeHeatBalance(TCrit3DDomain *myDomain, double myTimeStep, double timeStepWater)
 {
-    balanceCurrentTimeStep.sinkSourceHeat = sumHeatFlow(myTimeStep);
+    myDomain->balanceCurrentTimeStep.sinkSourceHeat = sumHeatFlow(myDomain, myTimeStep);
 
-    balanceCurrentTimeStep.storageHeat = computeHeatStorage(myTimeStep, timeStepWater);
+    myDomain->balanceCurrentTimeStep.storageHeat = computeHeatStorage(myDomain, myTimeStep, timeStepWater);
 
-    double deltaHeatStorage = balanceCurrentTimeStep.storageHeat - balancePreviousTimeStep.storageHeat;
-    balanceCurrentTimeStep.heatMBE = deltaHeatStorage - balanceCurrentTimeStep.sinkSourceHeat;
+    double deltaHeatStorage = myDomain->balanceCurrentTimeStep.storageHeat - myDomain->balancePreviousTimeStep.storageHeat;
+    myDomain->balanceCurrentTimeStep.heatMBE = deltaHeatStorage - myDomain->balanceCurrentTimeStep.sinkSourceHeat;
 
-    double referenceHeat = maxValue(fabs(balanceCurrentTimeStep.sinkSourceHeat), balanceCurrentTimeStep.storageHeat * 1e-6);
-    balanceCurrentTimeStep.heatMBR = 1. - balanceCurrentTimeStep.heatMBE / referenceHeat;
+    double referenceHeat = maxValue(fabs(myDomain->balanceCurrentTimeStep.sinkSourceHeat), myDomain->balanceCurrentTimeStep.storageHeat * 1e-6);
+    myDomain->balanceCurrentTimeStep.heatMBR = 1. - myDomain->balanceCurrentTimeStep.heatMBE / referenceHeat;
 }
 
-float readHeatFlux(TlinkedNode* myLink, int fluxType)
+float readHeatFlux(TCrit3DDomain *myDomain, TlinkedNode* myLink, int fluxType)
 {
-    if (! isHeatLinkedNode(myLink)) return NODATA;
+    if (! isHeatLinkedNode(myDomain, myLink)) return NODATA;
 
-    if (myStructure.saveHeatFluxesType == SAVE_HEATFLUXES_TOTAL && fluxType == HEATFLUX_TOTAL)
+    if (myDomain->structure.saveHeatFluxesType == SAVE_HEATFLUXES_TOTAL && fluxType == HEATFLUX_TOTAL)
         return myLink->linkedExtra->heatFlux->fluxes[HEATFLUX_TOTAL];
-    else if (myStructure.saveHeatFluxesType == SAVE_HEATFLUXES_ALL && (fluxType == HEATFLUX_TOTAL ||
+    else if (myDomain->structure.saveHeatFluxesType == SAVE_HEATFLUXES_ALL && (fluxType == HEATFLUX_TOTAL ||
             fluxType == HEATFLUX_DIFFUSIVE ||
             fluxType == HEATFLUX_LATENT_ISOTHERMAL ||
             fluxType == HEATFLUX_LATENT_THERMAL ||
@@ -130,18 +132,18 @@ float readHeatFlux(TlinkedNode* myLink, int fluxType)
         return NODATA;
 }
 
-void saveHeatFlux(TlinkedNode* myLink, int fluxType, double myValue)
+void saveHeatFlux(TCrit3DDomain *myDomain, TlinkedNode* myLink, int fluxType, double myValue)
 {
-    if (! isHeatLinkedNode(myLink)) return;
+    if (! isHeatLinkedNode(myDomain, myLink)) return;
 
-    if (myStructure.saveHeatFluxesType == SAVE_HEATFLUXES_NONE) return;
+    if (myDomain->structure.saveHeatFluxesType == SAVE_HEATFLUXES_NONE) return;
 
     if (myLink->linkedExtra->heatFlux->fluxes[HEATFLUX_TOTAL] == NODATA)
         myLink->linkedExtra->heatFlux->fluxes[HEATFLUX_TOTAL] = float(myValue);
     else
         myLink->linkedExtra->heatFlux->fluxes[HEATFLUX_TOTAL] += float(myValue);
 
-    if (myStructure.saveHeatFluxesType == SAVE_HEATFLUXES_ALL)
+    if (myDomain->structure.saveHeatFluxesType == SAVE_HEATFLUXES_ALL)
         myLink->linkedExtra->heatFlux->fluxes[fluxType] = float(myValue);
 }
 
@@ -152,11 +154,11 @@ void saveHeatFlux(TlinkedNode* myLink, int fluxType, double myValue)
  * \param i
  * \return result
  */
-double VaporThetaV(double h, double T, long i)
+double VaporThetaV(TCrit3DDomain *myDomain, double h, double T, long i)
 {
-    double theta = theta_from_sign_Psi(h, i);
+    double theta = theta_from_sign_Psi(myDomain, h, i);
     double vaporConc = VaporFromPsiTemp(h, T);
-    return (vaporConc / WATER_DENSITY * (myNode[i].Soil->Theta_s - theta));
+    return (vaporConc / WATER_DENSITY * (myDomain->node[i].Soil->Theta_s - theta));
 }
 
 /*!
@@ -204,10 +206,10 @@ double SoilRelativeHumidity(double h, double myT)
  * \param myT
  * \return result
  */
-double IsothermalVaporConductivity(long i, double h, double myT)
+double IsothermalVaporConductivity(TCrit3DDomain *myDomain, long i, double h, double myT)
 {
-    double theta = theta_from_sign_Psi(h, i);
-    double Dv = SoilVaporDiffusivity(myNode[i].Soil->Theta_s, theta, myT);
+    double theta = theta_from_sign_Psi(myDomain, h, i);
+    double Dv = SoilVaporDiffusivity(myDomain->node[i].Soil->Theta_s, theta, myT);
     double vapor = VaporFromPsiTemp(h, myT);
     return (Dv * vapor * MH2O / (R_GAS * myT));
 }
@@ -219,16 +221,16 @@ double IsothermalVaporConductivity(long i, double h, double myT)
  * \param T
  * \return result
  */
-double SoilHeatCapacity(long i, double h, double T)
+double SoilHeatCapacity(TCrit3DDomain *myDomain, long i, double h, double T)
 {
     double heatCapacity;
-    double theta = theta_from_sign_Psi(h, i);
-    double thetaV = VaporThetaV(h, T, i);
-    double bulkDensity = estimateBulkDensity(i);
+    double theta = theta_from_sign_Psi(myDomain, h, i);
+    double thetaV = VaporThetaV(myDomain, h, T, i);
+    double bulkDensity = estimateBulkDensity(myDomain, i);
     heatCapacity = bulkDensity / 2.65 * HEAT_CAPACITY_MINERAL +
             theta * HEAT_CAPACITY_WATER;
 
-    if (myStructure.computeHeatVapor)
+    if (myDomain->structure.computeHeatVapor)
         heatCapacity += thetaV * HEAT_CAPACITY_AIR;
 
     return heatCapacity;
@@ -298,7 +300,7 @@ double ThermalLiquidConductivity(double temp_celsius, double h, double Klh)
  * \param h (m)
  * \return result
  */
-double ThermalVaporConductivity(long i, double temperature, double h)
+double ThermalVaporConductivity(TCrit3DDomain *myDomain, long i, double temperature, double h)
 {
     double myPressure;				// [Pa] total air pressure
 	double Dv;						// [m2 s-1] vapor diffusivity
@@ -315,12 +317,12 @@ double ThermalVaporConductivity(long i, double temperature, double h)
 
     tempCelsius = temperature - ZEROCELSIUS;
 
-    myPressure = PressureFromAltitude(myNode[i].z);
+    myPressure = PressureFromAltitude(myDomain->node[i].z);
 
-    theta = theta_from_sign_Psi(h, i);
+    theta = theta_from_sign_Psi(myDomain, h, i);
 
 	// vapor diffusivity
-    Dv = SoilVaporDiffusivity(myNode[i].Soil->Theta_s, theta, temperature);
+    Dv = SoilVaporDiffusivity(myDomain->node[i].Soil->Theta_s, theta, temperature);
 
 	// slope of saturation vapor pressure
     svp = SaturationVaporPressure(tempCelsius);
@@ -335,8 +337,8 @@ double ThermalVaporConductivity(long i, double temperature, double h)
 	hr = myVaporPressure / svp;
 
     // enhancement factor (Cass et al. 1984)
-    satDegree = theta / myNode[i].Soil->Theta_s;
-    eta = 9.5 + 3. * satDegree - 8.5 * exp(-pow((1. + 2.6/sqrt(myNode[i].Soil->clay))*satDegree, 4));
+    satDegree = theta / myDomain->node[i].Soil->Theta_s;
+    eta = 9.5 + 3. * satDegree - 8.5 * exp(-pow((1. + 2.6/sqrt(myDomain->node[i].Soil->clay))*satDegree, 4));
 
     return (eta * Dv * slopesvc * hr);
 
@@ -349,7 +351,7 @@ double ThermalVaporConductivity(long i, double temperature, double h)
  * \param h: water matric potential [m]
  * \return result
  */
-double AirHeatConductivity(long i, double T, double h)
+double AirHeatConductivity(TCrit3DDomain *myDomain, long i, double T, double h)
 {
     double Kda;						// [W m-1 K-1] thermal conductivity of dry air
     double Ka;						// [W m-1 K-1] thermal conductivity of air
@@ -364,13 +366,13 @@ double AirHeatConductivity(long i, double T, double h)
 
     Ka = Kda;
 
-    if (myStructure.computeWater)
+    if (myDomain->structure.computeWater)
     {
         myLambda = LatentHeatVaporization(T - ZEROCELSIUS);
 
         coeff= myLambda;
 
-        myKvt = ThermalVaporConductivity(i, T, h);
+        myKvt = ThermalVaporConductivity(myDomain, i, T, h);
         Ka += coeff * myKvt;
     }
 
@@ -385,7 +387,7 @@ double AirHeatConductivity(long i, double T, double h)
  * \param h: water matric potential [m]
  * \return result
  */
-double SoilHeatConductivity(long i, double T, double h)
+double SoilHeatConductivity(TCrit3DDomain *myDomain, long i, double T, double h)
 {
 	double ga = 0.088;				// [] deVries shape factor; assume same for all mineral soils
 	double gc;						// [] shape factor
@@ -408,11 +410,11 @@ double SoilHeatConductivity(long i, double T, double h)
 	Kw = 0.554 + 0.0024 * myTCelsiusMean - 0.00000987 * myTCelsiusMean * myTCelsiusMean;
 
 	// air conductivity
-    Ka = AirHeatConductivity(i, T, h);
+    Ka = AirHeatConductivity(myDomain, i, T, h);
 
-    xw = theta_from_sign_Psi(h, i);
+    xw = theta_from_sign_Psi(myDomain, h, i);
 
-    fw = WaterReturnFlowFactor(xw, myNode[i].Soil->clay, myTCelsiusMean + ZEROCELSIUS);
+    fw = WaterReturnFlowFactor(xw, myDomain->node[i].Soil->clay, myTCelsiusMean + ZEROCELSIUS);
 	Kf = Ka + fw * (Kw - Ka);
 
 	gc = 1. - 2. * ga;
@@ -421,8 +423,8 @@ double SoilHeatConductivity(long i, double T, double h)
 	ew = (2. / (1 + (Kw / Kf - 1) * ga) + 1 / (1 + (Kw / Kf - 1) * gc)) / 3.;
     es = (2. / (1 + (KH_mineral / Kf - 1) * ga) + 1 / (1 + (KH_mineral / Kf - 1) * gc)) / 3.;
 
-	xs = 1. - myNode[i].Soil->Theta_s;
-	xa = myNode[i].Soil->Theta_s - xw;
+	xs = 1. - myDomain->node[i].Soil->Theta_s;
+	xa = myDomain->node[i].Soil->Theta_s - xw;
 
     myConductivity = (xw * ew * Kw + xa * ea * Ka + xs * es * KH_mineral) / (ew * xw + ea * xa + es * xs);
     return myConductivity;
@@ -434,7 +436,7 @@ double SoilHeatConductivity(long i, double T, double h)
  * \param myLink
  * \return result
  */
-double ThermalLiquidFlux(long i, TlinkedNode *myLink, int myProcess, double timeStep, double timeStepWater)
+double ThermalLiquidFlux(TCrit3DDomain *myDomain, long i, TlinkedNode *myLink, int myProcess, double timeStep, double timeStepWater)
 {
     //TODO: inserire time step water per calcolo più preciso
 
@@ -442,30 +444,30 @@ double ThermalLiquidFlux(long i, TlinkedNode *myLink, int myProcess, double time
 
     // temperatures (K) and water potential (m)
     double tavg, tavgLink, havg, havgLink;
-    if (myProcess == PROCESS_WATER && myStructure.computeWater)
+    if (myProcess == PROCESS_WATER && myDomain->structure.computeWater)
     {
-        tavg = getTMean(i);
-        tavgLink = getTMean(j);
-        havg = myNode[i].H - myNode[i].z;
-        havgLink = myNode[j].H - myNode[j].z;
+        tavg = getTMean(myDomain, i);
+        tavgLink = getTMean(myDomain, j);
+        havg = myDomain->nodeState.H[i] - myDomain->node[i].z;
+        havgLink = myDomain->nodeState.H[j] - myDomain->node[j].z;
     }
-    else if (myProcess = PROCESS_HEAT && myStructure.computeHeat)
+    else if (myProcess = PROCESS_HEAT && myDomain->structure.computeHeat)
     {
-        tavg = myNode[i].extra->Heat->T;
-        tavgLink = myNode[j].extra->Heat->T;
-        havg = arithmeticMean(getH_timeStep(i, timeStep, timeStepWater), myNode[i].oldH) - myNode[i].z;
-        havgLink = arithmeticMean(getH_timeStep(j, timeStep, timeStepWater), myNode[j].oldH) - myNode[j].z;
+        tavg = myDomain->node[i].extra->Heat->T;
+        tavgLink = myDomain->node[j].extra->Heat->T;
+        havg = arithmeticMean(getH_timeStep(myDomain, i, timeStep, timeStepWater), myDomain->nodeState.oldH[i]) - myDomain->node[i].z;
+        havgLink = arithmeticMean(getH_timeStep(myDomain, j, timeStep, timeStepWater), myDomain->nodeState.oldH[j]) - myDomain->node[j].z;
     }
     else
         return NODATA;
 
     // m2 K-1 s-1
-    double Klt = ThermalLiquidConductivity(tavg - ZEROCELSIUS, havg, myNode[i].k);
-    double KltLink = ThermalLiquidConductivity(tavgLink - ZEROCELSIUS, havgLink, myNode[j].k);
-    double meanKlt = computeMean(Klt, KltLink);
+    double Klt = ThermalLiquidConductivity(tavg - ZEROCELSIUS, havg, myDomain->nodeState.k[i]);
+    double KltLink = ThermalLiquidConductivity(tavgLink - ZEROCELSIUS, havgLink, myDomain->nodeState.k[j]);
+    double meanKlt = computeMean(myDomain, Klt, KltLink);
 
     // m s-1
-    double myFlowDensity = meanKlt * (tavgLink - tavg) / distance(i, j);
+    double myFlowDensity = meanKlt * (tavgLink - tavg) / distance(myDomain, i, j);
 
     // m3 s-1
     double myFlow = myFlowDensity * (*myLink).area;
@@ -479,7 +481,7 @@ double ThermalLiquidFlux(long i, TlinkedNode *myLink, int myProcess, double time
  * \param myLink
  * \return result
  */
-double ThermalVaporFlux(long i, TlinkedNode *myLink, int myProcess, double timeStep, double timeStepWater)
+double ThermalVaporFlux(TCrit3DDomain *myDomain, long i, TlinkedNode *myLink, int myProcess, double timeStep, double timeStepWater)
 {
     //TODO: inserire time step water per calcolo più preciso
 
@@ -487,30 +489,30 @@ double ThermalVaporFlux(long i, TlinkedNode *myLink, int myProcess, double timeS
 
     // temperatures (K) and water potential (m)
     double tavg, tavgLink, havg, havgLink;
-    if (myProcess == PROCESS_WATER && myStructure.computeWater)
+    if (myProcess == PROCESS_WATER && myDomain->structure.computeWater)
     {
-        tavg = getTMean(i);
-        tavgLink = getTMean(j);
-        havg = myNode[i].H - myNode[i].z;
-        havgLink = myNode[j].H - myNode[j].z;
+        tavg = getTMean(myDomain, i);
+        tavgLink = getTMean(myDomain, j);
+        havg = myDomain->nodeState.H[i] - myDomain->node[i].z;
+        havgLink = myDomain->nodeState.H[j] - myDomain->node[j].z;
     }
-    else if (myProcess = PROCESS_HEAT && myStructure.computeHeat)
+    else if (myProcess = PROCESS_HEAT && myDomain->structure.computeHeat)
     {
-        tavg = myNode[i].extra->Heat->T;
-        tavgLink = myNode[j].extra->Heat->T;
-        havg = arithmeticMean(getH_timeStep(i, timeStep, timeStepWater), myNode[i].oldH) - myNode[i].z;
-        havgLink = arithmeticMean(getH_timeStep(j, timeStep, timeStepWater), myNode[j].oldH) - myNode[j].z;
+        tavg = myDomain->node[i].extra->Heat->T;
+        tavgLink = myDomain->node[j].extra->Heat->T;
+        havg = arithmeticMean(getH_timeStep(myDomain, i, timeStep, timeStepWater), myDomain->nodeState.oldH[i]) - myDomain->node[i].z;
+        havgLink = arithmeticMean(getH_timeStep(myDomain, j, timeStep, timeStepWater), myDomain->nodeState.oldH[j]) - myDomain->node[j].z;
     }
     else
         return NODATA;
 
     // kg m-1 s-1 K-1
-    double Kvt = ThermalVaporConductivity(i, tavg, havg);
-    double KvtLink = ThermalVaporConductivity(j, tavgLink, havgLink);
-    double meanKv = computeMean(Kvt, KvtLink);
+    double Kvt = ThermalVaporConductivity(myDomain, i, tavg, havg);
+    double KvtLink = ThermalVaporConductivity(myDomain, j, tavgLink, havgLink);
+    double meanKv = computeMean(myDomain, Kvt, KvtLink);
 
     // kg m-2 s-1
-    double myFlowDensity = meanKv * (tavgLink - tavg) / distance(i, j);
+    double myFlowDensity = meanKv * (tavgLink - tavg) / distance(myDomain, i, j);
 
     // kg s-1
     double myFlow = myFlowDensity * (*myLink).area;
@@ -524,7 +526,7 @@ double ThermalVaporFlux(long i, TlinkedNode *myLink, int myProcess, double timeS
  * \param myLink
  * \return isothermal vapor flux [kg s-1]
  */
-double IsothermalVaporFlux(long i, TlinkedNode *myLink, double timeStep, double timeStepWater)
+double IsothermalVaporFlux(TCrit3DDomain *myDomain, long i, TlinkedNode *myLink, double timeStep, double timeStepWater)
 {
     double myKvi;								// [kg s m-3] vapor conductivity
     double psi, psiLink;                        // [J kg-1 = m2 s-2] water matric potential
@@ -535,19 +537,19 @@ double IsothermalVaporFlux(long i, TlinkedNode *myLink, double timeStep, double
 
     long j = (*myLink).index;
 
-    havg = arithmeticMean(getH_timeStep(i, timeStep, timeStepWater), myNode[i].oldH) - myNode[i].z;
-    havglink = arithmeticMean(getH_timeStep(j, timeStep, timeStepWater), myNode[j].oldH) - myNode[j].z;
+    havg = arithmeticMean(getH_timeStep(myDomain, i, timeStep, timeStepWater), myDomain->nodeState.oldH[i]) - myDomain->node[i].z;
+    havglink = arithmeticMean(getH_timeStep(myDomain, j, timeStep, timeStepWater), myDomain->nodeState.oldH[j]) - myDomain->node[j].z;
 
-    Kvi = IsothermalVaporConductivity(i, havg, myNode[i].extra->Heat->T);
-    KviLink = IsothermalVaporConductivity(j, havglink, myNode[j].extra->Heat->T);
-    myKvi = computeMean(Kvi, KviLink);
+    Kvi = IsothermalVaporConductivity(myDomain, i, havg, myDomain->node[i].extra->Heat->T);
+    KviLink = IsothermalVaporConductivity(myDomain, j, havglink, myDomain->node[j].extra->Heat->T);
+    myKvi = computeMean(myDomain, Kvi, KviLink);
 
     psi = havg * GRAVITY;
     psiLink = havglink * GRAVITY;
 
     deltaPsi = (psiLink - psi);
 
-    myFlux = myKvi * deltaPsi / distance(i, j) * myLink->area;
+    myFlux = myKvi * deltaPsi / distance(myDomain, i, j) * myLink->area;
 
     return (myFlux);
 }
@@ -558,18 +560,18 @@ double IsothermalVaporFlux(long i, TlinkedNode *myLink, double timeStep, double
  * \param myLink
  * \return isothermal latent heat flux [W]
  */
-double IsothermalLatentHeatFlux(long i, TlinkedNode *myLink, double timeStep, double timeStepWater)
+double IsothermalLatentHeatFlux(TCrit3DDomain *myDomain, long i, TlinkedNode *myLink, double timeStep, double timeStepWater)
 {
     double lambda, lambdaLink, avgLambda;       // [J kg-1] latent heat of vaporization
     double myLatentFlux;						// [J s-1] latent heat flow
 
     long j = (*myLink).index;
 
-    lambda = LatentHeatVaporization(myNode[i].extra->Heat->T - ZEROCELSIUS);
-    lambdaLink = LatentHeatVaporization(myNode[j].extra->Heat->T - ZEROCELSIUS);
+    lambda = LatentHeatVaporization(myDomain->node[i].extra->Heat->T - ZEROCELSIUS);
+    lambdaLink = LatentHeatVaporization(myDomain->node[j].extra->Heat->T - ZEROCELSIUS);
     avgLambda = arithmeticMean(lambda, lambdaLink);
 
-    myLatentFlux = avgLambda * IsothermalVaporFlux(i, myLink, timeStep, timeStepWater);
+    myLatentFlux = avgLambda * IsothermalVaporFlux(myDomain, i, myLink, timeStep, timeStepWater);
 
     return (myLatentFlux);
 }
@@ -578,9 +580,10 @@ double IsothermalLatentHeatFlux(long i, TlinkedNode *myLink, double timeStep, do
  * \brief advective isothermal liquid water heat flux
  * \param i
  * \param myLink
+ * \param fluxCourant [W K-1] advective heat capacity flow, updated
  * \return advective liquid water heat flux [W]
  */
-double AdvectiveFlux(long i, TlinkedNode *myLink)
+double AdvectiveFlux(TCrit3DDomain *myDomain, long i, TlinkedNode *myLink, double *fluxCourant)
 {
     double TliqAdv, TvapAdv;
     double liqWaterFlux, vapWaterFlux;
@@ -589,29 +592,29 @@ double AdvectiveFlux(long i, TlinkedNode *myLink)
     liqWaterFlux = (*myLink).linkedExtra->heatFlux->waterFlux;
 
     if (liqWaterFlux < 0.)
-        TliqAdv = myNode[i].extra->Heat->T;
+        TliqAdv = myDomain->node[i].extra->Heat->T;
     else
-        TliqAdv = myNode[myLink->index].extra->Heat->T;
+        TliqAdv = myDomain->node[myLink->index].extra->Heat->T;
 
-    fluxCourant += HEAT_CAPACITY_WATER * liqWaterFlux;
-    advection = fluxCourant * TliqAdv;
+    *fluxCourant += HEAT_CAPACITY_WATER * liqWaterFlux;
+    advection = *fluxCourant * TliqAdv;
 
     vapWaterFlux = (*myLink).linkedExtra->heatFlux->vaporFlux;
 
     if (vapWaterFlux < 0.)
-        TvapAdv = myNode[i].extra->Heat->T;
+        TvapAdv = myDomain->node[i].extra->Heat->T;
     else
-        TvapAdv = myNode[myLink->index].extra->Heat->T;
+        TvapAdv = myDomain->node[myLink->index].extra->Heat->T;
 
     double fluxCourantVap = HEAT_CAPACITY_WATER_VAPOR * vapWaterFlux;
-    fluxCourant += fluxCourantVap;
+    *fluxCourant += fluxCourantVap;
     advection += fluxCourantVap * TvapAdv;
 
     return (advection);
 }
 
 
-double Conduction(long i, TlinkedNode *myLink, double timeStep, double timeStepWater)
+double Conduction(TCrit3DDomain *myDomain, long i, TlinkedNode *myLink, double timeStep, double timeStepWater)
 {
 	double myConductivity, linkConductivity, meanKh;
     double zeta;
@@ -619,70 +622,75 @@ double Conduction(long i, TlinkedNode *myLink, double timeStep, double timeStepW
     double myH, myHLink;
 
     long j = (*myLink).index;
-    double myDistance = distance(i, j);
+    double myDistance = distance(myDomain, i, j);
 
     zeta = myLink->area / myDistance;
 
-    myH = getH_timeStep(i, timeStep, timeStepWater);
-    myHLink = getH_timeStep(j, timeStep, timeStepWater);
-    hAvg = arithmeticMean(myH, myNode[i].oldH) - myNode[i].z;
-    hLinkAvg = arithmeticMean(myHLink, myNode[j].oldH) - myNode[j].z;
+    myH = getH_timeStep(myDomain, i, timeStep, timeStepWater);
+    myHLink = getH_timeStep(myDomain, j, timeStep, timeStepWater);
+    hAvg = arithmeticMean(myH, myDomain->nodeState.oldH[i]) - myDomain->node[i].z;
+    hLinkAvg = arithmeticMean(myHLink, myDomain->nodeState.oldH[j]) - myDomain->node[j].z;
 
-    myConductivity = SoilHeatConductivity(i, myNode[i].extra->Heat->T, hAvg);
-    linkConductivity = SoilHeatConductivity(j, myNode[j].extra->Heat->T, hLinkAvg);
-    meanKh = computeMean(myConductivity, linkConductivity);
+    myConductivity = SoilHeatConductivity(myDomain, i, myDomain->node[i].extra->Heat->T, hAvg);
+    linkConductivity = SoilHeatConductivity(myDomain, j, myDomain->node[j].extra->Heat->T, hLinkAvg);
+    meanKh = computeMean(myDomain, myConductivity, linkConductivity);
 
     return (zeta * meanKh);
 }
 
-bool computeHeatFlux(long i, int myMatrixIndex, TlinkedNode *myLink, double timeStep, double timeStepWater)
+/*!
+ * \brief matrix element of the heat flux between node i and myLink
+ * \param courant [-] maximum Courant number of the advective flux, updated
+ */
+bool computeHeatFlux(TCrit3DDomain *myDomain, long i, int myMatrixIndex, TlinkedNode *myLink, double timeStep, double timeStepWater, double *courant)
 {
     if (myLink == nullptr) return false;
     if ((*myLink).index == NOLINK) return false;
 
     long myLinkIndex = (*myLink).index;
-    double myConduction, myAdvectiveFlux, myLatentFlux;
+    double myConduction, myAdvectiveFlux, myLatentFlux, fluxCourant;
     double nodeDistance;
 
-    if (! isHeatNode(myLinkIndex)) return false;
+    if (! isHeatNode(myDomain, myLinkIndex)) return false;
 
     myConduction = 0.;
     myAdvectiveFlux = 0.;
     myLatentFlux = 0.;
     fluxCourant = 0.;
 
-    myConduction = Conduction(i, myLink, timeStep, timeStepWater);
-    if (myStructure.computeWater)
+    myConduction = Conduction(myDomain, i, myLink, timeStep, timeStepWater);
+    if (myDomain->structure.computeWater)
     {
-        if (myStructure.computeHeatVapor)
+        if (myDomain->structure.computeHeatVapor)
         {
-            myLatentFlux = IsothermalLatentHeatFlux(i, myLink, timeStep, timeStepWater);
-            saveHeatFlux(myLink, HEATFLUX_LATENT_ISOTHERMAL, myLatentFlux);
+            myLatentFlux = IsothermalLatentHeatFlux(myDomain, i, myLink, timeStep, timeStepWater);
+            saveHeatFlux(myDomain, myLink, HEATFLUX_LATENT_ISOTHERMAL, myLatentFlux);
         }
 
-        if (myStructure.computeHeatAdvection)
+        if (myDomain->structure.computeHeatAdvection)
         {
-            myAdvectiveFlux = AdvectiveFlux(i, myLink);
-            saveHeatFlux(myLink, HEATFLUX_ADVECTIVE, myAdvectiveFlux);
+            myAdvectiveFlux = AdvectiveFlux(myDomain, i, myLink, &fluxCourant);
+            saveHeatFlux(myDomain, myLink, HEATFLUX_ADVECTIVE, myAdvectiveFlux);
         }
     }
 
-    A[i][myMatrixIndex].index = myLinkIndex;
-    A[i][myMatrixIndex].val = myConduction;
+    long k = i * myDomain->A.nrColumns + myMatrixIndex;
+    myDomain->A.index[k] = int(myLinkIndex);
+    myDomain->A.val[k] = myConduction;
 
-    invariantFlux[i] += myAdvectiveFlux + myLatentFlux;
+    myDomain->invariantFlux[i] += myAdvectiveFlux + myLatentFlux;
 
     if (fluxCourant != 0)
     {
-        nodeDistance = distance(i, myLinkIndex);
-        CourantHeat = maxValue(CourantHeat, fabs(fluxCourant) * timeStep / (C[i] * nodeDistance));
+        nodeDistance = distance(myDomain, i, myLinkIndex);
+        *courant = maxValue(*courant, fabs(fluxCourant) * timeStep / (myDomain->C[i] * nodeDistance));
     }
 
     return (true);
 }
 
 // should be called only BEFORE heat computation, since A matrix should contain water flux values
-void saveNodeWaterFlux(long i, TlinkedNode *link, double timeStepHeat, double timeStepWater)
+void saveNodeWaterFlux(TCrit3DDomain *myDomain, long i, TlinkedNode *link, double timeStepHeat, double timeStepWater)
 {
     if (link == nullptr) return;
 
@@ -694,23 +702,23 @@ void saveNodeWaterFlux(long i, TlinkedNode *link, double timeStepHeat, double ti
     double thermVapFlux = 0.;
 
     double avgH, avgHLink;
-    avgH = getH_timeStep(i, timeStepHeat, timeStepWater);
-    avgHLink = getH_timeStep(link->index, timeStepHeat, timeStepWater);
+    avgH = getH_timeStep(myDomain, i, timeStepHeat, timeStepWater);
+    avgHLink = getH_timeStep(myDomain, link->index, timeStepHeat, timeStepWater);
 
-    double matrixValue = getMatrixValue(i, link);
+    double matrixValue = getMatrixValue(myDomain, i, link);
     if (matrixValue != INDEX_ERROR) isothLiqFlux = matrixValue * (avgH - avgHLink);
 
-    if (!myNode[i].isSurface && ! myNode[link->index].isSurface)
+    if (!myDomain->node[i].isSurface && ! myDomain->node[link->index].isSurface)
     {
         // compute isothermal vapor flux and subtract from total water flux
         // (because fluxLiquid is computed from A matrix which include isothermal vapor flux component)
-        isothVapFlux = IsothermalVaporFlux(i, link, timeStepHeat, timeStepWater);
+        isothVapFlux = IsothermalVaporFlux(myDomain, i, link, timeStepHeat, timeStepWater);
 
         // thermal liquid flux
-        thermLiqFlux = ThermalLiquidFlux(i, link, PROCESS_HEAT, timeStepHeat, timeStepWater);
+        thermLiqFlux = ThermalLiquidFlux(myDomain, i, link, PROCESS_HEAT, timeStepHeat, timeStepWater);
 
         // thermal vapor flux
-        thermVapFlux = ThermalVaporFlux(i, link, PROCESS_HEAT, timeStepHeat, timeStepWater);
+        thermVapFlux = ThermalVaporFlux(myDomain, i, link, PROCESS_HEAT, timeStepHeat, timeStepWater);
     }
 
     fluxLiquid = isothLiqFlux - isothVapFlux / WATER_DENSITY + thermLiqFlux;
@@ -719,7 +727,7 @@ void saveNodeWaterFlux(long i, TlinkedNode *link, double timeStepHeat, double ti
     link->linkedExtra->heatFlux->waterFlux = (float)fluxLiquid;
     link->linkedExtra->heatFlux->vaporFlux = (float)fluxVapor;
 
-    if (myStructure.saveHeatFluxesType == SAVE_HEATFLUXES_ALL)
+    if (myDomain->structure.saveHeatFluxesType == SAVE_HEATFLUXES_ALL)
     {
         link->linkedExtra->heatFlux->fluxes[WATERFLUX_LIQUID_ISOTHERMAL] = (float)isothLiqFlux;
         link->linkedExtra->heatFlux->fluxes[WATERFLUX_LIQUID_THERMAL] = (float)thermLiqFlux;
@@ -730,269 +738,317 @@ void saveNodeWaterFlux(long i, TlinkedNode *link, double timeStepHeat, double ti
     return;
 }
 
-void saveWaterFluxes(double dtHeat, double dtWater)
+void saveWaterFluxes(TCrit3DDomain *myDomain, double dtHeat, double dtWater)
 {
-    for (long i = 0; i < myStructure.nrNodes; i++)
+    for (long i = 0; i < myDomain->structure.nrNodes; i++)
         {
-            if (&myNode[i].up != nullptr)
-                if (myNode[i].up.linkedExtra != nullptr)
-                    saveNodeWaterFlux(i, &myNode[i].up, dtHeat, dtWater);
+            if (&myDomain->node[i].up != nullptr)
+                if (myDomain->node[i].up.linkedExtra != nullptr)
+                    saveNodeWaterFlux(myDomain, i, &myDomain->node[i].up, dtHeat, dtWater);
 
-            if (&myNode[i].down != nullptr)
-                if (myNode[i].down.linkedExtra != nullptr)
-                    saveNodeWaterFlux(i, &myNode[i].down, dtHeat, dtWater);
+            if (&myDomain->node[i].down != nullptr)
+                if (myDomain->node[i].down.linkedExtra != nullptr)
+                    saveNodeWaterFlux(myDomain, i, &myDomain->node[i].down, dtHeat, dtWater);
 
-            for (short j = 0; j < myStructure.nrLateralLinks; j++)
-                if (&myNode[i].lateral[j] != nullptr)
-                    if (myNode[i].lateral[j].linkedExtra != nullptr)
-                        saveNodeWaterFlux(i, &myNode[i].lateral[j], dtHeat, dtWater);
+            for (short j = 0; j < myDomain->structure.nrLateralLinks; j++)
+                if (&myDomain->node[i].lateral[j] != nullptr)
+                    if (myDomain->node[i].lateral[j].linkedExtra != nullptr)
+                        saveNodeWaterFlux(myDomain, i, &myDomain->node[i].lateral[j], dtHeat, dtWater);
 
         }
 }
 
-void saveNodeHeatFlux(long myIndex, TlinkedNode *myLink, double timeStep, double timeStepWater)
+void saveNodeHeatFlux(TCrit3DDomain *myDomain, long myIndex, TlinkedNode *myLink, double timeStep, double timeStepWater)
 // [W] heat flow between node myNode[myIndex] and link node myLink
 {
-   if (! isHeatLinkedNode(myLink)) return;
+   if (! isHeatLinkedNode(myDomain, myLink)) return;
 
     long myLinkIndex = (*myLink).index;
     double myDiffHeat, myA;
 
-    int j = 1;
-    while ((j < myStructure.maxNrColumns) && (A[myIndex][j].index != NOLINK) && (A[myIndex][j].index != myLinkIndex)) j++;
+    long first = myIndex * myDomain->A.nrColumns;
+    int j = 0;
+    while ((j < myDomain->A.nrLinks[myIndex]) && (myDomain->A.index[first + j] != myLinkIndex)) j++;
 
-    if (A[myIndex][j].index == myLinkIndex)
+    if (j < myDomain->A.nrLinks[myIndex])
     {
-        myA = (A[myIndex][j].val * A[myIndex][0].val);
-        myDiffHeat = myA * (myNode[myIndex].extra->Heat->T - myNode[myLinkIndex].extra->Heat->T) * myParameters.heatWeightingFactor;
-        myDiffHeat += myA * (myNode[myIndex].extra->Heat->oldT - myNode[myLinkIndex].extra->Heat->oldT) * (1. - myParameters.heatWeightingFactor);
+        myA = (myDomain->A.val[first + j] * myDomain->A.diagonal[myIndex]);
+        myDiffHeat = myA * (myDomain->node[myIndex].extra->Heat->T - myDomain->node[myLinkIndex].extra->Heat->T) * myDomain->parameters.heatWeightingFactor;
+        myDiffHeat += myA * (myDomain->node[myIndex].extra->Heat->oldT - myDomain->node[myLinkIndex].extra->Heat->oldT) * (1. - myDomain->parameters.heatWeightingFactor);
 
         // when saving separate fluxes, thermal latent heat has to be subtracted from diffusive,
         // where is incorporated (see AirHeatConductivity)
-        if (myStructure.saveHeatFluxesType == SAVE_HEATFLUXES_ALL)
+        if (myDomain->structure.saveHeatFluxesType == SAVE_HEATFLUXES_ALL)
         {
-            if (myStructure.computeHeatVapor)
+            if (myDomain->structure.computeHeatVapor)
             {
-                double thermalLatentFlux = ThermalVaporFlux(myIndex, myLink, PROCESS_HEAT, timeStep, timeStepWater);
-                thermalLatentFlux *= LatentHeatVaporization(myNode[myIndex].extra->Heat->T - ZEROCELSIUS);
-                saveHeatFlux(myLink, HEATFLUX_LATENT_THERMAL, thermalLatentFlux);
-                saveHeatFlux(myLink, HEATFLUX_DIFFUSIVE, myDiffHeat - thermalLatentFlux);
+                double thermalLatentFlux = ThermalVaporFlux(myDomain, myIndex, myLink, PROCESS_HEAT, timeStep, timeStepWater);
+                thermalLatentFlux *= LatentHeatVaporization(myDomain->node[myIndex].extra->Heat->T - ZEROCELSIUS);
+                saveHeatFlux(myDomain, myLink, HEATFLUX_LATENT_THERMAL, thermalLatentFlux);
+                saveHeatFlux(myDomain, myLink, HEATFLUX_DIFFUSIVE, myDiffHeat - thermalLatentFlux);
             }
             else
-                saveHeatFlux(myLink, HEATFLUX_DIFFUSIVE, myDiffHeat);
+                saveHeatFlux(myDomain, myLink, HEATFLUX_DIFFUSIVE, myDiffHeat);
 
         }
         else
         {
-            saveHeatFlux(myLink, HEATFLUX_TOTAL, myDiffHeat);
+            saveHeatFlux(myDomain, myLink, HEATFLUX_TOTAL, myDiffHeat);
         }
     }
 }
 
-void updateHeatFluxes(double timeStep, double timeStepWater)
+void updateHeatFluxes(TCrit3DDomain *myDomain, double timeStep, double timeStepWater)
 {
-    if (myStructure.saveHeatFluxesType == SAVE_HEATFLUXES_NONE) return;
+    if (myDomain->structure.saveHeatFluxesType == SAVE_HEATFLUXES_NONE) return;
 
-    for (long i = 1; i < myStructure.nrNodes; i++)
+    for (long i = 1; i < myDomain->structure.nrNodes; i++)
     {
-        if (myNode[i].up.index != NOLINK)
-            if (myNode[i].up.linkedExtra->heatFlux != nullptr)
-                saveNodeHeatFlux(i, &(myNode[i].up), timeStep, timeStepWater);
-
-        if (myNode[i].down.index != NOLINK)
-            if (myNode[i].down.linkedExtra->heatFlux != nullptr)
-                saveNodeHeatFlux(i, &(myNode[i].down), timeStep, timeStepWater);
-
-        for (short j = 0; j < myStructure.nrLateralLinks; j++)
-            if (myNode[i].lateral[j].index != NOLINK)
-                if (myNode[i].lateral[j].linkedExtra->heatFlux != nullptr)
-                    saveNodeHeatFlux(i, &(myNode[i].lateral[j]), timeStep, timeStepWater);
+        if (myDomain->node[i].up.index != NOLINK)
+            if (myDomain->node[i].up.linkedExtra->heatFlux != nullptr)
+                saveNodeHeatFlux(myDomain, i, &(myDomain->node[i].up), timeStep, timeStepWater);
+
+        if (myDomain->node[i].down.index != NOLINK)
+            if (myDomain->node[i].down.linkedExtra->heatFlux != nullptr)
+                saveNodeHeatFlux(myDomain, i, &(myDomain->node[i].down), timeStep, timeStepWater);
+
+        for (short j = 0; j < myDomain->structure.nrLateralLinks; j++)
+            if (myDomain->node[i].lateral[j].index != NOLINK)
+                if (myDomain->node[i].lateral[j].linkedExtra->heatFlux != nullptr)
+                    saveNodeHeatFlux(myDomain, i, &(myDomain->node[i].lateral[j]), timeStep, timeStepWater);
     }
 }
 
-void updateBalanceHeat()
+void updateBalanceHeat(TCrit3DDomain *myDomain)
 {
-    balancePreviousTimeStep.storageHeat = balanceCurrentTimeStep.storageHeat;
-    balancePreviousTimeStep.sinkSourceHeat = balanceCurrentTimeStep.sinkSourceHeat;
-    balanceCurrentPeriod.sinkSourceHeat += balanceCurrentTimeStep.sinkSourceHeat;
+    myDomain->balancePreviousTimeStep.storageHeat = myDomain->balanceCurrentTimeStep.storageHeat;
+    myDomain->balancePreviousTimeStep.sinkSourceHeat = myDomain->balanceCurrentTimeStep.sinkSourceHeat;
+    myDomain->balanceCurrentPeriod.sinkSourceHeat += myDomain->balanceCurrentTimeStep.sinkSourceHeat;
 }
 
-bool heatBalance(double timeStep, double timeStepWater)
+bool heatBalance(TCrit3DDomain *myDomain, double timeStep, double timeStepWater)
 {
-    computeHeatBalance(timeStep, timeStepWater);
-    return ((fabs(1.-balanceCurrentTimeStep.heatMBR) < myParameters.MBRThreshold));
+    computeHeatBalance(myDomain, timeStep, timeStepWater);
+    return ((fabs(1.-myDomain->balanceCurrentTimeStep.heatMBR) < myDomain->parameters.MBRThreshold));
 }
 
-void initializeBalanceHeat()
+void initializeBalanceHeat(TCrit3DDomain *myDomain)
 {
-     balanceCurrentTimeStep.sinkSourceHeat = 0.;
-     balancePreviousTimeStep.sinkSourceHeat = 0.;
-     balanceCurrentPeriod.sinkSourceHeat = 0.;
-     balanceWholePeriod.sinkSourceHeat = 0.;
-
-     balanceCurrentTimeStep.heatMBE = 0.;
-     balanceCurrentPeriod.heatMBE = 0.;
-     balanceWholePeriod.waterMBE = 0.;
-
-     balanceCurrentTimeStep.heatMBR = 1.;
-     balanceCurrentPeriod.heatMBR = 1.;
-     balanceWholePeriod.heatMBR = 1.;
-
-     balanceWholePeriod.storageHeat = computeHeatStorage(NODATA, NODATA);
-     balanceCurrentTimeStep.storageHeat = balanceWholePeriod.storageHeat;
-     balancePreviousTimeStep.storageHeat = balanceWholePeriod.storageHeat;
-     balanceCurrentPeriod.storageHeat = balanceWholePeriod.storageHeat;
+     myDomain->balanceCurrentTimeStep.sinkSourceHeat = 0.;
+     myDomain->balancePreviousTimeStep.sinkSourceHeat = 0.;
+     myDomain->balanceCurrentPeriod.sinkSourceHeat = 0.;
+     myDomain->balanceWholePeriod.sinkSourceHeat = 0.;
+
+     myDomain->balanceCurrentTimeStep.heatMBE = 0.;
+     myDomain->balanceCurrentPeriod.heatMBE = 0.;
+     myDomain->balanceWholePeriod.waterMBE = 0.;
+
+     myDomain->balanceCurrentTimeStep.heatMBR = 1.;
+     myDomain->balanceCurrentPeriod.heatMBR = 1.;
+     myDomain->balanceWholePeriod.heatMBR = 1.;
+
+     myDomain->balanceWholePeriod.storageHeat = computeHeatStorage(myDomain, NODATA, NODATA);
+     myDomain->balanceCurrentTimeStep.storageHeat = myDomain->balanceWholePeriod.storageHeat;
+     myDomain->balancePreviousTimeStep.storageHeat = myDomain->balanceWholePeriod.storageHeat;
+     myDomain->balanceCurrentPeriod.storageHeat = myDomain->balanceWholePeriod.storageHeat;
 }
 
-void updateBalanceHeatWholePeriod()
+void updateBalanceHeatWholePeriod(TCrit3DDomain *myDomain)
 {
     /*! update the flows in the balance (balanceWholePeriod) */
-    balanceWholePeriod.sinkSourceHeat  += balanceCurrentPeriod.sinkSourceHeat;
+    myDomain->balanceWholePeriod.sinkSourceHeat  += myDomain->balanceCurrentPeriod.sinkSourceHeat;
 
-    double deltaStoragePeriod = balanceCurrentTimeStep.storageHeat - balanceCurrentPeriod.storageHeat;
-    double deltaStorageHistorical = balanceCurrentTimeStep.storageHeat - balanceWholePeriod.storageHeat;
+    double deltaStoragePeriod = myDomain->balanceCurrentTimeStep.storageHeat - myDomain->balanceCurrentPeriod.storageHeat;
+    double deltaStorageHistorical = myDomain->balanceCurrentTimeStep.storageHeat - myDomain->balanceWholePeriod.storageHeat;
 
     /*! compute MBE and MBR */
-    balanceCurrentPeriod.heatMBE = deltaStoragePeriod - balanceCurrentPeriod.sinkSourceHeat;
-    balanceWholePeriod.heatMBE = deltaStorageHistorical - balanceWholePeriod.sinkSourceHeat;
-    if ((balanceWholePeriod.storageHeat == 0.) && (balanceWholePeriod.sinkSourceHeat == 0.)) balanceWholePeriod.heatMBR = 1.;
-    else if (balanceCurrentTimeStep.storageHeat > fabs(balanceWholePeriod.sinkSourceHeat))
-        balanceWholePeriod.heatMBR = balanceCurrentTimeStep.storageHeat / (balanceWholePeriod.storageHeat + balanceWholePeriod.sinkSourceHeat);
+    myDomain->balanceCurrentPeriod.heatMBE = deltaStoragePeriod - myDomain->balanceCurrentPeriod.sinkSourceHeat;
+    myDomain->balanceWholePeriod.heatMBE = deltaStorageHistorical - myDomain->balanceWholePeriod.sinkSourceHeat;
+    if ((myDomain->balanceWholePeriod.storageHeat == 0.) && (myDomain->balanceWholePeriod.sinkSourceHeat == 0.)) myDomain->balanceWholePeriod.heatMBR = 1.;
+    else if (myDomain->balanceCurrentTimeStep.storageHeat > fabs(myDomain->balanceWholePeriod.sinkSourceHeat))
+        myDomain->balanceWholePeriod.heatMBR = myDomain->balanceCurrentTimeStep.storageHeat / (myDomain->balanceWholePeriod.storageHeat + myDomain->balanceWholePeriod.sinkSourceHeat);
     else
-        balanceWholePeriod.heatMBR = deltaStorageHistorical / balanceWholePeriod.sinkSourceHeat;
+        myDomain->balanceWholePeriod.heatMBR = deltaStorageHistorical / myDomain->balanceWholePeriod.sinkSourceHeat;
 
     /*! update storageWater in balanceCurrentPeriod */
-    balanceCurrentPeriod.storageHeat = balanceCurrentTimeStep.storageHeat;
+    myDomain->balanceCurrentPeriod.storageHeat = myDomain->balanceCurrentTimeStep.storageHeat;
 }
 
-void restoreHeat()
+void restoreHeat(TCrit3DDomain *myDomain)
 {
-    for (long i = 1; i < myStructure.nrNodes; i++)
-        myNode[i].extra->Heat->T = myNode[i].extra->Heat->oldT;
+    for (long i = 1; i < myDomain->structure.nrNodes; i++)
+        myDomain->node[i].extra->Heat->T = myDomain->node[i].extra->Heat->oldT;
 }
 
-void initializeHeatFluxes(bool initHeat, bool initWater)
+void initializeHeatFluxes(TCrit3DDomain *myDomain, bool initHeat, bool initWater)
 {
-    for (long n = 0; n < myStructure.nrNodes; n++)
+    for (long n = 0; n < myDomain->structure.nrNodes; n++)
     {
-        initializeNodeHeatFlux(myNode[n].up.linkedExtra, initHeat, initWater);
-        initializeNodeHeatFlux(myNode[n].down.linkedExtra, initHeat, initWater);
-        for (short i = 1; i < myStructure.nrLateralLinks; i++)
-           initializeNodeHeatFlux(myNode[n].lateral[i].linkedExtra, initHeat, initWater);
+        initializeNodeHeatFlux(myDomain, myDomain->node[n].up.linkedExtra, initHeat, initWater);
+        initializeNodeHeatFlux(myDomain, myDomain->node[n].down.linkedExtra, initHeat, initWater);
+        for (short i = 1; i < myDomain->structure.nrLateralLinks; i++)
+           initializeNodeHeatFlux(myDomain, myDomain->node[n].lateral[i].linkedExtra, initHeat, initWater);
     }
 }
 
-double computeMaximumDeltaT()
+double computeMaximumDeltaT(TCrit3DDomain *myDomain)
 {
     double maxDeltaT = 0.;
-    for (long i = 1; i < myStructure.nrNodes; i++)
-        maxDeltaT = maxValue(maxDeltaT, fabs(myNode[i].extra->Heat->T - myNode[i].extra->Heat->oldT));
+    for (long i = 1; i < myDomain->structure.nrNodes; i++)
+        maxDeltaT = maxValue(maxDeltaT, fabs(myDomain->node[i].extra->Heat->T - myDomain->node[i].extra->Heat->oldT));
 
     return maxDeltaT;
 }
 
-bool HeatComputation(double timeStep, double timeStepWater)
+/*!
+ * \brief matrix row, known term and preconditioning of heat node i
+ * \param courant [-] maximum Courant number, updated
+ */
+void computeHeatMatrixRow(TCrit3DDomain *myDomain, long i, double timeStep, double timeStepWater, double *courant)
 {
-
-	long i, j;
-    double sum = 0;
-    double sumFlow0 = 0;
-    double myDeltaTemp0;
-    double avgh;
-    double heatCapacityVar;
+    long j;
+    double sum, sumFlow0, myDeltaTemp0;
+    double avgh, heatCapacityVar;
     double dtheta, dthetav;
     double myH;
 
-    initializeHeatFluxes(true, false);
-    CourantHeat = 0.;
+    myDomain->invariantFlux[i] = 0.;
+
+    myH = getH_timeStep(myDomain, i, timeStep, timeStepWater);
+
+    // compute heat capacity temporal variation
+    // due to changes in water and vapor
+    dtheta = theta_from_sign_Psi(myDomain, myH - myDomain->node[i].z, i) -
+            theta_from_sign_Psi(myDomain, myDomain->nodeState.oldH[i] - myDomain->node[i].z, i);
+
+    heatCapacityVar = dtheta * HEAT_CAPACITY_WATER * myDomain->node[i].extra->Heat->T;
 
-    for (i = 1; i < myStructure.nrNodes; i++)
+    if (myDomain->structure.computeHeatVapor)
     {
-        A[i][0].index = i;
-        X[i] = myNode[i].extra->Heat->T;
-        myNode[i].extra->Heat->oldT = myNode[i].extra->Heat->T;
+        dthetav = VaporThetaV(myDomain, myH - myDomain->node[i].z, myDomain->node[i].extra->Heat->T, i) -
+                VaporThetaV(myDomain, myDomain->nodeState.oldH[i] - myDomain->node[i].z, myDomain->node[i].extra->Heat->oldT, i);
+        heatCapacityVar += dthetav * HEAT_CAPACITY_AIR * myDomain->node[i].extra->Heat->T;
+        heatCapacityVar += dthetav * LatentHeatVaporization(myDomain->node[i].extra->Heat->T - ZEROCELSIUS) * WATER_DENSITY;
+    }
+
+    heatCapacityVar *= myDomain->node[i].volume_area;
+
+    j = 0;
+    if (computeHeatFlux(myDomain, i, j, &(myDomain->node[i].up), timeStep, timeStepWater, courant)) j++;
+    for (short l = 0; l < myDomain->structure.nrLateralLinks; l++)
+        if (computeHeatFlux(myDomain, i, j, &(myDomain->node[i].lateral[l]), timeStep, timeStepWater, courant)) j++;
+    if (computeHeatFlux(myDomain, i, j, &(myDomain->node[i].down), timeStep, timeStepWater, courant)) j++;
 
-        myH = getH_timeStep(i, timeStep, timeStepWater);
-        avgh = arithmeticMean(myNode[i].oldH, myH) - myNode[i].z;
-        C[i] = SoilHeatCapacity(i, avgh, myNode[i].extra->Heat->T) * myNode[i].volume_area;
+    // closure
+    myDomain->A.nrLinks[i] = int(j);
+
+    int *rowIndex = myDomain->A.index + i * myDomain->A.nrColumns;
+    double *rowVal = myDomain->A.val + i * myDomain->A.nrColumns;
+    sum = 0.;
+    sumFlow0 = 0;
+    myDeltaTemp0 = 0;
+
+    for (j = 0; j < myDomain->A.nrLinks[i]; j++)
+    {
+        sum += rowVal[j] * myDomain->parameters.heatWeightingFactor;
+        myDeltaTemp0 = myDomain->node[rowIndex[j]].extra->Heat->oldT - myDomain->node[i].extra->Heat->oldT;
+        sumFlow0 += rowVal[j] * (1. - myDomain->parameters.heatWeightingFactor) * myDeltaTemp0;
+        rowVal[j] *= -(myDomain->parameters.heatWeightingFactor);
     }
 
-    for (i = 1; i < myStructure.nrNodes; i++)
+    /*! sum of diagonal elements */
+    avgh = arithmeticMean(myDomain->nodeState.oldH[i], myH) - myDomain->node[i].z;
+    myDomain->A.diagonal[i] = SoilHeatCapacity(myDomain, i, avgh, myDomain->node[i].extra->Heat->T) * myDomain->node[i].volume_area / timeStep + sum;
+
+    /*! b vector (constant terms) */
+    myDomain->b[i] = myDomain->C[i] * myDomain->node[i].extra->Heat->oldT / timeStep - heatCapacityVar / timeStep + myDomain->node[i].extra->Heat->Qh + myDomain->invariantFlux[i] + sumFlow0;
+
+    // preconditioning
+    if (myDomain->A.diagonal[i] > 0)
     {
-        invariantFlux[i] = 0.;
+        myDomain->b[i] /= myDomain->A.diagonal[i];
+        for (j = 0; j < myDomain->A.nrLinks[i]; j++)
+            rowVal[j] /= myDomain->A.diagonal[i];
+    }
+}
 
-        myH = getH_timeStep(i, timeStep, timeStepWater);
 
-        // compute heat capacity temporal variation
-        // due to changes in water and vapor
-        dtheta = theta_from_sign_Psi(myH - myNode[i].z, i) -
-                theta_from_sign_Psi(myNode[i].oldH - myNode[i].z, i);
+/*!
+ * \brief heat capacity of node i, the current temperature becomes the old one
+ */
+void computeHeatNodeCapacity(TCrit3DDomain *myDomain, long i, double timeStep, double timeStepWater)
+{
+    myDomain->X[i] = myDomain->node[i].extra->Heat->T;
+    myDomain->node[i].extra->Heat->oldT = myDomain->node[i].extra->Heat->T;
 
-        heatCapacityVar = dtheta * HEAT_CAPACITY_WATER * myNode[i].extra->Heat->T;
+    double myH = getH_timeStep(myDomain, i, timeStep, timeStepWater);
+    double avgh = arithmeticMean(myDomain->nodeState.oldH[i], myH) - myDomain->node[i].z;
+    myDomain->C[i] = SoilHeatCapacity(myDomain, i, avgh, myDomain->node[i].extra->Heat->T) * myDomain->node[i].volume_area;
+}
 
-        if (myStructure.computeHeatVapor)
-        {
-            dthetav = VaporThetaV(myH - myNode[i].z, myNode[i].extra->Heat->T, i) -
-                    VaporThetaV(myNode[i].oldH - myNode[i].z, myNode[i].extra->Heat->oldT, i);
-            heatCapacityVar += dthetav * HEAT_CAPACITY_AIR * myNode[i].extra->Heat->T;
-            heatCapacityVar += dthetav * LatentHeatVaporization(myNode[i].extra->Heat->T - ZEROCELSIUS) * WATER_DENSITY;
-        }
 
-        heatCapacityVar *= myNode[i].volume_area;
+/*!
+ * \brief assembly of the heat system: each row is independent, the rows are
+ * computed in parallel on large domains when more than one thread is set (setNumberOfThreads)
+ * \return [-] maximum Courant number of the advective fluxes
+ */
+double assembleHeatMatrix(TCrit3DDomain *myDomain, double timeStep, double timeStepWater)
+{
+    long nrNodes = myDomain->structure.nrNodes;
+    double maxCourant = 0.;
 
-        j = 1;
-        if (computeHeatFlux(i, j, &(myNode[i].up), timeStep, timeStepWater)) j++;
-        for (short l = 0; l < myStructure.nrLateralLinks; l++)
-            if (computeHeatFlux(i, j, &(myNode[i].lateral[l]), timeStep, timeStepWater)) j++;
-        if (computeHeatFlux(i, j, &(myNode[i].down), timeStep, timeStepWater)) j++;
+    if (myDomain->parameters.nrThreads <= 1 || nrNodes <= MIN_PARALLEL_SIZE)
+    {
+        for (long i = 1; i < nrNodes; i++)
+            computeHeatNodeCapacity(myDomain, i, timeStep, timeStepWater);
 
-        // closure
-        while (j < myStructure.maxNrColumns)
-            A[i][j++].index = NOLINK;
+        /*! the rows read oldT of the linked nodes */
+        for (long i = 1; i < nrNodes; i++)
+            computeHeatMatrixRow(myDomain, i, timeStep, timeStepWater, &maxCourant);
 
-        j = 1;
-        sum = 0.;
-        sumFlow0 = 0;
-        myDeltaTemp0 = 0;
+        return maxCourant;
+    }
 
-        while ((j < myStructure.maxNrColumns) && (A[i][j].index != NOLINK))
-        {
-            sum += A[i][j].val * myParameters.heatWeightingFactor;
-            myDeltaTemp0 = myNode[A[i][j].index].extra->Heat->oldT - myNode[i].extra->Heat->oldT;
-            sumFlow0 += A[i][j].val * (1. - myParameters.heatWeightingFactor) * myDeltaTemp0;
-            A[i][j++].val *= -(myParameters.heatWeightingFactor);
-        }
+    #pragma omp parallel num_threads(myDomain->parameters.nrThreads) reduction(max:maxCourant)
+    {
+        double threadCourant = 0.;
 
-        /*! sum of diagonal elements */
-        avgh = arithmeticMean(myNode[i].oldH, myH) - myNode[i].z;
-        A[i][0].val = SoilHeatCapacity(i, avgh, myNode[i].extra->Heat->T) * myNode[i].volume_area / timeStep + sum;
+        #pragma omp for schedule(static)
+        for (long i = 1; i < nrNodes; i++)
+            computeHeatNodeCapacity(myDomain, i, timeStep, timeStepWater);
 
-        /*! b vector (constant terms) */
-        b[i] = C[i] * myNode[i].extra->Heat->oldT / timeStep - heatCapacityVar / timeStep + myNode[i].extra->Heat->Qh + invariantFlux[i] + sumFlow0;
+        #pragma omp for schedule(static)
+        for (long i = 1; i < nrNodes; i++)
+            computeHeatMatrixRow(myDomain, i, timeStep, timeStepWater, &threadCourant);
 
-        // preconditioning
-        if (A[i][0].val > 0)
-        {
-            b[i] /= A[i][0].val;
-            j = 1;
-            while ((j < myStructure.maxNrColumns) && (A[i][j].index != NOLINK))
-                A[i][j++].val /= A[i][0].val;
-        }
+        maxCourant = threadCourant;
     }
 
+    return maxCourant;
+}
+
+
+bool HeatComputation(TCrit3DDomain *myDomain, double timeStep, double timeStepWater)
+{
+    long i;
+
+    initializeHeatFluxes(myDomain, true, false);
+
+    double courantHeat = assembleHeatMatrix(myDomain, timeStep, timeStepWater);
+
     // avoiding oscillations (Courant number)
-    if (CourantHeat > 1.0)
-        if (timeStep > myParameters.delta_t_min)
+    if (courantHeat > 1.0)
+        if (timeStep > myDomain->parameters.delta_t_min)
         {
-            halveTimeStep();
-            setForcedHalvedTime(true);
+            reduceTimeStep(myDomain, 0.9 / courantHeat);
+            setForcedHalvedTime(myDomain, true);
             return (false);
         }
 
-    GaussSeidelRelaxation(0, myParameters.ResidualTolerance, PROCESS_HEAT);
+    GaussSeidelRelaxation(myDomain, 0, myDomain->parameters.ResidualTolerance, PROCESS_HEAT);
 
-    for (i = 1; i < myStructure.nrNodes; i++)
-        myNode[i].extra->Heat->T = X[i];
+    for (i = 1; i < myDomain->structure.nrNodes; i++)
+        myDomain->node[i].extra->Heat->T = myDomain->X[i];
 
     // avoiding oscillations (maximum temperature change allowed)
     /*double maxDeltaT = computeMaximumDeltaT();
@@ -1008,14 +1064,14 @@ bool HeatComputation(double timeStep, double timeStepWater)
         if (myParameters.current_delta_t > myParameters.delta_t_min) return false;
     }*/
 
-    heatBalance(timeStep, timeStepWater);
-    updateBalanceHeat();
+    heatBalance(myDomain, timeStep, timeStepWater);
+    updateBalanceHeat(myDomain);
 
-    updateHeatFluxes(timeStep, timeStepWater);
+    updateHeatFluxes(myDomain, timeStep, timeStepWater);
 
 	// save old temperatures
-    for (long n = 1; n < myStructure.nrNodes; n++)
-        myNode[n].extra->Heat->oldT = myNode[n].extra->Heat->T;
+    for (long n = 1; n < myDomain->structure.nrNodes; n++)
+        myDomain->node[n].extra->Heat->oldT = myDomain->node[n].extra->Heat->T;
 
     return (true);
 }
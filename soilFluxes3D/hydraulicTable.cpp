@@ -0,0 +1,398 @@
+/*!
+    \name hydraulicTable.cpp
+    \copyright (C) 2011 Fausto Tomei, Gabriele Antolini, Antonio Volta,
+                        Alberto Pistocchi, Marco Bittelli
+
+    This file is part of CRITERIA3D.
+    CRITERIA3D has been developed under contract issued by A.R.P.A. Emilia-Romagna
+
+    CRITERIA3D is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    CRITERIA3D is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with CRITERIA3D.  If not, see <http://www.gnu.org/licenses/>.
+
+    contacts:
+    fausto.tomei@gmail.com
+    ftomei@arpae.emr.it
+    gantolini@arpae.emr.it
+*/
+
+#include <math.h>
+#include <map>
+#include <tuple>
+#include <mutex>
+
+#include "../mathFunctions/commonConstants.h"
+#include "header/types.h"
+#include "header/soilPhysics.h"
+#include "header/hydraulicTable.h"
+#include "header/domain.h"
+
+/*!
+ * Tabulated Van Genuchten - Mualem functions, used only in table mode (setHydraulicTables).
+ * The table of each soil horizon is built on a uniform grid of ln(psi):
+ * the grid is refined until the interpolation errors (checked inside each interval against the
+ * analytic forms) are below the tolerances, and the errors reached are stored in the table.
+ * The capacity dSe/dPsi is the derivative of the Se cubic, so it is consistent with the secant
+ * (Se - SePrevious) / deltaH used when the potential changes: its error is checked too.
+ * The tables are read-only once built: horizons with the same parameters (also in different
+ * domains) share the same table.
+ */
+
+static const double TABLE_PSI_MIN = 1E-4;           /*!< [m] */
+static const double TABLE_PSI_MAX = 1E5;            /*!< [m] */
+static const int MIN_POINTS_DECADE = 16;
+static const int MAX_POINTS_DECADE = 1024;
+static const double TOLERANCE_SE = 1E-7;            /*!< [-] absolute */
+static const double TOLERANCE_K = 1E-5;             /*!< [-] relative error of K */
+static const double TOLERANCE_CAPACITY = 1E-4;      /*!< [-] relative error of dSe/dPsi */
+static const double MIN_SE_POWER = 1E-8;            /*!< [-] min Se^(1/m): below, the Mualem form loses precision */
+
+static const int NR_COEFF = 8;                      /*!< Se, lnK: 4 coefficients each */
+
+/*! water retention curve and parameters of the hydraulic functions */
+typedef std::tuple<int, double, double, double, double, double, double> ThydraulicTableKey;
+
+/*! tables in use: released when the last horizon using them is deleted or changed */
+static std::map<ThydraulicTableKey, std::weak_ptr<const ThydraulicTable>> sharedTables;
+static std::mutex sharedTablesMutex;
+
+
+/*!
+ * \brief monotone slopes (Fritsch-Butland) of y on a uniform grid, in grid units
+ * extrema get zero slope, so the interpolation does not overshoot
+ */
+static void monotoneSlopes(const std::vector<double> &y, std::vector<double> &slope)
+{
+    unsigned n = unsigned(y.size());
+    slope.assign(n, 0.);
+    if (n < 2) return;
+
+    for (unsigned j = 1; j < n - 1; j++)
+    {
+        double d1 = y[j] - y[j-1];
+        double d2 = y[j+1] - y[j];
+        if (d1 * d2 > 0.)
+            slope[j] = 2. * d1 * d2 / (d1 + d2);
+    }
+
+    /*! one-sided three points at the ends */
+    slope[0] = y[1] - y[0];
+    slope[n-1] = y[n-1] - y[n-2];
+    if (n > 2)
+    {
+        double d = (-3. * y[0] + 4. * y[1] - y[2]) * 0.5;
+        if (d * slope[0] > 0.) slope[0] = minValue(fabs(d), 3. * fabs(slope[0])) * (d > 0. ? 1. : -1.);
+        else slope[0] = 0.;
+
+        d = (3. * y[n-1] - 4. * y[n-2] + y[n-3]) * 0.5;
+        if (d * slope[n-1] > 0.) slope[n-1] = minValue(fabs(d), 3. * fabs(slope[n-1])) * (d > 0. ? 1. : -1.);
+        else slope[n-1] = 0.;
+    }
+}
+
+
+/*!
+ * \brief Fritsch-Carlson limiter: keeps the Hermite cubic monotone in each interval
+ */
+static void limitSlopes(const std::vector<double> &y, std::vector<double> &slope)
+{
+    for (unsigned j = 0; j + 1 < y.size(); j++)
+    {
+        double delta = y[j+1] - y[j];
+        if (delta == 0.)
+        {
+            slope[j] = slope[j+1] = 0.;
+            continue;
+        }
+
+        double alpha = slope[j] / delta;
+        double beta = slope[j+1] / delta;
+        if (alpha < 0.) { slope[j] = 0.; alpha = 0.; }
+        if (beta < 0.) { slope[j+1] = 0.; beta = 0.; }
+
+        double sum2 = alpha * alpha + beta * beta;
+        if (sum2 > 9.)
+        {
+            double tau = 3. / sqrt(sum2);
+            slope[j] = tau * alpha * delta;
+            slope[j+1] = tau * beta * delta;
+        }
+    }
+}
+
+
+/*! cubic Hermite coefficients on t = [0, 1] */
+static void hermiteCoefficients(double y0, double y1, double d0, double d1, double *c)
+{
+    double delta = y1 - y0;
+    c[0] = y0;
+    c[1] = d0;
+    c[2] = 3. * delta - 2. * d0 - d1;
+    c[3] = d0 + d1 - 2. * delta;
+}
+
+
+static inline double cubic(const double *c, double t)
+{
+    return c[0] + t * (c[1] + t * (c[2] + t * c[3]));
+}
+
+
+/*! derivative of the cubic with respect to t */
+static inline double cubicDerivative(const double *c, double t)
+{
+    return c[1] + t * (2. * c[2] + t * 3. * c[3]);
+}
+
+
+/*!
+ * \brief position of psi in the table
+ * \return false if psi is out of the table
+ */
+static inline bool tablePosition(const ThydraulicTable &table, double psi, const double **coeff, double *t)
+{
+    double u = (log(psi) - table.lnPsiMin) * table.invStep;
+    if (! (u >= 0. && u < table.nrIntervals)) return false;
+
+    int j = int(u);
+    *t = u - j;
+    *coeff = table.coeff.data() + j * NR_COEFF;
+    return true;
+}
+
+
+/*!
+ * \brief fill the table of mySoil with nrIntervals intervals on [lnPsiMin, lnPsiMax]
+ * the table ends where the analytic conductivity is not accurate
+ * (1 - [1 - Se^(1/m)]^m cancels for very dry soil) or ln(K), ln(dSe/dPsi) are not finite
+ */
+static void fillTable(TCrit3DDomain *myDomain, ThydraulicTable *table, Tsoil *mySoil, double lnPsiMin, double lnPsiMax, int nrIntervals)
+{
+    double step = (lnPsiMax - lnPsiMin) / nrIntervals;
+
+    std::vector<double> Se, lnK, slopeSe, slopeK;
+    for (int j = 0; j <= nrIntervals; j++)
+    {
+        double psi = exp(lnPsiMin + j * step);
+        double mySe = computeSefromPsi(myDomain, psi, mySoil);
+        double scaledSe = mySe;
+        if (myDomain->parameters.waterRetentionCurve == MODIFIEDVANGENUCHTEN)
+            scaledSe *= mySoil->VG_Sc;
+        if (pow(scaledSe, 1. / mySoil->VG_m) < MIN_SE_POWER) break;
+
+        double myLnK = log(computeWaterConductivity(myDomain, mySe, mySoil) / mySoil->K_sat);
+        double myC = dSe_dPsi(myDomain, psi, mySoil);
+
+        if (! (std::isfinite(myLnK) && std::isfinite(log(myC)))) break;
+
+        Se.push_back(mySe);
+        lnK.push_back(myLnK);
+        /*! exact slope of Se in grid units: dSe/du = -psi * dSe/dPsi * step */
+        slopeSe.push_back(-psi * myC * step);
+    }
+
+    table->nrIntervals = maxValue(int(Se.size()) - 1, 0);
+    table->lnPsiMin = lnPsiMin;
+    table->lnPsiMax = lnPsiMin + table->nrIntervals * step;
+    table->invStep = 1. / step;
+    table->coeff.assign(unsigned(table->nrIntervals * NR_COEFF), 0.);
+    if (table->nrIntervals == 0) return;
+
+    limitSlopes(Se, slopeSe);
+    monotoneSlopes(lnK, slopeK);
+
+    for (int j = 0; j < table->nrIntervals; j++)
+    {
+        double *c = table->coeff.data() + j * NR_COEFF;
+        hermiteCoefficients(Se[j], Se[j+1], slopeSe[j], slopeSe[j+1], c);
+        hermiteCoefficients(lnK[j], lnK[j+1], slopeK[j], slopeK[j+1], c + 4);
+    }
+}
+
+
+/*!
+ * \brief max errors of the table against the analytic forms (three points in each interval)
+ */
+static void checkTable(TCrit3DDomain *myDomain, ThydraulicTable *table, Tsoil *mySoil)
+{
+    table->maxErrorSe = table->maxErrorK = table->maxErrorC = 0.;
+
+    for (int j = 0; j < table->nrIntervals; j++)
+    {
+        const double *c = table->coeff.data() + j * NR_COEFF;
+        for (double t = 0.25; t < 1.; t += 0.25)
+        {
+            double psi = exp(table->lnPsiMin + (j + t) / table->invStep);
+            double mySe = computeSefromPsi(myDomain, psi, mySoil);
+            double myK = computeWaterConductivity(myDomain, mySe, mySoil) / mySoil->K_sat;
+            double myC = dSe_dPsi(myDomain, psi, mySoil);
+
+            table->maxErrorSe = maxValue(table->maxErrorSe, fabs(cubic(c, t) - mySe));
+            double tableC = -cubicDerivative(c, t) * table->invStep / psi;
+
+            table->maxErrorK = maxValue(table->maxErrorK, fabs(exp(cubic(c + 4, t)) / myK - 1.));
+            table->maxErrorC = maxValue(table->maxErrorC, fabs(tableC / myC - 1.));
+        }
+    }
+}
+
+
+/*!
+ * \brief compute the table of hydraulic functions of a soil horizon
+ * (for the current water retention curve)
+ */
+static void computeTable(TCrit3DDomain *myDomain, ThydraulicTable *table, Tsoil *mySoil)
+{
+    table->waterRetentionCurve = myDomain->parameters.waterRetentionCurve;
+
+    /*! modified Van Genuchten: saturated below the air entry potential */
+    double psiMin = TABLE_PSI_MIN;
+    if (myDomain->parameters.waterRetentionCurve == MODIFIEDVANGENUCHTEN)
+        psiMin = maxValue(psiMin, mySoil->VG_he);
+
+    if ((mySoil->K_sat <= 0.) || (psiMin >= TABLE_PSI_MAX))
+    {
+        fillTable(myDomain, table, mySoil, 0., 1., 0);
+        return;
+    }
+
+    double nrDecades = log10(TABLE_PSI_MAX / psiMin);
+    for (int pointsDecade = MIN_POINTS_DECADE; pointsDecade <= MAX_POINTS_DECADE; pointsDecade *= 2)
+    {
+        fillTable(myDomain, table, mySoil, log(psiMin), log(TABLE_PSI_MAX), int(ceil(nrDecades * pointsDecade)));
+        checkTable(myDomain, table, mySoil);
+
+        if ((table->maxErrorSe < TOLERANCE_SE) && (table->maxErrorK < TOLERANCE_K)
+            && (table->maxErrorC < TOLERANCE_CAPACITY))
+            break;
+    }
+}
+
+
+/*!
+ * \brief set the table of hydraulic functions of a soil horizon (for the current water retention curve):
+ * the table of a horizon with the same parameters is shared, otherwise a new table is built
+ * \return number of intervals (0 if the table is not usable)
+ */
+int buildHydraulicTable(TCrit3DDomain *myDomain, Tsoil *mySoil)
+{
+    ThydraulicTableKey key(myDomain->parameters.waterRetentionCurve, mySoil->VG_alpha, mySoil->VG_n, mySoil->VG_m,
+                           mySoil->VG_he, mySoil->K_sat, mySoil->Mualem_L);
+
+    std::lock_guard<std::mutex> lock(sharedTablesMutex);
+
+    mySoil->table = sharedTables[key].lock();
+    if (mySoil->table == nullptr)
+    {
+        std::shared_ptr<ThydraulicTable> newTable = std::make_shared<ThydraulicTable>();
+        computeTable(myDomain, newTable.get(), mySoil);
+        mySoil->table = newTable;
+        sharedTables[key] = newTable;
+
+        /*! remove the tables no more used */
+        for (auto it = sharedTables.begin(); it != sharedTables.end(); )
+        {
+            if (it->second.expired())
+                it = sharedTables.erase(it);
+            else
+                it++;
+        }
+    }
+
+    return mySoil->table->nrIntervals;
+}
+
+
+static inline bool isTableValid(TCrit3DDomain *myDomain, const Tsoil *mySoil)
+{
+    return (mySoil->table != nullptr && mySoil->table->nrIntervals > 0
+            && mySoil->table->waterRetentionCurve == myDomain->parameters.waterRetentionCurve);
+}
+
+
+/*!
+ * \brief degree of saturation at psi [m]: table inside its range, analytic form outside
+ * (the same rule for the current and the previous potential, so the secant is consistent)
+ */
+static inline double computeSeTable(TCrit3DDomain *myDomain, Tsoil *mySoil, bool isValid, double psi)
+{
+    if (psi <= 0.) return 1.;
+
+    const double *c;
+    double t;
+    if (isValid && tablePosition(*(mySoil->table), psi, &c, &t))
+        return cubic(c, t);
+
+    return computeSefromPsi(myDomain, psi, mySoil);
+}
+
+
+/*!
+ * \brief degree of saturation of the sub-surface nodes in [firstNode, lastNode)
+ * nodes out of the tables are computed with the analytic form
+ */
+void computeSeBatch(TCrit3DDomain *myDomain, long firstNode, long lastNode)
+{
+    for (long i = firstNode; i < lastNode; i++)
+    {
+        if (myDomain->node[i].isSurface) continue;
+
+        Tsoil *mySoil = myDomain->node[i].Soil;
+        myDomain->nodeState.Se[i] = computeSeTable(myDomain, mySoil, isTableValid(myDomain, mySoil), myDomain->node[i].z - myDomain->nodeState.H[i]);
+    }
+}
+
+
+/*!
+ * \brief liquid water conductivity [m s-1] and dTheta/dH [m-1] of the sub-surface nodes
+ * in [firstNode, lastNode): same cases of computeK and dTheta_dH, Se must be updated (computeSeBatch)
+ * nodes out of the tables are computed with the analytic forms
+ * \param dThetadH [nrNodes] output
+ */
+void computeConductivityCapacityBatch(TCrit3DDomain *myDomain, long firstNode, long lastNode, double *dThetadH)
+{
+    for (long i = firstNode; i < lastNode; i++)
+    {
+        if (myDomain->node[i].isSurface) continue;
+
+        Tsoil *mySoil = myDomain->node[i].Soil;
+        bool isValid = isTableValid(myDomain, mySoil);
+        double psi = myDomain->node[i].z - myDomain->nodeState.H[i];
+
+        const double *c = nullptr;
+        double t = 0.;
+        bool isInTable = (psi > 0.) && isValid && tablePosition(*(mySoil->table), psi, &c, &t);
+
+        if (isInTable)
+            myDomain->nodeState.k[i] = mySoil->K_sat * exp(cubic(c + 4, t));
+        else
+            myDomain->nodeState.k[i] = compute_K_Mualem(myDomain, mySoil->K_sat, myDomain->nodeState.Se[i],
+                                                mySoil->VG_Sc, mySoil->VG_m, mySoil->Mualem_L);
+
+        double dSe;
+        double deltaH = myDomain->nodeState.H[i] - myDomain->nodeState.oldH[i];
+        if (deltaH != 0.)
+        {
+            double SePrevious = computeSeTable(myDomain, mySoil, isValid, myDomain->node[i].z - myDomain->nodeState.oldH[i]);
+            dSe = fabs((myDomain->nodeState.Se[i] - SePrevious) / deltaH);
+        }
+        else if (isInTable)
+            dSe = -cubicDerivative(c, t) * mySoil->table->invStep / psi;
+        else
+        {
+            dThetadH[i] = dTheta_dH(myDomain, unsigned(i));
+            continue;
+        }
+
+        dThetadH[i] = dSe * (mySoil->Theta_s - mySoil->Theta_r);
+    }
+}
@@ -0,0 +1,264 @@
+/*!
+    \name krylov.cpp
+    \copyright (C) 2011 Fausto Tomei, Gabriele Antolini, Antonio Volta,
+                        Alberto Pistocchi, Marco Bittelli
+
+    This file is part of CRITERIA3D.
+    CRITERIA3D has been developed under contract issued by A.R.P.A. Emilia-Romagna
+
+    CRITERIA3D is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    CRITERIA3D is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with CRITERIA3D.  If not, see <http://www.gnu.org/licenses/>.
+
+    contacts:
+    fausto.tomei@gmail.com
+    ftomei@arpae.emr.it
+    gantolini@arpae.emr.it
+*/
+
+#include <math.h>
+#include <vector>
+
+#include "../mathFunctions/commonConstants.h"
+#include "header/types.h"
+#include "header/krylov.h"
+#include "header/domain.h"
+
+/*!
+ * Krylov solvers for the linear systems of soilFluxes3D.
+ * The matrix is stored preconditioned (each row divided by its diagonal, see Tmatrix),
+ * so it has unit diagonal and the Jacobi preconditioning comes for free:
+ * BiCGSTAB works directly on the scaled system (water),
+ * PCG rebuilds the symmetric system weighting the products by the diagonal (heat).
+ * Inactive rows (fixed nodes) keep their value and have zero residual.
+ * The loops are parallel only on large systems, when more than one thread is set (setNumberOfThreads).
+ */
+
+const long MIN_PARALLEL_SIZE = 1024;
+
+static inline bool isParallel(TCrit3DDomain *myDomain, long n)
+{
+    return (myDomain->parameters.nrThreads > 1 && n > MIN_PARALLEL_SIZE);
+}
+
+
+/*!
+ * \brief y = Ax (unit diagonal), only for the active rows
+ */
+void matrixProduct(TCrit3DDomain *myDomain, const Tmatrix &matrix, const char *isActive, const double *x, double *y)
+{
+    long n = matrix.nrRows;
+
+    #pragma omp parallel for if (isParallel(myDomain, n)) num_threads(myDomain->parameters.nrThreads)
+    for (long i = 0; i < n; i++)
+    {
+        if (! isActive[i])
+        {
+            y[i] = 0.;
+            continue;
+        }
+
+        const int *index = matrix.index + i * matrix.nrColumns;
+        const double *val = matrix.val + i * matrix.nrColumns;
+        double sum = x[i];
+        for (int k = 0; k < matrix.nrLinks[i]; k++)
+            sum += val[k] * x[index[k]];
+        y[i] = sum;
+    }
+}
+
+
+/*!
+ * \brief scalar product (weighted by w if w != nullptr)
+ */
+double dotProduct(TCrit3DDomain *myDomain, const double *v1, const double *v2, const double *w, long n)
+{
+    double sum = 0.;
+
+    if (w == nullptr)
+    {
+        #pragma omp parallel for reduction(+:sum) if (isParallel(myDomain, n)) num_threads(myDomain->parameters.nrThreads)
+        for (long i = 0; i < n; i++)
+            sum += v1[i] * v2[i];
+    }
+    else
+    {
+        #pragma omp parallel for reduction(+:sum) if (isParallel(myDomain, n)) num_threads(myDomain->parameters.nrThreads)
+        for (long i = 0; i < n; i++)
+            sum += w[i] * v1[i] * v2[i];
+    }
+
+    return sum;
+}
+
+
+double infinityNorm(TCrit3DDomain *myDomain, const double *v, long n)
+{
+    double norm = 0.;
+
+    #pragma omp parallel for reduction(max:norm) if (isParallel(myDomain, n)) num_threads(myDomain->parameters.nrThreads)
+    for (long i = 0; i < n; i++)
+        if (fabs(v[i]) > norm) norm = fabs(v[i]);
+
+    return norm;
+}
+
+
+/*!
+ * \brief initial residual r = b - Ax on the active rows
+ */
+void computeResidual(TCrit3DDomain *myDomain, const Tmatrix &matrix, const char *isActive, const double *x, const double *knownTerm, double *r)
+{
+    long n = matrix.nrRows;
+    matrixProduct(myDomain, matrix, isActive, x, r);
+
+    #pragma omp parallel for if (isParallel(myDomain, n)) num_threads(myDomain->parameters.nrThreads)
+    for (long i = 0; i < n; i++)
+        r[i] = isActive[i] ? knownTerm[i] - r[i] : 0.;
+}
+
+
+/*!
+ * \brief preconditioned conjugate gradient, symmetric systems (heat)
+ * \return true if converged
+ */
+bool conjugateGradient(TCrit3DDomain *myDomain, const char *isActive, int maxIterationsNr, double residualTolerance,
+                       int *nrIterations, double *residual)
+{
+    const Tmatrix matrix = myDomain->A;
+    const double *weight = myDomain->A.diagonal;
+    double *x = myDomain->X;
+    long n = matrix.nrRows;
+
+    std::vector<double> &workArray = myDomain->krylovWork;
+    workArray.resize(size_t(n) * 3);
+    double *r = workArray.data();
+    double *p = r + n;
+    double *q = p + n;
+
+    /*! r: preconditioned residual (equal to the Jacobi preconditioned z) */
+    computeResidual(myDomain, matrix, isActive, x, myDomain->b, r);
+    for (long i = 0; i < n; i++) p[i] = r[i];
+    double rz = dotProduct(myDomain, r, r, weight, n);
+
+    *nrIterations = 0;
+    *residual = infinityNorm(myDomain, r, n);
+
+    while ((*residual > residualTolerance) && (*nrIterations < maxIterationsNr))
+    {
+        matrixProduct(myDomain, matrix, isActive, p, q);
+        double pq = dotProduct(myDomain, p, q, weight, n);
+        if (pq <= 0.) return false;
+
+        double alpha = rz / pq;
+
+        #pragma omp parallel for if (isParallel(myDomain, n)) num_threads(myDomain->parameters.nrThreads)
+        for (long i = 0; i < n; i++)
+        {
+            x[i] += alpha * p[i];
+            r[i] -= alpha * q[i];
+        }
+
+        double rzNew = dotProduct(myDomain, r, r, weight, n);
+        double beta = rzNew / rz;
+        rz = rzNew;
+
+        #pragma omp parallel for if (isParallel(myDomain, n)) num_threads(myDomain->parameters.nrThreads)
+        for (long i = 0; i < n; i++)
+            p[i] = r[i] + beta * p[i];
+
+        (*nrIterations)++;
+        *residual = infinityNorm(myDomain, r, n);
+    }
+
+    return (*residual <= residualTolerance);
+}
+
+
+/*!
+ * \brief biconjugate gradient stabilized (BiCGSTAB), non-symmetric systems (water)
+ * \return true if converged
+ */
+bool biConjugateGradientStabilized(TCrit3DDomain *myDomain, const char *isActive, int maxIterationsNr, double residualTolerance,
+                                   int *nrIterations, double *residual)
+{
+    const Tmatrix matrix = myDomain->A;
+    double *x = myDomain->X;
+    long n = matrix.nrRows;
+
+    std::vector<double> &workArray = myDomain->krylovWork;
+    workArray.assign(size_t(n) * 6, 0.);
+    double *r = workArray.data();
+    double *r0 = r + n;
+    double *p = r0 + n;
+    double *v = p + n;
+    double *s = v + n;
+    double *t = s + n;
+
+    computeResidual(myDomain, matrix, isActive, x, myDomain->b, r);
+    for (long i = 0; i < n; i++) r0[i] = r[i];
+
+    double rho = 1., alpha = 1., omega = 1.;
+
+    *nrIterations = 0;
+    *residual = infinityNorm(myDomain, r, n);
+
+    while ((*residual > residualTolerance) && (*nrIterations < maxIterationsNr))
+    {
+        double rhoNew = dotProduct(myDomain, r0, r, nullptr, n);
+        if (rhoNew == 0. || omega == 0.) return false;
+
+        double beta = (rhoNew / rho) * (alpha / omega);
+        rho = rhoNew;
+
+        #pragma omp parallel for if (isParallel(myDomain, n)) num_threads(myDomain->parameters.nrThreads)
+        for (long i = 0; i < n; i++)
+            p[i] = r[i] + beta * (p[i] - omega * v[i]);
+
+        matrixProduct(myDomain, matrix, isActive, p, v);
+        double r0v = dotProduct(myDomain, r0, v, nullptr, n);
+        if (r0v == 0.) return false;
+        alpha = rho / r0v;
+
+        #pragma omp parallel for if (isParallel(myDomain, n)) num_threads(myDomain->parameters.nrThreads)
+        for (long i = 0; i < n; i++)
+            s[i] = r[i] - alpha * v[i];
+
+        (*nrIterations)++;
+
+        if (infinityNorm(myDomain, s, n) <= residualTolerance)
+        {
+            #pragma omp parallel for if (isParallel(myDomain, n)) num_threads(myDomain->parameters.nrThreads)
+            for (long i = 0; i < n; i++)
+                x[i] += alpha * p[i];
+
+            *residual = infinityNorm(myDomain, s, n);
+            return true;
+        }
+
+        matrixProduct(myDomain, matrix, isActive, s, t);
+        double tt = dotProduct(myDomain, t, t, nullptr, n);
+        if (tt == 0.) return false;
+        omega = dotProduct(myDomain, t, s, nullptr, n) / tt;
+
+        #pragma omp parallel for if (isParallel(myDomain, n)) num_threads(myDomain->parameters.nrThreads)
+        for (long i = 0; i < n; i++)
+        {
+            x[i] += alpha * p[i] + omega * s[i];
+            r[i] = s[i] - omega * t[i];
+        }
+
+        *residual = infinityNorm(myDomain, r, n);
+    }
+
+    return (*residual <= residualTolerance);
+}
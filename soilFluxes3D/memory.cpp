@@ -28,40 +28,95 @@
 
 #include <stdio.h>
 #include <malloc.h>
+#include <limits.h>
 #include "header/types.h"
+#include "header/memory.h"
+#include "header/domain.h"
 
 
-void cleanArrays()
+void cleanArrays(TCrit3DDomain *myDomain)
 {
     /*! free matrix A */
-    if (A != nullptr)
-    {
-            for (long i=0; i < myStructure.nrNodes; i++)
-                if (A[i] != nullptr) free(A[i]);
-            free(A);
-            A = nullptr;
-    }
+    if (myDomain->A.nrLinks != nullptr) { free(myDomain->A.nrLinks); myDomain->A.nrLinks = nullptr; }
+    if (myDomain->A.index != nullptr) { free(myDomain->A.index); myDomain->A.index = nullptr; }
+    if (myDomain->A.val != nullptr) { free(myDomain->A.val); myDomain->A.val = nullptr; }
+    if (myDomain->A.diagonal != nullptr) { free(myDomain->A.diagonal); myDomain->A.diagonal = nullptr; }
+    myDomain->A.nrRows = 0;
+    myDomain->A.nrColumns = 0;
 
     /*! free arrays */
-    if (b != nullptr){ free(b); b = nullptr; }
-    if (C != nullptr){ free(C); C = nullptr; }
-    if (invariantFlux != nullptr){ free(invariantFlux); invariantFlux = nullptr; }
-    if (X != nullptr) { free(X); X = nullptr; }
+    if (myDomain->b != nullptr){ free(myDomain->b); myDomain->b = nullptr; }
+    if (myDomain->C != nullptr){ free(myDomain->C); myDomain->C = nullptr; }
+    if (myDomain->invariantFlux != nullptr){ free(myDomain->invariantFlux); myDomain->invariantFlux = nullptr; }
+    if (myDomain->X != nullptr) { free(myDomain->X); myDomain->X = nullptr; }
+
+    cleanColoring(myDomain);
     }
 
 
-void cleanNodes()
+/*!
+ * \brief free node coloring (it is rebuilt at the first multicolor relaxation)
+ */
+void cleanColoring(TCrit3DDomain *myDomain)
+{
+    if (myDomain->coloring.firstNode != nullptr) { free(myDomain->coloring.firstNode); myDomain->coloring.firstNode = nullptr; }
+    if (myDomain->coloring.node != nullptr) { free(myDomain->coloring.node); myDomain->coloring.node = nullptr; }
+    myDomain->coloring.nrColors = 0;
+}
+
+
+void cleanNodeState(TCrit3DDomain *myDomain)
+{
+    free(myDomain->nodeState.Se);
+    free(myDomain->nodeState.k);
+    free(myDomain->nodeState.H);
+    free(myDomain->nodeState.oldH);
+    free(myDomain->nodeState.bestH);
+    free(myDomain->nodeState.waterSinkSource);
+    free(myDomain->nodeState.Qw);
+    myDomain->nodeState = TCrit3DnodeState();
+}
+
+
+void cleanNodes(TCrit3DDomain *myDomain)
 {
-    if (myNode != nullptr)
+    if (myDomain->node != nullptr)
     {
-        for (long i = 0; i < myStructure.nrNodes; i++)
+        for (long i = 0; i < myDomain->structure.nrNodes; i++)
         {
-			if (myNode[i].boundary != nullptr) free(myNode[i].boundary);
-			free(myNode[i].lateral);
+			if (myDomain->node[i].boundary != nullptr) free(myDomain->node[i].boundary);
+			free(myDomain->node[i].lateral);
         }
-        free(myNode);
-        myNode = nullptr;
+        free(myDomain->node);
+        myDomain->node = nullptr;
     }
+    cleanNodeState(myDomain);
+}
+
+
+/*!
+ * \brief initialize the water state of the nodes
+ * \return OK/ERROR
+ */
+int initializeNodeState(TCrit3DDomain *myDomain)
+{
+    cleanNodeState(myDomain);
+
+    size_t nrNodes = size_t(myDomain->structure.nrNodes);
+    myDomain->nodeState.Se = (double *) calloc(nrNodes, sizeof(double));
+    myDomain->nodeState.k = (double *) calloc(nrNodes, sizeof(double));
+    myDomain->nodeState.H = (double *) calloc(nrNodes, sizeof(double));
+    myDomain->nodeState.oldH = (double *) calloc(nrNodes, sizeof(double));
+    myDomain->nodeState.bestH = (double *) calloc(nrNodes, sizeof(double));
+    myDomain->nodeState.waterSinkSource = (double *) calloc(nrNodes, sizeof(double));
+    myDomain->nodeState.Qw = (double *) calloc(nrNodes, sizeof(double));
+
+    if (myDomain->nodeState.Se == nullptr || myDomain->nodeState.k == nullptr || myDomain->nodeState.H == nullptr
+        || myDomain->nodeState.oldH == nullptr || myDomain->nodeState.bestH == nullptr
+        || myDomain->nodeState.waterSinkSource == nullptr || myDomain->nodeState.Qw == nullptr)
+        return(MEMORY_ERROR);
+
+    return(CRIT3D_OK);
 }
 
 
@@ -69,41 +124,45 @@ void cleanNodes()
  * \brief initialize matrix and arrays
  * \return OK/ERROR
  */
-int initializeArrays()
+int initializeArrays(TCrit3DDomain *myDomain)
 {
-    long i, j, n;
+    long n;
 
     /*! clean previous arrays */
-    cleanArrays();
+    cleanArrays(myDomain);
+
+    /*! column indices are stored as int */
+    if (myDomain->structure.nrNodes > INT_MAX) return(MEMORY_ERROR);
 
-    /*! matrix solver: rows */
-    A = (TmatrixElement **) calloc(myStructure.nrNodes, sizeof(TmatrixElement *));
+    /*! matrix solver: max nr columns without the diagonal */
+    myDomain->A.nrRows = myDomain->structure.nrNodes;
+    myDomain->A.nrColumns = myDomain->structure.maxNrColumns - 1;
+    size_t nrElements = size_t(myDomain->A.nrRows) * size_t(myDomain->A.nrColumns);
 
-    /*! matrix solver: columns */
-    for (i = 0; i < myStructure.nrNodes; i++)
-            A[i] = (TmatrixElement *) calloc(myStructure.maxNrColumns, sizeof(TmatrixElement));
+    myDomain->A.nrLinks = (int *) calloc(size_t(myDomain->A.nrRows), sizeof(int));
+    myDomain->A.diagonal = (double *) calloc(size_t(myDomain->A.nrRows), sizeof(double));
+    myDomain->A.index = (int *) calloc(nrElements, sizeof(int));
+    myDomain->A.val = (double *) calloc(nrElements, sizeof(double));
+
+    if (myDomain->A.nrLinks == nullptr || myDomain->A.diagonal == nullptr || myDomain->A.index == nullptr || myDomain->A.val == nullptr)
+        return(MEMORY_ERROR);
 
     /*! initialize matrix solver */
-    for (i = 0; i < myStructure.nrNodes; i++)
-        for (j = 0; j < (myStructure.nrLateralLinks + 2); j++)
-        {
-            A[i][j].index   = NOLINK;
-            A[i][j].val     = 0.;
-        }
+    for (size_t k = 0; k < nrElements; k++)
+        myDomain->A.index[k] = NOLINK;
 
-    b = (double *) calloc(myStructure.nrNodes, sizeof(double));
-    for (n = 0; n < myStructure.nrNodes; n++) b[n] = 0.;
+    myDomain->b = (double *) calloc(myDomain->structure.nrNodes, sizeof(double));
+    for (n = 0; n < myDomain->structure.nrNodes; n++) myDomain->b[n] = 0.;
 
-    X = (double *) calloc(myStructure.nrNodes, sizeof(double));
+    myDomain->X = (double *) calloc(myDomain->structure.nrNodes, sizeof(double));
 
     /*! mass diagonal matrix */
-    C = (double *) calloc(myStructure.nrNodes, sizeof(double));
-    for (n = 0; n < myStructure.nrNodes; n++) C[n] = 0.;
+    myDomain->C = (double *) calloc(myDomain->structure.nrNodes, sizeof(double));
+    for (n = 0; n < myDomain->structure.nrNodes; n++) myDomain->C[n] = 0.;
 
     /*! mass diagonal matrix */
-    invariantFlux = (double *) calloc(myStructure.nrNodes, sizeof(double));
-    for (n = 0; n < myStructure.nrNodes; n++) invariantFlux[n] = 0.;
+    myDomain->invariantFlux = (double *) calloc(myDomain->structure.nrNodes, sizeof(double));
+    for (n = 0; n < myDomain->structure.nrNodes; n++) myDomain->invariantFlux[n] = 0.;
 
-    if (A == nullptr) return(MEMORY_ERROR);
-    else return(CRIT3D_OK);
+    return(CRIT3D_OK);
 }
@@ -28,10 +28,13 @@
 #include <stdio.h>
 #include <math.h>
 #include <malloc.h>
+#include <string.h>
 
 #include "../mathFunctions/physics.h"
 #include "header/types.h"
 #include "header/memory.h"
+#include "header/hydraulicTable.h"
+#include "header/state.h"
 #include "header/soilPhysics.h"
 #include "header/soilFluxes3D.h"
 #include "header/solver.h"
@@ -40,24 +43,71 @@
 #include "header/boundary.h"
 #include "header/heat.h"
 #include "header/extra.h"
+#include "header/domain.h"
 
-/*! global variables */
+/*! node and link setters shared by the single and the bulk API (no error check) */
 
-TParameters myParameters;
-TCrit3DStructure myStructure;
+static void initializeNode(TCrit3DDomain *myDomain, long i, float x, float y, float z, double volume_or_area, bool isSurface,
+                           bool isBoundary, int boundaryType, float slope)
+{
+    if (isBoundary)
+    {
+        myDomain->node[i].boundary = new(Tboundary);
+        initializeBoundary(myDomain, myDomain->node[i].boundary, boundaryType, slope);
+    }
+
+    if ((myDomain->structure.computeHeat || myDomain->structure.computeSolutes) && ! isSurface)
+    {
+        myDomain->node[i].extra = new(TCrit3DnodeExtra);
+        initializeExtra(myDomain->node[i].extra, myDomain->structure.computeHeat, myDomain->structure.computeSolutes);
+    }
+
+    myDomain->node[i].x = x;
+    myDomain->node[i].y = y;
+    myDomain->node[i].z = z;
+    myDomain->node[i].volume_area = volume_or_area;   /*!< area on surface elements, volume on sub-surface */
+
+    myDomain->node[i].isSurface = isSurface;
+
+    myDomain->nodeState.waterSinkSource[i] = 0.;
+}
 
-Tculvert myCulvert;
 
-TCrit3Dnode *myNode = nullptr;
-TmatrixElement **A = nullptr;
+static int nrFreeLateralLinks(TCrit3DDomain *myDomain, long n)
+{
+    int nrFree = 0;
+    for (short j = 0; j < myDomain->structure.nrLateralLinks; j++)
+        if (myDomain->node[n].lateral[j].index == NOLINK) nrFree++;
 
-double *invariantFlux = nullptr;
-double *C = nullptr;
-double *X = nullptr;
-double *b = nullptr;
+    return nrFree;
+}
 
-static Tsoil Soil_List[MAX_SOILS][MAX_HORIZONS];
-static Tsoil Surface_List[MAX_SURFACES];
+
+static void addNodeLink(TCrit3DDomain *myDomain, long n, long linkIndex, short direction, float interfaceArea)
+{
+    TlinkedNode *link;
+
+    if (direction == UP)
+        link = &(myDomain->node[n].up);
+    else if (direction == DOWN)
+        link = &(myDomain->node[n].down);
+    else
+    {
+        short j = 0;
+        while (myDomain->node[n].lateral[j].index != NOLINK) j++;
+        link = &(myDomain->node[n].lateral[j]);
+    }
+
+    link->index = linkIndex;
+    link->area = interfaceArea;
+    link->sumFlow = 0;
+
+    if (myDomain->structure.computeHeat || myDomain->structure.computeSolutes)
+    {
+        link->linkedExtra = new(TCrit3DLinkedNodeExtra);
+        initializeLinkExtra(myDomain, link->linkedExtra, myDomain->structure.computeHeat, myDomain->structure.computeSolutes);
+    }
+}
 
 
 namespace soilFluxes3D {
@@ -69,108 +119,214 @@ namespace soilFluxes3D {
 
 	void DLL_EXPORT __STDCALL cleanMemory()
 	{
-        cleanNodes();
-        cleanArrays();
+        TCrit3DDomain *myDomain = getCurrentDomain();
+
+        cleanNodes(myDomain);
+        cleanArrays(myDomain);
         //clean balance
 	}
 
+    /*!
+     * \brief create a new empty domain
+     * the API calls work on the domain selected on the calling thread (selectDomain),
+     * independent domains can be computed in parallel on different threads
+     * \return domain pointer
+     */
+    TCrit3DDomain* DLL_EXPORT __STDCALL createDomain()
+    {
+        return new TCrit3DDomain();
+    }
+
+    /*!
+     * \brief select the domain of the calling thread
+     * threads without a selected domain share the default domain of the process
+     * \param myDomain (nullptr: default domain)
+     * \return OK/ERROR
+     */
+    int DLL_EXPORT __STDCALL selectDomain(TCrit3DDomain* myDomain)
+    {
+        setCurrentDomain(myDomain);
+        return(CRIT3D_OK);
+    }
+
+    /*!
+     * \brief free the memory of a domain created with createDomain
+     * \param myDomain
+     */
+    void DLL_EXPORT __STDCALL deleteDomain(TCrit3DDomain* myDomain)
+    {
+        if ((myDomain == nullptr) || (myDomain == getDefaultDomain())) return;
+
+        cleanNodes(myDomain);
+        cleanArrays(myDomain);
+
+        if (getCurrentDomain() == myDomain)
+            setCurrentDomain(nullptr);
+
+        delete myDomain;
+    }
+
     void DLL_EXPORT __STDCALL initializeHeat(short myType, bool computeAdvectiveHeat, bool computeLatentHeat)
 {
-    myStructure.saveHeatFluxesType = myType;
-    myStructure.computeHeatAdvection = computeAdvectiveHeat;
-    myStructure.computeHeatVapor = computeLatentHeat;
+    TCrit3DDomain *myDomain = getCurrentDomain();
+
+    myDomain->structure.saveHeatFluxesType = myType;
+    myDomain->structure.computeHeatAdvection = computeAdvectiveHeat;
+    myDomain->structure.computeHeatVapor = computeLatentHeat;
 }
 
     int DLL_EXPORT __STDCALL initialize(long nrNodes, int nrLayers, int nrLateralLinks,
                                         bool computeWater_, bool computeHeat_, bool computeSolutes_)
 {
+    TCrit3DDomain *myDomain = getCurrentDomain();
+
     /*! clean the old data structures */
     cleanMemory();
 
-    myParameters.initialize();
-    myStructure.initialize();   
+    myDomain->parameters.initialize();
+    myDomain->structure.initialize();   
 
-    myStructure.computeWater = computeWater_;
-    myStructure.computeHeat = computeHeat_;
+    myDomain->structure.computeWater = computeWater_;
+    myDomain->structure.computeHeat = computeHeat_;
     if (computeHeat_)
     {
-        myStructure.computeHeatVapor = true;
-        myStructure.computeHeatAdvection = true;
+        myDomain->structure.computeHeatVapor = true;
+        myDomain->structure.computeHeatAdvection = true;
     }
-    myStructure.computeSolutes = computeSolutes_;
+    myDomain->structure.computeSolutes = computeSolutes_;
 
-    myStructure.nrNodes = nrNodes;
-    myStructure.nrLayers = nrLayers;
-    myStructure.nrLateralLinks = nrLateralLinks;
+    myDomain->structure.nrNodes = nrNodes;
+    myDomain->structure.nrLayers = nrLayers;
+    myDomain->structure.nrLateralLinks = nrLateralLinks;
     /*! max nr columns = nr. of lateral links + 2 columns for up and down link + 1 column for diagonal */
-    myStructure.maxNrColumns = nrLateralLinks + 2 + 1;
+    myDomain->structure.maxNrColumns = nrLateralLinks + 2 + 1;
 
     /*! build the nodes vector */
-    myNode = (TCrit3Dnode *) calloc(myStructure.nrNodes, sizeof(TCrit3Dnode));
-	for (long i = 0; i < myStructure.nrNodes; i++)
+    myDomain->node = (TCrit3Dnode *) calloc(myDomain->structure.nrNodes, sizeof(TCrit3Dnode));
+    if (myDomain->node == nullptr || initializeNodeState(myDomain) != CRIT3D_OK)
+        {return(MEMORY_ERROR);}
+
+	for (long i = 0; i < myDomain->structure.nrNodes; i++)
 	{
-		myNode[i].Soil = nullptr;
-		myNode[i].boundary = nullptr;
-		myNode[i].up.index = NOLINK;
-		myNode[i].down.index = myNode[i].up.index = NOLINK;
+		myDomain->node[i].Soil = nullptr;
+		myDomain->node[i].boundary = nullptr;
+		myDomain->node[i].up.index = NOLINK;
+		myDomain->node[i].down.index = myDomain->node[i].up.index = NOLINK;
 
-        myNode[i].lateral = (TlinkedNode *) calloc(myStructure.nrLateralLinks, sizeof(TlinkedNode));
-        for (short l = 0; l < myStructure.nrLateralLinks; l++)
+        myDomain->node[i].lateral = (TlinkedNode *) calloc(myDomain->structure.nrLateralLinks, sizeof(TlinkedNode));
+        for (short l = 0; l < myDomain->structure.nrLateralLinks; l++)
         {
-            myNode[i].lateral[l].index = NOLINK;
-            if (myStructure.computeHeat || myStructure.computeSolutes)
-                myNode[i].lateral[l].linkedExtra = new(TCrit3DLinkedNodeExtra);
+            myDomain->node[i].lateral[l].index = NOLINK;
+            if (myDomain->structure.computeHeat || myDomain->structure.computeSolutes)
+                myDomain->node[i].lateral[l].linkedExtra = new(TCrit3DLinkedNodeExtra);
         }
     }
 
     /*! build the matrix */
-    if (myNode == nullptr)
-        {return(MEMORY_ERROR);}
-    else
-		{return(initializeArrays());}
+    return(initializeArrays(myDomain));
  }
 
 	int DLL_EXPORT __STDCALL setNumericalParameters(float minDeltaT, float maxDeltaT, int maxIterationNumber,
                         int maxApproximationsNumber, int ResidualTolerance, float MBRThreshold)
  {
+     TCrit3DDomain *myDomain = getCurrentDomain();
+
      /*!
         \brief Set numerical solution parameters
      */
 
         if (minDeltaT < 0.1f) minDeltaT = 0.1f;
         if (minDeltaT > 3600) minDeltaT = 3600;
-        myParameters.delta_t_min = double(minDeltaT);
+        myDomain->parameters.delta_t_min = double(minDeltaT);
 
         if (maxDeltaT < 60) maxDeltaT = 60;
         if (maxDeltaT > 3600) maxDeltaT = 3600;
         if (maxDeltaT < minDeltaT) maxDeltaT = minDeltaT;
-        myParameters.delta_t_max = double(maxDeltaT);
+        myDomain->parameters.delta_t_max = double(maxDeltaT);
 
-        myParameters.current_delta_t = myParameters.delta_t_max;
+        myDomain->parameters.current_delta_t = myDomain->parameters.delta_t_max;
 
         if (maxIterationNumber < 10) maxIterationNumber = 10;
         if (maxIterationNumber > MAX_NUMBER_ITERATIONS) maxIterationNumber = MAX_NUMBER_ITERATIONS;
-        myParameters.iterazioni_max = maxIterationNumber;
+        myDomain->parameters.iterazioni_max = maxIterationNumber;
 
         if (maxApproximationsNumber < 1) maxApproximationsNumber = 1;
 
 		if (maxApproximationsNumber > MAX_NUMBER_APPROXIMATIONS)
 				maxApproximationsNumber = MAX_NUMBER_APPROXIMATIONS;
 
-        myParameters.maxApproximationsNumber = maxApproximationsNumber;
+        myDomain->parameters.maxApproximationsNumber = maxApproximationsNumber;
 
         if (ResidualTolerance < 4) ResidualTolerance = 4;
         if (ResidualTolerance > 16) ResidualTolerance = 16;
-        myParameters.ResidualTolerance = pow(double(10.), -ResidualTolerance);
+        myDomain->parameters.ResidualTolerance = pow(double(10.), -ResidualTolerance);
 
         if (MBRThreshold < 1) MBRThreshold = 1;
         if (MBRThreshold > 6) MBRThreshold = 6;
-        myParameters.MBRThreshold = pow(double(10.), double(-MBRThreshold));
+        myDomain->parameters.MBRThreshold = pow(double(10.), double(-MBRThreshold));
 
         return(CRIT3D_OK);
  }
 
 
+    /*!
+     * \brief Set the solver of the linear systems (default: RELAXATION)
+     * \param numericalSolutionMethod
+     * RELAXATION              Gauss-Seidel with alternating sweeps
+     * RELAXATION_MULTICOLOR   parallel multicolor Gauss-Seidel (OpenMP)
+     * CONJUGATE_GRADIENT      Krylov solvers: PCG (heat) and BiCGSTAB (water), Jacobi preconditioning
+     * \return OK/ERROR
+     */
+    int DLL_EXPORT __STDCALL setNumericalSolutionMethod(int numericalSolutionMethod)
+ {
+    TCrit3DDomain *myDomain = getCurrentDomain();
+
+    if ((numericalSolutionMethod != RELAXATION) && (numericalSolutionMethod != RELAXATION_MULTICOLOR)
+        && (numericalSolutionMethod != CONJUGATE_GRADIENT))
+        return(PARAMETER_ERROR);
+
+    myDomain->parameters.numericalSolutionMethod = numericalSolutionMethod;
+    return(CRIT3D_OK);
+ }
+
+
+    /*!
+     * \brief Set the time step control (default: halving / doubling)
+     * \param isEnabled true: PI controller, the next time step is predicted from the
+     * mass balance error of the last steps, the Courant number and the approximations used;
+     * rejected steps are reduced by the predicted factor instead of halved.
+     * It rejects fewer steps but keeps a shorter mean step, so it is not faster in general
+     * (see timeStepControl in TestSoilFluxes3D): it is off by default
+     * \return OK
+     */
+    int DLL_EXPORT __STDCALL setAdaptiveTimeStep(bool isEnabled)
+ {
+    TCrit3DDomain *myDomain = getCurrentDomain();
+
+    myDomain->parameters.isAdaptiveTimeStep = isEnabled;
+    return(CRIT3D_OK);
+ }
+
+
+    /*!
+     * \brief Set the number of OpenMP threads of the solver (default: 1)
+     * the matrix assembly and the Krylov / multicolor loops are parallel only
+     * with more than one thread and on large domains; with one thread they run serially
+     * (no parallel region and no copy of the solver state)
+     * \param nrThreads [-] >= 1
+     * \return OK/ERROR
+     */
+    int DLL_EXPORT __STDCALL setNumberOfThreads(int nrThreads)
+ {
+    TCrit3DDomain *myDomain = getCurrentDomain();
+
+    if (nrThreads < 1) return(PARAMETER_ERROR);
+
+    myDomain->parameters.nrThreads = nrThreads;
+    return(CRIT3D_OK);
+ }
+
+
     /*!
      * \brief Set hydraulic properties
      *  default values:
@@ -186,23 +342,84 @@ namespace soilFluxes3D {
 	int DLL_EXPORT __STDCALL setHydraulicProperties(int waterRetentionCurve,
                         int conductivityMeanType, float horizVertRatioConductivity)
  {
+    TCrit3DDomain *myDomain = getCurrentDomain();
 
-	myParameters.waterRetentionCurve = waterRetentionCurve;
+    /*! the tables depend on the water retention curve */
+    if (waterRetentionCurve != myDomain->parameters.waterRetentionCurve)
+    {
+        myDomain->parameters.waterRetentionCurve = waterRetentionCurve;
+        for (Tsoil &mySoil : myDomain->soilList)
+            if (mySoil.table != nullptr)
+                buildHydraulicTable(myDomain, &mySoil);
+    }
 
-    myParameters.meanType = conductivityMeanType;
+    myDomain->parameters.meanType = conductivityMeanType;
 
 	if  ((horizVertRatioConductivity >= 1) && (horizVertRatioConductivity <= 100))
     {
-        myParameters.k_lateral_vertical_ratio = horizVertRatioConductivity;
+        myDomain->parameters.k_lateral_vertical_ratio = horizVertRatioConductivity;
         return(CRIT3D_OK);
     }
 	else
 	{
-	    myParameters.k_lateral_vertical_ratio = 10.;
+	    myDomain->parameters.k_lateral_vertical_ratio = 10.;
 	    return(PARAMETER_ERROR);
 	}
  }
 
+
+    /*!
+     * \brief Set the use of tabulated hydraulic functions (default: analytic)
+     * the tables are built only in table mode: here for the soil horizons already set,
+     * then in setSoilProperties. They are released when the mode is disabled
+     * \param isEnabled false: analytic Van Genuchten - Mualem functions
+     * \return OK
+     */
+    int DLL_EXPORT __STDCALL setHydraulicTables(bool isEnabled)
+ {
+    TCrit3DDomain *myDomain = getCurrentDomain();
+
+    myDomain->parameters.useHydraulicTables = isEnabled;
+
+    for (Tsoil &mySoil : myDomain->soilList)
+    {
+        if (isEnabled && mySoil.VG_alpha > 0.)
+            buildHydraulicTable(myDomain, &mySoil);
+        else
+            mySoil.table.reset();
+    }
+
+    return(CRIT3D_OK);
+ }
+
+
+    /*!
+     * \brief accuracy of the tabulated hydraulic functions of a soil horizon
+     * (max errors against the analytic forms, checked inside each interval of the table)
+     * \param nrSoil
+     * \param nrHorizon
+     * \param maxErrorSe [-] absolute error of the degree of saturation
+     * \param maxErrorK [-] relative error of the hydraulic conductivity
+     * \param maxErrorC [-] relative error of dSe/dPsi
+     * \return OK/ERROR
+     */
+    int DLL_EXPORT __STDCALL getHydraulicTableAccuracy(int nrSoil, int nrHorizon, double *maxErrorSe,
+                                                      double *maxErrorK, double *maxErrorC)
+ {
+    TCrit3DDomain *myDomain = getCurrentDomain();
+
+    if ((nrSoil < 0) || (nrSoil >= MAX_SOILS)) return(INDEX_ERROR);
+    if ((nrHorizon < 0) || (nrHorizon >= MAX_HORIZONS)) return(INDEX_ERROR);
+
+    const ThydraulicTable *table = myDomain->soilList[unsigned(nrSoil * MAX_HORIZONS + nrHorizon)].table.get();
+    if (table == nullptr || table->nrIntervals == 0) return(PARAMETER_ERROR);
+
+    *maxErrorSe = table->maxErrorSe;
+    *maxErrorK = table->maxErrorK;
+    *maxErrorC = table->maxErrorC;
+    return(CRIT3D_OK);
+ }
+
     /*!
      * \brief Set node position and properties
      * \param myIndex
@@ -219,109 +436,148 @@ namespace soilFluxes3D {
 	int DLL_EXPORT __STDCALL setNode(long myIndex, float x, float y, float z, double volume_or_area, bool isSurface,
                         bool isBoundary, int boundaryType, float slope)
  {
+    TCrit3DDomain *myDomain = getCurrentDomain();
 
+    if (myDomain->node == nullptr) return(MEMORY_ERROR);
+    if ((myIndex < 0) || (myIndex >= myDomain->structure.nrNodes)) return(INDEX_ERROR);
 
-    if (myNode == nullptr) return(MEMORY_ERROR);
-    if ((myIndex < 0) || (myIndex >= myStructure.nrNodes)) return(INDEX_ERROR);
+    initializeNode(myDomain, myIndex, x, y, z, volume_or_area, isSurface, isBoundary, boundaryType, slope);
 
-	if (isBoundary)
-	{
-		myNode[myIndex].boundary = new(Tboundary);
-		initializeBoundary(myNode[myIndex].boundary, boundaryType, slope);
-	}
+    return(CRIT3D_OK);
+ }
 
-    if ((myStructure.computeHeat || myStructure.computeSolutes) && ! isSurface)
-    {
-        myNode[myIndex].extra = new(TCrit3DnodeExtra);
-        initializeExtra(myNode[myIndex].extra, myStructure.computeHeat, myStructure.computeSolutes);
-    }
 
-    myNode[myIndex].x = x;
-    myNode[myIndex].y = y;
-    myNode[myIndex].z = z;
-    myNode[myIndex].volume_area = volume_or_area;   /*!< area on surface elements, volume on sub-surface */
+ int DLL_EXPORT __STDCALL setNodeLink(long n, long linkIndex, short direction, float interfaceArea)
+ {
+    TCrit3DDomain *myDomain = getCurrentDomain();
+
+    /*! error check */
+    if (myDomain->node == nullptr) return(MEMORY_ERROR);
+
+    if ((n < 0) || (n >= myDomain->structure.nrNodes) || (linkIndex < 0) || (linkIndex >= myDomain->structure.nrNodes))
+        return(INDEX_ERROR);
+
+    if (direction != UP && direction != DOWN && direction != LATERAL)
+        return(PARAMETER_ERROR);
+
+    if (direction == LATERAL && nrFreeLateralLinks(myDomain, n) == 0)
+        return(TOPOGRAPHY_ERROR);
+
+    /*! topology changed: node coloring must be rebuilt */
+    cleanColoring(myDomain);
+
+    addNodeLink(myDomain, n, linkIndex, direction, interfaceArea);
 
-	myNode[myIndex].isSurface = isSurface;
+	return(CRIT3D_OK);
+ }
 
-    myNode[myIndex].waterSinkSource = 0.;
+
+    /*!
+     * \brief Set position and properties of a contiguous range of nodes
+     * \param firstIndex   index of the first node
+     * \param nrNodes      number of nodes
+     * \param x, y, z      [m] coordinates (nrNodes values)
+     * \param volume_or_area [m^2] area on surface nodes, [m^3] volume on sub-surface
+     * \param isSurface
+     * \param isBoundary   may be nullptr: no boundary nodes
+     * \param boundaryType read only where isBoundary is true
+     * \param slope        read only where isBoundary is true, may be nullptr
+     * \return OK/ERROR (no node is modified on error)
+     */
+    int DLL_EXPORT __STDCALL setNodes(long firstIndex, long nrNodes, const float *x, const float *y,
+                        const float *z, const double *volume_or_area, const bool *isSurface,
+                        const bool *isBoundary, const int *boundaryType, const float *slope)
+ {
+    TCrit3DDomain *myDomain = getCurrentDomain();
+
+    if (myDomain->node == nullptr) return(MEMORY_ERROR);
+    if ((firstIndex < 0) || (nrNodes < 0) || (firstIndex + nrNodes > myDomain->structure.nrNodes))
+        return(INDEX_ERROR);
+    if (x == nullptr || y == nullptr || z == nullptr || volume_or_area == nullptr || isSurface == nullptr)
+        return(PARAMETER_ERROR);
+    if (isBoundary != nullptr && boundaryType == nullptr)
+        return(PARAMETER_ERROR);
+
+    for (long k = 0; k < nrNodes; k++)
+    {
+        bool isNodeBoundary = (isBoundary != nullptr && isBoundary[k]);
+        initializeNode(myDomain, firstIndex + k, x[k], y[k], z[k], volume_or_area[k], isSurface[k], isNodeBoundary,
+                       isNodeBoundary ? boundaryType[k] : BOUNDARY_NONE,
+                       (isNodeBoundary && slope != nullptr) ? slope[k] : 0.f);
+    }
 
     return(CRIT3D_OK);
  }
 
 
- int DLL_EXPORT __STDCALL setNodeLink(long n, long linkIndex, short direction, float interfaceArea)
+    /*!
+     * \brief Set the links of a contiguous range of nodes in compressed sparse row format
+     * \param firstIndex   index of the first node
+     * \param nrNodes      number of nodes
+     * \param firstLink    nrNodes+1 offsets: links of node firstIndex+k are [firstLink[k], firstLink[k+1])
+     * \param linkIndex    linked node
+     * \param direction    UP, DOWN or LATERAL
+     * \param interfaceArea [m^2]
+     * \return OK/ERROR (all links are checked before any node is modified)
+     */
+    int DLL_EXPORT __STDCALL setLinksCSR(long firstIndex, long nrNodes, const long *firstLink,
+                        const long *linkIndex, const short *direction, const float *interfaceArea)
  {
-    /*! error check */
-    if (myNode == nullptr) return(MEMORY_ERROR);
+    TCrit3DDomain *myDomain = getCurrentDomain();
 
-    if ((n < 0) || (n >= myStructure.nrNodes) || (linkIndex < 0) || (linkIndex >= myStructure.nrNodes))
+    if (myDomain->node == nullptr) return(MEMORY_ERROR);
+    if ((firstIndex < 0) || (nrNodes < 0) || (firstIndex + nrNodes > myDomain->structure.nrNodes))
         return(INDEX_ERROR);
+    if (firstLink == nullptr || linkIndex == nullptr || direction == nullptr || interfaceArea == nullptr)
+        return(PARAMETER_ERROR);
 
-    short j;
-    switch (direction)
+    for (long k = 0; k < nrNodes; k++)
     {
-        case UP :
-                    myNode[n].up.index = linkIndex;
-                    myNode[n].up.area = interfaceArea;
-                    myNode[n].up.sumFlow = 0;
-
-                    if (myStructure.computeHeat || myStructure.computeSolutes)
-                    {
-                        myNode[n].up.linkedExtra = new(TCrit3DLinkedNodeExtra);
-                        initializeLinkExtra(myNode[n].up.linkedExtra, myStructure.computeHeat, myStructure.computeSolutes);
-                    }
-
-                    break;
-        case DOWN :
-                    myNode[n].down.index = linkIndex;
-                    myNode[n].down.area = interfaceArea;
-					myNode[n].down.sumFlow = 0;
-
-                    if (myStructure.computeHeat || myStructure.computeSolutes)
-                    {
-                        myNode[n].down.linkedExtra = new(TCrit3DLinkedNodeExtra);
-                        initializeLinkExtra(myNode[n].down.linkedExtra, myStructure.computeHeat, myStructure.computeSolutes);
-                    }
-
-                    break;
-        case LATERAL :
-                    j = 0;
-                    while ((j < myStructure.nrLateralLinks) && (myNode[n].lateral[j].index != NOLINK)) j++;
-                    if (j == myStructure.nrLateralLinks) return (TOPOGRAPHY_ERROR);
-                    myNode[n].lateral[j].index = linkIndex;
-                    myNode[n].lateral[j].area = interfaceArea;
-					myNode[n].lateral[j].sumFlow = 0;
-
-                    if (myStructure.computeHeat || myStructure.computeSolutes)
-                    {
-                        myNode[n].lateral[j].linkedExtra = new(TCrit3DLinkedNodeExtra);
-                        initializeLinkExtra(myNode[n].lateral[j].linkedExtra, myStructure.computeHeat, myStructure.computeSolutes);
-                    }
-
-                    break;
-        default :
-                    return(PARAMETER_ERROR);
+        if (firstLink[k] < 0 || firstLink[k+1] < firstLink[k]) return(PARAMETER_ERROR);
+
+        int nrLateral = 0;
+        for (long l = firstLink[k]; l < firstLink[k+1]; l++)
+        {
+            if ((linkIndex[l] < 0) || (linkIndex[l] >= myDomain->structure.nrNodes)) return(INDEX_ERROR);
+            if (direction[l] == LATERAL)
+                nrLateral++;
+            else if (direction[l] != UP && direction[l] != DOWN)
+                return(PARAMETER_ERROR);
+        }
+
+        if (nrLateral > 0 && nrLateral > nrFreeLateralLinks(myDomain, firstIndex + k))
+            return(TOPOGRAPHY_ERROR);
     }
-	return(CRIT3D_OK);
+
+    /*! topology changed: node coloring must be rebuilt */
+    cleanColoring(myDomain);
+
+    for (long k = 0; k < nrNodes; k++)
+        for (long l = firstLink[k]; l < firstLink[k+1]; l++)
+            addNodeLink(myDomain, firstIndex + k, linkIndex[l], direction[l], interfaceArea[l]);
+
+    return(CRIT3D_OK);
  }
 
 
  int DLL_EXPORT __STDCALL setCulvert(long nodeIndex, double roughness, double slope, double width, double height)
  {
-	 if ((nodeIndex < 0) || (!myNode[nodeIndex].isSurface))
+	 TCrit3DDomain *myDomain = getCurrentDomain();
+
+	 if ((nodeIndex < 0) || (!myDomain->node[nodeIndex].isSurface))
 	 {
-		 myCulvert.index = NOLINK;
+		 myDomain->culvert.index = NOLINK;
 		 return(INDEX_ERROR);
 	 }
 
-	 myCulvert.index = nodeIndex;
-	 myCulvert.roughness = roughness;			// [s m^-1/3]
-	 myCulvert.slope = slope;					// [-]
-	 myCulvert.width = width;					// [m]
-	 myCulvert.height = height;					// [m]
+	 myDomain->culvert.index = nodeIndex;
+	 myDomain->culvert.roughness = roughness;			// [s m^-1/3]
+	 myDomain->culvert.slope = slope;					// [-]
+	 myDomain->culvert.width = width;					// [m]
+	 myDomain->culvert.height = height;					// [m]
 
-	myNode[nodeIndex].boundary = new(Tboundary);
-	initializeBoundary(myNode[nodeIndex].boundary, BOUNDARY_CULVERT, float(slope));
+	myDomain->node[nodeIndex].boundary = new(Tboundary);
+	initializeBoundary(myDomain, myDomain->node[nodeIndex].boundary, BOUNDARY_CULVERT, float(slope));
 
 	 return(CRIT3D_OK);
  }
@@ -335,11 +591,13 @@ namespace soilFluxes3D {
      */
  int DLL_EXPORT __STDCALL setNodeSurface(long nodeIndex, int surfaceIndex)
  {
-	if (myNode == nullptr) return(MEMORY_ERROR);
-    if ((nodeIndex < 0) || (! myNode[nodeIndex].isSurface)) return(INDEX_ERROR);
+	TCrit3DDomain *myDomain = getCurrentDomain();
+
+	if (myDomain->node == nullptr) return(MEMORY_ERROR);
+    if ((nodeIndex < 0) || (! myDomain->node[nodeIndex].isSurface)) return(INDEX_ERROR);
     if ((surfaceIndex < 0) || (surfaceIndex >= MAX_SURFACES)) return(PARAMETER_ERROR);
 
-    myNode[nodeIndex].Soil = &Surface_List[surfaceIndex];
+    myDomain->node[nodeIndex].Soil = &(myDomain->surfaceList[unsigned(surfaceIndex)]);
 
     return(CRIT3D_OK);
  }
@@ -354,12 +612,14 @@ namespace soilFluxes3D {
      */
  int DLL_EXPORT __STDCALL setNodeSoil(long nodeIndex, int soilIndex, int horizonIndex)
  {
-	if (myNode == nullptr) return(MEMORY_ERROR);
-    if ((nodeIndex < 0) || (nodeIndex >= myStructure.nrNodes)) return(INDEX_ERROR);
+	TCrit3DDomain *myDomain = getCurrentDomain();
+
+	if (myDomain->node == nullptr) return(MEMORY_ERROR);
+    if ((nodeIndex < 0) || (nodeIndex >= myDomain->structure.nrNodes)) return(INDEX_ERROR);
     if ((soilIndex < 0) || (soilIndex >= MAX_SOILS)) return(PARAMETER_ERROR);
     if ((horizonIndex < 0) || (horizonIndex >= MAX_HORIZONS)) return(PARAMETER_ERROR);
 
-    myNode[nodeIndex].Soil = &Soil_List[soilIndex][horizonIndex];
+    myDomain->node[nodeIndex].Soil = &(myDomain->soilList[unsigned(soilIndex * MAX_HORIZONS + horizonIndex)]);
 
     return(CRIT3D_OK);
  }
@@ -382,6 +642,7 @@ namespace soilFluxes3D {
     int DLL_EXPORT __STDCALL setSoilProperties(int nSoil, int nHorizon, double VG_alpha, double VG_n, double VG_m,
                         double VG_he, double ThetaR, double ThetaS, double Ksat, double L, double organicMatter, double clay)
  {
+	TCrit3DDomain *myDomain = getCurrentDomain();
 
 	if ((nSoil < 0) || (nSoil >= MAX_SOILS)) return(INDEX_ERROR);
 
@@ -391,20 +652,27 @@ namespace soilFluxes3D {
     || (ThetaS <= 0.) || (ThetaS > 1.) || (ThetaR > ThetaS))
         return(PARAMETER_ERROR);
 
-    Soil_List[nSoil][nHorizon].VG_alpha  = VG_alpha;
-    Soil_List[nSoil][nHorizon].VG_n  = VG_n;
-	Soil_List[nSoil][nHorizon].VG_m =  VG_m;
+    Tsoil *mySoil = &(myDomain->soilList[unsigned(nSoil * MAX_HORIZONS + nHorizon)]);
 
-    Soil_List[nSoil][nHorizon].VG_he = VG_he;
-    Soil_List[nSoil][nHorizon].VG_Sc = pow(1. + pow(VG_alpha * VG_he, VG_n), -VG_m);
+    mySoil->VG_alpha  = VG_alpha;
+    mySoil->VG_n  = VG_n;
+	mySoil->VG_m =  VG_m;
 
-    Soil_List[nSoil][nHorizon].Theta_r = ThetaR;
-    Soil_List[nSoil][nHorizon].Theta_s = ThetaS;
-    Soil_List[nSoil][nHorizon].K_sat = Ksat;
-    Soil_List[nSoil][nHorizon].Mualem_L = L;
+    mySoil->VG_he = VG_he;
+    mySoil->VG_Sc = pow(1. + pow(VG_alpha * VG_he, VG_n), -VG_m);
 
-    Soil_List[nSoil][nHorizon].organicMatter = organicMatter;
-    Soil_List[nSoil][nHorizon].clay = clay;
+    mySoil->Theta_r = ThetaR;
+    mySoil->Theta_s = ThetaS;
+    mySoil->K_sat = Ksat;
+    mySoil->Mualem_L = L;
+
+    mySoil->organicMatter = organicMatter;
+    mySoil->clay = clay;
+
+    if (myDomain->parameters.useHydraulicTables)
+        buildHydraulicTable(myDomain, mySoil);
+    else
+        mySoil->table.reset();
 
     return(CRIT3D_OK);
  }
@@ -412,11 +680,14 @@ namespace soilFluxes3D {
 
 	int DLL_EXPORT __STDCALL setSurfaceProperties(int surfaceIndex, double roughness, double surfacePond)
  {
+    TCrit3DDomain *myDomain = getCurrentDomain();
+
     if ((surfaceIndex < 0) || (surfaceIndex >= MAX_SURFACES)) return(INDEX_ERROR);
     if ((roughness < 0.) || (surfacePond < 0.)) return(PARAMETER_ERROR);
 
-    Surface_List[surfaceIndex].Roughness = roughness;
-    Surface_List[surfaceIndex].Pond = surfacePond;
+    Tsoil *mySurface = &(myDomain->surfaceList[unsigned(surfaceIndex)]);
+    mySurface->Roughness = roughness;
+    mySurface->Pond = surfacePond;
 
     return(CRIT3D_OK);
  }
@@ -430,25 +701,25 @@ namespace soilFluxes3D {
      */
 	int DLL_EXPORT __STDCALL setMatricPotential(long nodeIndex, double potential)
  {
+     TCrit3DDomain *myDomain = getCurrentDomain();
 
-
-     if (myNode == nullptr)
+     if (myDomain->node == nullptr)
          return(MEMORY_ERROR);
-     if ((nodeIndex < 0) || (nodeIndex >= myStructure.nrNodes))
+     if ((nodeIndex < 0) || (nodeIndex >= myDomain->structure.nrNodes))
          return(INDEX_ERROR);
 
-     myNode[nodeIndex].H = potential + myNode[nodeIndex].z;
-     myNode[nodeIndex].oldH = myNode[nodeIndex].H;
+     myDomain->nodeState.H[nodeIndex] = potential + myDomain->node[nodeIndex].z;
+     myDomain->nodeState.oldH[nodeIndex] = myDomain->nodeState.H[nodeIndex];
 
-     if (myNode[nodeIndex].isSurface)
+     if (myDomain->node[nodeIndex].isSurface)
      {
-         myNode[nodeIndex].Se = 1.;
-         myNode[nodeIndex].k = NODATA;
+         myDomain->nodeState.Se[nodeIndex] = 1.;
+         myDomain->nodeState.k[nodeIndex] = NODATA;
      }
      else
      {
-         myNode[nodeIndex].Se = computeSe(nodeIndex);
-         myNode[nodeIndex].k = computeK(nodeIndex);
+         myDomain->nodeState.Se[nodeIndex] = computeSe(myDomain, nodeIndex);
+         myDomain->nodeState.k[nodeIndex] = computeK(myDomain, nodeIndex);
      }
 
      return(CRIT3D_OK);
@@ -463,25 +734,26 @@ namespace soilFluxes3D {
      */
 	int DLL_EXPORT __STDCALL setTotalPotential(long nodeIndex, double totalPotential)
  {
+	 TCrit3DDomain *myDomain = getCurrentDomain();
 
-	 if (myNode == nullptr)
+	 if (myDomain->node == nullptr)
 		 return(MEMORY_ERROR);
 
-	 if ((nodeIndex < 0) || (nodeIndex >= myStructure.nrNodes))
+	 if ((nodeIndex < 0) || (nodeIndex >= myDomain->structure.nrNodes))
 		 return(INDEX_ERROR);
 
-     myNode[nodeIndex].H = totalPotential;
-	 myNode[nodeIndex].oldH = myNode[nodeIndex].H;
+     myDomain->nodeState.H[nodeIndex] = totalPotential;
+	 myDomain->nodeState.oldH[nodeIndex] = myDomain->nodeState.H[nodeIndex];
 
-	 if (myNode[nodeIndex].isSurface)
+	 if (myDomain->node[nodeIndex].isSurface)
 	 {
-		 myNode[nodeIndex].Se = 1.;
-		 myNode[nodeIndex].k = NODATA;
+		 myDomain->nodeState.Se[nodeIndex] = 1.;
+		 myDomain->nodeState.k[nodeIndex] = NODATA;
 	 }
 	 else
 	 {
-         myNode[nodeIndex].Se = computeSe(nodeIndex);
-         myNode[nodeIndex].k = computeK(nodeIndex);
+         myDomain->nodeState.Se[nodeIndex] = computeSe(myDomain, nodeIndex);
+         myDomain->nodeState.k[nodeIndex] = computeK(myDomain, nodeIndex);
 	 }
 
 	 return(CRIT3D_OK);
@@ -496,29 +768,29 @@ namespace soilFluxes3D {
      */
 	int DLL_EXPORT __STDCALL setWaterContent(long nodeIndex, double waterContent)
  {
+    TCrit3DDomain *myDomain = getCurrentDomain();
 
+    if (myDomain->node == nullptr) return(MEMORY_ERROR);
 
-    if (myNode == nullptr) return(MEMORY_ERROR);
-
-    if ((nodeIndex < 0) || (nodeIndex >= myStructure.nrNodes)) return(INDEX_ERROR);
+    if ((nodeIndex < 0) || (nodeIndex >= myDomain->structure.nrNodes)) return(INDEX_ERROR);
 
     if (waterContent < 0.) return(PARAMETER_ERROR);
 
-    if (myNode[nodeIndex].isSurface)
+    if (myDomain->node[nodeIndex].isSurface)
             {
             /*! surface */
-            myNode[nodeIndex].H = myNode[nodeIndex].z + waterContent;
-            myNode[nodeIndex].oldH = myNode[nodeIndex].H;
-            myNode[nodeIndex].Se = 1.;
-            myNode[nodeIndex].k = 0.;
+            myDomain->nodeState.H[nodeIndex] = myDomain->node[nodeIndex].z + waterContent;
+            myDomain->nodeState.oldH[nodeIndex] = myDomain->nodeState.H[nodeIndex];
+            myDomain->nodeState.Se[nodeIndex] = 1.;
+            myDomain->nodeState.k[nodeIndex] = 0.;
             }
     else
             {
             if (waterContent > 1.0) return(PARAMETER_ERROR);
-            myNode[nodeIndex].Se = Se_from_theta(nodeIndex, waterContent);
-            myNode[nodeIndex].H = myNode[nodeIndex].z - psi_from_Se(nodeIndex);
-            myNode[nodeIndex].oldH = myNode[nodeIndex].H;
-            myNode[nodeIndex].k = computeK(nodeIndex);
+            myDomain->nodeState.Se[nodeIndex] = Se_from_theta(myDomain, nodeIndex, waterContent);
+            myDomain->nodeState.H[nodeIndex] = myDomain->node[nodeIndex].z - psi_from_Se(myDomain, nodeIndex);
+            myDomain->nodeState.oldH[nodeIndex] = myDomain->nodeState.H[nodeIndex];
+            myDomain->nodeState.k[nodeIndex] = computeK(myDomain, nodeIndex);
             }
 
     return(CRIT3D_OK);
@@ -533,11 +805,34 @@ namespace soilFluxes3D {
      */
 	int DLL_EXPORT __STDCALL setWaterSinkSource(long nodeIndex, double waterSinkSource)
  {
+    TCrit3DDomain *myDomain = getCurrentDomain();
+
+    if (myDomain->node == nullptr) return(MEMORY_ERROR);
+    if ((nodeIndex < 0) || (nodeIndex >= myDomain->structure.nrNodes)) return(INDEX_ERROR);
+
+    myDomain->nodeState.waterSinkSource[nodeIndex] = waterSinkSource;
+
+    return(CRIT3D_OK);
+ }
+
+
+    /*!
+     * \brief Set current water sink/source of a contiguous range of nodes
+     * \param firstIndex
+     * \param nrValues
+     * \param waterSinkSource [m^3/sec] flow (nrValues values)
+     * \return OK/ERROR
+     */
+    int DLL_EXPORT __STDCALL setWaterSinkSources(long firstIndex, long nrValues, const double *waterSinkSource)
+ {
+    TCrit3DDomain *myDomain = getCurrentDomain();
 
-    if (myNode == nullptr) return(MEMORY_ERROR);
-    if ((nodeIndex < 0) || (nodeIndex >= myStructure.nrNodes)) return(INDEX_ERROR);
+    if (myDomain->node == nullptr) return(MEMORY_ERROR);
+    if ((firstIndex < 0) || (nrValues < 0) || (firstIndex + nrValues > myDomain->structure.nrNodes))
+        return(INDEX_ERROR);
+    if (waterSinkSource == nullptr) return(PARAMETER_ERROR);
 
-    myNode[nodeIndex].waterSinkSource = waterSinkSource;
+    memcpy(myDomain->nodeState.waterSinkSource + firstIndex, waterSinkSource, size_t(nrValues) * sizeof(double));
 
     return(CRIT3D_OK);
  }
@@ -551,13 +846,14 @@ namespace soilFluxes3D {
      */
 	int DLL_EXPORT __STDCALL setPrescribedTotalPotential(long nodeIndex, double prescribedTotalPotential)
  {
+    TCrit3DDomain *myDomain = getCurrentDomain();
 
-    if (myNode == nullptr) return(MEMORY_ERROR);
-    if ((nodeIndex < 0) || (nodeIndex >= myStructure.nrNodes)) return(INDEX_ERROR);
-    if (myNode[nodeIndex].boundary == nullptr) return(BOUNDARY_ERROR);
-	if (myNode[nodeIndex].boundary->type != BOUNDARY_PRESCRIBEDTOTALPOTENTIAL) return(BOUNDARY_ERROR);
+    if (myDomain->node == nullptr) return(MEMORY_ERROR);
+    if ((nodeIndex < 0) || (nodeIndex >= myDomain->structure.nrNodes)) return(INDEX_ERROR);
+    if (myDomain->node[nodeIndex].boundary == nullptr) return(BOUNDARY_ERROR);
+	if (myDomain->node[nodeIndex].boundary->type != BOUNDARY_PRESCRIBEDTOTALPOTENTIAL) return(BOUNDARY_ERROR);
 
-    myNode[nodeIndex].boundary->prescribedTotalPotential = prescribedTotalPotential;
+    myDomain->node[nodeIndex].boundary->prescribedTotalPotential = prescribedTotalPotential;
 
     return(CRIT3D_OK);
  }
@@ -571,15 +867,17 @@ namespace soilFluxes3D {
 	double DLL_EXPORT __STDCALL getWaterContent(long nodeIndex)
 
  {
-        if (myNode == nullptr) return(MEMORY_ERROR);
-        if ((nodeIndex < 0) || (nodeIndex >= myStructure.nrNodes)) return(INDEX_ERROR);
+        TCrit3DDomain *myDomain = getCurrentDomain();
+
+        if (myDomain->node == nullptr) return(MEMORY_ERROR);
+        if ((nodeIndex < 0) || (nodeIndex >= myDomain->structure.nrNodes)) return(INDEX_ERROR);
 
-        if  (myNode[nodeIndex].isSurface)
+        if  (myDomain->node[nodeIndex].isSurface)
             /*! surface */
-            return (myNode[nodeIndex].H - myNode[nodeIndex].z);
+            return (myDomain->nodeState.H[nodeIndex] - myDomain->node[nodeIndex].z);
         else
             /*! sub-surface */
-            return (theta_from_Se(nodeIndex));
+            return (theta_from_Se(myDomain, nodeIndex));
  }
 
 
@@ -590,15 +888,17 @@ namespace soilFluxes3D {
      */
 	double DLL_EXPORT __STDCALL getAvailableWaterContent(long index)
  {
-        if (myNode == nullptr) return(MEMORY_ERROR);
-        if ((index < 0) || (index >= myStructure.nrNodes)) return(INDEX_ERROR);
+        TCrit3DDomain *myDomain = getCurrentDomain();
+
+        if (myDomain->node == nullptr) return(MEMORY_ERROR);
+        if ((index < 0) || (index >= myDomain->structure.nrNodes)) return(INDEX_ERROR);
 
-        if  (myNode[index].isSurface)
+        if  (myDomain->node[index].isSurface)
             /*! surface */
-            return (myNode[index].H - myNode[index].z);
+            return (myDomain->nodeState.H[index] - myDomain->node[index].z);
         else
             /*! sub-surface */
-            return maxValue(0.0, theta_from_Se(index) - theta_from_sign_Psi(-160, index));
+            return maxValue(0.0, theta_from_Se(myDomain, index) - theta_from_sign_Psi(myDomain, -160, index));
  }
 
 
@@ -610,15 +910,17 @@ namespace soilFluxes3D {
      */
 	double DLL_EXPORT __STDCALL getWaterDeficit(long index, double fieldCapacity)
  {
-        if (myNode == nullptr) return(MEMORY_ERROR);
-        if ((index < 0) || (index >= myStructure.nrNodes)) return(INDEX_ERROR);
+        TCrit3DDomain *myDomain = getCurrentDomain();
 
-        if  (myNode[index].isSurface)
+        if (myDomain->node == nullptr) return(MEMORY_ERROR);
+        if ((index < 0) || (index >= myDomain->structure.nrNodes)) return(INDEX_ERROR);
+
+        if  (myDomain->node[index].isSurface)
             /*! surface */
             return (0.0);
         else
             /*! sub-surface */
-            return (theta_from_sign_Psi(-fieldCapacity, index) - theta_from_Se(index));
+            return (theta_from_sign_Psi(myDomain, -fieldCapacity, index) - theta_from_Se(myDomain, index));
  }
 
 
@@ -630,18 +932,20 @@ namespace soilFluxes3D {
   */
  double DLL_EXPORT __STDCALL getDegreeOfSaturation(long nodeIndex)
  {
-        if (myNode == nullptr) return(MEMORY_ERROR);
-        if ((nodeIndex < 0) || (nodeIndex >= myStructure.nrNodes)) return(INDEX_ERROR);
+        TCrit3DDomain *myDomain = getCurrentDomain();
+
+        if (myDomain->node == nullptr) return(MEMORY_ERROR);
+        if ((nodeIndex < 0) || (nodeIndex >= myDomain->structure.nrNodes)) return(INDEX_ERROR);
 
-        if  (myNode[nodeIndex].isSurface)
+        if  (myDomain->node[nodeIndex].isSurface)
         {
-            if ((myNode[nodeIndex].H - myNode[nodeIndex].z) > 0.0001)
+            if ((myDomain->nodeState.H[nodeIndex] - myDomain->node[nodeIndex].z) > 0.0001)
                 return(100.0);
             else
                 return(0.0);
         }
         else
-            return (myNode[nodeIndex].Se*100.0);
+            return (myDomain->nodeState.Se[nodeIndex]*100.0);
  }
 
 
@@ -651,7 +955,9 @@ namespace soilFluxes3D {
   */
  double DLL_EXPORT __STDCALL getTotalWaterContent()
  {
-    return(computeTotalWaterContent());
+    TCrit3DDomain *myDomain = getCurrentDomain();
+
+    return(computeTotalWaterContent(myDomain));
  }
 
 
@@ -662,11 +968,13 @@ namespace soilFluxes3D {
   */
  double DLL_EXPORT __STDCALL getWaterConductivity(long nodeIndex)
  {
+    TCrit3DDomain *myDomain = getCurrentDomain();
+
     /*! error check */
-    if (myNode == nullptr) return(MEMORY_ERROR);
-    if ((nodeIndex < 0) || (nodeIndex >= myStructure.nrNodes)) return(INDEX_ERROR);
+    if (myDomain->node == nullptr) return(MEMORY_ERROR);
+    if ((nodeIndex < 0) || (nodeIndex >= myDomain->structure.nrNodes)) return(INDEX_ERROR);
 
-    return (myNode[nodeIndex].k);
+    return (myDomain->nodeState.k[nodeIndex]);
  }
 
 
@@ -677,10 +985,12 @@ namespace soilFluxes3D {
   */
  double DLL_EXPORT __STDCALL getMatricPotential(long nodeIndex)
  {
-    if (myNode == nullptr) return(MEMORY_ERROR);
-    if ((nodeIndex < 0) || (nodeIndex >= myStructure.nrNodes)) return(INDEX_ERROR);
+    TCrit3DDomain *myDomain = getCurrentDomain();
 
-    return (myNode[nodeIndex].H - myNode[nodeIndex].z);
+    if (myDomain->node == nullptr) return(MEMORY_ERROR);
+    if ((nodeIndex < 0) || (nodeIndex >= myDomain->structure.nrNodes)) return(INDEX_ERROR);
+
+    return (myDomain->nodeState.H[nodeIndex] - myDomain->node[nodeIndex].z);
  }
 
 
@@ -691,10 +1001,12 @@ namespace soilFluxes3D {
   */
  double DLL_EXPORT __STDCALL getTotalPotential(long nodeIndex)
  {
-	 if (myNode == nullptr) return(MEMORY_ERROR);
-	 if ((nodeIndex < 0) || (nodeIndex >= myStructure.nrNodes)) return(INDEX_ERROR);
+	 TCrit3DDomain *myDomain = getCurrentDomain();
+
+	 if (myDomain->node == nullptr) return(MEMORY_ERROR);
+	 if ((nodeIndex < 0) || (nodeIndex >= myDomain->structure.nrNodes)) return(INDEX_ERROR);
 
-	 return (myNode[nodeIndex].H);
+	 return (myDomain->nodeState.H[nodeIndex]);
  }
 
 
@@ -706,30 +1018,32 @@ namespace soilFluxes3D {
   */
  double DLL_EXPORT __STDCALL getWaterFlow(long n, short direction)
  {
-    if (myNode == nullptr) return MEMORY_ERROR;
-    if ((n < 0) || (n >= myStructure.nrNodes)) return INDEX_ERROR;
+    TCrit3DDomain *myDomain = getCurrentDomain();
+
+    if (myDomain->node == nullptr) return MEMORY_ERROR;
+    if ((n < 0) || (n >= myDomain->structure.nrNodes)) return INDEX_ERROR;
 
 	double maxFlow = 0.0;
 
 	switch (direction) {
         case UP:
-            if (myNode[n].up.index != NOLINK)
-                return (myNode[n].up.sumFlow);
+            if (myDomain->node[n].up.index != NOLINK)
+                return (myDomain->node[n].up.sumFlow);
             else
                 return INDEX_ERROR;
 
 		case DOWN:
-            if (myNode[n].down.index != NOLINK)
-                return (myNode[n].down.sumFlow);
+            if (myDomain->node[n].down.index != NOLINK)
+                return (myDomain->node[n].down.sumFlow);
             else
                 return INDEX_ERROR;
 
 		case LATERAL:
 			// return maximum lateral flow
-            for (short i = 0; i < myStructure.nrLateralLinks; i++)
-                if (myNode[n].lateral[i].index != NOLINK)
-                    if (fabs(myNode[n].lateral[i].sumFlow) > maxFlow)
-                        maxFlow = myNode[n].lateral[i].sumFlow;
+            for (short i = 0; i < myDomain->structure.nrLateralLinks; i++)
+                if (myDomain->node[n].lateral[i].index != NOLINK)
+                    if (fabs(myDomain->node[n].lateral[i].sumFlow) > maxFlow)
+                        maxFlow = myDomain->node[n].lateral[i].sumFlow;
             return maxFlow;
 
         default:
@@ -745,13 +1059,15 @@ namespace soilFluxes3D {
   */
  double DLL_EXPORT __STDCALL getSumLateralWaterFlow(long n)
  {
-    if (myNode == nullptr) return MEMORY_ERROR;
-    if ((n < 0) || (n >= myStructure.nrNodes)) return INDEX_ERROR;
+    TCrit3DDomain *myDomain = getCurrentDomain();
+
+    if (myDomain->node == nullptr) return MEMORY_ERROR;
+    if ((n < 0) || (n >= myDomain->structure.nrNodes)) return INDEX_ERROR;
 
     double sumLateralFlow = 0.0;
-    for (short i = 0; i < myStructure.nrLateralLinks; i++)
-        if (myNode[n].lateral[i].index != NOLINK)
-			sumLateralFlow += myNode[n].lateral[i].sumFlow;
+    for (short i = 0; i < myDomain->structure.nrLateralLinks; i++)
+        if (myDomain->node[n].lateral[i].index != NOLINK)
+			sumLateralFlow += myDomain->node[n].lateral[i].sumFlow;
 	return sumLateralFlow;
  }
 
@@ -763,14 +1079,16 @@ namespace soilFluxes3D {
   */
  double DLL_EXPORT __STDCALL getSumLateralWaterFlowIn(long n)
  {
-    if (myNode == nullptr) return MEMORY_ERROR;
-    if ((n < 0) || (n >= myStructure.nrNodes)) return INDEX_ERROR;
+    TCrit3DDomain *myDomain = getCurrentDomain();
+
+    if (myDomain->node == nullptr) return MEMORY_ERROR;
+    if ((n < 0) || (n >= myDomain->structure.nrNodes)) return INDEX_ERROR;
 
     double sumLateralFlow = 0.0;
-    for (short i = 0; i < myStructure.nrLateralLinks; i++)
-        if (myNode[n].lateral[i].index != NOLINK)
-            if (myNode[n].lateral[i].sumFlow > 0)
-                sumLateralFlow += myNode[n].lateral[i].sumFlow;
+    for (short i = 0; i < myDomain->structure.nrLateralLinks; i++)
+        if (myDomain->node[n].lateral[i].index != NOLINK)
+            if (myDomain->node[n].lateral[i].sumFlow > 0)
+                sumLateralFlow += myDomain->node[n].lateral[i].sumFlow;
 
     return sumLateralFlow;
  }
@@ -783,14 +1101,16 @@ namespace soilFluxes3D {
   */
  double DLL_EXPORT __STDCALL getSumLateralWaterFlowOut(long n)
  {
-    if (myNode == nullptr) return MEMORY_ERROR;
-    if ((n < 0) || (n >= myStructure.nrNodes)) return INDEX_ERROR;
+    TCrit3DDomain *myDomain = getCurrentDomain();
+
+    if (myDomain->node == nullptr) return MEMORY_ERROR;
+    if ((n < 0) || (n >= myDomain->structure.nrNodes)) return INDEX_ERROR;
 
     double sumLateralFlow = 0.0;
-    for (short i = 0; i < myStructure.nrLateralLinks; i++)
-        if (myNode[n].lateral[i].index != NOLINK)
-            if (myNode[n].lateral[i].sumFlow < 0)
-                sumLateralFlow += myNode[n].lateral[i].sumFlow;
+    for (short i = 0; i < myDomain->structure.nrLateralLinks; i++)
+        if (myDomain->node[n].lateral[i].index != NOLINK)
+            if (myDomain->node[n].lateral[i].sumFlow < 0)
+                sumLateralFlow += myDomain->node[n].lateral[i].sumFlow;
 
     return sumLateralFlow;
  }
@@ -798,24 +1118,32 @@ namespace soilFluxes3D {
 
  void DLL_EXPORT __STDCALL initializeBalance()
 {
-    InitializeBalanceWater();
-    if (myStructure.computeHeat)
-        initializeBalanceHeat();
+    TCrit3DDomain *myDomain = getCurrentDomain();
+
+    InitializeBalanceWater(myDomain);
+    if (myDomain->structure.computeHeat)
+        initializeBalanceHeat(myDomain);
 }
 
  double DLL_EXPORT __STDCALL getWaterMBR()
  {
-    return (balanceWholePeriod.waterMBR);
+    TCrit3DDomain *myDomain = getCurrentDomain();
+
+    return (myDomain->balanceWholePeriod.waterMBR);
  }
 
  double DLL_EXPORT __STDCALL getHeatMBR()
   {
-     return (balanceWholePeriod.heatMBR);
+     TCrit3DDomain *myDomain = getCurrentDomain();
+
+     return (myDomain->balanceWholePeriod.heatMBR);
   }
 
  double DLL_EXPORT __STDCALL getHeatMBE()
   {
-     return (balanceWholePeriod.heatMBE);
+     TCrit3DDomain *myDomain = getCurrentDomain();
+
+     return (myDomain->balanceWholePeriod.heatMBE);
   }
 
  /*!
@@ -825,13 +1153,14 @@ namespace soilFluxes3D {
   */
  double DLL_EXPORT __STDCALL getBoundaryWaterFlow(long nodeIndex)
  {
+    TCrit3DDomain *myDomain = getCurrentDomain();
 
-    if (myNode == nullptr) return(MEMORY_ERROR);
-    if ((nodeIndex < 0) || (nodeIndex >= myStructure.nrNodes)) return(INDEX_ERROR);
+    if (myDomain->node == nullptr) return(MEMORY_ERROR);
+    if ((nodeIndex < 0) || (nodeIndex >= myDomain->structure.nrNodes)) return(INDEX_ERROR);
 
-	if (myNode[nodeIndex].boundary == nullptr) return(BOUNDARY_ERROR);
+	if (myDomain->node[nodeIndex].boundary == nullptr) return(BOUNDARY_ERROR);
 
-    return(myNode[nodeIndex].boundary->sumBoundaryWaterFlow);
+    return(myDomain->node[nodeIndex].boundary->sumBoundaryWaterFlow);
  }
 
 
@@ -842,13 +1171,14 @@ namespace soilFluxes3D {
   */
  double DLL_EXPORT __STDCALL getBoundaryWaterSumFlow(int boundaryType)
  {
+    TCrit3DDomain *myDomain = getCurrentDomain();
 
     double sumBoundaryFlow = 0.0;
 
-    for (long n = 0; n < myStructure.nrNodes; n++)
-        if (myNode[n].boundary != nullptr)
-            if (myNode[n].boundary->type == boundaryType)
-				sumBoundaryFlow += myNode[n].boundary->sumBoundaryWaterFlow;
+    for (long n = 0; n < myDomain->structure.nrNodes; n++)
+        if (myDomain->node[n].boundary != nullptr)
+            if (myDomain->node[n].boundary->type == boundaryType)
+				sumBoundaryFlow += myDomain->node[n].boundary->sumBoundaryWaterFlow;
 
 	return(sumBoundaryFlow);
  }
@@ -860,10 +1190,13 @@ namespace soilFluxes3D {
   */
  void DLL_EXPORT __STDCALL computePeriod(double myPeriod)
     {
+		TCrit3DDomain *myDomain = getCurrentDomain();
+
 		double deltaT, ResidualTime, sumTime = 0.0;
 
-        balanceCurrentPeriod.sinkSourceWater = 0.;
-        balanceCurrentPeriod.sinkSourceHeat = 0.;
+        myDomain->statistics = TsolverStatistics();
+        myDomain->balanceCurrentPeriod.sinkSourceWater = 0.;
+        myDomain->balanceCurrentPeriod.sinkSourceHeat = 0.;
 
 		while (sumTime < myPeriod)
         {
@@ -872,8 +1205,8 @@ namespace soilFluxes3D {
 			sumTime += deltaT;
         }
 
-        if (myStructure.computeWater) updateBalanceWaterWholePeriod();
-        if (myStructure.computeHeat) updateBalanceHeatWholePeriod();
+        if (myDomain->structure.computeWater) updateBalanceWaterWholePeriod(myDomain);
+        if (myDomain->structure.computeHeat) updateBalanceHeatWholePeriod(myDomain);
 
     }
 
@@ -885,44 +1218,104 @@ namespace soilFluxes3D {
  */
 double DLL_EXPORT __STDCALL computeStep(double maxTime)
 {
+    TCrit3DDomain *myDomain = getCurrentDomain();
+
     double dtWater, dtHeat;
 
-    if (myStructure.computeHeat) initializeHeatFluxes(false, true);
-    updateBoundary();
+    if (myDomain->structure.computeHeat) initializeHeatFluxes(myDomain, false, true);
+    updateBoundary(myDomain);
 
-    if (myStructure.computeWater)
-        computeWater(maxTime, &dtWater);
+    if (myDomain->structure.computeWater)
+        computeWater(myDomain, maxTime, &dtWater);
     else
-        dtWater = minValue(maxTime, myParameters.delta_t_max);
+        dtWater = minValue(maxTime, myDomain->parameters.delta_t_max);
 
     dtHeat = dtWater;
 
-    if (myStructure.computeHeat)
+    if (myDomain->structure.computeHeat)
     {
         double dtHeatCurrent = dtHeat;
 
-        saveWaterFluxes(dtHeatCurrent, dtWater);
+        saveWaterFluxes(myDomain, dtHeatCurrent, dtWater);
 
         double dtHeatSum = 0;
         while (dtHeatSum < dtWater)
         {
             dtHeatCurrent = minValue(dtHeat, dtWater - dtHeatSum);
 
-            updateBoundaryHeat();
+            updateBoundaryHeat(myDomain);
 
-            if (HeatComputation(dtHeatCurrent, dtWater))
+            if (HeatComputation(myDomain, dtHeatCurrent, dtWater))
             {
                 dtHeatSum += dtHeat;
             }
             else
             {
-                restoreHeat();
-                dtHeat = myParameters.current_delta_t;
+                myDomain->statistics.nrRejectedSteps++;
+                restoreHeat(myDomain);
+                dtHeat = myDomain->parameters.current_delta_t;
             }
         }
     }
 
-    return minValue(dtWater, dtHeat);
+    double deltaT = minValue(dtWater, dtHeat);
+
+    /*! time step statistics */
+    myDomain->statistics.nrAcceptedSteps++;
+    if (myDomain->statistics.nrAcceptedSteps == 1)
+    {
+        myDomain->statistics.minDeltaT = myDomain->statistics.maxDeltaT = deltaT;
+    }
+    else
+    {
+        myDomain->statistics.minDeltaT = minValue(myDomain->statistics.minDeltaT, deltaT);
+        myDomain->statistics.maxDeltaT = maxValue(myDomain->statistics.maxDeltaT, deltaT);
+    }
+    myDomain->statistics.meanDeltaT += (deltaT - myDomain->statistics.meanDeltaT) / myDomain->statistics.nrAcceptedSteps;
+
+    return deltaT;
+}
+
+/*!
+ * \brief statistics of the solver in the last computePeriod
+ * \param statistics [output] linear iterations and maximum residual, accepted and rejected time steps,
+ * approximations, minimum / maximum / mean time step
+ * \return OK/ERROR
+ */
+int DLL_EXPORT __STDCALL getSolverStatistics(TsolverStatistics *statistics)
+{
+    TCrit3DDomain *myDomain = getCurrentDomain();
+
+    if (statistics == nullptr) return(PARAMETER_ERROR);
+
+    *statistics = myDomain->statistics;
+    return(CRIT3D_OK);
+}
+
+/*!
+ * \brief save the state of the current domain in a binary file (checkpoint):
+ * node water and heat state, link and boundary flow sums, balances and current time step
+ * \param fileName
+ * \return OK/ERROR
+ */
+int DLL_EXPORT __STDCALL saveState(const char *fileName)
+{
+    TCrit3DDomain *myDomain = getCurrentDomain();
+
+    return writeStateFile(myDomain, fileName);
+}
+
+/*!
+ * \brief load the state of the current domain from a file written by saveState (restart)
+ * the topology (nodes, links, soils, boundary) must be set before, as in the saved domain
+ * \param fileName
+ * \return OK/ERROR (FILE_ERROR: wrong file, version or checksum; TOPOGRAPHY_ERROR: different domain)
+ */
+int DLL_EXPORT __STDCALL loadState(const char *fileName)
+{
+    TCrit3DDomain *myDomain = getCurrentDomain();
+
+    return readStateFile(myDomain, fileName);
 }
 
 /*!
@@ -933,22 +1326,24 @@ double DLL_EXPORT __STDCALL computeStep(double maxTime)
  */
 int DLL_EXPORT __STDCALL setTemperature(long nodeIndex, double myT)
 {
+   TCrit3DDomain *myDomain = getCurrentDomain();
+
    //----------------------------------------------------------------------------------------------
    // Set current temperature of node
    //----- Input ----------------------------------------------------------------------------------
    // myT              [K] temperature
    //----------------------------------------------------------------------------------------------
 
-   if (myNode == nullptr) return(MEMORY_ERROR);
+   if (myDomain->node == nullptr) return(MEMORY_ERROR);
 
-   if ((nodeIndex < 0) || (nodeIndex >= myStructure.nrNodes)) return(INDEX_ERROR);
+   if ((nodeIndex < 0) || (nodeIndex >= myDomain->structure.nrNodes)) return(INDEX_ERROR);
 
    if ((myT < 200) && (myT > 500)) return(PARAMETER_ERROR);
 
-   if (! isHeatNode(nodeIndex)) return(MEMORY_ERROR);
+   if (! isHeatNode(myDomain, nodeIndex)) return(MEMORY_ERROR);
 
-   myNode[nodeIndex].extra->Heat->T = myT;
-   myNode[nodeIndex].extra->Heat->oldT = myT;
+   myDomain->node[nodeIndex].extra->Heat->T = myT;
+   myDomain->node[nodeIndex].extra->Heat->oldT = myT;
 
    return(CRIT3D_OK);
 }
@@ -961,15 +1356,17 @@ int DLL_EXPORT __STDCALL setTemperature(long nodeIndex, double myT)
  */
 int DLL_EXPORT __STDCALL setFixedTemperature(long nodeIndex, double myT, double myDepth)
 {
-   if (myNode == nullptr) return(MEMORY_ERROR);
-   if ((nodeIndex < 0) || (nodeIndex >= myStructure.nrNodes)) return(INDEX_ERROR);
-   if (myNode[nodeIndex].boundary == nullptr) return(BOUNDARY_ERROR);
-   if (myNode[nodeIndex].boundary->Heat == nullptr) return(BOUNDARY_ERROR);
-   if (myNode[nodeIndex].boundary->type != BOUNDARY_PRESCRIBEDTOTALPOTENTIAL &&
-           myNode[nodeIndex].boundary->type != BOUNDARY_FREEDRAINAGE) return(BOUNDARY_ERROR);
+   TCrit3DDomain *myDomain = getCurrentDomain();
 
-   myNode[nodeIndex].boundary->Heat->fixedTemperatureDepth = myDepth;
-   myNode[nodeIndex].boundary->Heat->fixedTemperature = myT;
+   if (myDomain->node == nullptr) return(MEMORY_ERROR);
+   if ((nodeIndex < 0) || (nodeIndex >= myDomain->structure.nrNodes)) return(INDEX_ERROR);
+   if (myDomain->node[nodeIndex].boundary == nullptr) return(BOUNDARY_ERROR);
+   if (myDomain->node[nodeIndex].boundary->Heat == nullptr) return(BOUNDARY_ERROR);
+   if (myDomain->node[nodeIndex].boundary->type != BOUNDARY_PRESCRIBEDTOTALPOTENTIAL &&
+           myDomain->node[nodeIndex].boundary->type != BOUNDARY_FREEDRAINAGE) return(BOUNDARY_ERROR);
+
+   myDomain->node[nodeIndex].boundary->Heat->fixedTemperatureDepth = myDepth;
+   myDomain->node[nodeIndex].boundary->Heat->fixedTemperature = myT;
 
    return(CRIT3D_OK);
 }
@@ -982,14 +1379,16 @@ int DLL_EXPORT __STDCALL setFixedTemperature(long nodeIndex, double myT, double
  */
 int DLL_EXPORT __STDCALL setHeatBoundaryWindSpeed(long nodeIndex, double myWindSpeed)
 {
-   if (myNode == nullptr) return(MEMORY_ERROR);
-   if ((nodeIndex < 0) || (nodeIndex >= myStructure.nrNodes)) return(INDEX_ERROR);
+   TCrit3DDomain *myDomain = getCurrentDomain();
+
+   if (myDomain->node == nullptr) return(MEMORY_ERROR);
+   if ((nodeIndex < 0) || (nodeIndex >= myDomain->structure.nrNodes)) return(INDEX_ERROR);
    if ((myWindSpeed < 0) && (myWindSpeed > 1000)) return(PARAMETER_ERROR);
 
-   if (myNode[nodeIndex].boundary == nullptr || myNode[nodeIndex].boundary->Heat == nullptr)
+   if (myDomain->node[nodeIndex].boundary == nullptr || myDomain->node[nodeIndex].boundary->Heat == nullptr)
        return (BOUNDARY_ERROR);
 
-   myNode[nodeIndex].boundary->Heat->windSpeed = myWindSpeed;
+   myDomain->node[nodeIndex].boundary->Heat->windSpeed = myWindSpeed;
 
    return(CRIT3D_OK);
 }
@@ -1002,14 +1401,16 @@ int DLL_EXPORT __STDCALL setHeatBoundaryWindSpeed(long nodeIndex, double myWindS
  */
 int DLL_EXPORT __STDCALL setHeatBoundaryRoughness(long nodeIndex, double myRoughness)
 {
-   if (myNode == nullptr) return(MEMORY_ERROR);
-   if ((nodeIndex < 0) || (nodeIndex >= myStructure.nrNodes)) return(INDEX_ERROR);
+   TCrit3DDomain *myDomain = getCurrentDomain();
+
+   if (myDomain->node == nullptr) return(MEMORY_ERROR);
+   if ((nodeIndex < 0) || (nodeIndex >= myDomain->structure.nrNodes)) return(INDEX_ERROR);
    if (myRoughness < 0) return(PARAMETER_ERROR);
 
-   if (myNode[nodeIndex].boundary == nullptr || myNode[nodeIndex].boundary->Heat == nullptr)
+   if (myDomain->node[nodeIndex].boundary == nullptr || myDomain->node[nodeIndex].boundary->Heat == nullptr)
        return (BOUNDARY_ERROR);
 
-   myNode[nodeIndex].boundary->Heat->roughnessHeight = myRoughness;
+   myDomain->node[nodeIndex].boundary->Heat->roughnessHeight = myRoughness;
 
    return(CRIT3D_OK);
 }
@@ -1022,13 +1423,15 @@ int DLL_EXPORT __STDCALL setHeatBoundaryRoughness(long nodeIndex, double myRough
  */
 int DLL_EXPORT __STDCALL setHeatSinkSource(long nodeIndex, double myHeatFlow)
 {
-   if (myNode == nullptr)
+   TCrit3DDomain *myDomain = getCurrentDomain();
+
+   if (myDomain->node == nullptr)
        return(MEMORY_ERROR);
 
-   if ((nodeIndex < 0) || (nodeIndex >= myStructure.nrNodes))
+   if ((nodeIndex < 0) || (nodeIndex >= myDomain->structure.nrNodes))
        return(INDEX_ERROR);
 
-   myNode[nodeIndex].extra->Heat->sinkSource = myHeatFlow;
+   myDomain->node[nodeIndex].extra->Heat->sinkSource = myHeatFlow;
 
    return(CRIT3D_OK);
 }
@@ -1041,16 +1444,18 @@ int DLL_EXPORT __STDCALL setHeatSinkSource(long nodeIndex, double myHeatFlow)
  */
 int DLL_EXPORT __STDCALL setHeatBoundaryTemperature(long nodeIndex, double myTemperature)
 {
-   if (myNode == nullptr)
+   TCrit3DDomain *myDomain = getCurrentDomain();
+
+   if (myDomain->node == nullptr)
        return(MEMORY_ERROR);
 
-   if ((nodeIndex < 0) || (nodeIndex >= myStructure.nrNodes))
+   if ((nodeIndex < 0) || (nodeIndex >= myDomain->structure.nrNodes))
        return(INDEX_ERROR);
 
-   if (myNode[nodeIndex].boundary == nullptr || myNode[nodeIndex].boundary->Heat == nullptr)
+   if (myDomain->node[nodeIndex].boundary == nullptr || myDomain->node[nodeIndex].boundary->Heat == nullptr)
        return (BOUNDARY_ERROR);
 
-   myNode[nodeIndex].boundary->Heat->temperature = myTemperature;
+   myDomain->node[nodeIndex].boundary->Heat->temperature = myTemperature;
 
    return(CRIT3D_OK);
 }
@@ -1063,16 +1468,18 @@ int DLL_EXPORT __STDCALL setHeatBoundaryTemperature(long nodeIndex, double myTem
  */
 int DLL_EXPORT __STDCALL setHeatBoundaryNetIrradiance(long nodeIndex, double myNetIrradiance)
 {
-   if (myNode == nullptr)
+   TCrit3DDomain *myDomain = getCurrentDomain();
+
+   if (myDomain->node == nullptr)
        return(MEMORY_ERROR);
 
-   if ((nodeIndex < 0) || (nodeIndex >= myStructure.nrNodes))
+   if ((nodeIndex < 0) || (nodeIndex >= myDomain->structure.nrNodes))
        return(INDEX_ERROR);
 
-   if (myNode[nodeIndex].boundary == nullptr || myNode[nodeIndex].boundary->Heat == nullptr)
+   if (myDomain->node[nodeIndex].boundary == nullptr || myDomain->node[nodeIndex].boundary->Heat == nullptr)
        return (BOUNDARY_ERROR);
 
-   myNode[nodeIndex].boundary->Heat->netIrradiance = myNetIrradiance;
+   myDomain->node[nodeIndex].boundary->Heat->netIrradiance = myNetIrradiance;
 
    return(CRIT3D_OK);
 }
@@ -1085,16 +1492,18 @@ int DLL_EXPORT __STDCALL setHeatBoundaryNetIrradiance(long nodeIndex, double myN
  */
 int DLL_EXPORT __STDCALL setHeatBoundaryRelativeHumidity(long nodeIndex, double myRelativeHumidity)
 {
-   if (myNode == nullptr)
+   TCrit3DDomain *myDomain = getCurrentDomain();
+
+   if (myDomain->node == nullptr)
        return(MEMORY_ERROR);
 
-   if ((nodeIndex < 0) || (nodeIndex >= myStructure.nrNodes))
+   if ((nodeIndex < 0) || (nodeIndex >= myDomain->structure.nrNodes))
        return(INDEX_ERROR);
 
-   if (myNode[nodeIndex].boundary == nullptr || myNode[nodeIndex].boundary->Heat == nullptr)
+   if (myDomain->node[nodeIndex].boundary == nullptr || myDomain->node[nodeIndex].boundary->Heat == nullptr)
        return (BOUNDARY_ERROR);
 
-   myNode[nodeIndex].boundary->Heat->relativeHumidity = myRelativeHumidity;
+   myDomain->node[nodeIndex].boundary->Heat->relativeHumidity = myRelativeHumidity;
 
    return(CRIT3D_OK);
 }
@@ -1107,13 +1516,15 @@ int DLL_EXPORT __STDCALL setHeatBoundaryRelativeHumidity(long nodeIndex, double
  */
 int DLL_EXPORT __STDCALL setHeatBoundaryHeightWind(long nodeIndex, double myHeight)
 {
-   if (myNode == nullptr) return(MEMORY_ERROR);
-   if ((nodeIndex < 0) || (nodeIndex >= myStructure.nrNodes)) return(INDEX_ERROR);
+   TCrit3DDomain *myDomain = getCurrentDomain();
 
-   if (myNode[nodeIndex].boundary == nullptr || myNode[nodeIndex].boundary->Heat == nullptr)
+   if (myDomain->node == nullptr) return(MEMORY_ERROR);
+   if ((nodeIndex < 0) || (nodeIndex >= myDomain->structure.nrNodes)) return(INDEX_ERROR);
+
+   if (myDomain->node[nodeIndex].boundary == nullptr || myDomain->node[nodeIndex].boundary->Heat == nullptr)
        return (BOUNDARY_ERROR);
 
-   myNode[nodeIndex].boundary->Heat->heightWind = myHeight;
+   myDomain->node[nodeIndex].boundary->Heat->heightWind = myHeight;
 
    return(CRIT3D_OK);
 }
@@ -1127,17 +1538,57 @@ int DLL_EXPORT __STDCALL setHeatBoundaryHeightWind(long nodeIndex, double myHeig
  */
 int DLL_EXPORT __STDCALL setHeatBoundaryHeightTemperature(long nodeIndex, double myHeight)
 {
-   if (myNode == nullptr) return(MEMORY_ERROR);
-   if ((nodeIndex < 0) || (nodeIndex >= myStructure.nrNodes)) return(INDEX_ERROR);
+   TCrit3DDomain *myDomain = getCurrentDomain();
+
+   if (myDomain->node == nullptr) return(MEMORY_ERROR);
+   if ((nodeIndex < 0) || (nodeIndex >= myDomain->structure.nrNodes)) return(INDEX_ERROR);
 
-   if (myNode[nodeIndex].boundary == nullptr || myNode[nodeIndex].boundary->Heat == nullptr)
+   if (myDomain->node[nodeIndex].boundary == nullptr || myDomain->node[nodeIndex].boundary->Heat == nullptr)
        return (BOUNDARY_ERROR);
 
-   myNode[nodeIndex].boundary->Heat->heightTemperature = myHeight;
+   myDomain->node[nodeIndex].boundary->Heat->heightTemperature = myHeight;
 
    return(CRIT3D_OK);
 }
 
+/*!
+ * \brief Set the hourly boundary forcing of a list of heat boundary nodes
+ * \param nrNodes
+ * \param nodeIndex  nrNodes indices of boundary nodes
+ * \param forcing    struct of arrays (nrNodes values each), nullptr members are not modified
+ * \return OK/ERROR (all nodes are checked before any value is set)
+ */
+int DLL_EXPORT __STDCALL setHeatBoundaryForcing(long nrNodes, const long *nodeIndex, const TheatBoundaryForcing *forcing)
+{
+    TCrit3DDomain *myDomain = getCurrentDomain();
+
+    if (myDomain->node == nullptr) return(MEMORY_ERROR);
+    if (nrNodes < 0 || nodeIndex == nullptr || forcing == nullptr) return(PARAMETER_ERROR);
+
+    for (long k = 0; k < nrNodes; k++)
+    {
+        long i = nodeIndex[k];
+        if ((i < 0) || (i >= myDomain->structure.nrNodes)) return(INDEX_ERROR);
+
+        if (myDomain->node[i].boundary == nullptr || myDomain->node[i].boundary->Heat == nullptr)
+            return (BOUNDARY_ERROR);
+
+        if (forcing->windSpeed != nullptr && forcing->windSpeed[k] < 0) return(PARAMETER_ERROR);
+    }
+
+    for (long k = 0; k < nrNodes; k++)
+    {
+        TboundaryHeat *boundaryHeat = myDomain->node[nodeIndex[k]].boundary->Heat;
+
+        if (forcing->temperature != nullptr) boundaryHeat->temperature = forcing->temperature[k];
+        if (forcing->relativeHumidity != nullptr) boundaryHeat->relativeHumidity = forcing->relativeHumidity[k];
+        if (forcing->windSpeed != nullptr) boundaryHeat->windSpeed = forcing->windSpeed[k];
+        if (forcing->netIrradiance != nullptr) boundaryHeat->netIrradiance = forcing->netIrradiance[k];
+    }
+
+    return(CRIT3D_OK);
+}
+
 /*!
  * \brief return node temperature
  * \param nodeIndex
@@ -1145,11 +1596,13 @@ int DLL_EXPORT __STDCALL setHeatBoundaryHeightTemperature(long nodeIndex, double
 */
 double DLL_EXPORT __STDCALL getTemperature(long nodeIndex)
 {
-    if (myNode == nullptr) return(TOPOGRAPHY_ERROR);
-    if ((nodeIndex >= myStructure.nrNodes)) return(INDEX_ERROR);
-    if (! isHeatNode(nodeIndex)) return (MEMORY_ERROR);
+    TCrit3DDomain *myDomain = getCurrentDomain();
 
-    return (myNode[nodeIndex].extra->Heat->T);
+    if (myDomain->node == nullptr) return(TOPOGRAPHY_ERROR);
+    if ((nodeIndex >= myDomain->structure.nrNodes)) return(INDEX_ERROR);
+    if (! isHeatNode(myDomain, nodeIndex)) return (MEMORY_ERROR);
+
+    return (myDomain->node[nodeIndex].extra->Heat->T);
 }
 
 /*!
@@ -1159,11 +1612,13 @@ double DLL_EXPORT __STDCALL getTemperature(long nodeIndex)
  */
 double DLL_EXPORT __STDCALL getHeatConductivity(long nodeIndex)
 {
-    if (myNode == nullptr) return(TOPOGRAPHY_ERROR);
-    if ((nodeIndex >= myStructure.nrNodes)) return(INDEX_ERROR);
-    if (! isHeatNode(nodeIndex)) return (MEMORY_ERROR);
+    TCrit3DDomain *myDomain = getCurrentDomain();
+
+    if (myDomain->node == nullptr) return(TOPOGRAPHY_ERROR);
+    if ((nodeIndex >= myDomain->structure.nrNodes)) return(INDEX_ERROR);
+    if (! isHeatNode(myDomain, nodeIndex)) return (MEMORY_ERROR);
 
-   return SoilHeatConductivity(nodeIndex, myNode[nodeIndex].extra->Heat->T, myNode[nodeIndex].H - myNode[nodeIndex].z);
+   return SoilHeatConductivity(myDomain, nodeIndex, myDomain->node[nodeIndex].extra->Heat->T, myDomain->nodeState.H[nodeIndex] - myDomain->node[nodeIndex].z);
 }
 
 /*!
@@ -1174,9 +1629,11 @@ double DLL_EXPORT __STDCALL getHeatConductivity(long nodeIndex)
 */
 float DLL_EXPORT __STDCALL getHeatFlux(long nodeIndex, short myDirection, int fluxType)
 {
-    if (myNode == nullptr) return(TOPOGRAPHY_ERROR);
-    if ((nodeIndex >= myStructure.nrNodes)) return(INDEX_ERROR);
-    if (! isHeatNode(nodeIndex)) return (MEMORY_ERROR);
+    TCrit3DDomain *myDomain = getCurrentDomain();
+
+    if (myDomain->node == nullptr) return(TOPOGRAPHY_ERROR);
+    if ((nodeIndex >= myDomain->structure.nrNodes)) return(INDEX_ERROR);
+    if (! isHeatNode(myDomain, nodeIndex)) return (MEMORY_ERROR);
 
     float myMaxFlux = 0.;
     float myFlux;
@@ -1184,15 +1641,15 @@ float DLL_EXPORT __STDCALL getHeatFlux(long nodeIndex, short myDirection, int fl
     switch (myDirection)
     {
     case UP:
-        return readHeatFlux(&(myNode[nodeIndex].up), fluxType);
+        return readHeatFlux(myDomain, &(myDomain->node[nodeIndex].up), fluxType);
 
     case DOWN:
-        return readHeatFlux(&(myNode[nodeIndex].down), fluxType);
+        return readHeatFlux(myDomain, &(myDomain->node[nodeIndex].down), fluxType);
 
     case LATERAL:
-        for (short i = 0; i < myStructure.nrLateralLinks; i++)
+        for (short i = 0; i < myDomain->structure.nrLateralLinks; i++)
         {
-            myFlux = readHeatFlux(&(myNode[nodeIndex].lateral[i]), fluxType);
+            myFlux = readHeatFlux(myDomain, &(myDomain->node[nodeIndex].lateral[i]), fluxType);
             if (myFlux != NODATA && myFlux > fabs(myMaxFlux))
                 myMaxFlux = myFlux;
         }
@@ -1209,14 +1666,16 @@ float DLL_EXPORT __STDCALL getHeatFlux(long nodeIndex, short myDirection, int fl
 */
 double DLL_EXPORT __STDCALL getBoundarySensibleFlux(long nodeIndex)
 {
-    if (myNode == nullptr) return (TOPOGRAPHY_ERROR);
-    if (nodeIndex >= myStructure.nrNodes) return (INDEX_ERROR);
-    if (! myStructure.computeHeat) return (MISSING_DATA_ERROR);
-    if (myNode[nodeIndex].boundary == nullptr) return (INDEX_ERROR);
-    if (myNode[nodeIndex].boundary->type != BOUNDARY_HEAT_SURFACE) return (INDEX_ERROR);
+    TCrit3DDomain *myDomain = getCurrentDomain();
+
+    if (myDomain->node == nullptr) return (TOPOGRAPHY_ERROR);
+    if (nodeIndex >= myDomain->structure.nrNodes) return (INDEX_ERROR);
+    if (! myDomain->structure.computeHeat) return (MISSING_DATA_ERROR);
+    if (myDomain->node[nodeIndex].boundary == nullptr) return (INDEX_ERROR);
+    if (myDomain->node[nodeIndex].boundary->type != BOUNDARY_HEAT_SURFACE) return (INDEX_ERROR);
 
     // boundary sensible heat flow density
-    return (myNode[nodeIndex].boundary->Heat->sensibleFlux);
+    return (myDomain->node[nodeIndex].boundary->Heat->sensibleFlux);
 }
 
 
@@ -1227,14 +1686,16 @@ double DLL_EXPORT __STDCALL getBoundarySensibleFlux(long nodeIndex)
 */
 double DLL_EXPORT __STDCALL getBoundaryLatentFlux(long nodeIndex)
 {
-    if (myNode == nullptr) return (TOPOGRAPHY_ERROR);
-    if (nodeIndex >= myStructure.nrNodes) return (INDEX_ERROR);
-    if (! myStructure.computeHeat || ! myStructure.computeWater || ! myStructure.computeHeatVapor) return (MISSING_DATA_ERROR);
-    if (myNode[nodeIndex].boundary == nullptr) return (INDEX_ERROR);
-    if (myNode[nodeIndex].boundary->type != BOUNDARY_HEAT_SURFACE) return (INDEX_ERROR);
+    TCrit3DDomain *myDomain = getCurrentDomain();
+
+    if (myDomain->node == nullptr) return (TOPOGRAPHY_ERROR);
+    if (nodeIndex >= myDomain->structure.nrNodes) return (INDEX_ERROR);
+    if (! myDomain->structure.computeHeat || ! myDomain->structure.computeWater || ! myDomain->structure.computeHeatVapor) return (MISSING_DATA_ERROR);
+    if (myDomain->node[nodeIndex].boundary == nullptr) return (INDEX_ERROR);
+    if (myDomain->node[nodeIndex].boundary->type != BOUNDARY_HEAT_SURFACE) return (INDEX_ERROR);
 
     // boundary latent heat flow density
-    return (myNode[nodeIndex].boundary->Heat->latentFlux);
+    return (myDomain->node[nodeIndex].boundary->Heat->latentFlux);
 }
 
 /*!
@@ -1244,15 +1705,17 @@ double DLL_EXPORT __STDCALL getBoundaryLatentFlux(long nodeIndex)
 */
 double DLL_EXPORT __STDCALL getBoundaryAdvectiveFlux(long nodeIndex)
 {
-    if (myNode == nullptr) return (TOPOGRAPHY_ERROR);
-    if (nodeIndex >= myStructure.nrNodes) return (INDEX_ERROR);
-    if (! myStructure.computeHeat || ! myStructure.computeWater || ! myStructure.computeHeatAdvection) return (MISSING_DATA_ERROR);
-    if (myNode[nodeIndex].boundary == nullptr) return (BOUNDARY_ERROR);
-    if (myNode[nodeIndex].boundary->Heat == nullptr) return (BOUNDARY_ERROR);
-    if (myNode[nodeIndex].boundary->type != BOUNDARY_HEAT_SURFACE) return (BOUNDARY_ERROR);
+    TCrit3DDomain *myDomain = getCurrentDomain();
+
+    if (myDomain->node == nullptr) return (TOPOGRAPHY_ERROR);
+    if (nodeIndex >= myDomain->structure.nrNodes) return (INDEX_ERROR);
+    if (! myDomain->structure.computeHeat || ! myDomain->structure.computeWater || ! myDomain->structure.computeHeatAdvection) return (MISSING_DATA_ERROR);
+    if (myDomain->node[nodeIndex].boundary == nullptr) return (BOUNDARY_ERROR);
+    if (myDomain->node[nodeIndex].boundary->Heat == nullptr) return (BOUNDARY_ERROR);
+    if (myDomain->node[nodeIndex].boundary->type != BOUNDARY_HEAT_SURFACE) return (BOUNDARY_ERROR);
 
     // boundary advective heat flow density
-    return (myNode[nodeIndex].boundary->Heat->advectiveHeatFlux);
+    return (myDomain->node[nodeIndex].boundary->Heat->advectiveHeatFlux);
 }
 
 /*!
@@ -1262,14 +1725,16 @@ double DLL_EXPORT __STDCALL getBoundaryAdvectiveFlux(long nodeIndex)
 */
 double DLL_EXPORT __STDCALL getBoundaryRadiativeFlux(long nodeIndex)
 {
-    if (myNode == nullptr) return (TOPOGRAPHY_ERROR);
-    if (nodeIndex >= myStructure.nrNodes) return (INDEX_ERROR);
-    if (! myStructure.computeHeat) return (MISSING_DATA_ERROR);
-    if (myNode[nodeIndex].boundary == nullptr) return (INDEX_ERROR);
-    if (myNode[nodeIndex].boundary->type != BOUNDARY_HEAT_SURFACE) return (INDEX_ERROR);
+    TCrit3DDomain *myDomain = getCurrentDomain();
+
+    if (myDomain->node == nullptr) return (TOPOGRAPHY_ERROR);
+    if (nodeIndex >= myDomain->structure.nrNodes) return (INDEX_ERROR);
+    if (! myDomain->structure.computeHeat) return (MISSING_DATA_ERROR);
+    if (myDomain->node[nodeIndex].boundary == nullptr) return (INDEX_ERROR);
+    if (myDomain->node[nodeIndex].boundary->type != BOUNDARY_HEAT_SURFACE) return (INDEX_ERROR);
 
     // boundary net radiative heat flow density
-    return (myNode[nodeIndex].boundary->Heat->radiativeFlux);
+    return (myDomain->node[nodeIndex].boundary->Heat->radiativeFlux);
 }
 
 /*!
@@ -1279,14 +1744,16 @@ double DLL_EXPORT __STDCALL getBoundaryRadiativeFlux(long nodeIndex)
 */
 double DLL_EXPORT __STDCALL getBoundaryAerodynamicConductance(long nodeIndex)
 {
-    if (myNode == nullptr) return (TOPOGRAPHY_ERROR);
-    if (nodeIndex >= myStructure.nrNodes) return (INDEX_ERROR);
-    if (! myStructure.computeHeat) return (MISSING_DATA_ERROR);
-    if (myNode[nodeIndex].boundary == nullptr) return (INDEX_ERROR);
-    if (myNode[nodeIndex].boundary->type != BOUNDARY_HEAT_SURFACE) return (INDEX_ERROR);
+    TCrit3DDomain *myDomain = getCurrentDomain();
+
+    if (myDomain->node == nullptr) return (TOPOGRAPHY_ERROR);
+    if (nodeIndex >= myDomain->structure.nrNodes) return (INDEX_ERROR);
+    if (! myDomain->structure.computeHeat) return (MISSING_DATA_ERROR);
+    if (myDomain->node[nodeIndex].boundary == nullptr) return (INDEX_ERROR);
+    if (myDomain->node[nodeIndex].boundary->type != BOUNDARY_HEAT_SURFACE) return (INDEX_ERROR);
 
     // boundary aerodynamic resistance
-    return (myNode[nodeIndex].boundary->Heat->aerodynamicConductance);
+    return (myDomain->node[nodeIndex].boundary->Heat->aerodynamicConductance);
 }
 
 
@@ -1317,14 +1784,16 @@ double DLL_EXPORT getBoundaryAerodynamicConductanceOpenWater(long nodeIndex)
 */
 double DLL_EXPORT __STDCALL getBoundarySoilConductance(long nodeIndex)
 {
-    if (myNode == nullptr) return (TOPOGRAPHY_ERROR);
-    if (nodeIndex >= myStructure.nrNodes) return (INDEX_ERROR);
-    if (! myStructure.computeHeat) return (MISSING_DATA_ERROR);
-    if (myNode[nodeIndex].boundary == nullptr) return (INDEX_ERROR);
-    if (myNode[nodeIndex].boundary->type != BOUNDARY_HEAT_SURFACE) return (INDEX_ERROR);
+    TCrit3DDomain *myDomain = getCurrentDomain();
+
+    if (myDomain->node == nullptr) return (TOPOGRAPHY_ERROR);
+    if (nodeIndex >= myDomain->structure.nrNodes) return (INDEX_ERROR);
+    if (! myDomain->structure.computeHeat) return (MISSING_DATA_ERROR);
+    if (myDomain->node[nodeIndex].boundary == nullptr) return (INDEX_ERROR);
+    if (myDomain->node[nodeIndex].boundary->type != BOUNDARY_HEAT_SURFACE) return (INDEX_ERROR);
 
     // boundary soil conductance
-    return (myNode[nodeIndex].boundary->Heat->soilConductance);
+    return (myDomain->node[nodeIndex].boundary->Heat->soilConductance);
 }
 
 /*!
@@ -1334,12 +1803,14 @@ double DLL_EXPORT __STDCALL getBoundarySoilConductance(long nodeIndex)
 */
 double DLL_EXPORT __STDCALL getNodeVapor(long i)
 {
-    if (myNode == nullptr) return(TOPOGRAPHY_ERROR);
-    if (i >= myStructure.nrNodes) return(INDEX_ERROR);
-    if (! myStructure.computeHeat || ! myStructure.computeWater || ! myStructure.computeHeatVapor) return (MISSING_DATA_ERROR);
+    TCrit3DDomain *myDomain = getCurrentDomain();
+
+    if (myDomain->node == nullptr) return(TOPOGRAPHY_ERROR);
+    if (i >= myDomain->structure.nrNodes) return(INDEX_ERROR);
+    if (! myDomain->structure.computeHeat || ! myDomain->structure.computeWater || ! myDomain->structure.computeHeatVapor) return (MISSING_DATA_ERROR);
 
-    double h = myNode[i].H - myNode[i].z;
-    double T = myNode[i].extra->Heat->T;
+    double h = myDomain->nodeState.H[i] - myDomain->node[i].z;
+    double T = myDomain->node[i].extra->Heat->T;
 
     return VaporFromPsiTemp(h, T);
 }
@@ -1351,18 +1822,20 @@ double DLL_EXPORT __STDCALL getNodeVapor(long i)
 */
 double DLL_EXPORT __STDCALL getHeat(long i, double h)
 {
-    if (myNode == nullptr) return(TOPOGRAPHY_ERROR);
-    if (i >= myStructure.nrNodes) return(INDEX_ERROR);
-    if (! myStructure.computeHeat) return (MISSING_DATA_ERROR);
-    if (myNode[i].extra->Heat == nullptr) return MISSING_DATA_ERROR;
-    if (myNode[i].extra->Heat->T == NODATA) return MISSING_DATA_ERROR;
+    TCrit3DDomain *myDomain = getCurrentDomain();
+
+    if (myDomain->node == nullptr) return(TOPOGRAPHY_ERROR);
+    if (i >= myDomain->structure.nrNodes) return(INDEX_ERROR);
+    if (! myDomain->structure.computeHeat) return (MISSING_DATA_ERROR);
+    if (myDomain->node[i].extra->Heat == nullptr) return MISSING_DATA_ERROR;
+    if (myDomain->node[i].extra->Heat->T == NODATA) return MISSING_DATA_ERROR;
 
-    double myHeat = SoilHeatCapacity(i, h, myNode[i].extra->Heat->T) * myNode[i].volume_area  * myNode[i].extra->Heat->T;
+    double myHeat = SoilHeatCapacity(myDomain, i, h, myDomain->node[i].extra->Heat->T) * myDomain->node[i].volume_area  * myDomain->node[i].extra->Heat->T;
 
-    if (myStructure.computeWater && myStructure.computeHeatVapor)
+    if (myDomain->structure.computeWater && myDomain->structure.computeHeatVapor)
     {
-        double thetaV = VaporThetaV(h, myNode[i].extra->Heat->T, i);
-        myHeat += thetaV * LatentHeatVaporization(myNode[i].extra->Heat->T - ZEROCELSIUS) * WATER_DENSITY * myNode[i].volume_area;
+        double thetaV = VaporThetaV(myDomain, h, myDomain->node[i].extra->Heat->T, i);
+        myHeat += thetaV * LatentHeatVaporization(myDomain->node[i].extra->Heat->T - ZEROCELSIUS) * WATER_DENSITY * myDomain->node[i].volume_area;
     }
 
     return (myHeat);
@@ -28,6 +28,9 @@ win32:{
     TARGET = soilFluxes3D
 }
 
+# multicolor relaxation (RELAXATION_MULTICOLOR): link the application with -fopenmp
+*-g++*:QMAKE_CXXFLAGS += -fopenmp
+
 # do not include mathFunctions to compile as dll
 
 SOURCES +=  \
@@ -35,11 +38,15 @@ SOURCES +=  \
     balance.cpp \
     water.cpp \
     solver.cpp \
+    krylov.cpp \
+    hydraulicTable.cpp \
+    state.cpp \
     memory.cpp \
     soilPhysics.cpp \
     soilFluxes3D.cpp \
     heat.cpp \
-    extra.cpp
+    extra.cpp \
+    domain.cpp
 
 
 HEADERS += \
@@ -49,8 +56,12 @@ HEADERS += \
     header/balance.h \
     header/water.h \
     header/solver.h \
+    header/krylov.h \
+    header/hydraulicTable.h \
+    header/state.h \
     header/memory.h \
     header/soilPhysics.h \
     header/soilFluxes3D.h \
     header/extra.h \
-    header/heat.h
+    header/heat.h \
+    header/domain.h
@@ -35,15 +35,16 @@
 #include "header/solver.h"
 #include "header/heat.h"
 #include "header/extra.h"
+#include "header/domain.h"
 
      /*!
      * \brief Computes volumetric water content from current degree of saturation
      * \param myIndex
      * \return result
      */
-	double theta_from_Se (unsigned long myIndex)
+	double theta_from_Se (TCrit3DDomain *myDomain, unsigned long myIndex)
 	{
-		return ((myNode[myIndex].Se * (myNode[myIndex].Soil->Theta_s - myNode[myIndex].Soil->Theta_r)) + myNode[myIndex].Soil->Theta_r);
+		return ((myDomain->nodeState.Se[myIndex] * (myDomain->node[myIndex].Soil->Theta_s - myDomain->node[myIndex].Soil->Theta_r)) + myDomain->node[myIndex].Soil->Theta_r);
 	}
 
     /*!
@@ -52,9 +53,9 @@
      * \param myIndex
      * \return result
      */
-	double theta_from_Se (double Se, unsigned long myIndex)
+	double theta_from_Se (TCrit3DDomain *myDomain, double Se, unsigned long myIndex)
 	{
-		return ((Se * (myNode[myIndex].Soil->Theta_s - myNode[myIndex].Soil->Theta_r)) + myNode[myIndex].Soil->Theta_r);
+		return ((Se * (myDomain->node[myIndex].Soil->Theta_s - myDomain->node[myIndex].Soil->Theta_r)) + myDomain->node[myIndex].Soil->Theta_r);
 	}
 
     /*!
@@ -63,19 +64,19 @@
      * \param index
      * \return result
      */
-    double theta_from_sign_Psi (double signPsi, unsigned long index)
+    double theta_from_sign_Psi (TCrit3DDomain *myDomain, double signPsi, unsigned long index)
 	{
-        if (myNode[index].isSurface) return 1.;
+        if (myDomain->node[index].isSurface) return 1.;
 
         if (signPsi >= 0.0)
         {
             /*! saturated */
-            return myNode[index].Soil->Theta_s;
+            return myDomain->node[index].Soil->Theta_s;
         }
 		else
         {
-            double Se = computeSefromPsi(fabs(signPsi),myNode[index].Soil);
-            return theta_from_Se(Se, index);
+            double Se = computeSefromPsi(myDomain, fabs(signPsi),myDomain->node[index].Soil);
+            return theta_from_Se(myDomain, Se, index);
         }
 	}
 
@@ -86,12 +87,12 @@
      * \param theta
      * \return result
      */
-	double Se_from_theta (unsigned long myIndex, double theta)
+	double Se_from_theta (TCrit3DDomain *myDomain, unsigned long myIndex, double theta)
 	{
         /*! check range */
-		if (theta >= myNode[myIndex].Soil->Theta_s) return(1.);
-		else if (theta <= myNode[myIndex].Soil->Theta_r) return(0.);
-		else return ((theta - myNode[myIndex].Soil->Theta_r) / (myNode[myIndex].Soil->Theta_s - myNode[myIndex].Soil->Theta_r));
+		if (theta >= myDomain->node[myIndex].Soil->Theta_s) return(1.);
+		else if (theta <= myDomain->node[myIndex].Soil->Theta_r) return(0.);
+		else return ((theta - myDomain->node[myIndex].Soil->Theta_r) / (myDomain->node[myIndex].Soil->Theta_s - myDomain->node[myIndex].Soil->Theta_r));
 	}
 
     /*!
@@ -100,11 +101,11 @@
      * \param mySoil
      * \return result Se
      */
-    double computeSefromPsi(double myPsi, Tsoil *mySoil)
+    double computeSefromPsi(TCrit3DDomain *myDomain, double myPsi, Tsoil *mySoil)
 	{
 		double Se = NODATA;
 
-        if (myParameters.waterRetentionCurve == MODIFIEDVANGENUCHTEN)
+        if (myDomain->parameters.waterRetentionCurve == MODIFIEDVANGENUCHTEN)
 			if (myPsi <=  mySoil->VG_he)
 				Se = 1.;
 			else
@@ -112,7 +113,7 @@
                 Se = pow(1. + pow(mySoil->VG_alpha * myPsi, mySoil->VG_n), - mySoil->VG_m);
 				Se *= (1. / mySoil->VG_Sc);
 				}
-        else if (myParameters.waterRetentionCurve == VANGENUCHTEN)
+        else if (myDomain->parameters.waterRetentionCurve == VANGENUCHTEN)
             Se = pow(1. + pow(mySoil->VG_alpha * myPsi, mySoil->VG_n), - mySoil->VG_m);
 
 		return Se;
@@ -123,14 +124,14 @@
      * \param myIndex
      * \return result
      */
-    double computeSe(unsigned long myIndex)
+    double computeSe(TCrit3DDomain *myDomain, unsigned long myIndex)
     {
         /*! saturated */
-        if (myNode[myIndex].H >= myNode[myIndex].z) return 1.;
+        if (myDomain->nodeState.H[myIndex] >= myDomain->node[myIndex].z) return 1.;
 
-        double psi = fabs(myNode[myIndex].H - myNode[myIndex].z);   /*!< [m] */
+        double psi = fabs(myDomain->nodeState.H[myIndex] - myDomain->node[myIndex].z);   /*!< [m] */
 
-        return computeSefromPsi(psi, myNode[myIndex].Soil);
+        return computeSefromPsi(myDomain, psi, myDomain->node[myIndex].Soil);
     }
 
 
@@ -142,17 +143,17 @@
      * \param mySoil Tsoil pointer
      * \return result
      */
-    double computeWaterConductivity(double Se, Tsoil *mySoil)
+    double computeWaterConductivity(TCrit3DDomain *myDomain, double Se, Tsoil *mySoil)
 	{
 		if (Se >= 1.) return(mySoil->K_sat );
 
 		double myTmp = NODATA;
-        if (myParameters.waterRetentionCurve == MODIFIEDVANGENUCHTEN)
+        if (myDomain->parameters.waterRetentionCurve == MODIFIEDVANGENUCHTEN)
 		{
 			double myNumerator = 1. - pow(1. - pow(Se*mySoil->VG_Sc, 1./mySoil->VG_m), mySoil->VG_m);
 			myTmp = myNumerator / (1. - pow(1. - pow(mySoil->VG_Sc, 1./mySoil->VG_m), mySoil->VG_m));
 		}
-        else if (myParameters.waterRetentionCurve == VANGENUCHTEN)
+        else if (myDomain->parameters.waterRetentionCurve == VANGENUCHTEN)
 			myTmp = 1. - pow(1. - pow(Se, 1./mySoil->VG_m), mySoil->VG_m);
 
 		return (mySoil->K_sat * pow(Se, mySoil->Mualem_L) * pow(myTmp , 2.));
@@ -171,17 +172,17 @@
      * \param Mualem_L
      * \return result
      */
-    double compute_K_Mualem(double Ksat, double Se, double VG_Sc, double VG_m, double Mualem_L)
+    double compute_K_Mualem(TCrit3DDomain *myDomain, double Ksat, double Se, double VG_Sc, double VG_m, double Mualem_L)
 	{
 		if (Se >= 1.) return(Ksat);
 		double temp= NODATA;
 
-        if (myParameters.waterRetentionCurve == MODIFIEDVANGENUCHTEN)
+        if (myDomain->parameters.waterRetentionCurve == MODIFIEDVANGENUCHTEN)
         {
             double num = 1. - pow(1. - pow(Se*VG_Sc, 1./VG_m), VG_m);
             temp = num / (1. - pow(1. - pow(VG_Sc, 1./VG_m), VG_m));
         }
-        else if (myParameters.waterRetentionCurve == VANGENUCHTEN)
+        else if (myDomain->parameters.waterRetentionCurve == VANGENUCHTEN)
         {
 			temp = 1. - pow(1. - pow(Se, 1./VG_m), VG_m);
         }
@@ -195,43 +196,50 @@
      * \param myIndex
      * \return result
      */
-    double computeK(unsigned long myIndex)
+    double computeK(TCrit3DDomain *myDomain, unsigned long myIndex)
     {
-        double k = compute_K_Mualem(myNode[myIndex].Soil->K_sat, myNode[myIndex].Se,
-                                myNode[myIndex].Soil->VG_Sc, myNode[myIndex].Soil->VG_m,
-                                myNode[myIndex].Soil->Mualem_L);
+        double k = compute_K_Mualem(myDomain, myDomain->node[myIndex].Soil->K_sat, myDomain->nodeState.Se[myIndex],
+                                myDomain->node[myIndex].Soil->VG_Sc, myDomain->node[myIndex].Soil->VG_m,
+                                myDomain->node[myIndex].Soil->Mualem_L);
 
         // vapor isothermal flow
-        if (myStructure.computeHeat && myStructure.computeHeatVapor)
-        {
-            double avgT = getTMean(myIndex);
-            double kv = IsothermalVaporConductivity(myIndex, myNode[myIndex].H - myNode[myIndex].z, avgT);
-            // from kg s m-3 to m s-1
-            kv *= (GRAVITY / WATER_DENSITY);
-
-            k += kv;
-        }
+        if (myDomain->structure.computeHeat && myDomain->structure.computeHeatVapor)
+            k += computeVaporK(myDomain, myIndex);
 
         return k;
     }
 
 
+    /*!
+     * \brief Computes current isothermal vapor conductivity [m sec^-1]
+     * \param myIndex
+     * \return result
+     */
+    double computeVaporK(TCrit3DDomain *myDomain, unsigned long myIndex)
+    {
+        double avgT = getTMean(myDomain, myIndex);
+        double kv = IsothermalVaporConductivity(myDomain, myIndex, myDomain->nodeState.H[myIndex] - myDomain->node[myIndex].z, avgT);
+        // from kg s m-3 to m s-1
+        return kv * (GRAVITY / WATER_DENSITY);
+    }
+
+
     /*!
      * \brief Computes Water Potential from degree of saturation
      * \param myIndex
      * \return result
      */
-    double psi_from_Se(unsigned long myIndex)
+    double psi_from_Se(TCrit3DDomain *myDomain, unsigned long myIndex)
 	{
-		double m = myNode[myIndex].Soil->VG_m;
+		double m = myDomain->node[myIndex].Soil->VG_m;
 		double temp = NODATA;
 
-        if (myParameters.waterRetentionCurve == MODIFIEDVANGENUCHTEN)
-				temp = pow(1./ (myNode[myIndex].Se * myNode[myIndex].Soil->VG_Sc) , 1./ m ) - 1.;
-        else if (myParameters.waterRetentionCurve == VANGENUCHTEN)
-				temp = pow(1./ myNode[myIndex].Se, 1./ m ) - 1.;
+        if (myDomain->parameters.waterRetentionCurve == MODIFIEDVANGENUCHTEN)
+				temp = pow(1./ (myDomain->nodeState.Se[myIndex] * myDomain->node[myIndex].Soil->VG_Sc) , 1./ m ) - 1.;
+        else if (myDomain->parameters.waterRetentionCurve == VANGENUCHTEN)
+				temp = pow(1./ myDomain->nodeState.Se[myIndex], 1./ m ) - 1.;
 
-        return((1./ myNode[myIndex].Soil->VG_alpha) * pow(temp, 1./ myNode[myIndex].Soil->VG_n));
+        return((1./ myDomain->node[myIndex].Soil->VG_alpha) * pow(temp, 1./ myDomain->node[myIndex].Soil->VG_n));
 	}
 
     /*!
@@ -239,18 +247,38 @@
      * \param myIndex
      * \return derivative of vapor volumetric content with respect to H
      */
-    double dThetav_dH(unsigned long i, double temperature, double dTheta_dH)
+    double dThetav_dH(TCrit3DDomain *myDomain, unsigned long i, double temperature, double dTheta_dH)
     {
-        double h = myNode[i].H - myNode[i].z;
+        double h = myDomain->nodeState.H[i] - myDomain->node[i].z;
         double hr = SoilRelativeHumidity(h, temperature);
         double satVapPressure = SaturationVaporPressure(temperature - ZEROCELSIUS);
         double satVapConc = VaporConcentrationFromPressure(satVapPressure, temperature);
-        double theta = theta_from_sign_Psi(h, i);
+        double theta = theta_from_sign_Psi(myDomain, h, i);
         double dThetav_dPsi = (satVapConc * hr / WATER_DENSITY) *
-                ((myNode[i].Soil->Theta_s - theta) * MH2O / (R_GAS * temperature) - dTheta_dH / GRAVITY);
+                ((myDomain->node[i].Soil->Theta_s - theta) * MH2O / (R_GAS * temperature) - dTheta_dH / GRAVITY);
         return dThetav_dPsi * GRAVITY;
     }
 
+    /*!
+     * \brief [m-1] dSe/dPsi  (Van Genutchen)
+     * dSe/dPsi = alfa n m [1+(alfa psi)^n]^(-m-1) (alfa psi)^n-1
+     * \param psi [m] matric potential (absolute value)
+     * \param mySoil
+     * \return derivative of degree of saturation with respect to psi (absolute value)
+     */
+    double dSe_dPsi(TCrit3DDomain *myDomain, double psi, Tsoil *mySoil)
+    {
+        double alfa = mySoil->VG_alpha;
+        double n    = mySoil->VG_n;
+        double m    = mySoil->VG_m;
+
+        double dSe = alfa * n * m * pow(1. + pow(alfa * psi, n), -(m + 1.)) * pow(alfa * psi, n - 1.);
+        if (myDomain->parameters.waterRetentionCurve == MODIFIEDVANGENUCHTEN)
+            dSe *= (1. / mySoil->VG_Sc);
+
+        return dSe;
+    }
+
     /*!
      * \brief [m-1] dTheta/dH  (Van Genutchen)
      * dTheta/dH = dSe/dH (Theta_s-Theta_r)
@@ -258,79 +286,72 @@
      * \param myIndex
      * \return derivative of water volumetric content with respect to H
      */
-	double dTheta_dH(unsigned long myIndex)
+	double dTheta_dH(TCrit3DDomain *myDomain, unsigned long myIndex)
 	 {
-     double alfa = myNode[myIndex].Soil->VG_alpha;
-	 double n    = myNode[myIndex].Soil->VG_n;
-	 double m    = myNode[myIndex].Soil->VG_m;
 	 double dSe_dH;
 
-     double psi = fabs(minValue(myNode[myIndex].H - myNode[myIndex].z, 0.));
-     double psiPrevious = fabs(minValue(myNode[myIndex].oldH - myNode[myIndex].z, 0.));
+     double psi = fabs(minValue(myDomain->nodeState.H[myIndex] - myDomain->node[myIndex].z, 0.));
+     double psiPrevious = fabs(minValue(myDomain->nodeState.oldH[myIndex] - myDomain->node[myIndex].z, 0.));
 
-    if (myParameters.waterRetentionCurve == MODIFIEDVANGENUCHTEN)
-		{ if ((psi <= myNode[myIndex].Soil->VG_he) && (psiPrevious <= myNode[myIndex].Soil->VG_he)) return 0.;}
-    else if (myParameters.waterRetentionCurve == VANGENUCHTEN)
+    if (myDomain->parameters.waterRetentionCurve == MODIFIEDVANGENUCHTEN)
+		{ if ((psi <= myDomain->node[myIndex].Soil->VG_he) && (psiPrevious <= myDomain->node[myIndex].Soil->VG_he)) return 0.;}
+    else if (myDomain->parameters.waterRetentionCurve == VANGENUCHTEN)
 		{ if ((psi == 0.) && (psiPrevious == 0.)) return 0.;}
 
 	 if (psi == psiPrevious)
-			{
-			dSe_dH = alfa * n * m * pow(1. + pow(alfa * psi, n), -(m + 1.)) * pow(alfa * psi, n - 1.);
-            if (myParameters.waterRetentionCurve == MODIFIEDVANGENUCHTEN)
-					dSe_dH *= (1. / myNode[myIndex].Soil->VG_Sc);
-			}
+            dSe_dH = dSe_dPsi(myDomain, psi, myDomain->node[myIndex].Soil);
 	 else
 			{
-            double theta = computeSefromPsi(psi, myNode[myIndex].Soil);
-            double thetaPrevious = computeSefromPsi(psiPrevious, myNode[myIndex].Soil);
-			double delta_H = myNode[myIndex].H - myNode[myIndex].oldH;
+            double theta = computeSefromPsi(myDomain, psi, myDomain->node[myIndex].Soil);
+            double thetaPrevious = computeSefromPsi(myDomain, psiPrevious, myDomain->node[myIndex].Soil);
+			double delta_H = myDomain->nodeState.H[myIndex] - myDomain->nodeState.oldH[myIndex];
 			dSe_dH = fabs((theta - thetaPrevious) / delta_H);
 			}
 
-	 return (dSe_dH * (myNode[myIndex].Soil->Theta_s - myNode[myIndex].Soil->Theta_r));
+	 return (dSe_dH * (myDomain->node[myIndex].Soil->Theta_s - myDomain->node[myIndex].Soil->Theta_r));
 	 }
 
-    double getThetaMean(long i)
+    double getThetaMean(TCrit3DDomain *myDomain, long i)
 	{
-        double myHMean = getHMean(i);
+        double myHMean = getHMean(myDomain, i);
 
-		if (myNode[i].isSurface)
+		if (myDomain->node[i].isSurface)
 		{
-            double mySurfaceWater = maxValue(myHMean - myNode[i].z, 0.);		//[m]
+            double mySurfaceWater = maxValue(myHMean - myDomain->node[i].z, 0.);		//[m]
             return (minValue(mySurfaceWater / 0.01, 1.));
 		}
 		else
 		{
             /*! sub-surface */
-            return (getTheta(i, myHMean));
+            return (getTheta(myDomain, i, myHMean));
 		}
 	}
 
-    double getTheta(long i, double H)
+    double getTheta(TCrit3DDomain *myDomain, long i, double H)
     {
-        double psi = H - myNode[i].z;
-        return (theta_from_sign_Psi(psi, i));
+        double psi = H - myDomain->node[i].z;
+        return (theta_from_sign_Psi(myDomain, psi, i));
     }
 
-    double getTMean(long i)
+    double getTMean(TCrit3DDomain *myDomain, long i)
     {
-        if (myStructure.computeHeat && myNode[i].extra->Heat != nullptr)
-            return arithmeticMean(myNode[i].extra->Heat->oldT, myNode[i].extra->Heat->T);
+        if (myDomain->structure.computeHeat && myDomain->node[i].extra->Heat != nullptr)
+            return arithmeticMean(myDomain->node[i].extra->Heat->oldT, myDomain->node[i].extra->Heat->T);
         else
             return NODATA;
     }
 
-    double getHMean(long i)
+    double getHMean(TCrit3DDomain *myDomain, long i)
     {
         // is there any efficient way to compute a geometric mean of H?
-        return arithmeticMean(myNode[i].oldH, myNode[i].H);
+        return arithmeticMean(myDomain->nodeState.oldH[i], myDomain->nodeState.H[i]);
     }
 
-    double getPsiMean(long i)
+    double getPsiMean(TCrit3DDomain *myDomain, long i)
 	{
         double Psi;
-        double meanH = getHMean(i);
-        Psi = minValue(0., (meanH - myNode[i].z));
+        double meanH = getHMean(myDomain, i);
+        Psi = minValue(0., (meanH - myDomain->node[i].z));
         return Psi;
 	}
 
@@ -353,17 +374,17 @@
      * \param i
      * \return bulk density (Mg m-3)
      */
-    double estimateBulkDensity(long i)
+    double estimateBulkDensity(TCrit3DDomain *myDomain, long i)
     {
         double particleDensity;
         double totalPorosity;
 
-        particleDensity = ParticleDensity(myNode[i].Soil->organicMatter);
+        particleDensity = ParticleDensity(myDomain->node[i].Soil->organicMatter);
 
-        totalPorosity = myNode[i].Soil->Theta_s;
+        totalPorosity = myDomain->node[i].Soil->Theta_s;
 
         // very small pores not water fillable
-        if (myNode[i].Soil->clay > 0.4)
+        if (myDomain->node[i].Soil->clay > 0.4)
             totalPorosity *= 1.03;
         else
             totalPorosity *= 1.05;
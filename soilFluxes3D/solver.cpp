@@ -29,22 +29,27 @@
 #include <math.h>
 #include <malloc.h>
 
+#include <vector>
+
 #include "../mathFunctions/basicMath.h"
 #include "header/types.h"
+#include "header/memory.h"
+#include "header/krylov.h"
 #include "header/solver.h"
+#include "header/domain.h"
 
 
-double distance(unsigned long i, unsigned long j)
+double distance(TCrit3DDomain *myDomain, unsigned long i, unsigned long j)
 {
-    return (sqrt(square(fabs(myNode[i].x - myNode[j].x))
-        + square(fabs(myNode[i].y - myNode[j].y))
-        + square(fabs(myNode[i].z - myNode[j].z))));
+    return (sqrt(square(fabs(myDomain->node[i].x - myDomain->node[j].x))
+        + square(fabs(myDomain->node[i].y - myDomain->node[j].y))
+        + square(fabs(myDomain->node[i].z - myDomain->node[j].z))));
 }
 
 
-double distance2D(unsigned long i, unsigned long j)
+double distance2D(TCrit3DDomain *myDomain, unsigned long i, unsigned long j)
 {
-    return sqrt(square(fabs(myNode[i].x - myNode[j].x)) + square(fabs(myNode[i].y - myNode[j].y)));
+    return sqrt(square(fabs(myDomain->node[i].x - myDomain->node[j].x)) + square(fabs(myDomain->node[i].y - myDomain->node[j].y)));
 }
 
 double arithmeticMean(double v1, double v2)
@@ -66,11 +71,11 @@ double geometricMean(double v1, double v2)
     return sign * sqrt(v1 * v2);
 }
 
-double computeMean(double v1, double v2)
+double computeMean(TCrit3DDomain *myDomain, double v1, double v2)
 {
-    if (myParameters.meanType == MEAN_LOGARITHMIC)
+    if (myDomain->parameters.meanType == MEAN_LOGARITHMIC)
         return(logarithmicMean(v1, v2));
-    else if (myParameters.meanType == MEAN_GEOMETRIC)
+    else if (myDomain->parameters.meanType == MEAN_GEOMETRIC)
         return(geometricMean(v1, v2));
     else
         //default: logarithmic
@@ -78,129 +83,388 @@ double computeMean(double v1, double v2)
 }
 
 
-TlinkedNode* getLink(long i, long j)
+TlinkedNode* getLink(TCrit3DDomain *myDomain, long i, long j)
 {
-    if (myNode[i].up.index == j) return &(myNode[i].up);
+    if (myDomain->node[i].up.index == j) return &(myDomain->node[i].up);
 
-    if (myNode[i].down.index == j) return &(myNode[i].down);
+    if (myDomain->node[i].down.index == j) return &(myDomain->node[i].down);
 
-    for (short l = 0; l < myStructure.nrLateralLinks; l++)
-         if (myNode[i].lateral[l].index == j) return &(myNode[i].lateral[l]);
+    for (short l = 0; l < myDomain->structure.nrLateralLinks; l++)
+         if (myDomain->node[i].lateral[l].index == j) return &(myDomain->node[i].lateral[l]);
 
     return(nullptr);
 }
 
 
-int calcola_iterazioni_max(int num_approssimazione)
+int calcola_iterazioni_max(TCrit3DDomain *myDomain, int num_approssimazione)
 {
-    float max_iterazioni = float(myParameters.iterazioni_max)
-                            / float(myParameters.maxApproximationsNumber) * float(num_approssimazione + 1);
+    float max_iterazioni = float(myDomain->parameters.iterazioni_max)
+                            / float(myDomain->parameters.maxApproximationsNumber) * float(num_approssimazione + 1);
     return maxValue(20, int(max_iterazioni));
 }
 
 
-double GaussSeidelIterationWater(short direction)
+/*!
+ * \brief product of the off-diagonal elements of row i and x
+ */
+inline double rowProduct(const Tmatrix &matrix, long i, const double *x)
+{
+    const int *index = matrix.index + i * matrix.nrColumns;
+    const double *val = matrix.val + i * matrix.nrColumns;
+    int nrLinks = matrix.nrLinks[i];
+
+    double sum = 0.;
+    for (int k = 0; k < nrLinks; k++)
+        sum += val[k] * x[index[k]];
+
+    return sum;
+}
+
+
+/*!
+ * \brief relaxation of the water potential of node i
+ * \return new value of X[i] and its normalized difference (norm)
+ */
+inline double relaxNodeWater(long i, const TCrit3Dnode *nodes, const Tmatrix &matrix,
+                             const double *x, const double *knownTerm, double *norm)
+{
+    double newX = knownTerm[i] - rowProduct(matrix, i, x);
+
+    /*! surface check */
+    if (nodes[i].isSurface)
+        if (newX < nodes[i].z)
+            newX = nodes[i].z;
+
+    /*! water potential [m] */
+    double psi = fabs(newX - nodes[i].z);
+
+    /*! infinity norm (normalized if psi > 1m) */
+    if (psi > 1.0)
+        *norm = (fabs(newX - x[i])) / psi;
+    else
+        *norm = fabs(newX - x[i]);
+
+    return newX;
+}
+
+
+/*!
+ * \brief relaxation of the temperature of node i
+ * \return new value of X[i]
+ */
+inline double relaxNodeHeat(long i, const Tmatrix &matrix, const double *x, const double *knownTerm)
+{
+    return knownTerm[i] - rowProduct(matrix, i, x);
+}
+
+
+double GaussSeidelIterationWater(TCrit3DDomain *myDomain, short direction)
  {
-    double psi = 0.0, newX = 0.0;
+    double newX = 0.0;
     double norm = 0.0, infinityNorm = 0.0;
-    short j;
     long i, firstIndex, lastIndex;
 
     if (direction == UP)
     {
         firstIndex = 0;
-        lastIndex = myStructure.nrNodes;
+        lastIndex = myDomain->structure.nrNodes;
     }
     else
     {
-        firstIndex = myStructure.nrNodes -1;
+        firstIndex = myDomain->structure.nrNodes -1;
         lastIndex = -1;
     }
 
     i = firstIndex;
     while (i != lastIndex)
     {
-        newX = b[i];
-        j = 1;
-        while ((A[i][j].index != NOLINK) && (j < myStructure.maxNrColumns))
-        {
-            newX -= A[i][j].val * X[A[i][j].index];
-            j++;
-        }
-
-        /*! surface check */
-        if (myNode[i].isSurface)
-            if (newX < myNode[i].z)
-                newX = myNode[i].z;
-
-        /*! water potential [m] */
-        psi = fabs(newX - myNode[i].z);
-
-        /*! infinity norm (normalized if psi > 1m) */
-        if (psi > 1.0)
-            norm = (fabs(newX - X[i])) / psi;
-        else
-            norm = fabs(newX - X[i]);
+        newX = relaxNodeWater(i, myDomain->node, myDomain->A, myDomain->X, myDomain->b, &norm);
 
         if (norm > infinityNorm) infinityNorm = norm;
 
-        X[i] = newX;
+        myDomain->X[i] = newX;
 
         (direction == UP)? i++ : i--;
     }
     return(infinityNorm);
  }
 
-double GaussSeidelIterationHeat()
+double GaussSeidelIterationHeat(TCrit3DDomain *myDomain)
 {
     double delta, new_x, norma_inf = 0.;
-    short j;
 
-    for (long i = 1; i < myStructure.nrNodes; i++)
-        if (!myNode[i].isSurface)
+    for (long i = 1; i < myDomain->structure.nrNodes; i++)
+        if (!myDomain->node[i].isSurface)
         {
-            if (A[i][0].val != 0.)
+            if (myDomain->A.diagonal[i] != 0.)
             {
-                j = 1;
-                new_x = b[i];
-                while ((A[i][j].index != NOLINK) && (j < myStructure.maxNrColumns))
-                {
-                    new_x -= A[i][j].val * X[A[i][j].index];
-                    j++;
-                }
-
-                delta = fabs(new_x - X[i]);
+                new_x = relaxNodeHeat(i, myDomain->A, myDomain->X, myDomain->b);
+
+                delta = fabs(new_x - myDomain->X[i]);
                 if (delta > norma_inf) norma_inf = delta;
-                X[i] = new_x;
+                myDomain->X[i] = new_x;
             }
         }
 
     return(norma_inf);
  }
 
-bool GaussSeidelRelaxation (int approximation, double residualTolerance, int process)
+
+/*!
+ * \brief greedy coloring of the nodes: linked nodes never share the same color,
+ * so all the nodes of a color can be relaxed in parallel
+ * \return OK/ERROR
+ */
+int computeNodeColoring(TCrit3DDomain *myDomain)
+{
+    long nrNodes = myDomain->structure.nrNodes;
+    cleanColoring(myDomain);
+    if (myDomain->node == nullptr || nrNodes == 0) return(MEMORY_ERROR);
+
+    /*! symmetric adjacency (links are not required to be declared in both directions) */
+    std::vector<long> firstLink(unsigned(nrNodes + 1), 0);
+    std::vector<long> linked;
+    long i, j;
+    short l;
+
+    for (i = 0; i < nrNodes; i++)
+    {
+        if (myDomain->node[i].up.index != NOLINK) { firstLink[unsigned(i+1)]++; firstLink[unsigned(myDomain->node[i].up.index+1)]++; }
+        if (myDomain->node[i].down.index != NOLINK) { firstLink[unsigned(i+1)]++; firstLink[unsigned(myDomain->node[i].down.index+1)]++; }
+        for (l = 0; l < myDomain->structure.nrLateralLinks; l++)
+            if (myDomain->node[i].lateral[l].index != NOLINK)
+            {
+                firstLink[unsigned(i+1)]++;
+                firstLink[unsigned(myDomain->node[i].lateral[l].index+1)]++;
+            }
+    }
+    for (i = 0; i < nrNodes; i++)
+        firstLink[unsigned(i+1)] += firstLink[unsigned(i)];
+
+    linked.resize(unsigned(firstLink[unsigned(nrNodes)]));
+    std::vector<long> position(firstLink.begin(), firstLink.end() - 1);
+
+    for (i = 0; i < nrNodes; i++)
+    {
+        j = myDomain->node[i].up.index;
+        if (j != NOLINK) { linked[unsigned(position[unsigned(i)]++)] = j; linked[unsigned(position[unsigned(j)]++)] = i; }
+        j = myDomain->node[i].down.index;
+        if (j != NOLINK) { linked[unsigned(position[unsigned(i)]++)] = j; linked[unsigned(position[unsigned(j)]++)] = i; }
+        for (l = 0; l < myDomain->structure.nrLateralLinks; l++)
+        {
+            j = myDomain->node[i].lateral[l].index;
+            if (j != NOLINK) { linked[unsigned(position[unsigned(i)]++)] = j; linked[unsigned(position[unsigned(j)]++)] = i; }
+        }
+    }
+
+    /*! greedy coloring: first color not used by linked nodes */
+    std::vector<int> color(unsigned(nrNodes), NODATA);
+    std::vector<long> usedBy;
+    int nrColors = 0;
+
+    for (i = 0; i < nrNodes; i++)
+    {
+        for (long k = firstLink[unsigned(i)]; k < firstLink[unsigned(i+1)]; k++)
+        {
+            int c = color[unsigned(linked[unsigned(k)])];
+            if (c != NODATA) usedBy[unsigned(c)] = i;
+        }
+
+        int c = 0;
+        while (c < nrColors && usedBy[unsigned(c)] == i) c++;
+        if (c == nrColors)
+        {
+            nrColors++;
+            usedBy.push_back(NOLINK);
+        }
+        color[unsigned(i)] = c;
+    }
+
+    /*! nodes sorted by color */
+    myDomain->coloring.firstNode = (long *) calloc(unsigned(nrColors + 1), sizeof(long));
+    myDomain->coloring.node = (long *) calloc(unsigned(nrNodes), sizeof(long));
+    if (myDomain->coloring.firstNode == nullptr || myDomain->coloring.node == nullptr)
+    {
+        cleanColoring(myDomain);
+        return(MEMORY_ERROR);
+    }
+
+    for (i = 0; i < nrNodes; i++)
+        myDomain->coloring.firstNode[color[unsigned(i)] + 1]++;
+    for (int c = 0; c < nrColors; c++)
+        myDomain->coloring.firstNode[c + 1] += myDomain->coloring.firstNode[c];
+
+    std::vector<long> nextPosition(myDomain->coloring.firstNode, myDomain->coloring.firstNode + nrColors);
+    for (i = 0; i < nrNodes; i++)
+        myDomain->coloring.node[nextPosition[unsigned(color[unsigned(i)])]++] = i;
+
+    myDomain->coloring.nrColors = nrColors;
+    return(CRIT3D_OK);
+}
+
+
+/*!
+ * \brief multicolor Gauss-Seidel: the nodes of each color are relaxed in parallel,
+ * colors are swept forward (UP) or backward (DOWN) as the sequential iteration
+ */
+double GaussSeidelMulticolorIterationWater(TCrit3DDomain *myDomain, short direction)
+{
+    const TCrit3Dnode *nodes = myDomain->node;
+    const Tmatrix matrix = myDomain->A;
+    double *x = myDomain->X;
+    const double *knownTerm = myDomain->b;
+    const long *colorNode = myDomain->coloring.node;
+    int nrColors = myDomain->coloring.nrColors;
+    double infinityNorm = 0.0;
+
+    for (int k = 0; k < nrColors; k++)
+    {
+        int color = (direction == UP)? k : nrColors - 1 - k;
+        long first = myDomain->coloring.firstNode[color];
+        long last = myDomain->coloring.firstNode[color + 1];
+        double colorNorm = 0.0;
+
+        #pragma omp parallel for reduction(max:colorNorm) if (myDomain->parameters.nrThreads > 1 && last - first > 256) num_threads(myDomain->parameters.nrThreads)
+        for (long n = first; n < last; n++)
+        {
+            long i = colorNode[n];
+            double norm;
+            double newX = relaxNodeWater(i, nodes, matrix, x, knownTerm, &norm);
+            if (norm > colorNorm) colorNorm = norm;
+            x[i] = newX;
+        }
+
+        if (colorNorm > infinityNorm) infinityNorm = colorNorm;
+    }
+
+    return(infinityNorm);
+}
+
+
+double GaussSeidelMulticolorIterationHeat(TCrit3DDomain *myDomain)
+{
+    const TCrit3Dnode *nodes = myDomain->node;
+    const Tmatrix matrix = myDomain->A;
+    double *x = myDomain->X;
+    const double *knownTerm = myDomain->b;
+    const long *colorNode = myDomain->coloring.node;
+    int nrColors = myDomain->coloring.nrColors;
+    double infinityNorm = 0.0;
+
+    for (int color = 0; color < nrColors; color++)
+    {
+        long first = myDomain->coloring.firstNode[color];
+        long last = myDomain->coloring.firstNode[color + 1];
+        double colorNorm = 0.0;
+
+        #pragma omp parallel for reduction(max:colorNorm) if (myDomain->parameters.nrThreads > 1 && last - first > 256) num_threads(myDomain->parameters.nrThreads)
+        for (long n = first; n < last; n++)
+        {
+            long i = colorNode[n];
+            if (i == 0 || nodes[i].isSurface || matrix.diagonal[i] == 0.) continue;
+
+            double newX = relaxNodeHeat(i, matrix, x, knownTerm);
+            double delta = fabs(newX - x[i]);
+            if (delta > colorNorm) colorNorm = delta;
+            x[i] = newX;
+        }
+
+        if (colorNorm > infinityNorm) infinityNorm = colorNorm;
+    }
+
+    return(infinityNorm);
+}
+
+
+/*!
+ * \brief Krylov solver: PCG for heat (symmetric), BiCGSTAB for water
+ * surface nodes of the water system are checked afterwards (X >= z)
+ * \return true if converged
+ */
+bool KrylovSolver(TCrit3DDomain *myDomain, int maxIterationsNr, double residualTolerance, int process)
+{
+    std::vector<char> &isActive = myDomain->isActiveRow;
+    isActive.resize(unsigned(myDomain->structure.nrNodes));
+
+    int nrIterations = 0;
+    double residual = NODATA;
+    bool isConverged;
+
+    if (process == PROCESS_HEAT)
+    {
+        /*! same nodes of GaussSeidelIterationHeat */
+        for (long i = 0; i < myDomain->structure.nrNodes; i++)
+            isActive[unsigned(i)] = (i > 0 && ! myDomain->node[i].isSurface && myDomain->A.diagonal[i] > 0.);
+
+        isConverged = conjugateGradient(myDomain, isActive.data(), maxIterationsNr, residualTolerance, &nrIterations, &residual);
+    }
+    else
+    {
+        for (long i = 0; i < myDomain->structure.nrNodes; i++)
+            isActive[unsigned(i)] = true;
+
+        isConverged = biConjugateGradientStabilized(myDomain, isActive.data(), maxIterationsNr, residualTolerance, &nrIterations, &residual);
+
+        for (long i = 0; i < myDomain->structure.nrNodes; i++)
+            if (myDomain->node[i].isSurface && myDomain->X[i] < myDomain->node[i].z)
+                myDomain->X[i] = myDomain->node[i].z;
+    }
+
+    /*! residual of every exit, also when the solver did not converge */
+    myDomain->statistics.nrLinearIterations += nrIterations;
+    myDomain->statistics.maxResidual = maxValue(myDomain->statistics.maxResidual, residual);
+
+    return isConverged;
+}
+
+
+bool GaussSeidelRelaxation (TCrit3DDomain *myDomain, int approximation, double residualTolerance, int process)
 {
     const double MAX_NORM = 1.0;
     double norm = MAX_NORM;
     double bestNorm = MAX_NORM;
     int iteration = 0;
 
-    int maxIterationsNr = calcola_iterazioni_max(approximation);
+    int maxIterationsNr = calcola_iterazioni_max(myDomain, approximation);
+
+    /*! Krylov solver: the relaxation sweeps check the solution
+     * (and continue from it if the solver did not converge) */
+    if (myDomain->parameters.numericalSolutionMethod == CONJUGATE_GRADIENT)
+    {
+        if (KrylovSolver(myDomain, maxIterationsNr, residualTolerance, process) && process == PROCESS_HEAT)
+            return(true);
+    }
+
+    bool isMulticolor = (myDomain->parameters.numericalSolutionMethod == RELAXATION_MULTICOLOR);
+    if (isMulticolor && myDomain->coloring.nrColors == 0)
+    {
+        if (computeNodeColoring(myDomain) != CRIT3D_OK) isMulticolor = false;
+    }
 
     while ((norm > residualTolerance) && (iteration < maxIterationsNr))
 	{
         if (process == PROCESS_HEAT)
-            norm = GaussSeidelIterationHeat();
+        {
+            if (isMulticolor)
+                norm = GaussSeidelMulticolorIterationHeat(myDomain);
+            else
+                norm = GaussSeidelIterationHeat(myDomain);
+        }
 
         else if (process == PROCESS_WATER)
         {
-            if (iteration%2 == 0)
-                norm = GaussSeidelIterationWater(DOWN);
+            short direction = (iteration%2 == 0)? DOWN : UP;
+            if (isMulticolor)
+                norm = GaussSeidelMulticolorIterationWater(myDomain, direction);
             else
-                norm = GaussSeidelIterationWater(UP);
+                norm = GaussSeidelIterationWater(myDomain, direction);
 
             if (norm > (bestNorm * 10.0))
+            {
+                myDomain->statistics.nrLinearIterations += iteration + 1;
+                myDomain->statistics.maxResidual = maxValue(myDomain->statistics.maxResidual, norm);
                 return(false);                    //not converging
+            }
             else if (norm < bestNorm)
                 bestNorm = norm;
         }
@@ -208,5 +472,8 @@ bool GaussSeidelRelaxation (int approximation, double residualTolerance, int pro
         iteration++;
 	}
 
+    myDomain->statistics.nrLinearIterations += iteration;
+    myDomain->statistics.maxResidual = maxValue(myDomain->statistics.maxResidual, norm);
+
 	return(true);
 }
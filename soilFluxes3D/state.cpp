@@ -0,0 +1,366 @@
+/*!
+    \name state.cpp
+    \copyright (C) 2011 Fausto Tomei, Gabriele Antolini, Antonio Volta,
+                        Alberto Pistocchi, Marco Bittelli
+
+    This file is part of CRITERIA3D.
+    CRITERIA3D has been developed under contract issued by A.R.P.A. Emilia-Romagna
+
+    CRITERIA3D is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    CRITERIA3D is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with CRITERIA3D.  If not, see <http://www.gnu.org/licenses/>.
+
+    contacts:
+    fausto.tomei@gmail.com
+    ftomei@arpae.emr.it
+    gantolini@arpae.emr.it
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include <string>
+
+#include "../mathFunctions/commonConstants.h"
+#include "header/types.h"
+#include "header/state.h"
+#include "header/domain.h"
+
+/*!
+ * Binary snapshot of the soilFluxes3D state (checkpoint / restart).
+ * The file is a fixed header followed by the payload: arrays in native byte order,
+ * each one contiguous and 8-byte aligned, at offsets that depend only on the header,
+ * so the file can also be memory-mapped. The checksum (FNV-1a 64 bit) covers the payload.
+ *
+ * payload:
+ *  node state          7 x double[nrNodes]: H, oldH, bestH, Se, k, Qw, waterSinkSource
+ *  link sum flow       float[nrNodes x (2 + nrLateralLinks)]: up, down, lateral
+ *  boundary            double[nrBoundaryNodes x 3]: waterFlow, sumBoundaryWaterFlow, prescribedTotalPotential
+ *  heat nodes          double[nrHeatNodes x 4]: T, oldT, Qh, sinkSource
+ *  heat boundary       TboundaryHeat[nrHeatBoundaryNodes]
+ *  balances            Tbalance[4]: current time step, previous time step, current period, whole period
+ *
+ * The topology (nodes, links, soils, boundary types) is not saved: it must be built again
+ * with the same calls before reading the state.
+ */
+
+static const char STATE_FILE_TYPE[8] = {'S', 'F', '3', 'D', 'S', 'T', 'A', 'T'};
+static const int STATE_VERSION = 1;
+static const unsigned long long FNV_OFFSET = 14695981039346656037ULL;
+
+struct TstateHeader {
+    char fileType[8];
+    int version;
+    int headerSize;
+    long long nrNodes;
+    int nrLayers;
+    int nrLateralLinks;
+    long long nrBoundaryNodes;
+    long long nrHeatNodes;
+    long long nrHeatBoundaryNodes;
+    int computeWater;
+    int computeHeat;
+    double currentDeltaT;       /*!< [s] current time step */
+    long long payloadSize;      /*!< [bytes] */
+    unsigned long long checksum;
+};
+
+
+static unsigned long long addChecksum(unsigned long long checksum, const char *data, size_t size)
+{
+    const unsigned long long FNV_PRIME = 1099511628211ULL;
+    for (size_t i = 0; i < size; i++)
+    {
+        checksum ^= (unsigned char) data[i];
+        checksum *= FNV_PRIME;
+    }
+    return checksum;
+}
+
+
+/*! [bytes] size of a section (8-byte aligned) */
+static inline size_t padded(size_t size)
+{
+    return (size + 7) / 8 * 8;
+}
+
+
+/*! payload of the current domain, in file order */
+struct TstatePayload
+{
+    std::vector<char> data;
+
+    void add(const void *values, size_t size)
+    {
+        const char *bytes = static_cast<const char *>(values);
+        data.insert(data.end(), bytes, bytes + size);
+        data.resize(padded(data.size()), 0);
+    }
+};
+
+
+/*! position in the payload read from file */
+struct TstateReader
+{
+    const char *position;
+
+    void get(void *values, size_t size)
+    {
+        memcpy(values, position, size);
+        position += padded(size);
+    }
+};
+
+
+static void countNodes(TCrit3DDomain *myDomain, TstateHeader *header)
+{
+    header->nrBoundaryNodes = header->nrHeatNodes = header->nrHeatBoundaryNodes = 0;
+    for (long i = 0; i < myDomain->structure.nrNodes; i++)
+    {
+        if (myDomain->node[i].boundary != nullptr)
+        {
+            header->nrBoundaryNodes++;
+            if (myDomain->node[i].boundary->Heat != nullptr) header->nrHeatBoundaryNodes++;
+        }
+        if (myDomain->structure.computeHeat && myDomain->node[i].extra != nullptr && myDomain->node[i].extra->Heat != nullptr)
+            header->nrHeatNodes++;
+    }
+}
+
+
+static size_t nodeStateSize(TCrit3DDomain *myDomain)
+{
+    return size_t(myDomain->structure.nrNodes) * sizeof(double);
+}
+
+
+/*!
+ * \brief save the state of the current domain
+ * the state is written on fileName.tmp and then renamed:
+ * an interrupted save never replaces the previous state file
+ * \param fileName
+ * \return OK/ERROR
+ */
+int writeStateFile(TCrit3DDomain *myDomain, const char *fileName)
+{
+    if (myDomain->node == nullptr) return(MEMORY_ERROR);
+    if (fileName == nullptr) return(FILE_ERROR);
+
+    TstateHeader header;
+    memset(&header, 0, sizeof(TstateHeader));
+    memcpy(header.fileType, STATE_FILE_TYPE, sizeof(STATE_FILE_TYPE));
+    header.version = STATE_VERSION;
+    header.headerSize = int(sizeof(TstateHeader));
+    header.nrNodes = myDomain->structure.nrNodes;
+    header.nrLayers = int(myDomain->structure.nrLayers);
+    header.nrLateralLinks = myDomain->structure.nrLateralLinks;
+    header.computeWater = myDomain->structure.computeWater;
+    header.computeHeat = myDomain->structure.computeHeat;
+    header.currentDeltaT = myDomain->parameters.current_delta_t;
+    countNodes(myDomain, &header);
+
+    TstatePayload payload;
+
+    /*! node state */
+    size_t size = nodeStateSize(myDomain);
+    payload.add(myDomain->nodeState.H, size);
+    payload.add(myDomain->nodeState.oldH, size);
+    payload.add(myDomain->nodeState.bestH, size);
+    payload.add(myDomain->nodeState.Se, size);
+    payload.add(myDomain->nodeState.k, size);
+    payload.add(myDomain->nodeState.Qw, size);
+    payload.add(myDomain->nodeState.waterSinkSource, size);
+
+    /*! sum of link flows */
+    std::vector<float> sumFlow;
+    sumFlow.reserve(size_t(myDomain->structure.nrNodes) * size_t(2 + myDomain->structure.nrLateralLinks));
+    for (long i = 0; i < myDomain->structure.nrNodes; i++)
+    {
+        sumFlow.push_back(myDomain->node[i].up.sumFlow);
+        sumFlow.push_back(myDomain->node[i].down.sumFlow);
+        for (int l = 0; l < myDomain->structure.nrLateralLinks; l++)
+            sumFlow.push_back(myDomain->node[i].lateral[l].sumFlow);
+    }
+    payload.add(sumFlow.data(), sumFlow.size() * sizeof(float));
+
+    /*! boundary */
+    std::vector<double> values;
+    std::vector<TboundaryHeat> boundaryHeat;
+    for (long i = 0; i < myDomain->structure.nrNodes; i++)
+        if (myDomain->node[i].boundary != nullptr)
+        {
+            values.push_back(myDomain->node[i].boundary->waterFlow);
+            values.push_back(myDomain->node[i].boundary->sumBoundaryWaterFlow);
+            values.push_back(myDomain->node[i].boundary->prescribedTotalPotential);
+            if (myDomain->node[i].boundary->Heat != nullptr)
+                boundaryHeat.push_back(*(myDomain->node[i].boundary->Heat));
+        }
+    payload.add(values.data(), values.size() * sizeof(double));
+
+    /*! heat */
+    values.clear();
+    if (myDomain->structure.computeHeat)
+        for (long i = 0; i < myDomain->structure.nrNodes; i++)
+            if (myDomain->node[i].extra != nullptr && myDomain->node[i].extra->Heat != nullptr)
+            {
+                values.push_back(myDomain->node[i].extra->Heat->T);
+                values.push_back(myDomain->node[i].extra->Heat->oldT);
+                values.push_back(myDomain->node[i].extra->Heat->Qh);
+                values.push_back(myDomain->node[i].extra->Heat->sinkSource);
+            }
+    payload.add(values.data(), values.size() * sizeof(double));
+    payload.add(boundaryHeat.data(), boundaryHeat.size() * sizeof(TboundaryHeat));
+
+    /*! balances */
+    Tbalance balances[4] = {myDomain->balanceCurrentTimeStep, myDomain->balancePreviousTimeStep, myDomain->balanceCurrentPeriod, myDomain->balanceWholePeriod};
+    payload.add(balances, sizeof(balances));
+
+    header.payloadSize = (long long) payload.data.size();
+    header.checksum = addChecksum(FNV_OFFSET, payload.data.data(), payload.data.size());
+
+    std::string tmpFileName = std::string(fileName) + ".tmp";
+    FILE *fp = fopen(tmpFileName.c_str(), "wb");
+    if (fp == nullptr) return(FILE_ERROR);
+
+    bool isOk = (fwrite(&header, sizeof(TstateHeader), 1, fp) == 1)
+                && (fwrite(payload.data.data(), 1, payload.data.size(), fp) == payload.data.size());
+    if (fclose(fp) != 0) isOk = false;
+
+    if (isOk)
+    {
+        // rename does not replace an existing file on Windows
+        remove(fileName);
+        isOk = (rename(tmpFileName.c_str(), fileName) == 0);
+    }
+    if (! isOk)
+        remove(tmpFileName.c_str());
+
+    return isOk ? CRIT3D_OK : FILE_ERROR;
+}
+
+
+/*!
+ * \brief load the state of the current domain
+ * the domain must have the same topology (nodes, links, boundary) of the saved one
+ * \param fileName
+ * \return OK/ERROR
+ */
+int readStateFile(TCrit3DDomain *myDomain, const char *fileName)
+{
+    if (myDomain->node == nullptr) return(MEMORY_ERROR);
+
+    FILE *fp = fopen(fileName, "rb");
+    if (fp == nullptr) return(FILE_ERROR);
+
+    TstateHeader header;
+    if ((fread(&header, sizeof(TstateHeader), 1, fp) != 1)
+        || (memcmp(header.fileType, STATE_FILE_TYPE, sizeof(STATE_FILE_TYPE)) != 0)
+        || (header.version != STATE_VERSION) || (header.headerSize != int(sizeof(TstateHeader)))
+        || (header.payloadSize < 0))
+    {
+        fclose(fp);
+        return(FILE_ERROR);
+    }
+
+    /*! check topology */
+    TstateHeader current = header;
+    countNodes(myDomain, &current);
+    if ((header.nrNodes != myDomain->structure.nrNodes) || (header.nrLateralLinks != myDomain->structure.nrLateralLinks)
+        || (header.computeWater != int(myDomain->structure.computeWater)) || (header.computeHeat != int(myDomain->structure.computeHeat))
+        || (header.nrBoundaryNodes != current.nrBoundaryNodes) || (header.nrHeatNodes != current.nrHeatNodes)
+        || (header.nrHeatBoundaryNodes != current.nrHeatBoundaryNodes))
+    {
+        fclose(fp);
+        return(TOPOGRAPHY_ERROR);
+    }
+
+    std::vector<char> data(size_t(header.payloadSize));
+    size_t nrRead = fread(data.data(), 1, data.size(), fp);
+    fclose(fp);
+    if ((nrRead != data.size())
+        || (addChecksum(FNV_OFFSET, data.data(), data.size()) != header.checksum))
+        return(FILE_ERROR);
+
+    /*! expected size */
+    size_t nrNodes = size_t(myDomain->structure.nrNodes);
+    size_t nrLinks = nrNodes * size_t(2 + myDomain->structure.nrLateralLinks);
+    size_t expectedSize = 7 * padded(nodeStateSize(myDomain)) + padded(nrLinks * sizeof(float))
+                          + padded(size_t(header.nrBoundaryNodes) * 3 * sizeof(double))
+                          + padded(size_t(header.nrHeatNodes) * 4 * sizeof(double))
+                          + padded(size_t(header.nrHeatBoundaryNodes) * sizeof(TboundaryHeat))
+                          + padded(4 * sizeof(Tbalance));
+    if (data.size() != expectedSize) return(FILE_ERROR);
+
+    TstateReader reader;
+    reader.position = data.data();
+
+    size_t size = nodeStateSize(myDomain);
+    reader.get(myDomain->nodeState.H, size);
+    reader.get(myDomain->nodeState.oldH, size);
+    reader.get(myDomain->nodeState.bestH, size);
+    reader.get(myDomain->nodeState.Se, size);
+    reader.get(myDomain->nodeState.k, size);
+    reader.get(myDomain->nodeState.Qw, size);
+    reader.get(myDomain->nodeState.waterSinkSource, size);
+
+    std::vector<float> sumFlow(nrLinks);
+    reader.get(sumFlow.data(), nrLinks * sizeof(float));
+    size_t n = 0;
+    for (long i = 0; i < myDomain->structure.nrNodes; i++)
+    {
+        myDomain->node[i].up.sumFlow = sumFlow[n++];
+        myDomain->node[i].down.sumFlow = sumFlow[n++];
+        for (int l = 0; l < myDomain->structure.nrLateralLinks; l++)
+            myDomain->node[i].lateral[l].sumFlow = sumFlow[n++];
+    }
+
+    std::vector<double> values(size_t(header.nrBoundaryNodes) * 3);
+    reader.get(values.data(), values.size() * sizeof(double));
+    n = 0;
+    for (long i = 0; i < myDomain->structure.nrNodes; i++)
+        if (myDomain->node[i].boundary != nullptr)
+        {
+            myDomain->node[i].boundary->waterFlow = values[n++];
+            myDomain->node[i].boundary->sumBoundaryWaterFlow = values[n++];
+            myDomain->node[i].boundary->prescribedTotalPotential = values[n++];
+        }
+
+    values.resize(size_t(header.nrHeatNodes) * 4);
+    reader.get(values.data(), values.size() * sizeof(double));
+    std::vector<TboundaryHeat> boundaryHeat(size_t(header.nrHeatBoundaryNodes));
+    reader.get(boundaryHeat.data(), boundaryHeat.size() * sizeof(TboundaryHeat));
+    n = 0;
+    size_t nb = 0;
+    for (long i = 0; i < myDomain->structure.nrNodes; i++)
+    {
+        if (myDomain->structure.computeHeat && myDomain->node[i].extra != nullptr && myDomain->node[i].extra->Heat != nullptr)
+        {
+            myDomain->node[i].extra->Heat->T = values[n++];
+            myDomain->node[i].extra->Heat->oldT = values[n++];
+            myDomain->node[i].extra->Heat->Qh = values[n++];
+            myDomain->node[i].extra->Heat->sinkSource = values[n++];
+        }
+        if (myDomain->node[i].boundary != nullptr && myDomain->node[i].boundary->Heat != nullptr)
+            *(myDomain->node[i].boundary->Heat) = boundaryHeat[nb++];
+    }
+
+    Tbalance balances[4];
+    reader.get(balances, sizeof(balances));
+    myDomain->balanceCurrentTimeStep = balances[0];
+    myDomain->balancePreviousTimeStep = balances[1];
+    myDomain->balanceCurrentPeriod = balances[2];
+    myDomain->balanceWholePeriod = balances[3];
+
+    myDomain->parameters.current_delta_t = header.currentDeltaT;
+
+    return(CRIT3D_OK);
+}
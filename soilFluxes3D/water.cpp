@@ -35,10 +35,19 @@
 #include "header/types.h"
 #include "header/water.h"
 #include "header/soilPhysics.h"
+#include "header/hydraulicTable.h"
 #include "header/solver.h"
 #include "header/balance.h"
 #include "header/boundary.h"
 #include "header/heat.h"
+#include "header/domain.h"
+
+
+/*! minimum number of nodes for the parallel assembly (nrThreads > 1) */
+static const long MIN_PARALLEL_SIZE = 1024;
+
+/*! nodes of each call to the hydraulic table batches */
+static const long TABLE_CHUNK_SIZE = 4096;
 
 
 /*!
@@ -48,12 +57,12 @@
  * \param deltaT
  * \return result
  */
-double getWaterExchange(long i, TlinkedNode *link, double deltaT)
+double getWaterExchange(TCrit3DDomain *myDomain, long i, TlinkedNode *link, double deltaT)
 {
     if (link != nullptr)
         {
-		double matrixValue = getMatrixValue(i, link);
-		double flow = matrixValue * (myNode[i].H - myNode[link->index].H) * deltaT;
+		double matrixValue = getMatrixValue(myDomain, i, link);
+		double flow = matrixValue * (myDomain->nodeState.H[i] - myDomain->nodeState.H[link->index]) * deltaT;
         return (flow);
         }
 	else
@@ -70,72 +79,73 @@ double getWaterExchange(long i, TlinkedNode *link, double deltaT)
  * \param link TlinkedNode pointer
  * \param deltaT
  * \param approximationNr
+ * \param courant [-] maximum Courant number, updated
  * \return result
  */
-double runoff(long i, long j, TlinkedNode *link, double deltaT, unsigned long approximationNr)
+double runoff(TCrit3DDomain *myDomain, long i, long j, TlinkedNode *link, double deltaT, unsigned long approximationNr, double *courant)
 {
     double Hi, Hj;
     double const EPSILON_mm = 0.0001;
 
     if (approximationNr == 0)
     {
-        double flux_i = (myNode[i].Qw * deltaT) / myNode[i].volume_area;
-        double flux_j = (myNode[j].Qw * deltaT) / myNode[j].volume_area;
-        Hi = myNode[i].oldH + flux_i;
-        Hj = myNode[j].oldH + flux_j;
+        double flux_i = (myDomain->nodeState.Qw[i] * deltaT) / myDomain->node[i].volume_area;
+        double flux_j = (myDomain->nodeState.Qw[j] * deltaT) / myDomain->node[j].volume_area;
+        Hi = myDomain->nodeState.oldH[i] + flux_i;
+        Hj = myDomain->nodeState.oldH[j] + flux_j;
     }
     else
     {
 		
-		Hi = myNode[i].H;
-		Hj = myNode[j].H;
+		Hi = myDomain->nodeState.H[i];
+		Hj = myDomain->nodeState.H[j];
 		/*
-		Hi = (myNode[i].H + myNode[i].oldH) / 2.0;
-        Hj = (myNode[j].H + myNode[j].oldH) / 2.0;
+		Hi = (myNodeState.H[i] + myNodeState.oldH[i]) / 2.0;
+        Hj = (myNodeState.H[j] + myNodeState.oldH[j]) / 2.0;
 		*/
     }
 
 
     double H = maxValue(Hi, Hj);
-    double z = maxValue(myNode[i].z + myNode[i].Soil->Pond, myNode[j].z + myNode[j].Soil->Pond);
+    double z = maxValue(myDomain->node[i].z + myDomain->node[i].Soil->Pond, myDomain->node[j].z + myDomain->node[j].Soil->Pond);
     double Hs = H - z;
     if (Hs <= 0.) return(0.);
 
     double dH = fabs(Hi - Hj);
-    double cellDistance = distance2D(i,j);
+    double cellDistance = distance2D(myDomain, i,j);
     if ((dH/cellDistance) < EPSILON_mm) return(0.);
 
-    double roughness = (myNode[i].Soil->Roughness + myNode[j].Soil->Roughness) / 2.;
+    double roughness = (myDomain->node[i].Soil->Roughness + myDomain->node[j].Soil->Roughness) / 2.;
 
     //Manning
     double v = pow(Hs, 2.0/3.0) * sqrt(dH/cellDistance) / roughness;
     double flowArea = link->area * Hs;
 
-    Courant = maxValue(Courant, v * deltaT / cellDistance);
+    *courant = maxValue(*courant, v * deltaT / cellDistance);
     return (v * flowArea) / dH;
 }
 
 
 
-double infiltration(long sup, long inf, TlinkedNode *link, double deltaT)
+double infiltration(TCrit3DDomain *myDomain, long sup, long inf, TlinkedNode *link, double deltaT)
 {
- double cellDistance = (myNode[sup].z - myNode[inf].z) * 2.0;
+ double cellDistance = (myDomain->node[sup].z - myDomain->node[inf].z) * 2.0;
 
  /*! unsaturated */
- if (myNode[inf].H < myNode[sup].z)
+ if (myDomain->nodeState.H[inf] < myDomain->node[sup].z)
         {
         /*! surface water content [m] */
-        // double surfaceH = (myNode[sup].H + myNode[sup].oldH) * 0.5;
-		double surfaceH = myNode[sup].H;
+        // double surfaceH = (myNodeState.H[sup] + myNodeState.oldH[sup]) * 0.5;
+		double surfaceH = myDomain->nodeState.H[sup];
 
         /*! maximum water infiltration rate [m/s] */
-        double maxInfiltrationRate = (surfaceH - myNode[sup].z) / deltaT;
+        double maxInfiltrationRate = (surfaceH - myDomain->node[sup].z) / deltaT;
         if (maxInfiltrationRate <= 0.0) return(0.0);
 
         /*! first soil layer: mean between current k and k_sat */
-        double meanK = computeMean(myNode[inf].k, myNode[inf].Soil->K_sat);
+        double meanK = computeMean(myDomain, myDomain->nodeState.k[inf], myDomain->node[inf].Soil->K_sat);
 
-        double dH = myNode[sup].H - myNode[inf].H;
+        double dH = myDomain->nodeState.H[sup] - myDomain->nodeState.H[inf];
         double maxK = maxInfiltrationRate * (cellDistance / dH);
 
         double k = minValue(meanK , maxK);
@@ -146,186 +156,279 @@ double infiltration(long sup, long inf, TlinkedNode *link, double deltaT)
  /*! saturated */
  else
     {
-        return(myNode[inf].Soil->K_sat * link->area) / cellDistance;
+        return(myDomain->node[inf].Soil->K_sat * link->area) / cellDistance;
     }
 
 }
 
 
-double redistribution(long i, TlinkedNode *link, int linkType)
+double redistribution(TCrit3DDomain *myDomain, long i, TlinkedNode *link, int linkType)
 {
     double cellDistance;
-    double k1 = myNode[i].k;
-    double k2 = myNode[(*link).index].k;
+    double k1 = myDomain->nodeState.k[i];
+    double k2 = myDomain->nodeState.k[(*link).index];
 
     /*! horizontal */
     if (linkType == LATERAL)
     {
-        cellDistance = distance(i, (*link).index);
-        k1 *= myParameters.k_lateral_vertical_ratio;
-        k2 *= myParameters.k_lateral_vertical_ratio;
+        cellDistance = distance(myDomain, i, (*link).index);
+        k1 *= myDomain->parameters.k_lateral_vertical_ratio;
+        k2 *= myDomain->parameters.k_lateral_vertical_ratio;
     }
     else
     {
-        cellDistance = fabs(myNode[i].z - myNode[(*link).index].z);
+        cellDistance = fabs(myDomain->node[i].z - myDomain->node[(*link).index].z);
     }
-    double k = computeMean(k1, k2);
+    double k = computeMean(myDomain, k1, k2);
 
     return (k * link->area) / cellDistance;
 }
 
 
 
-bool computeFlux(long i, int matrixIndex, TlinkedNode *link, double deltaT, unsigned long myApprox, int linkType)
+bool computeFlux(TCrit3DDomain *myDomain, long i, int matrixIndex, TlinkedNode *link, double deltaT, unsigned long myApprox, int linkType, double *courant)
 {
 	if ((*link).index == NOLINK) return (false);
 
     double val;
     long j = (*link).index;
 
-    if (myNode[i].isSurface)
+    if (myDomain->node[i].isSurface)
     {
-		if (myNode[j].isSurface)
-			val = runoff(i, j, link, deltaT, myApprox);
+		if (myDomain->node[j].isSurface)
+			val = runoff(myDomain, i, j, link, deltaT, myApprox, courant);
         else
-            val = infiltration(i, j, link, deltaT);
+            val = infiltration(myDomain, i, j, link, deltaT);
     }
     else
     {
-        if (myNode[j].isSurface)
-            val = infiltration(j, i, link, deltaT);
+        if (myDomain->node[j].isSurface)
+            val = infiltration(myDomain, j, i, link, deltaT);
         else
-            val = redistribution(i, link, linkType);
+            val = redistribution(myDomain, i, link, linkType);
     }
 
-    A[i][matrixIndex].index = j;
-    A[i][matrixIndex].val = val;
+    long k = i * myDomain->A.nrColumns + matrixIndex;
+    myDomain->A.index[k] = int(j);
+    myDomain->A.val[k] = val;
 
-    if (myStructure.computeHeat &&
-        ! myNode[i].isSurface && ! myNode[j].isSurface)
+    if (myDomain->structure.computeHeat &&
+        ! myDomain->node[i].isSurface && ! myDomain->node[j].isSurface)
     {
-        if (myStructure.computeHeatVapor)
+        if (myDomain->structure.computeHeatVapor)
         {
             double vaporThermal;
-            vaporThermal = ThermalVaporFlux(i, link, PROCESS_WATER, NODATA, NODATA) / WATER_DENSITY;
-            invariantFlux[i] += vaporThermal;
+            vaporThermal = ThermalVaporFlux(myDomain, i, link, PROCESS_WATER, NODATA, NODATA) / WATER_DENSITY;
+            myDomain->invariantFlux[i] += vaporThermal;
         }
 
         double liquidThermal;
-        liquidThermal = ThermalLiquidFlux(i, link, PROCESS_WATER, NODATA, NODATA);
-        invariantFlux[i] += liquidThermal;
+        liquidThermal = ThermalLiquidFlux(myDomain, i, link, PROCESS_WATER, NODATA, NODATA);
+        myDomain->invariantFlux[i] += liquidThermal;
     }
 
     return (true);
 }
 
 
-bool waterFlowComputation(double deltaT)
- {
-     bool isValidStep;
-     long i = 0;
-     short j = 0;
-     double dThetadH, dthetavdh;
-     double avgTemperature;
+/*!
+ * \brief hydraulic conductivity and capacity of node i
+ * (tables: liquid conductivity and dTheta/dH have been computed in C)
+ */
+void computeNodeCapacity(TCrit3DDomain *myDomain, long i)
+{
+    double dThetadH;
 
-     int approximationNr = 0;
-     do
-     {
-        Courant = 0.0;
-        if (approximationNr == 0)
-        {
-            for (i = 0; i < myStructure.nrNodes; i++)
-            {
-                A[i][0].index = i;
-            }
-        }
+    myDomain->invariantFlux[i] = 0.;
+    if (myDomain->node[i].isSurface) return;
 
+    if (myDomain->parameters.useHydraulicTables)
+    {
+        dThetadH = myDomain->C[i];
+        if (myDomain->structure.computeHeat && myDomain->structure.computeHeatVapor)
+            myDomain->nodeState.k[i] += computeVaporK(myDomain, i);
+    }
+    else
+    {
+        myDomain->nodeState.k[i] = computeK(myDomain, i);
+        dThetadH = dTheta_dH(myDomain, i);
+    }
+    myDomain->C[i] = myDomain->node[i].volume_area  * dThetadH;
+
+    // vapor capacity term
+    if (myDomain->structure.computeHeat && myDomain->structure.computeHeatVapor)
+    {
+        double avgTemperature = getTMean(myDomain, i);
+        double dthetavdh = dThetav_dH(myDomain, i, avgTemperature, dThetadH);
+        myDomain->C[i] += myDomain->node[i].volume_area  * dthetavdh;
+    }
+}
+
+
+/*!
+ * \brief matrix row, known term and preconditioning of node i
+ * \param courant [-] maximum Courant number, updated
+ */
+void computeMatrixRow(TCrit3DDomain *myDomain, long i, double deltaT, int approximationNr, double *courant)
+{
+    short j = 0;
+    if (computeFlux(myDomain, i, j, &(myDomain->node[i].up), deltaT, approximationNr, UP, courant)) j++;
+    for (short l = 0; l < myDomain->structure.nrLateralLinks; l++)
+            if (computeFlux(myDomain, i, j, &(myDomain->node[i].lateral[l]), deltaT, approximationNr, LATERAL, courant)) j++;
+    if (computeFlux(myDomain, i, j, &(myDomain->node[i].down), deltaT, approximationNr, DOWN, courant)) j++;
+
+    /*! closure */
+    myDomain->A.nrLinks[i] = j;
+
+    double *rowVal = myDomain->A.val + i * myDomain->A.nrColumns;
+    double sum = 0.;
+    for (j = 0; j < myDomain->A.nrLinks[i]; j++)
+    {
+        sum += rowVal[j];
+        rowVal[j] *= -1.0;
+    }
+
+    /*! sum of the diagonal elements */
+    myDomain->A.diagonal[i] = myDomain->C[i]/deltaT + sum;
+
+    /*! b vector(vector of constant terms) */
+    myDomain->b[i] = ((myDomain->C[i] / deltaT) * myDomain->nodeState.oldH[i]) + myDomain->nodeState.Qw[i] + myDomain->invariantFlux[i];
+
+    /*! preconditioning */
+    for (j = 0; j < myDomain->A.nrLinks[i]; j++)
+        rowVal[j] /= myDomain->A.diagonal[i];
+    myDomain->b[i] /= myDomain->A.diagonal[i];
+}
+
+
+/*!
+ * \brief assembly of the water system: each row is independent, the rows are
+ * computed in parallel on large domains when more than one thread is set (setNumberOfThreads)
+ * the Courant number of the step is the maximum of the values of the workers
+ */
+void assembleWaterMatrix(TCrit3DDomain *myDomain, double deltaT, int approximationNr)
+{
+    long nrNodes = myDomain->structure.nrNodes;
+
+    double maxCourant = 0.;
+
+    if (myDomain->parameters.nrThreads <= 1 || nrNodes <= MIN_PARALLEL_SIZE)
+    {
         /*! hydraulic conductivity and theta derivative */
-        for (i = 0; i < myStructure.nrNodes; i++)
+        if (myDomain->parameters.useHydraulicTables)
+            computeConductivityCapacityBatch(myDomain, 0, nrNodes, myDomain->C);
+
+        for (long i = 0; i < nrNodes; i++)
+            computeNodeCapacity(myDomain, i);
+
+        /*! computes the matrix elements (the rows read k of the linked nodes) */
+        for (long i = 0; i < nrNodes; i++)
+            computeMatrixRow(myDomain, i, deltaT, approximationNr, &maxCourant);
+
+        myDomain->courant = maxCourant;
+        return;
+    }
+
+    #pragma omp parallel num_threads(myDomain->parameters.nrThreads) reduction(max:maxCourant)
+    {
+        double threadCourant = 0.;
+
+        if (myDomain->parameters.useHydraulicTables)
         {
-            invariantFlux[i] = 0.;
-            if (!myNode[i].isSurface)
-            {
-                 myNode[i].k = computeK(i);
-                 dThetadH = dTheta_dH(i);
-                 C[i] = myNode[i].volume_area  * dThetadH;
-
-                 // vapor capacity term
-                 if (myStructure.computeHeat && myStructure.computeHeatVapor)
-                 {
-                     avgTemperature = getTMean(i);
-                     dthetavdh = dThetav_dH(i, avgTemperature, dThetadH);
-                     C[i] += myNode[i].volume_area  * dthetavdh;
-                 }
-            }
+            #pragma omp for schedule(static)
+            for (long first = 0; first < nrNodes; first += TABLE_CHUNK_SIZE)
+                computeConductivityCapacityBatch(myDomain, first, minValue(first + TABLE_CHUNK_SIZE, nrNodes), myDomain->C);
         }
 
-        // update boundary conditions
-        // updateBoundaryWater(deltaT);
+        #pragma omp for schedule(static)
+        for (long i = 0; i < nrNodes; i++)
+            computeNodeCapacity(myDomain, i);
+
+        #pragma omp for schedule(static)
+        for (long i = 0; i < nrNodes; i++)
+            computeMatrixRow(myDomain, i, deltaT, approximationNr, &threadCourant);
+
+        maxCourant = threadCourant;
+    }
+
+    myDomain->courant = maxCourant;
+}
 
-        /*! computes the matrix elements */
-        for (i = 0; i < myStructure.nrNodes; i++)
+
+/*!
+ * \brief set the new potential and compute the new degree of saturation
+ */
+void updateWaterState(TCrit3DDomain *myDomain)
+{
+    long nrNodes = myDomain->structure.nrNodes;
+
+    if (myDomain->parameters.nrThreads <= 1 || nrNodes <= MIN_PARALLEL_SIZE)
+    {
+        for (long i = 0; i < nrNodes; i++)
         {
-            j = 1;
-            if (computeFlux(i, j, &(myNode[i].up), deltaT, approximationNr, UP)) j++;
-            for (short l = 0; l < myStructure.nrLateralLinks; l++)
-                    if (computeFlux(i, j, &(myNode[i].lateral[l]), deltaT, approximationNr, LATERAL)) j++;
-            if (computeFlux(i, j, &(myNode[i].down), deltaT, approximationNr, DOWN)) j++;
-
-            /*! closure */
-            while (j < myStructure.maxNrColumns) A[i][j++].index = NOLINK;
-
-            j = 1;
-            double sum = 0.;
-            while ((j < myStructure.maxNrColumns) && (A[i][j].index != NOLINK))
-            {
-                sum += A[i][j].val;
-                A[i][j].val *= -1.0;
-                j++;
-            }
+            myDomain->nodeState.H[i] = myDomain->X[i];
+            if (!myDomain->node[i].isSurface && !myDomain->parameters.useHydraulicTables)
+                myDomain->nodeState.Se[i] = computeSe(myDomain, i);
+        }
 
-            /*! sum of the diagonal elements */
-            A[i][0].val = C[i]/deltaT + sum;
+        if (myDomain->parameters.useHydraulicTables)
+            computeSeBatch(myDomain, 0, nrNodes);
 
-            /*! b vector(vector of constant terms) */
-            b[i] = ((C[i] / deltaT) * myNode[i].oldH) + myNode[i].Qw + invariantFlux[i];
+        return;
+    }
 
-            /*! preconditioning */
-            j = 1;
-            while ((j < myStructure.maxNrColumns) && (A[i][j].index != NOLINK))
-                    A[i][j++].val /= A[i][0].val;
-            b[i] /= A[i][0].val;
+    #pragma omp parallel num_threads(myDomain->parameters.nrThreads)
+    {
+        #pragma omp for schedule(static)
+        for (long i = 0; i < nrNodes; i++)
+        {
+            myDomain->nodeState.H[i] = myDomain->X[i];
+            if (!myDomain->node[i].isSurface && !myDomain->parameters.useHydraulicTables)
+                myDomain->nodeState.Se[i] = computeSe(myDomain, i);
         }
 
-        if (Courant > 1.0)
-            if (deltaT > myParameters.delta_t_min)
+        if (myDomain->parameters.useHydraulicTables)
+        {
+            #pragma omp for schedule(static)
+            for (long first = 0; first < nrNodes; first += TABLE_CHUNK_SIZE)
+                computeSeBatch(myDomain, first, minValue(first + TABLE_CHUNK_SIZE, nrNodes));
+        }
+    }
+}
+
+
+bool waterFlowComputation(TCrit3DDomain *myDomain, double deltaT)
+ {
+     bool isValidStep;
+
+     int approximationNr = 0;
+     do
+     {
+        assembleWaterMatrix(myDomain, deltaT, approximationNr);
+
+        if (myDomain->courant > 1.0)
+            if (deltaT > myDomain->parameters.delta_t_min)
             {
-                halveTimeStep();
-                setForcedHalvedTime(true);
+                reduceTimeStep(myDomain, 0.9 / myDomain->courant);
+                setForcedHalvedTime(myDomain, true);
                 return (false);
             }
 
-        if (! GaussSeidelRelaxation(approximationNr, myParameters.ResidualTolerance, PROCESS_WATER))
-            if (deltaT > myParameters.delta_t_min)
+        if (! GaussSeidelRelaxation(myDomain, approximationNr, myDomain->parameters.ResidualTolerance, PROCESS_WATER))
+            if (deltaT > myDomain->parameters.delta_t_min)
             {
-                halveTimeStep();
-                setForcedHalvedTime(true);
+                reduceTimeStep(myDomain, 0.5);
+                setForcedHalvedTime(myDomain, true);
                 return (false);
             }
 
-        /*! set new potential - compute new degree of saturation */
-        for (i = 0; i < myStructure.nrNodes; i++)
-        {
-            myNode[i].H = X[i];
-            if (!myNode[i].isSurface)
-                myNode[i].Se = computeSe(i);
-        }
+        updateWaterState(myDomain);
 
         /*! water balance */
-        isValidStep = waterBalance(deltaT, approximationNr);
-        if (getForcedHalvedTime()) return (false);
+        isValidStep = waterBalance(myDomain, deltaT, approximationNr);
+        if (getForcedHalvedTime(myDomain)) return (false);
         }
-    while ((!isValidStep) && (++approximationNr < myParameters.maxApproximationsNumber));
+    while ((!isValidStep) && (++approximationNr < myDomain->parameters.maxApproximationsNumber));
 
     return (isValidStep);
  }
@@ -339,38 +442,44 @@ bool waterFlowComputation(double deltaT)
   * \param acceptedTime [s] current seconds for simulation step
   * \return
   */
- bool computeWater(double maxTime, double *acceptedTime)
+ bool computeWater(TCrit3DDomain *myDomain, double maxTime, double *acceptedTime)
 {
  bool isStepOK = false;
 
  while (!isStepOK)
  {
-        *acceptedTime = minValue(myParameters.current_delta_t, maxTime);
+        *acceptedTime = minValue(myDomain->parameters.current_delta_t, maxTime);
 
         /*! save the instantaneous H values - Prepare the solutions vector (X = H) */
-        for (long n = 0; n < myStructure.nrNodes; n++)
+        for (long n = 0; n < myDomain->structure.nrNodes; n++)
                 {
-                myNode[n].oldH = myNode[n].H;
-                X[n] = myNode[n].H;
+                myDomain->nodeState.oldH[n] = myDomain->nodeState.H[n];
+                myDomain->X[n] = myDomain->nodeState.H[n];
                 }
 
         /*! assign Theta_e
             for the surface nodes C = area */
-        for (long n = 0; n < myStructure.nrNodes; n++)
+        for (long n = 0; n < myDomain->structure.nrNodes; n++)
         {
-            if (myNode[n].isSurface)
-                C[n] = myNode[n].volume_area;
-            else
-                myNode[n].Se = computeSe(n);
+            if (myDomain->node[n].isSurface)
+                myDomain->C[n] = myDomain->node[n].volume_area;
+            else if (!myDomain->parameters.useHydraulicTables)
+                myDomain->nodeState.Se[n] = computeSe(myDomain, n);
         }
+        if (myDomain->parameters.useHydraulicTables)
+            computeSeBatch(myDomain, 0, myDomain->structure.nrNodes);
 
         /*! update boundary conditions */
-        updateBoundary();
-        updateBoundaryWater(*acceptedTime);
+        updateBoundary(myDomain);
+        updateBoundaryWater(myDomain, *acceptedTime);
 
-        isStepOK = waterFlowComputation(*acceptedTime);
+        isStepOK = waterFlowComputation(myDomain, *acceptedTime);
 
-		if (!isStepOK) restoreWater();
+		if (!isStepOK)
+        {
+            myDomain->statistics.nrRejectedSteps++;
+            restoreWater(myDomain);
+        }
   }
 
  return (isStepOK);
@@ -378,10 +487,10 @@ bool waterFlowComputation(double deltaT)
 }
 
 
-void restoreWater()
+void restoreWater(TCrit3DDomain *myDomain)
 {
 
-    for (long n = 0; n < myStructure.nrNodes; n++)
-         myNode[n].H = myNode[n].oldH;
+    for (long n = 0; n < myDomain->structure.nrNodes; n++)
+         myDomain->nodeState.H[n] = myDomain->nodeState.oldH[n];
 
 }
@@ -132,7 +132,7 @@ bool readMOSESDailyData(QSqlQuery *query, Crit3DMeteoPoint *meteoPoint, QString
             if (waterTable < 0.f) waterTable = NODATA;
 
             date = getCrit3DDate(myDate);
-            if (meteoPoint->obsDataD[0].date.daysTo(date) < meteoPoint->nrObsDataDaysD)
+            if (meteoPoint->firstDateD.daysTo(date) < meteoPoint->getNrObsDataDaysD())
             {
                 meteoPoint->setMeteoPointValueD(date, dailyAirTemperatureMin, float(tmin));
                 meteoPoint->setMeteoPointValueD(date, dailyAirTemperatureMax, float(tmax));